@@ -0,0 +1,245 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Native benchmark of the RNDISEthernet demo's Internet checksum routines. Each routine is first checked against
+ *  a byte-wise RFC 1071 reference over every packet length and alignment, after which the time taken to checksum
+ *  payloads of typical sizes is reported, alongside the simple word loop the routines replaced.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "Lib/Checksum.h"
+
+/** Largest payload checksummed by the benchmark, the largest TCP segment in a full size Ethernet frame. */
+#define MAX_PAYLOAD_SIZE         1460
+
+/** Number of bytes checksummed for each timed payload size, so that small payloads are timed over many repetitions. */
+#define BYTES_PER_MEASUREMENT    (64UL * 1024 * 1024)
+
+/** Packet data the routines are checked and timed against. */
+static uint8_t  SourceData[MAX_PAYLOAD_SIZE + 8] __attribute__((aligned(4)));
+
+/** Packet buffer the copying routines write into. */
+static uint8_t  DestinationData[MAX_PAYLOAD_SIZE + 8] __attribute__((aligned(4)));
+
+/** Results of the timed routines, so that the compiler cannot discard them. */
+static volatile uint32_t ResultSink;
+
+/** Reference Internet checksum, summing the data a byte at a time as big endian words as described in RFC 1071.
+ *
+ *  \param[in] Data   Pointer to the data to checksum
+ *  \param[in] Bytes  Number of bytes to checksum
+ *
+ *  \return Checksum in network byte order, as it would be read from a packet header on a big endian host
+ */
+static uint16_t Reference_Checksum16(const uint8_t* Data,
+                                     uint16_t Bytes)
+{
+	uint32_t Sum = 0;
+
+	for (uint16_t CurrByte = 0; CurrByte < Bytes; CurrByte++)
+	  Sum += (CurrByte & 0x01) ? Data[CurrByte] : ((uint32_t)Data[CurrByte] << 8);
+
+	while (Sum >> 16)
+	  Sum = ((Sum & 0xFFFF) + (Sum >> 16));
+
+	return ~Sum;
+}
+
+/** Converts a checksum as stored in memory by the routines under test into the network order value returned by
+ *  \ref Reference_Checksum16().
+ *
+ *  \param[in] Checksum  Checksum as it would be written into a packet header
+ *
+ *  \return Checksum value in network byte order
+ */
+static uint16_t NetworkOrder(const uint16_t Checksum)
+{
+	uint8_t Bytes[2];
+
+	memcpy(Bytes, &Checksum, sizeof(Bytes));
+	return (((uint16_t)Bytes[0] << 8) | Bytes[1]);
+}
+
+/** Word loop used by the demo before the checksum routines were added, for comparison (odd lengths excepted). */
+static uint16_t WordLoop_Checksum16(void* Data,
+                                    uint16_t Bytes)
+{
+	uint16_t* Words    = (uint16_t*)Data;
+	uint32_t  Checksum = 0;
+
+	for (uint16_t CurrWord = 0; CurrWord < (Bytes >> 1); CurrWord++)
+	  Checksum += Words[CurrWord];
+
+	while (Checksum & 0xFFFF0000)
+	  Checksum = ((Checksum & 0xFFFF) + (Checksum >> 16));
+
+	return ~Checksum;
+}
+
+/** Checks each of the checksum routines against the reference checksum.
+ *
+ *  \return Boolean \c true if all routines gave the correct results, \c false otherwise
+ */
+static bool CheckRoutines(void)
+{
+	for (uint16_t Offset = 0; Offset < 8; Offset += 2)
+	{
+		for (uint16_t Length = 0; Length <= MAX_PAYLOAD_SIZE; Length++)
+		{
+			uint8_t* Data     = &SourceData[Offset];
+			uint16_t Expected = Reference_Checksum16(Data, Length);
+
+			if (NetworkOrder(Checksum_Calculate16(Data, Length)) != Expected)
+			{
+				printf("Checksum_Calculate16() failed, length %u offset %u.\n", Length, Offset);
+				return false;
+			}
+
+			/* Header and payload summed separately, as the TCP handler does */
+			uint16_t HeaderLength = ((Length / 2) & ~0x01);
+			uint32_t Sum          = Checksum_Add(0, Data, HeaderLength);
+
+			memset(DestinationData, 0xA5, sizeof(DestinationData));
+			Sum = Checksum_Copy(Sum, &DestinationData[Offset], &Data[HeaderLength], (Length - HeaderLength));
+
+			if (NetworkOrder(Checksum_Fold(Sum)) != Expected)
+			{
+				printf("Checksum_Copy() failed, length %u offset %u.\n", Length, Offset);
+				return false;
+			}
+
+			if (memcmp(&DestinationData[Offset], &Data[HeaderLength], (Length - HeaderLength)) ||
+			    (DestinationData[Offset + (Length - HeaderLength)] != 0xA5))
+			{
+				printf("Checksum_Copy() copied incorrectly, length %u offset %u.\n", Length, Offset);
+				return false;
+			}
+
+			if (Length < 2)
+			  continue;
+
+			/* Rewrite one word of the data, and check that the updated checksum matches a full recalculation */
+			uint16_t WordOffset = ((rand() % (Length / 2)) * 2);
+			uint16_t OldWord;
+			uint16_t NewWord    = rand();
+
+			memcpy(&OldWord, &Data[WordOffset], sizeof(uint16_t));
+			memcpy(&DestinationData[Offset], Data, Length);
+			memcpy(&DestinationData[Offset + WordOffset], &NewWord, sizeof(uint16_t));
+
+			uint16_t Updated      = NetworkOrder(Checksum_Update16(Checksum_Calculate16(Data, Length), OldWord, NewWord));
+			uint16_t Recalculated = Reference_Checksum16(&DestinationData[Offset], Length);
+
+			/* Both representations of zero are valid for an updated checksum, RFC 1624 giving the one a sender would */
+			if ((Updated != Recalculated) && ((Updated ^ Recalculated) != 0xFFFF))
+			{
+				printf("Checksum_Update16() failed, length %u offset %u word %u.\n", Length, Offset, WordOffset);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/** Returns the current monotonic time in nanoseconds. */
+static uint64_t GetTime(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (((uint64_t)Now.tv_sec * 1000000000) + Now.tv_nsec);
+}
+
+/** Benchmarks each routine for the given payload size, and prints the average time taken per payload.
+ *
+ *  \param[in] PayloadSize  Size in bytes of the payload to checksum
+ */
+static void BenchmarkPayload(const uint16_t PayloadSize)
+{
+	uint32_t Iterations = (BYTES_PER_MEASUREMENT / PayloadSize);
+	uint64_t StartTime;
+	double   Times[4];
+
+	StartTime = GetTime();
+	for (uint32_t i = 0; i < Iterations; i++)
+	  ResultSink += WordLoop_Checksum16(SourceData, PayloadSize);
+	Times[0] = (double)(GetTime() - StartTime) / Iterations;
+
+	StartTime = GetTime();
+	for (uint32_t i = 0; i < Iterations; i++)
+	  ResultSink += Checksum_Calculate16(SourceData, PayloadSize);
+	Times[1] = (double)(GetTime() - StartTime) / Iterations;
+
+	StartTime = GetTime();
+	for (uint32_t i = 0; i < Iterations; i++)
+	{
+		memcpy(DestinationData, SourceData, PayloadSize);
+		ResultSink += Checksum_Calculate16(DestinationData, PayloadSize);
+	}
+	Times[2] = (double)(GetTime() - StartTime) / Iterations;
+
+	StartTime = GetTime();
+	for (uint32_t i = 0; i < Iterations; i++)
+	  ResultSink += Checksum_Fold(Checksum_Copy(0, DestinationData, SourceData, PayloadSize));
+	Times[3] = (double)(GetTime() - StartTime) / Iterations;
+
+	printf("%7u %12.1f %12.1f %12.1f %12.1f\n", PayloadSize, Times[0], Times[1], Times[2], Times[3]);
+}
+
+int main(void)
+{
+	static const uint16_t PayloadSizes[] = {20, 64, 128, 256, 512, 1024, MAX_PAYLOAD_SIZE};
+
+	srand(1);
+
+	for (uint16_t CurrByte = 0; CurrByte < sizeof(SourceData); CurrByte++)
+	  SourceData[CurrByte] = rand();
+
+	if (!(CheckRoutines()))
+	  return EXIT_FAILURE;
+
+	printf("Checksum routines match the reference for all lengths.\n\n");
+	printf("Average time per payload (ns):\n");
+	printf("%7s %12s %12s %12s %12s\n", "Bytes", "Word loop", "Calculate", "Copy+Calc", "Copy");
+
+	for (uint8_t CurrSize = 0; CurrSize < (sizeof(PayloadSizes) / sizeof(PayloadSizes[0])); CurrSize++)
+	  BenchmarkPayload(PayloadSizes[CurrSize]);
+
+	return EXIT_SUCCESS;
+}
+
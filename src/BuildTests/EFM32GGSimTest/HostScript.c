@@ -0,0 +1,546 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Script interpreter of the virtual host, and entry point of the simulation. The firmware is
+ *  started against the simulated EFM32GG USB core while the virtual host runs the script given on
+ *  the command line, one command per line:
+ *
+ *  \verbatim
+ *  attach | detach | reset | suspend | resume    Change the bus state
+ *  wait <frames>                                 Leave the bus idle
+ *  timeout <frames>                              Set the timeout of NAKed transfers
+ *  enumerate                                     Reset, address and configure the device
+ *  address <address>                             Set the device address used by the host
+ *  control <bmRequestType> <bRequest> <wValue> <wIndex> <wLength> [<data byte>...]
+ *                                                Run a control transfer
+ *  out <endpoint> [<data byte>...]               Send data to an OUT endpoint
+ *  out <endpoint> pattern <length>               Send a test pattern to an OUT endpoint
+ *  in <endpoint> <length>                        Read up to the given length from an IN endpoint
+ *  loopback <out> <in> <length> <packet size>    Send a pattern and read it back
+ *  expect ack | nak | stall | none | babble | timeout | mismatch
+ *                                                Check the result of the previous command
+ *  expect length <length>                        Check the data length of the previous command
+ *  expect data [<data byte>...]                  Check the data of the previous command
+ *  expect frames <frames>                        Check the previous loopback took at most this long
+ *  expect leds <mask> | baud <rate>              Check the board state
+ *  print <text>                                  Print a message
+ *  stats                                         Print the simulated core's counters
+ *  \endverbatim
+ *
+ *  Numbers use C syntax, data bytes are always hexadecimal and \c # starts a comment. A command
+ *  which does not complete with an ACK fails the script, unless the following line expects its
+ *  result.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "SimCore.h"
+#include "SimHAL.h"
+#include "VirtualHost.h"
+
+/** Largest number of words on a script line. */
+#define SCRIPT_MAX_WORDS             (SIM_MAX_PACKET_SIZE + 8)
+
+/** Largest amount of data a single script command transfers. */
+#define SCRIPT_MAX_DATA              4096
+
+/** Type define for a script command handler, returning \c false if the script is to be aborted. */
+typedef bool (*Script_Handler_t)(char **Words, const int Count);
+
+/** Type define for an entry of the script command table. */
+typedef struct {
+	const char*      Name;
+	int              MinWords;
+	Script_Handler_t Handler;
+} Script_Command_t;
+
+extern int Sim_FirmwareMain(void);
+
+static const char* Script_Path;
+static FILE*       Script_File;
+static unsigned    Script_Line;
+static bool        Script_Verbose;
+
+static uint8_t     Script_Result = HOST_RESULT_ACK;
+static bool        Script_ResultChecked = true;
+static uint8_t     Script_Data[SCRIPT_MAX_DATA];
+static uint16_t    Script_Length;
+static uint32_t    Script_Frames;
+
+static bool Script_Error(const char *Format, ...) __attribute__((format(printf, 1, 2)));
+static bool Script_Error(const char *Format, ...)
+{
+	va_list Args;
+
+	fprintf(stderr, "%s:%u: ", Script_Path, Script_Line);
+	va_start(Args, Format);
+	vfprintf(stderr, Format, Args);
+	va_end(Args);
+	fputc('\n', stderr);
+
+	return false;
+}
+
+static bool Script_Number(const char *Word, uint32_t *const Value)
+{
+	char* End;
+
+	*Value = strtoul(Word, &End, 0);
+
+	if (!(*Word) || *End)
+	  return Script_Error("'%s' is not a number", Word);
+
+	return true;
+}
+
+static bool Script_Bytes(char **Words, const int Count, uint8_t *const Data, uint16_t *const Length)
+{
+	int Index;
+
+	if (Count > SCRIPT_MAX_DATA)
+	  return Script_Error("too many data bytes");
+
+	for (Index = 0; Index < Count; Index++) {
+		char*         End;
+		unsigned long Value = strtoul(Words[Index], &End, 16);
+
+		if (*End || (Value > 0xFF))
+		  return Script_Error("'%s' is not a data byte", Words[Index]);
+
+		Data[Index] = Value;
+	}
+
+	*Length = Count;
+	return true;
+}
+
+static bool Script_SetResult(const uint8_t Result)
+{
+	Script_Result        = Result;
+	Script_ResultChecked = (Result == HOST_RESULT_ACK);
+	return true;
+}
+
+static bool Script_Bus(char **Words, const int Count)
+{
+	static const struct {
+		const char* Name;
+		uint8_t     Token;
+	} Operations[] = {
+		{"attach",  SIM_BUS_ATTACH},
+		{"detach",  SIM_BUS_DETACH},
+		{"reset",   SIM_BUS_RESET},
+		{"suspend", SIM_BUS_SUSPEND},
+		{"resume",  SIM_BUS_RESUME},
+	};
+	unsigned Index;
+
+	(void)Count;
+
+	for (Index = 0; strcmp(Operations[Index].Name, Words[0]); Index++);
+
+	return Script_SetResult(Host_Bus(Operations[Index].Token));
+}
+
+static bool Script_Wait(char **Words, const int Count)
+{
+	uint32_t Frames;
+
+	(void)Count;
+
+	if (!(Script_Number(Words[1], &Frames)))
+	  return false;
+
+	Host_WaitFrames(Frames);
+	return true;
+}
+
+static bool Script_Timeout(char **Words, const int Count)
+{
+	uint32_t Frames;
+
+	(void)Count;
+
+	if (!(Script_Number(Words[1], &Frames)))
+	  return false;
+
+	Host_SetTimeout(Frames);
+	return true;
+}
+
+static bool Script_Enumerate(char **Words, const int Count)
+{
+	(void)Words;
+	(void)Count;
+
+	return Script_SetResult(Host_Enumerate());
+}
+
+static bool Script_Address(char **Words, const int Count)
+{
+	uint32_t Address;
+
+	(void)Count;
+
+	if (!(Script_Number(Words[1], &Address)))
+	  return false;
+
+	Host_SetAddress(Address);
+	return true;
+}
+
+static bool Script_Control(char **Words, const int Count)
+{
+	Host_Request_t Request;
+	uint32_t       Fields[5];
+	uint16_t       DataLength = 0;
+	int            Index;
+
+	for (Index = 0; Index < 5; Index++) {
+		if (!(Script_Number(Words[1 + Index], &Fields[Index])))
+		  return false;
+	}
+
+	Request.bmRequestType = Fields[0];
+	Request.bRequest      = Fields[1];
+	Request.wValue        = Fields[2];
+	Request.wIndex        = Fields[3];
+	Request.wLength       = Fields[4];
+
+	if (Request.wLength > SCRIPT_MAX_DATA)
+	  return Script_Error("wLength %u is too long", Request.wLength);
+
+	if (!(Script_Bytes(&Words[6], Count - 6, Script_Data, &DataLength)))
+	  return false;
+
+	if (!(Request.bmRequestType & 0x80) && (DataLength != Request.wLength))
+	  return Script_Error("%u data bytes given for wLength %u", DataLength, Request.wLength);
+
+	return Script_SetResult(Host_ControlTransfer(&Request, Script_Data, &Script_Length));
+}
+
+static bool Script_OUT(char **Words, const int Count)
+{
+	uint32_t EPNum;
+	uint16_t Length;
+
+	if (!(Script_Number(Words[1], &EPNum)))
+	  return false;
+
+	if ((Count == 4) && !(strcmp(Words[2], "pattern"))) {
+		uint32_t PatternLength;
+
+		if (!(Script_Number(Words[3], &PatternLength)))
+		  return false;
+
+		if (PatternLength > SCRIPT_MAX_DATA)
+		  return Script_Error("pattern length %u is too long", PatternLength);
+
+		for (Length = 0; Length < PatternLength; Length++)
+		  Script_Data[Length] = (uint8_t)Length;
+	} else if (!(Script_Bytes(&Words[2], Count - 2, Script_Data, &Length))) {
+		return false;
+	}
+
+	Script_Length = Length;
+	return Script_SetResult(Host_OUT(EPNum, Script_Data, Length));
+}
+
+static bool Script_IN(char **Words, const int Count)
+{
+	uint32_t EPNum;
+	uint32_t MaxLength;
+
+	(void)Count;
+
+	if (!(Script_Number(Words[1], &EPNum)) || !(Script_Number(Words[2], &MaxLength)))
+	  return false;
+
+	if (MaxLength > SCRIPT_MAX_DATA)
+	  return Script_Error("length %u is too long", MaxLength);
+
+	return Script_SetResult(Host_IN(EPNum, Script_Data, MaxLength, &Script_Length));
+}
+
+static bool Script_Loopback(char **Words, const int Count)
+{
+	uint32_t Fields[4];
+	int      Index;
+	uint8_t  Result;
+
+	(void)Count;
+
+	for (Index = 0; Index < 4; Index++) {
+		if (!(Script_Number(Words[1 + Index], &Fields[Index])))
+		  return false;
+	}
+
+	if (!(Fields[3]) || (Fields[3] > SIM_MAX_PACKET_SIZE))
+	  return Script_Error("packet size %u is out of range", Fields[3]);
+
+	Script_Frames = 0;
+	Result = Host_Loopback(Fields[0], Fields[1], Fields[2], Fields[3], &Script_Frames);
+
+	if (Result == HOST_RESULT_ACK) {
+		printf("%s:%u: loopback of %u bytes in %u frames, %.1f bytes per frame\n", Script_Path, Script_Line,
+		       Fields[2], Script_Frames, Script_Frames ? ((double)Fields[2] / Script_Frames) : (double)Fields[2]);
+	}
+
+	return Script_SetResult(Result);
+}
+
+static bool Script_Expect(char **Words, const int Count)
+{
+	static const char* Results[] = {"ack", "nak", "stall", "none", "babble", "timeout", "mismatch"};
+	uint32_t Value;
+	unsigned Index;
+
+	for (Index = 0; Index < (sizeof(Results) / sizeof(Results[0])); Index++) {
+		if (strcmp(Words[1], Results[Index]))
+		  continue;
+
+		if (Script_Result != Index) {
+			return Script_Error("expected %s, got %s%s%s", Results[Index], Results[Script_Result],
+			                    (Script_Result != HOST_RESULT_ACK) ? ": " : "",
+			                    (Script_Result != HOST_RESULT_ACK) ? Host_GetError() : "");
+		}
+
+		Script_ResultChecked = true;
+		return true;
+	}
+
+	/* Checking data or state is meaningless after a failed command */
+	if (!(Script_ResultChecked))
+	  return Script_Error("%s", Host_GetError());
+
+	if (!(strcmp(Words[1], "data"))) {
+		uint8_t  Expected[SCRIPT_MAX_DATA];
+		uint16_t ExpectedLength;
+
+		if (!(Script_Bytes(&Words[2], Count - 2, Expected, &ExpectedLength)))
+		  return false;
+
+		if ((ExpectedLength != Script_Length) || memcmp(Expected, Script_Data, ExpectedLength)) {
+			char     Received[(SCRIPT_MAX_DATA * 3) + 1] = "";
+			uint16_t Index;
+
+			for (Index = 0; Index < Script_Length; Index++)
+			  sprintf(&Received[Index * 3], " %02X", Script_Data[Index]);
+
+			return Script_Error("data differs, %u bytes received, %u expected:%s", Script_Length, ExpectedLength,
+			                    Received);
+		}
+
+		return true;
+	}
+
+	if (Count < 3)
+	  return Script_Error("expect %s needs a value", Words[1]);
+
+	if (!(Script_Number(Words[2], &Value)))
+	  return false;
+
+	if (!(strcmp(Words[1], "length"))) {
+		if (Script_Length != Value)
+		  return Script_Error("length is %u, expected %u", Script_Length, Value);
+	} else if (!(strcmp(Words[1], "frames"))) {
+		if (Script_Frames > Value)
+		  return Script_Error("took %u frames, expected at most %u", Script_Frames, Value);
+	} else if (!(strcmp(Words[1], "leds"))) {
+		if (Sim_GetBoardLEDs() != Value)
+		  return Script_Error("LEDs are 0x%04X, expected 0x%04X", Sim_GetBoardLEDs(), Value);
+	} else if (!(strcmp(Words[1], "baud"))) {
+		if (Sim_GetBaudRate() != Value)
+		  return Script_Error("baud rate is %u, expected %u", Sim_GetBaudRate(), Value);
+	} else {
+		return Script_Error("unknown expectation '%s'", Words[1]);
+	}
+
+	return true;
+}
+
+static bool Script_Print(char **Words, const int Count)
+{
+	int Index;
+
+	printf("%s:%u:", Script_Path, Script_Line);
+
+	for (Index = 1; Index < Count; Index++)
+	  printf(" %s", Words[Index]);
+
+	putchar('\n');
+	return true;
+}
+
+static void Script_PrintStatistics(void)
+{
+	Sim_Statistics_t Statistics;
+
+	Sim_GetStatistics(&Statistics);
+
+	printf("%s: %u frames, %u transactions (%u NAK, %u STALL), %u USB and %u SysTick interrupts\n",
+	       Script_Path, Statistics.Frames, Statistics.Transactions, Statistics.NAKs, Statistics.STALLs,
+	       Statistics.USBInterrupts, Statistics.SysTickInterrupts);
+	printf("%s: %u of %u slots asleep in EM1 (%u entries), %u in interrupt handlers, %u register accesses\n",
+	       Script_Path, Statistics.SleepSlots, Statistics.Slots, Statistics.SleepEntries,
+	       Statistics.InterruptSlots, Statistics.RegisterAccesses);
+}
+
+static bool Script_Stats(char **Words, const int Count)
+{
+	(void)Words;
+	(void)Count;
+
+	Script_PrintStatistics();
+	return true;
+}
+
+static const Script_Command_t Script_Commands[] = {
+	{"attach",    1, Script_Bus},
+	{"detach",    1, Script_Bus},
+	{"reset",     1, Script_Bus},
+	{"suspend",   1, Script_Bus},
+	{"resume",    1, Script_Bus},
+	{"wait",      2, Script_Wait},
+	{"timeout",   2, Script_Timeout},
+	{"enumerate", 1, Script_Enumerate},
+	{"address",   2, Script_Address},
+	{"control",   6, Script_Control},
+	{"out",       2, Script_OUT},
+	{"in",        3, Script_IN},
+	{"loopback",  5, Script_Loopback},
+	{"expect",    2, Script_Expect},
+	{"print",     1, Script_Print},
+	{"stats",     1, Script_Stats},
+};
+
+static bool Script_RunLine(char *Line)
+{
+	static char* Words[SCRIPT_MAX_WORDS];
+	int          Count = 0;
+	char*        Word;
+	unsigned     Index;
+
+	if ((Word = strchr(Line, '#')) != NULL)
+	  *Word = '\0';
+
+	for (Word = strtok(Line, " \t\r\n"); Word; Word = strtok(NULL, " \t\r\n")) {
+		if (Count == SCRIPT_MAX_WORDS)
+		  return Script_Error("line is too long");
+
+		Words[Count++] = Word;
+	}
+
+	if (!(Count))
+	  return true;
+
+	/* A failed command must be followed by an expectation of its result */
+	if (!(Script_ResultChecked) && strcmp(Words[0], "expect"))
+	  return Script_Error("%s", Host_GetError());
+
+	for (Index = 0; Index < (sizeof(Script_Commands) / sizeof(Script_Commands[0])); Index++) {
+		if (strcmp(Script_Commands[Index].Name, Words[0]))
+		  continue;
+
+		if (Count < Script_Commands[Index].MinWords)
+		  return Script_Error("%s needs %d arguments", Words[0], Script_Commands[Index].MinWords - 1);
+
+		if (Script_Verbose)
+		  printf("%s:%u: %s\n", Script_Path, Script_Line, Words[0]);
+
+		return Script_Commands[Index].Handler(Words, Count);
+	}
+
+	return Script_Error("unknown command '%s'", Words[0]);
+}
+
+static void Script_Host(void)
+{
+	static char Line[16384];
+
+	while (fgets(Line, sizeof(Line), Script_File)) {
+		Script_Line++;
+
+		if (!(Script_RunLine(Line))) {
+			Script_PrintStatistics();
+			printf("%s: FAILED\n", Script_Path);
+			Sim_Exit(1);
+		}
+	}
+
+	if (!(Script_ResultChecked)) {
+		Script_Error("%s", Host_GetError());
+		Sim_Exit(1);
+	}
+
+	Script_PrintStatistics();
+	printf("%s: PASSED\n", Script_Path);
+	Sim_Exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t CyclesPerAccess = SIM_DEFAULT_ACCESS_CYCLES;
+	int      Option;
+
+	while ((Option = getopt(argc, argv, "vc:")) != -1) {
+		switch (Option) {
+			case 'v':
+				Script_Verbose = true;
+				break;
+			case 'c':
+				CyclesPerAccess = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-v] [-c cycles per register access] script\n", argv[0]);
+				return 2;
+		}
+	}
+
+	if ((optind + 1) != argc) {
+		fprintf(stderr, "Usage: %s [-v] [-c cycles per register access] script\n", argv[0]);
+		return 2;
+	}
+
+	Script_Path = argv[optind];
+
+	if ((Script_File = fopen(Script_Path, "r")) == NULL) {
+		perror(Script_Path);
+		return 2;
+	}
+
+	Sim_Start(CyclesPerAccess, Sim_FirmwareMain, Script_Host);
+}
@@ -0,0 +1,79 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated DK3750 board support header for the host side USB core simulation.
+ *
+ *  The board controller registers are plain variables, so that scripts can check the LED state.
+ */
+
+#ifndef __BSP_SIM_H__
+#define __BSP_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Macros: */
+#define BSP_INIT_DEFAULT         0
+#define BSP_STATUS_OK            0
+#define BSP_RS232_UART           1
+#define BSP_LED_PORT             (&Sim_BoardLEDs)
+
+/* External Variables: */
+extern volatile uint16_t Sim_BoardLEDs;
+extern volatile uint16_t Sim_BoardButtons;
+
+/* Function Prototypes: */
+int      BSP_Init(const uint32_t Flags);
+int      BSP_PeripheralAccess(const int Peripheral, const bool Enable);
+uint16_t BSP_PushButtonsGet(void);
+
+/* Inline Functions: */
+static inline void BSP_RegisterWrite(volatile uint16_t *Address, const uint16_t Data)
+{
+	*Address = Data;
+}
+
+static inline uint16_t BSP_RegisterRead(volatile uint16_t *Address)
+{
+	return *Address;
+}
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
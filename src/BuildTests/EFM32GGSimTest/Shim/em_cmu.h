@@ -0,0 +1,84 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK clock management header for the host side USB core simulation.
+ *
+ *  All clocks are considered running at the 48MHz the demos select, selections are ignored.
+ */
+
+#ifndef __EM_CMU_SIM_H__
+#define __EM_CMU_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Enums: */
+typedef enum {
+	cmuClock_HF,
+	cmuClock_HFPER,
+	cmuClock_CORE,
+	cmuClock_GPIO,
+	cmuClock_DMA,
+	cmuClock_USB,
+	cmuClock_USBC,
+	cmuClock_UART0,
+	cmuClock_UART1,
+	cmuClock_USART0,
+	cmuClock_USART1,
+	cmuClock_USART2,
+	cmuClock_TIMER0,
+} CMU_Clock_TypeDef;
+
+typedef enum {
+	cmuSelect_Disabled,
+	cmuSelect_LFXO,
+	cmuSelect_LFRCO,
+	cmuSelect_HFXO,
+	cmuSelect_HFRCO,
+	cmuSelect_HFCLK,
+} CMU_Select_TypeDef;
+
+/* Function Prototypes: */
+void     CMU_ClockEnable(const CMU_Clock_TypeDef Clock, const bool Enable);
+uint32_t CMU_ClockFreqGet(const CMU_Clock_TypeDef Clock);
+void     CMU_ClockSelectSet(const CMU_Clock_TypeDef Clock, const CMU_Select_TypeDef Ref);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,528 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated EFM32GG device header for the host side USB core simulation.
+ *
+ *  Stands in for the Gecko SDK device header when the EFM32GG port is built natively. The
+ *  peripherals are plain structures in RAM instead of memory mapped registers, laid out so that
+ *  the endpoint register arrays alias the EP0 registers in the same way as on the silicon. Only
+ *  the registers and bit fields used by the LUFA port, the board drivers and the demos are given.
+ */
+
+#ifndef __EM_DEVICE_SIM_H__
+#define __EM_DEVICE_SIM_H__
+
+/* Includes: */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+#define __I                                   volatile const
+#define __O                                   volatile
+#define __IO                                  volatile
+
+#define EFM32GG990F1024
+#define EFM32_PACK_START(x)
+#define EFM32_PACK_END()
+#define EFM32_ALIGN(x)
+#define __STATIC_INLINE                       static inline
+
+#define USB_IRQn                              5
+#define SysTick_IRQn                          -1
+
+/* USB core registers */
+#define USB_CTRL_VREGOSEN                     (0x1UL << 17)
+#define USB_STATUS_VREGOS                     (0x1UL << 0)
+
+#define USB_IF_VREGOSH                        (0x1UL << 0)
+#define USB_IF_VREGOSL                        (0x1UL << 1)
+#define USB_IFS_VREGOSH                       USB_IF_VREGOSH
+#define USB_IFS_VREGOSL                       USB_IF_VREGOSL
+#define USB_IFC_VREGOSH                       USB_IF_VREGOSH
+#define USB_IFC_VREGOSL                       USB_IF_VREGOSL
+#define USB_IEN_VREGOSH                       USB_IF_VREGOSH
+#define USB_IEN_VREGOSL                       USB_IF_VREGOSL
+
+#define USB_ROUTE_PHYPEN                      (0x1UL << 0)
+#define USB_ROUTE_VBUSENPEN                   (0x1UL << 1)
+
+#define USB_GAHBCFG_GLBLINTRMSK               (0x1UL << 0)
+#define _USB_GAHBCFG_HBSTLEN_MASK             0x1EUL
+#define USB_GAHBCFG_HBSTLEN_INCR              (0x1UL << 1)
+#define USB_GAHBCFG_DMAEN                     (0x1UL << 5)
+
+#define USB_GUSBCFG_FORCEHSTMODE              (0x1UL << 29)
+#define USB_GUSBCFG_FORCEDEVMODE              (0x1UL << 30)
+#define USB_GUSBCFG_CORRUPTTXPKT              (0x1UL << 31)
+
+#define USB_GRSTCTL_CSFTRST                   (0x1UL << 0)
+#define USB_GRSTCTL_RXFFLSH                   (0x1UL << 4)
+#define USB_GRSTCTL_TXFFLSH                   (0x1UL << 5)
+#define _USB_GRSTCTL_TXFNUM_SHIFT             6
+#define _USB_GRSTCTL_TXFNUM_MASK              0x7C0UL
+#define USB_GRSTCTL_AHBIDLE                   (0x1UL << 31)
+
+#define USB_GINTSTS_CURMOD                    (0x1UL << 0)
+#define USB_GINTSTS_SOF                       (0x1UL << 3)
+#define USB_GINTSTS_USBSUSP                   (0x1UL << 11)
+#define USB_GINTSTS_USBRST                    (0x1UL << 12)
+#define USB_GINTSTS_ENUMDONE                  (0x1UL << 13)
+#define USB_GINTSTS_IEPINT                    (0x1UL << 18)
+#define USB_GINTSTS_OEPINT                    (0x1UL << 19)
+#define USB_GINTSTS_RESETDET                  (0x1UL << 23)
+#define USB_GINTSTS_WKUPINT                   (0x1UL << 31)
+
+#define USB_GINTMSK_SOFMSK                    USB_GINTSTS_SOF
+#define USB_GINTMSK_USBSUSPMSK                USB_GINTSTS_USBSUSP
+#define USB_GINTMSK_USBRSTMSK                 USB_GINTSTS_USBRST
+#define USB_GINTMSK_ENUMDONEMSK               USB_GINTSTS_ENUMDONE
+#define USB_GINTMSK_IEPINTMSK                 USB_GINTSTS_IEPINT
+#define USB_GINTMSK_OEPINTMSK                 USB_GINTSTS_OEPINT
+#define USB_GINTMSK_RESETDETMSK               USB_GINTSTS_RESETDET
+#define USB_GINTMSK_WKUPINTMSK                USB_GINTSTS_WKUPINT
+
+#define _USB_GRXFSIZ_RXFDEP_SHIFT             0
+#define _USB_GRXFSIZ_RXFDEP_MASK              0x3FFUL
+#define _USB_GNPTXFSIZ_NPTXFSTADDR_SHIFT      0
+#define _USB_GNPTXFSIZ_NPTXFSTADDR_MASK       0xFFFFUL
+#define _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_SHIFT 16
+#define _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_MASK  0xFFFF0000UL
+#define _USB_DIEPTXF1_INEPNTXFSTADDR_MASK     0x7FFUL
+#define _USB_DIEPTXF1_INEPNTXFDEP_SHIFT       16
+
+#define _USB_HFNUM_RESETVALUE                 0x00003FFFUL
+
+#define _USB_DCFG_DEVSPD_MASK                 0x3UL
+#define USB_DCFG_NZSTSOUTHSHK                 (0x1UL << 2)
+#define _USB_DCFG_DEVADDR_SHIFT               4
+#define _USB_DCFG_DEVADDR_MASK                0x7F0UL
+#define _USB_DCFG_PERFRINT_MASK               0x1800UL
+
+#define USB_DCTL_RMTWKUPSIG                   (0x1UL << 0)
+#define USB_DCTL_SFTDISCON                    (0x1UL << 1)
+#define USB_DCTL_SGNPINNAK                    (0x1UL << 7)
+#define USB_DCTL_CGNPINNAK                    (0x1UL << 8)
+#define USB_DCTL_SGOUTNAK                     (0x1UL << 9)
+#define USB_DCTL_CGOUTNAK                     (0x1UL << 10)
+
+#define USB_DSTS_SUSPSTS                      (0x1UL << 0)
+#define _USB_DSTS_ENUMSPD_SHIFT               1
+#define _USB_DSTS_SOFFN_SHIFT                 8
+#define _USB_DSTS_SOFFN_MASK                  0x3FFF00UL
+
+#define USB_DIEPMSK_XFERCOMPLMSK              (0x1UL << 0)
+#define USB_DIEPMSK_EPDISBLDMSK               (0x1UL << 1)
+#define USB_DIEPMSK_INEPNAKEFFMSK             (0x1UL << 6)
+#define USB_DOEPMSK_XFERCOMPLMSK              (0x1UL << 0)
+#define USB_DOEPMSK_EPDISBLDMSK               (0x1UL << 1)
+#define USB_DOEPMSK_SETUPMSK                  (0x1UL << 3)
+
+#define USB_DAINTMSK_INEPMSK0                 (0x1UL << 0)
+#define USB_DAINTMSK_OUTEPMSK0                (0x1UL << 16)
+#define _USB_DAINTMSK_OUTEPMSK0_SHIFT         16
+
+/* Endpoint control, shared by EP0 and the endpoint arrays */
+#define _USB_DIEP_CTL_MPS_SHIFT               0
+#define _USB_DIEP_CTL_MPS_MASK                0x7FFUL
+#define USB_DIEP_CTL_USBACTEP                 (0x1UL << 15)
+#define USB_DIEP_CTL_NAKSTS                   (0x1UL << 17)
+#define _USB_DIEP_CTL_EPTYPE_SHIFT            18
+#define _USB_DIEP_CTL_EPTYPE_MASK             0xC0000UL
+#define USB_DIEP_CTL_STALL                    (0x1UL << 21)
+#define _USB_DIEP_CTL_TXFNUM_SHIFT            22
+#define _USB_DIEP_CTL_TXFNUM_MASK             0x3C00000UL
+#define USB_DIEP_CTL_CNAK                     (0x1UL << 26)
+#define USB_DIEP_CTL_SNAK                     (0x1UL << 27)
+#define USB_DIEP_CTL_SETD0PIDEF               (0x1UL << 28)
+#define USB_DIEP_CTL_SETD1PIDOF               (0x1UL << 29)
+#define USB_DIEP_CTL_EPDIS                    (0x1UL << 30)
+#define USB_DIEP_CTL_EPENA                    (0x1UL << 31)
+
+#define _USB_DOEP_CTL_MPS_SHIFT               _USB_DIEP_CTL_MPS_SHIFT
+#define _USB_DOEP_CTL_MPS_MASK                _USB_DIEP_CTL_MPS_MASK
+#define USB_DOEP_CTL_USBACTEP                 USB_DIEP_CTL_USBACTEP
+#define USB_DOEP_CTL_NAKSTS                   USB_DIEP_CTL_NAKSTS
+#define _USB_DOEP_CTL_EPTYPE_SHIFT            _USB_DIEP_CTL_EPTYPE_SHIFT
+#define _USB_DOEP_CTL_EPTYPE_MASK             _USB_DIEP_CTL_EPTYPE_MASK
+#define USB_DOEP_CTL_STALL                    USB_DIEP_CTL_STALL
+#define USB_DOEP_CTL_CNAK                     USB_DIEP_CTL_CNAK
+#define USB_DOEP_CTL_SNAK                     USB_DIEP_CTL_SNAK
+#define USB_DOEP_CTL_SETD0PIDEF               USB_DIEP_CTL_SETD0PIDEF
+#define USB_DOEP_CTL_SETD1PIDOF               USB_DIEP_CTL_SETD1PIDOF
+#define USB_DOEP_CTL_EPDIS                    USB_DIEP_CTL_EPDIS
+#define USB_DOEP_CTL_EPENA                    USB_DIEP_CTL_EPENA
+
+#define USB_DIEP_INT_XFERCOMPL                (0x1UL << 0)
+#define USB_DIEP_INT_EPDISBLD                 (0x1UL << 1)
+#define USB_DIEP_INT_INEPNAKEFF               (0x1UL << 6)
+#define USB_DOEP_INT_XFERCOMPL                (0x1UL << 0)
+#define USB_DOEP_INT_EPDISBLD                 (0x1UL << 1)
+#define USB_DOEP_INT_SETUP                    (0x1UL << 3)
+
+#define _USB_DIEP_TSIZ_XFERSIZE_SHIFT         0
+#define _USB_DIEP_TSIZ_XFERSIZE_MASK          0x7FFFFUL
+#define _USB_DIEP_TSIZ_PKTCNT_SHIFT           19
+#define _USB_DIEP_TSIZ_PKTCNT_MASK            0x1FF80000UL
+#define _USB_DOEP_TSIZ_XFERSIZE_SHIFT         _USB_DIEP_TSIZ_XFERSIZE_SHIFT
+#define _USB_DOEP_TSIZ_XFERSIZE_MASK          _USB_DIEP_TSIZ_XFERSIZE_MASK
+#define _USB_DOEP_TSIZ_PKTCNT_SHIFT           _USB_DIEP_TSIZ_PKTCNT_SHIFT
+#define _USB_DOEP_TSIZ_PKTCNT_MASK            _USB_DIEP_TSIZ_PKTCNT_MASK
+#define _USB_DOEP0TSIZ_SUPCNT_SHIFT           29
+#define _USB_DOEP0TSIZ_SUPCNT_MASK            0x60000000UL
+
+/* Host mode registers, shared by the port and the host channels */
+#define USB_CTRL_VBUSENAP                     (0x1UL << 2)
+#define USB_GOTGCTL_CONIDSTS                  (0x1UL << 16)
+
+#define USB_GINTSTS_PRTINT                    (0x1UL << 24)
+#define USB_GINTSTS_HCHINT                    (0x1UL << 25)
+#define USB_GINTSTS_CONIDSTSCHNG              (0x1UL << 28)
+#define USB_GINTSTS_DISCONNINT                (0x1UL << 29)
+#define USB_GINTMSK_PRTINTMSK                 USB_GINTSTS_PRTINT
+#define USB_GINTMSK_HCHINTMSK                 USB_GINTSTS_HCHINT
+#define USB_GINTMSK_CONIDSTSCHNGMSK           USB_GINTSTS_CONIDSTSCHNG
+#define USB_GINTMSK_DISCONNINTMSK             USB_GINTSTS_DISCONNINT
+
+#define _USB_HPTXFSIZ_PTXFSTADDR_MASK         0x7FFUL
+#define _USB_HPTXFSIZ_PTXFSIZE_SHIFT          16
+
+#define _USB_HCFG_FSLSPCLKSEL_MASK            0x3UL
+#define _USB_HCFG_FSLSPCLKSEL_DIV1            0x0UL
+#define _USB_HCFG_FSLSPCLKSEL_DIV8            0x2UL
+#define USB_HCFG_FSLSSUPP                     (0x1UL << 2)
+#define _USB_HFIR_FRINT_MASK                  0xFFFFUL
+#define _USB_HFNUM_FRNUM_MASK                 0xFFFFUL
+
+#define USB_HPRT_PRTCONNSTS                   (0x1UL << 0)
+#define USB_HPRT_PRTCONNDET                   (0x1UL << 1)
+#define USB_HPRT_PRTENA                       (0x1UL << 2)
+#define USB_HPRT_PRTENCHNG                    (0x1UL << 3)
+#define USB_HPRT_PRTOVRCURRACT                (0x1UL << 4)
+#define USB_HPRT_PRTOVRCURRCHNG               (0x1UL << 5)
+#define USB_HPRT_PRTRES                       (0x1UL << 6)
+#define USB_HPRT_PRTSUSP                      (0x1UL << 7)
+#define USB_HPRT_PRTRST                       (0x1UL << 8)
+#define _USB_HPRT_PRTLNSTS_MASK               0xC00UL
+#define USB_HPRT_PRTPWR                       (0x1UL << 12)
+#define _USB_HPRT_PRTSPD_SHIFT                17
+#define _USB_HPRT_PRTSPD_MASK                 0x60000UL
+#define _USB_HPRT_PRTSPD_FS                   0x1UL
+#define _USB_HPRT_PRTSPD_LS                   0x2UL
+
+#define _USB_HC_CHAR_MPS_MASK                 0x7FFUL
+#define _USB_HC_CHAR_EPNUM_SHIFT              11
+#define _USB_HC_CHAR_EPNUM_MASK               0x7800UL
+#define USB_HC_CHAR_EPDIR                     (0x1UL << 15)
+#define USB_HC_CHAR_LSPDDEV                   (0x1UL << 17)
+#define _USB_HC_CHAR_EPTYPE_SHIFT             18
+#define _USB_HC_CHAR_EPTYPE_MASK              0xC0000UL
+#define _USB_HC_CHAR_MC_SHIFT                 20
+#define _USB_HC_CHAR_MC_MASK                  0x300000UL
+#define _USB_HC_CHAR_DEVADDR_SHIFT            22
+#define _USB_HC_CHAR_DEVADDR_MASK             0x1FC00000UL
+#define USB_HC_CHAR_ODDFRM                    (0x1UL << 29)
+#define USB_HC_CHAR_CHDIS                     (0x1UL << 30)
+#define USB_HC_CHAR_CHENA                     (0x1UL << 31)
+
+#define USB_HC_INT_XFERCOMPL                  (0x1UL << 0)
+#define USB_HC_INT_CHHLTD                     (0x1UL << 1)
+#define USB_HC_INT_AHBERR                     (0x1UL << 2)
+#define USB_HC_INT_STALL                      (0x1UL << 3)
+#define USB_HC_INT_NAK                        (0x1UL << 4)
+#define USB_HC_INT_ACK                        (0x1UL << 5)
+#define USB_HC_INT_XACTERR                    (0x1UL << 7)
+#define USB_HC_INT_BBLERR                     (0x1UL << 8)
+#define USB_HC_INT_FRMOVRUN                   (0x1UL << 9)
+#define USB_HC_INT_DATATGLERR                 (0x1UL << 10)
+#define USB_HC_INTMSK_CHHLTDMSK               USB_HC_INT_CHHLTD
+
+#define _USB_HC_TSIZ_XFERSIZE_SHIFT           0
+#define _USB_HC_TSIZ_XFERSIZE_MASK            0x7FFFFUL
+#define _USB_HC_TSIZ_PKTCNT_SHIFT             19
+#define _USB_HC_TSIZ_PKTCNT_MASK              0x1FF80000UL
+#define _USB_HC_TSIZ_PID_SHIFT                29
+#define _USB_HC_TSIZ_PID_MASK                 0x60000000UL
+#define _USB_HC_TSIZ_PID_DATA0                0x0UL
+#define _USB_HC_TSIZ_PID_DATA2                0x1UL
+#define _USB_HC_TSIZ_PID_DATA1                0x2UL
+#define _USB_HC_TSIZ_PID_MDATA                0x3UL
+
+#define USB_PCGCCTL_STOPPCLK                  (0x1UL << 0)
+#define USB_PCGCCTL_PWRCLMP                   (0x1UL << 2)
+#define USB_PCGCCTL_RSTPDWNMODULE             (0x1UL << 3)
+
+/* Clock management */
+#define CMU_HFCORECLKEN0_USBC                 (0x1UL << 1)
+#define CMU_HFCORECLKEN0_USB                  (0x1UL << 3)
+
+/* UART frame and route settings */
+#define UART_FRAME_DATABITS_FIVE              0x2UL
+#define UART_FRAME_DATABITS_SIX               0x3UL
+#define UART_FRAME_DATABITS_SEVEN             0x4UL
+#define UART_FRAME_DATABITS_EIGHT             0x5UL
+#define UART_FRAME_DATABITS_SIXTEEN           0xDUL
+#define UART_FRAME_PARITY_NONE                (0x0UL << 8)
+#define UART_FRAME_PARITY_EVEN                (0x2UL << 8)
+#define UART_FRAME_PARITY_ODD                 (0x3UL << 8)
+#define UART_FRAME_STOPBITS_ONE               (0x1UL << 12)
+#define UART_FRAME_STOPBITS_ONEANDAHALF       (0x2UL << 12)
+#define UART_FRAME_STOPBITS_TWO               (0x3UL << 12)
+#define UART_ROUTE_RXPEN                      (0x1UL << 0)
+#define UART_ROUTE_TXPEN                      (0x1UL << 1)
+#define UART_ROUTE_LOCATION_LOC1              (0x1UL << 8)
+#define UART_ROUTE_LOCATION_LOC2              (0x2UL << 8)
+#define USART_ROUTE_RXPEN                     UART_ROUTE_RXPEN
+#define USART_ROUTE_TXPEN                     UART_ROUTE_TXPEN
+#define USART_ROUTE_LOCATION_LOC1             UART_ROUTE_LOCATION_LOC1
+
+/* DMA controller descriptors and request signals */
+#define _DMA_CTRL_CYCLE_CTRL_MASK             0x7UL
+#define DMA_CTRL_CYCLE_CTRL_INVALID           0x0UL
+#define _DMA_CTRL_N_MINUS_1_SHIFT             4
+#define _DMA_CTRL_N_MINUS_1_MASK              0x3FF0UL
+#define DMAREQ_UART0_RXDATAV                  ((0x2CUL << 16) | 0x0UL)
+#define DMAREQ_UART0_TXBL                     ((0x2CUL << 16) | 0x1UL)
+#define DMAREQ_UART1_RXDATAV                  ((0x2DUL << 16) | 0x0UL)
+#define DMAREQ_UART1_TXBL                     ((0x2DUL << 16) | 0x1UL)
+
+/* Type Defines: */
+typedef struct {
+	__IO uint32_t CTL;
+	uint32_t      RESERVED0;
+	__IO uint32_t INT;
+	uint32_t      RESERVED1;
+	__IO uint32_t TSIZ;
+	__IO uint32_t DMAADDR;
+	__I  uint32_t TXFSTS;
+	uint32_t      RESERVED2;
+} USB_DIEP_TypeDef;
+
+typedef struct {
+	__IO uint32_t CTL;
+	uint32_t      RESERVED0;
+	__IO uint32_t INT;
+	uint32_t      RESERVED1;
+	__IO uint32_t TSIZ;
+	__IO uint32_t DMAADDR;
+	uint32_t      RESERVED2[2];
+} USB_DOEP_TypeDef;
+
+typedef struct {
+	__IO uint32_t CHAR;
+	uint32_t      RESERVED0;
+	__IO uint32_t INT;
+	__IO uint32_t INTMSK;
+	__IO uint32_t TSIZ;
+	__IO uint32_t DMAADDR;
+	uint32_t      RESERVED1[2];
+} USB_HC_TypeDef;
+
+typedef struct {
+	__IO uint32_t    CTRL;
+	__I  uint32_t    STATUS;
+	__I  uint32_t    IF;
+	__IO uint32_t    IFS;
+	__IO uint32_t    IFC;
+	__IO uint32_t    IEN;
+	__IO uint32_t    ROUTE;
+
+	__IO uint32_t    GOTGCTL;
+	__IO uint32_t    GOTGINT;
+	__IO uint32_t    GAHBCFG;
+	__IO uint32_t    GUSBCFG;
+	__IO uint32_t    GRSTCTL;
+	__IO uint32_t    GINTSTS;
+	__IO uint32_t    GINTMSK;
+	__I  uint32_t    GRXSTSR;
+	__I  uint32_t    GRXSTSP;
+	__IO uint32_t    GRXFSIZ;
+	__IO uint32_t    GNPTXFSIZ;
+	__I  uint32_t    GNPTXSTS;
+	__IO uint32_t    GDFIFOCFG;
+	__IO uint32_t    HPTXFSIZ;
+	__IO uint32_t    DIEPTXF1;
+	__IO uint32_t    DIEPTXF2;
+	__IO uint32_t    DIEPTXF3;
+	__IO uint32_t    DIEPTXF4;
+	__IO uint32_t    DIEPTXF5;
+	__IO uint32_t    DIEPTXF6;
+
+	__IO uint32_t    HCFG;
+	__IO uint32_t    HFIR;
+	__IO uint32_t    HFNUM;
+	__I  uint32_t    HPTXSTS;
+	__I  uint32_t    HAINT;
+	__IO uint32_t    HAINTMSK;
+	__IO uint32_t    HPRT;
+	USB_HC_TypeDef   HC[14];
+
+	__IO uint32_t    DCFG;
+	__IO uint32_t    DCTL;
+	__I  uint32_t    DSTS;
+	__IO uint32_t    DIEPMSK;
+	__IO uint32_t    DOEPMSK;
+	__I  uint32_t    DAINT;
+	__IO uint32_t    DAINTMSK;
+	__IO uint32_t    DVBUSDIS;
+	__IO uint32_t    DVBUSPULSE;
+	__IO uint32_t    DIEPEMPMSK;
+
+	__IO uint32_t    DIEP0CTL;
+	uint32_t         RESERVED0;
+	__IO uint32_t    DIEP0INT;
+	uint32_t         RESERVED1;
+	__IO uint32_t    DIEP0TSIZ;
+	__IO uint32_t    DIEP0DMAADDR;
+	__I  uint32_t    DIEP0TXFSTS;
+	uint32_t         RESERVED2;
+	USB_DIEP_TypeDef DIEP[6];
+
+	__IO uint32_t    DOEP0CTL;
+	uint32_t         RESERVED3;
+	__IO uint32_t    DOEP0INT;
+	uint32_t         RESERVED4;
+	__IO uint32_t    DOEP0TSIZ;
+	__IO uint32_t    DOEP0DMAADDR;
+	uint32_t         RESERVED5[2];
+	USB_DOEP_TypeDef DOEP[6];
+
+	__IO uint32_t    PCGCCTL;
+} USB_TypeDef;
+
+typedef struct {
+	__IO uint32_t HFCORECLKEN0;
+	__IO uint32_t HFPERCLKEN0;
+} CMU_TypeDef;
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t FRAME;
+	__IO uint32_t TRIGCTRL;
+	__IO uint32_t CMD;
+	__I  uint32_t STATUS;
+	__IO uint32_t CLKDIV;
+	__I  uint32_t RXDATA;
+	__IO uint32_t TXDATA;
+	__IO uint32_t IF;
+	__IO uint32_t IFS;
+	__IO uint32_t IFC;
+	__IO uint32_t IEN;
+	__IO uint32_t ROUTE;
+} USART_TypeDef;
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t LOAD;
+	__IO uint32_t VAL;
+} SysTick_Type;
+
+typedef struct {
+	__I  uint32_t STATUS;
+	__O  uint32_t CONFIG;
+	__IO uint32_t CTRLBASE;
+	__I  uint32_t ALTCTRLBASE;
+	__IO uint32_t CHENS;
+	__IO uint32_t CHENC;
+	__IO uint32_t IF;
+	__O  uint32_t IFS;
+	__O  uint32_t IFC;
+	__IO uint32_t IEN;
+} DMA_TypeDef;
+
+typedef struct {
+	void* volatile SRCEND;
+	void* volatile DSTEND;
+	volatile uint32_t CTRL;
+	volatile uint32_t USER;
+} DMA_DESCRIPTOR_TypeDef;
+
+/* External Variables: */
+extern USB_TypeDef*  Sim_USBRegisters;
+extern CMU_TypeDef   Sim_CMU;
+extern USART_TypeDef Sim_UART0, Sim_UART1, Sim_USART0, Sim_USART1, Sim_USART2;
+extern DMA_TypeDef   Sim_DMA;
+
+/* Peripheral Instances: */
+#define USB                                   (Sim_USBRegisters)
+#define CMU                                   (&Sim_CMU)
+#define UART0                                 (&Sim_UART0)
+#define UART1                                 (&Sim_UART1)
+#define USART0                                (&Sim_USART0)
+#define USART1                                (&Sim_USART1)
+#define USART2                                (&Sim_USART2)
+#define DMA                                   (&Sim_DMA)
+
+#define USB_DINEPS                            ((USB_DIEP_TypeDef *)&USB->DIEP0CTL)
+#define USB_DOUTEPS                           ((USB_DOEP_TypeDef *)&USB->DOEP0CTL)
+#define USB_DIEPTXFS                          (&USB->DIEPTXF1)
+
+/** Interrupt handlers are plain functions in the simulation, which calls them from its register access
+ *  signal handlers; the host compiler's \c interrupt attribute would demand an x86 exception frame instead.
+ */
+#define ISR(Name, ...)                        void Name (void) __VA_ARGS__; void Name (void)
+
+/* Function Prototypes: */
+void     NVIC_EnableIRQ(const int IRQn);
+void     NVIC_DisableIRQ(const int IRQn);
+void     NVIC_ClearPendingIRQ(const int IRQn);
+uint32_t SysTick_Config(const uint32_t Ticks);
+uint32_t SystemCoreClockGet(void);
+uint32_t __get_IPSR(void);
+
+/* Inline Functions: */
+static inline uint32_t __get_BASEPRI(void)
+{
+	return 0;
+}
+
+static inline void __DSB(void)
+{
+	__sync_synchronize();
+}
+
+static inline void __DMB(void)
+{
+	__sync_synchronize();
+}
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
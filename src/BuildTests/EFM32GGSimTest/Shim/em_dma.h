@@ -0,0 +1,142 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK DMA controller header for the host side USB core simulation.
+ *
+ *  The DMA controller is not simulated; this header only allows the VCP demo's DMA driven UART bridge
+ *  mode to be compiled against the simulation, to check that it still builds.
+ */
+
+#ifndef __EM_DMA_SIM_H__
+#define __EM_DMA_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Enums: */
+typedef enum {
+	dmaDataInc1,
+	dmaDataInc2,
+	dmaDataInc4,
+	dmaDataIncNone,
+} DMA_DataInc_TypeDef;
+
+typedef enum {
+	dmaDataSize1,
+	dmaDataSize2,
+	dmaDataSize4,
+} DMA_DataSize_TypeDef;
+
+typedef enum {
+	dmaArbitrate1,
+	dmaArbitrate2,
+	dmaArbitrate4,
+	dmaArbitrate8,
+	dmaArbitrate16,
+	dmaArbitrate32,
+	dmaArbitrate64,
+	dmaArbitrate128,
+	dmaArbitrate256,
+	dmaArbitrate512,
+	dmaArbitrate1024,
+} DMA_ArbiterConfig_TypeDef;
+
+/* Type Defines: */
+typedef void (*DMA_FuncPtr_TypeDef)(unsigned int channel, bool primary, void *user);
+
+typedef struct {
+	DMA_FuncPtr_TypeDef cbFunc;
+	void                *userPtr;
+	uint8_t             primary;
+} DMA_CB_TypeDef;
+
+typedef struct {
+	bool           highPri;
+	bool           enableInt;
+	uint32_t       select;
+	DMA_CB_TypeDef *cb;
+} DMA_CfgChannel_TypeDef;
+
+typedef struct {
+	DMA_DataInc_TypeDef       dstInc;
+	DMA_DataInc_TypeDef       srcInc;
+	DMA_DataSize_TypeDef      size;
+	DMA_ArbiterConfig_TypeDef arbRate;
+	uint8_t                   hprot;
+} DMA_CfgDescr_TypeDef;
+
+typedef struct {
+	uint8_t                hprot;
+	DMA_DESCRIPTOR_TypeDef *controlBlock;
+} DMA_Init_TypeDef;
+
+/* Function Prototypes: */
+void DMA_Init(DMA_Init_TypeDef *init);
+void DMA_CfgChannel(unsigned int channel,
+                    DMA_CfgChannel_TypeDef *cfg);
+void DMA_CfgDescr(unsigned int channel,
+                  bool primary,
+                  DMA_CfgDescr_TypeDef *cfg);
+void DMA_ChannelEnable(unsigned int channel,
+                       bool enable);
+void DMA_ActivateBasic(unsigned int channel,
+                       bool primary,
+                       bool useBurst,
+                       void *dst,
+                       void *src,
+                       unsigned int nMinus1);
+void DMA_ActivatePingPong(unsigned int channel,
+                          bool useBurst,
+                          void *primDst,
+                          void *primSrc,
+                          unsigned int primNMinus1,
+                          void *altDst,
+                          void *altSrc,
+                          unsigned int altNMinus1);
+void DMA_RefreshPingPong(unsigned int channel,
+                         bool primary,
+                         bool useBurst,
+                         void *dst,
+                         void *src,
+                         unsigned int nMinus1,
+                         bool stop);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK GPIO header for the host side USB core simulation.
+ */
+
+#ifndef __EM_GPIO_SIM_H__
+#define __EM_GPIO_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Enums: */
+typedef enum {
+	gpioPortA,
+	gpioPortB,
+	gpioPortC,
+	gpioPortD,
+	gpioPortE,
+	gpioPortF,
+} GPIO_Port_TypeDef;
+
+typedef enum {
+	gpioModeDisabled,
+	gpioModeInput,
+	gpioModeInputPull,
+	gpioModePushPull,
+} GPIO_Mode_TypeDef;
+
+/* Function Prototypes: */
+void GPIO_PinModeSet(const GPIO_Port_TypeDef Port,
+                     const unsigned int Pin,
+                     const GPIO_Mode_TypeDef Mode,
+                     const unsigned int Out);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK USART header for the host side USB core simulation.
+ *
+ *  The UART is not simulated beyond recording the last baud rate the firmware programmed.
+ */
+
+#ifndef __EM_USART_SIM_H__
+#define __EM_USART_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Macros: */
+#define USART_INITASYNC_DEFAULT  { usartEnable, 0, 115200, usartOVS16, usartDatabits8, \
+                                   usartNoParity, usartStopbits1 }
+
+/* Enums: */
+typedef enum {
+	usartDisable,
+	usartEnableRx,
+	usartEnableTx,
+	usartEnable,
+} USART_Enable_TypeDef;
+
+typedef enum {
+	usartOVS16,
+	usartOVS8,
+	usartOVS6,
+	usartOVS4,
+} USART_OVS_TypeDef;
+
+typedef enum {
+	usartDatabits8 = 8,
+} USART_Databits_TypeDef;
+
+typedef enum {
+	usartNoParity,
+} USART_Parity_TypeDef;
+
+typedef enum {
+	usartStopbits1,
+} USART_Stopbits_TypeDef;
+
+/* Type Defines: */
+typedef struct {
+	USART_Enable_TypeDef   enable;
+	uint32_t               refFreq;
+	uint32_t               baudrate;
+	USART_OVS_TypeDef      oversampling;
+	USART_Databits_TypeDef databits;
+	USART_Parity_TypeDef   parity;
+	USART_Stopbits_TypeDef stopbits;
+} USART_InitAsync_TypeDef;
+
+/* Function Prototypes: */
+void USART_InitAsync(USART_TypeDef *const usart,
+                     const USART_InitAsync_TypeDef *const init);
+void USART_Enable(USART_TypeDef *const usart,
+                  const USART_Enable_TypeDef Enable);
+void USART_BaudrateAsyncSet(USART_TypeDef *const usart,
+                            const uint32_t RefFreq,
+                            const uint32_t Baudrate,
+                            const USART_OVS_TypeDef Ovs);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK USB stack header for the host side USB core simulation.
+ *
+ *  Gives the parts of the SDK USB API the EFM32GG port builds on: the status codes, the SETUP
+ *  packet layout and the transfer completion callback type.
+ */
+
+#ifndef __EM_USB_SIM_H__
+#define __EM_USB_SIM_H__
+
+/* Includes: */
+#include "em_device.h"
+#include "usbconfig.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+#define USB_SETUP_DIR_MASK        0x80
+#define USB_EPNUM_MASK            0x0F
+#define USB_SETUP_PKT_SIZE        8
+#define CONFIG_DESC_BM_TRANSFERTYPE 0x03
+
+#define UBUF(x, y)                uint8_t x[((y) + 3) & ~3] __attribute__((aligned(4)))
+#define STATIC_UBUF(x, y)         static UBUF(x, y)
+
+/* Enums: */
+typedef enum {
+	USB_STATUS_OK                 =   0,
+	USB_STATUS_REQ_ERR            =  -1,
+	USB_STATUS_EP_BUSY            =  -2,
+	USB_STATUS_REQ_UNHANDLED      =  -3,
+	USB_STATUS_ILLEGAL            =  -4,
+	USB_STATUS_EP_STALLED         =  -5,
+	USB_STATUS_EP_ABORTED         =  -6,
+	USB_STATUS_EP_ERROR           =  -7,
+	USB_STATUS_EP_NAK             =  -8,
+	USB_STATUS_DEVICE_UNCONFIGURED = -9,
+	USB_STATUS_DEVICE_SUSPENDED   = -10,
+	USB_STATUS_DEVICE_RESET       = -11,
+	USB_STATUS_TIMEOUT            = -12,
+	USB_STATUS_DEVICE_REMOVED     = -13,
+} USB_Status_TypeDef;
+
+/* Type Defines: */
+typedef struct {
+	uint8_t  bmRequestType;
+	uint8_t  bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} __attribute__((packed)) USB_Setup_TypeDef;
+
+typedef int (*USB_XferCompleteCb_TypeDef)(USB_Status_TypeDef Status,
+                                          uint32_t Xferred,
+                                          uint32_t Remaining);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK USB HAL for the host side USB core simulation.
+ *
+ *  The USBHAL_* and USBDHAL_* register helpers called by the EFM32GG port. They are implemented
+ *  against the simulated register block in SimHAL.c, following the register sequences of the SDK.
+ */
+
+#ifndef __EM_USBHAL_SIM_H__
+#define __EM_USBHAL_SIM_H__
+
+/* Includes: */
+#include "em_usbtypes.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Function Prototypes: */
+void               USBHAL_DisableGlobalInt(void);
+void               USBHAL_EnableGlobalInt(void);
+void               USBHAL_FlushRxFifo(void);
+void               USBHAL_FlushTxFifo(const uint8_t FIFONum);
+uint32_t           USBHAL_GetCoreInts(void);
+
+void               USBDHAL_ActivateEp(USBD_Ep_TypeDef *const ep, const bool ForceIdle);
+void               USBDHAL_AbortEpIn(USBD_Ep_TypeDef *const ep);
+void               USBDHAL_AbortEpOut(USBD_Ep_TypeDef *const ep);
+void               USBDHAL_EnableInts(USBD_Device_TypeDef *const dev);
+void               USBDHAL_EnableUsbResetAndSuspendInt(void);
+void               USBDHAL_Ep0Activate(const uint32_t Ep0MPS);
+bool               USBDHAL_EpIsStalled(USBD_Ep_TypeDef *const ep);
+uint32_t           USBDHAL_GetAllInEpInts(void);
+uint32_t           USBDHAL_GetAllOutEpInts(void);
+uint32_t           USBDHAL_GetInEpInts(USBD_Ep_TypeDef *const ep);
+uint32_t           USBDHAL_GetOutEpInts(USBD_Ep_TypeDef *const ep);
+USB_Status_TypeDef USBDHAL_StallEp(USBD_Ep_TypeDef *const ep);
+USB_Status_TypeDef USBDHAL_UnStallEp(USBD_Ep_TypeDef *const ep);
+void               USBDHAL_StartEpIn(USBD_Ep_TypeDef *const ep);
+void               USBDHAL_StartEpOut(USBD_Ep_TypeDef *const ep);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
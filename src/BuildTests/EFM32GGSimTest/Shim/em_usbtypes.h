@@ -0,0 +1,113 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK USB device types for the host side USB core simulation.
+ *
+ *  Endpoint and device bookkeeping structures shared between the SDK HAL and the EFM32GG port,
+ *  with the field names the port uses.
+ */
+
+#ifndef __EM_USBTYPES_SIM_H__
+#define __EM_USBTYPES_SIM_H__
+
+/* Includes: */
+#include "em_usb.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+#define MAX_NUM_IN_EPS            6
+#define MAX_NUM_OUT_EPS           6
+#define MAX_NUM_TX_FIFOS          6
+
+#define DEPCTL_WO_BITMASK         (USB_DOEP_CTL_CNAK | USB_DOEP_CTL_SNAK | \
+                                   USB_DOEP_CTL_SETD0PIDEF | USB_DOEP_CTL_SETD1PIDOF)
+#define DCTL_WO_BITMASK           (USB_DCTL_CGOUTNAK | USB_DCTL_SGOUTNAK | \
+                                   USB_DCTL_CGNPINNAK | USB_DCTL_SGNPINNAK)
+#define GUSBCFG_WO_BITMASK        (USB_GUSBCFG_CORRUPTTXPKT)
+
+/* Enums: */
+typedef enum {
+	D_EP_IDLE          = 0,
+	D_EP_TRANSFERRING  = 1,
+	D_EP_RECEIVING     = 2,
+	D_EP0_IN_STATUS    = 3,
+	D_EP0_OUT_STATUS   = 4,
+} USBD_EpState_TypeDef;
+
+/* Type Defines: */
+typedef struct {
+	bool                       in;
+	uint8_t                    zlp;
+	uint8_t                    num;
+	uint8_t                    addr;
+	uint8_t                    type;
+	uint8_t                    txFifoNum;
+	uint8_t                   *buf;
+	uint16_t                   packetSize;
+	uint16_t                   mask;
+	uint32_t                   remaining;
+	uint32_t                   xferred;
+	uint32_t                   hwXferSize;
+	uint32_t                   fifoSize;
+	USBD_EpState_TypeDef       state;
+	USB_XferCompleteCb_TypeDef xferCompleteCb;
+} USBD_Ep_TypeDef;
+
+typedef struct {
+	void (*usbReset)(void);
+	void (*usbStateChange)(int OldState, int NewState);
+	int  (*setupCmd)(const USB_Setup_TypeDef *Setup);
+	int  (*isSelfPowered)(void);
+	void (*sofInt)(uint16_t SofNr);
+} USBD_Callbacks_TypeDef;
+
+typedef struct {
+	USB_Setup_TypeDef            *setup;
+	USB_Setup_TypeDef             setupPkt[3];
+	uint8_t                       configurationValue;
+	bool                          remoteWakeupEnabled;
+	const USBD_Callbacks_TypeDef *callbacks;
+	USBD_Ep_TypeDef               ep[NUM_EP_USED + 1];
+	uint8_t                       inEpAddr2EpIndex[MAX_NUM_IN_EPS + 1];
+	uint8_t                       outEpAddr2EpIndex[MAX_NUM_OUT_EPS + 1];
+} USBD_Device_TypeDef;
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
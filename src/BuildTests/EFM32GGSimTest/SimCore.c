@@ -0,0 +1,960 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Simulated EFM32GG USB core, interrupt controller and virtual clock. See SimCore.h for an
+ *  overview of the model.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "SimCore.h"
+#include <em_device.h>
+#include <em_usbtypes.h>
+#include <em_int.h>
+#include <em_emu.h>
+
+/* The core itself works on a writable alias of the firmware's read only register mapping */
+#undef  USB
+#define USB                          Sim_CoreRegisters
+
+/** Number of endpoints of each direction modelled by the core, including EP0. */
+#define SIM_ENDPOINTS                (MAX_NUM_IN_EPS + 1)
+
+/** Reserved bit always set in the published GINTSTS value. Status registers are write one to clear,
+ *  but a store leaves the written value in memory; the firmware never stores this bit, so any store
+ *  to the register leaves it with a value other than the one last published, and the bits written as
+ *  one can then be cleared. The same is done for the endpoint interrupt registers.
+ */
+#define SIM_GINTSTS_CANARY           (1UL << 27)
+#define SIM_DEPINT_CANARY            (1UL << 30)
+
+/** Exception numbers returned by __get_IPSR() while the firmware runs an interrupt handler. */
+#define SIM_EXCEPTION_CLAIMED        1
+#define SIM_EXCEPTION_SYSTICK        15
+#define SIM_EXCEPTION_USB            (16 + USB_IRQn)
+
+/** Wall clock time the virtual host waits for its turn before declaring the simulation hung. This only
+ *  detects firmware which spins without touching the register block, it plays no part in the timing.
+ */
+#define SIM_WATCHDOG_SECONDS         10
+
+/** x86 trap flag, raising a debug exception after the next instruction. */
+#define SIM_TRAP_FLAG                (1UL << 8)
+
+/** Access to a register which is read only to the firmware. */
+#define SIM_REG(Register)            (*(volatile uint32_t*)&(Register))
+
+USB_TypeDef*        Sim_USBRegisters;
+static USB_TypeDef* Sim_CoreRegisters;
+static size_t       Sim_RegisterSpan;
+
+/** Millisecond tick counter of the firmware, which the makefile turns into a pointer for Delay_MS()
+ *  to poll. It is placed right after the register block, so that the poll advances the clock too.
+ */
+extern volatile uint32_t* Sim_TickCounter;
+
+/** State of the simulated core which is not visible in the register block itself. */
+static struct {
+	uint32_t GINTSTS;
+	uint32_t DIEPINT[SIM_ENDPOINTS];
+	uint32_t DOEPINT[SIM_ENDPOINTS];
+	uint32_t PublishedGINTSTS;
+	uint32_t PublishedDIEPINT[SIM_ENDPOINTS];
+	uint32_t PublishedDOEPINT[SIM_ENDPOINTS];
+	bool     INNAK[SIM_ENDPOINTS];
+	bool     OUTNAK[SIM_ENDPOINTS];
+	uint32_t IF;
+	bool     VBUS;
+	bool     Enumerated;
+	bool     Suspended;
+	bool     Resetting;
+	uint16_t FrameNumber;
+	uint16_t SlotInFrame;
+	uint8_t  Address;
+	uint8_t  PreviousAddress;
+	bool     PreviousAddressValid;
+	bool     SetupLatched;
+	uint8_t  SetupPacket[8];
+} Sim_Core;
+
+static Sim_Statistics_t            Sim_Statistics;
+static volatile uint32_t           Sim_FrameCount;
+
+static uint32_t                    Sim_CyclesPerAccess;
+static uint32_t                    Sim_CyclesPerSlot;
+static uint32_t                    Sim_Cycles;
+
+static volatile int                Sim_Busy;
+static Sim_Transaction_t* volatile Sim_Mailbox;
+static sem_t                       Sim_MailboxPosted;
+static sem_t                       Sim_MailboxDone;
+
+static volatile int                Sim_Exception;
+static volatile bool               Sim_PRIMASK;
+static uint32_t                    Sim_IntLockCount;
+static volatile uint32_t           Sim_NVICEnabled;
+static volatile bool               Sim_SysTickPending;
+static uint32_t                    Sim_SysTickReload;
+static uint32_t                    Sim_SysTickCountdown;
+static volatile bool               Sim_Sleeping;
+static volatile uint32_t           Sim_InterruptsTaken;
+
+extern void USB_IRQHandler(void);
+
+/* Weak default for firmware without a SysTick handler */
+void SysTick_Handler(void) __attribute__((weak));
+void SysTick_Handler(void)
+{
+
+}
+
+void Sim_Fatal(const char *Format, ...)
+{
+	va_list Args;
+
+	fputs("SIM FATAL: ", stderr);
+	va_start(Args, Format);
+	vfprintf(stderr, Format, Args);
+	va_end(Args);
+	fputc('\n', stderr);
+
+	Sim_Exit(2);
+}
+
+void Sim_Exit(const int Status)
+{
+	fflush(stdout);
+	fflush(stderr);
+	_exit(Status);
+}
+
+uint8_t* Sim_DMAPointer(const uint32_t Address)
+{
+	extern char __executable_start[];
+	extern char end[];
+	uint8_t *Pointer = (uint8_t*)(uintptr_t)Address;
+
+	if ((Pointer < (uint8_t*)__executable_start) || (Pointer >= (uint8_t*)end))
+	  Sim_Fatal("DMA address 0x%08X is outside the firmware's static data, only static buffers can be reached", Address);
+
+	return Pointer;
+}
+
+static uint16_t Sim_PacketSize(const uint8_t EPNum, const uint32_t Control)
+{
+	static const uint16_t EP0PacketSizes[] = {64, 32, 16, 8};
+
+	if (!(EPNum))
+	  return EP0PacketSizes[Control & 0x03];
+
+	return (Control & _USB_DIEP_CTL_MPS_MASK) >> _USB_DIEP_CTL_MPS_SHIFT;
+}
+
+static bool Sim_IsConnected(void)
+{
+	return Sim_Core.VBUS && (USB->ROUTE & USB_ROUTE_PHYPEN) && !(USB->DCTL & USB_DCTL_SFTDISCON);
+}
+
+static bool Sim_USBInterruptPending(void)
+{
+	bool Pending;
+
+	if (!(Sim_NVICEnabled & (1UL << USB_IRQn)))
+	  return false;
+
+	Pending  = (USB->GAHBCFG & USB_GAHBCFG_GLBLINTRMSK) &&
+	           (Sim_Core.PublishedGINTSTS & USB->GINTMSK & ~SIM_GINTSTS_CANARY);
+	Pending |= (Sim_Core.IF & USB->IEN) ? true : false;
+
+	return Pending;
+}
+
+/* Delivers a latched SETUP packet once EP0 OUT is enabled to take it */
+static void Sim_DeliverSetup(void)
+{
+	uint32_t Size;
+	uint32_t SetupCount;
+
+	if (!(Sim_Core.SetupLatched) || !(USB->DOEP0CTL & USB_DOEP_CTL_EPENA))
+	  return;
+
+	Size       = USB->DOEP0TSIZ;
+	SetupCount = (Size & _USB_DOEP0TSIZ_SUPCNT_MASK) >> _USB_DOEP0TSIZ_SUPCNT_SHIFT;
+
+	memcpy(Sim_DMAPointer(USB->DOEP0DMAADDR), Sim_Core.SetupPacket, sizeof(Sim_Core.SetupPacket));
+	USB->DOEP0DMAADDR += sizeof(Sim_Core.SetupPacket);
+
+	if (SetupCount)
+	  SetupCount--;
+
+	USB->DOEP0TSIZ = (Size & ~_USB_DOEP0TSIZ_SUPCNT_MASK) | (SetupCount << _USB_DOEP0TSIZ_SUPCNT_SHIFT);
+	USB->DOEP0CTL &= ~USB_DOEP_CTL_EPENA;
+
+	Sim_Core.DOEPINT[0]  |= USB_DOEP_INT_SETUP;
+	Sim_Core.SetupLatched = false;
+}
+
+/* Acts on the write only bits of an endpoint control register and reflects the NAK state */
+static void Sim_ApplyEndpointControl(volatile uint32_t *const Control,
+                                     bool *const NAK,
+                                     uint32_t *const Interrupts,
+                                     const bool IsIN)
+{
+	uint32_t Value = *Control;
+
+	if (Value & USB_DIEP_CTL_CNAK)
+	  *NAK = false;
+
+	if (Value & USB_DIEP_CTL_SNAK) {
+		*NAK = true;
+
+		if (IsIN)
+		  *Interrupts |= USB_DIEP_INT_INEPNAKEFF;
+	}
+
+	if ((Value & USB_DIEP_CTL_EPDIS) && (Value & USB_DIEP_CTL_EPENA)) {
+		Value       &= ~USB_DIEP_CTL_EPENA;
+		*Interrupts |= USB_DIEP_INT_EPDISBLD;
+	}
+
+	Value &= ~(USB_DIEP_CTL_CNAK | USB_DIEP_CTL_SNAK | USB_DIEP_CTL_SETD0PIDEF |
+	           USB_DIEP_CTL_SETD1PIDOF | USB_DIEP_CTL_EPDIS);
+
+	if (*NAK)
+	  Value |= USB_DIEP_CTL_NAKSTS;
+	else
+	  Value &= ~USB_DIEP_CTL_NAKSTS;
+
+	*Control = Value;
+}
+
+static void Sim_SoftReset(void)
+{
+	uint8_t EPNum;
+
+	Sim_Core.GINTSTS      = 0;
+	Sim_Core.SetupLatched = false;
+
+	for (EPNum = 0; EPNum < SIM_ENDPOINTS; EPNum++) {
+		Sim_Core.DIEPINT[EPNum] = 0;
+		Sim_Core.DOEPINT[EPNum] = 0;
+		Sim_Core.INNAK[EPNum]   = true;
+		Sim_Core.OUTNAK[EPNum]  = true;
+		USB_DINEPS[EPNum].CTL   = 0;
+		USB_DOUTEPS[EPNum].CTL  = 0;
+	}
+}
+
+/* Applies the firmware's register writes made since the registers were last published */
+static void Sim_ApplyWrites(void)
+{
+	uint32_t Written;
+	uint8_t  Address;
+	uint8_t  EPNum;
+
+	if ((Written = USB->GINTSTS) != Sim_Core.PublishedGINTSTS)
+	  Sim_Core.GINTSTS &= ~Written;
+
+	for (EPNum = 0; EPNum < SIM_ENDPOINTS; EPNum++) {
+		if ((Written = USB_DINEPS[EPNum].INT) != Sim_Core.PublishedDIEPINT[EPNum])
+		  Sim_Core.DIEPINT[EPNum] &= ~Written;
+
+		if ((Written = USB_DOUTEPS[EPNum].INT) != Sim_Core.PublishedDOEPINT[EPNum])
+		  Sim_Core.DOEPINT[EPNum] &= ~Written;
+	}
+
+	/* Clears are applied first, as firmware clears a flag before forcing it but never the reverse */
+	Sim_Core.IF &= ~USB->IFC;
+	Sim_Core.IF |=  USB->IFS;
+	USB->IFS     = 0;
+	USB->IFC     = 0;
+
+	if (USB->GRSTCTL & USB_GRSTCTL_CSFTRST)
+	  Sim_SoftReset();
+
+	USB->GRSTCTL = (USB->GRSTCTL & ~(USB_GRSTCTL_CSFTRST | USB_GRSTCTL_RXFFLSH | USB_GRSTCTL_TXFFLSH)) |
+	               USB_GRSTCTL_AHBIDLE;
+	USB->DCTL   &= ~DCTL_WO_BITMASK;
+
+	for (EPNum = 0; EPNum < SIM_ENDPOINTS; EPNum++) {
+		Sim_ApplyEndpointControl(&USB_DINEPS[EPNum].CTL, &Sim_Core.INNAK[EPNum], &Sim_Core.DIEPINT[EPNum], true);
+		Sim_ApplyEndpointControl(&USB_DOUTEPS[EPNum].CTL, &Sim_Core.OUTNAK[EPNum], &Sim_Core.DOEPINT[EPNum], false);
+	}
+
+	/* The old address stays valid for the status stage of SET_ADDRESS */
+	Address = (USB->DCFG & _USB_DCFG_DEVADDR_MASK) >> _USB_DCFG_DEVADDR_SHIFT;
+	if (Address != Sim_Core.Address) {
+		Sim_Core.PreviousAddress      = Sim_Core.Address;
+		Sim_Core.PreviousAddressValid = true;
+		Sim_Core.Address              = Address;
+	}
+
+	Sim_DeliverSetup();
+}
+
+/* Writes the hardware owned registers and status bits back to the register block */
+static void Sim_Publish(void)
+{
+	uint32_t AllEndpoints = 0;
+	uint32_t CoreInterrupts;
+	uint8_t  EPNum;
+
+	for (EPNum = 0; EPNum < SIM_ENDPOINTS; EPNum++) {
+		if (Sim_Core.DIEPINT[EPNum] & USB->DIEPMSK)
+		  AllEndpoints |= (1UL << EPNum);
+
+		if (Sim_Core.DOEPINT[EPNum] & USB->DOEPMSK)
+		  AllEndpoints |= (1UL << (EPNum + _USB_DAINTMSK_OUTEPMSK0_SHIFT));
+
+		Sim_Core.PublishedDIEPINT[EPNum] = Sim_Core.DIEPINT[EPNum] | SIM_DEPINT_CANARY;
+		Sim_Core.PublishedDOEPINT[EPNum] = Sim_Core.DOEPINT[EPNum] | SIM_DEPINT_CANARY;
+		USB_DINEPS[EPNum].INT            = Sim_Core.PublishedDIEPINT[EPNum];
+		USB_DOUTEPS[EPNum].INT           = Sim_Core.PublishedDOEPINT[EPNum];
+	}
+
+	CoreInterrupts = Sim_Core.GINTSTS & ~(USB_GINTSTS_IEPINT | USB_GINTSTS_OEPINT);
+
+	if (AllEndpoints & USB->DAINTMSK & 0x0000FFFF)
+	  CoreInterrupts |= USB_GINTSTS_IEPINT;
+
+	if (AllEndpoints & USB->DAINTMSK & 0xFFFF0000)
+	  CoreInterrupts |= USB_GINTSTS_OEPINT;
+
+	Sim_Core.PublishedGINTSTS = CoreInterrupts | SIM_GINTSTS_CANARY;
+	USB->GINTSTS              = Sim_Core.PublishedGINTSTS;
+
+	SIM_REG(USB->DAINT)  = AllEndpoints;
+	SIM_REG(USB->IF)     = Sim_Core.IF;
+	SIM_REG(USB->STATUS) = (Sim_Core.VBUS ? USB_STATUS_VREGOS : 0);
+	SIM_REG(USB->DSTS)   = ((uint32_t)Sim_Core.FrameNumber << _USB_DSTS_SOFFN_SHIFT) |
+	                       (3UL << _USB_DSTS_ENUMSPD_SHIFT) |
+	                       (Sim_Core.Suspended ? USB_DSTS_SUSPSTS : 0);
+	USB->HFNUM           = Sim_Core.FrameNumber;
+}
+
+static void Sim_BusReset(void)
+{
+	uint8_t EPNum;
+
+	for (EPNum = 0; EPNum < SIM_ENDPOINTS; EPNum++) {
+		uint32_t Inactive = (EPNum ? USB_DIEP_CTL_USBACTEP : 0);
+
+		USB_DINEPS[EPNum].CTL  &= ~(USB_DIEP_CTL_EPENA | USB_DIEP_CTL_STALL | Inactive);
+		USB_DOUTEPS[EPNum].CTL &= ~(USB_DOEP_CTL_EPENA | USB_DOEP_CTL_STALL | Inactive);
+		Sim_Core.INNAK[EPNum]   = true;
+		Sim_Core.OUTNAK[EPNum]  = true;
+	}
+
+	Sim_Core.SetupLatched         = false;
+	Sim_Core.PreviousAddressValid = false;
+	Sim_Core.Suspended            = false;
+	Sim_Core.Resetting            = true;
+	Sim_Core.GINTSTS             |= USB_GINTSTS_USBRST;
+}
+
+static bool Sim_IsAddressed(const uint8_t Address)
+{
+	if (!(Sim_Core.Enumerated) || Sim_Core.Suspended || Sim_Core.Resetting || !(Sim_IsConnected()))
+	  return false;
+
+	return (Address == Sim_Core.Address) ||
+	       (Sim_Core.PreviousAddressValid && (Address == Sim_Core.PreviousAddress));
+}
+
+static uint8_t Sim_RunSETUP(Sim_Transaction_t *const Transaction)
+{
+	if (Transaction->Endpoint || (Transaction->Length != sizeof(Sim_Core.SetupPacket)))
+	  return SIM_HANDSHAKE_BABBLE;
+
+	if (Transaction->Address == Sim_Core.Address)
+	  Sim_Core.PreviousAddressValid = false;
+
+	/* SETUP packets are always accepted, clearing a halt and NAKing EP0 until they are processed */
+	memcpy(Sim_Core.SetupPacket, Transaction->Data, sizeof(Sim_Core.SetupPacket));
+	Sim_Core.SetupLatched = true;
+
+	USB->DIEP0CTL    &= ~USB_DIEP_CTL_STALL;
+	USB->DOEP0CTL    &= ~USB_DOEP_CTL_STALL;
+	Sim_Core.INNAK[0]  = true;
+	Sim_Core.OUTNAK[0] = true;
+
+	Sim_DeliverSetup();
+	return SIM_HANDSHAKE_ACK;
+}
+
+static uint8_t Sim_RunOUT(Sim_Transaction_t *const Transaction)
+{
+	uint8_t           EPNum = Transaction->Endpoint;
+	USB_DOEP_TypeDef* EP;
+	uint32_t          Size;
+	uint32_t          TransferSize;
+	uint32_t          PacketCount;
+
+	if (EPNum >= SIM_ENDPOINTS)
+	  return SIM_HANDSHAKE_NONE;
+
+	EP = &USB_DOUTEPS[EPNum];
+
+	if (EPNum && !(EP->CTL & USB_DOEP_CTL_USBACTEP))
+	  return SIM_HANDSHAKE_NONE;
+	else if (EP->CTL & USB_DOEP_CTL_STALL)
+	  return SIM_HANDSHAKE_STALL;
+	else if (!(EP->CTL & USB_DOEP_CTL_EPENA) || Sim_Core.OUTNAK[EPNum])
+	  return SIM_HANDSHAKE_NAK;
+
+	Size         = EP->TSIZ;
+	TransferSize = (Size & _USB_DOEP_TSIZ_XFERSIZE_MASK) >> _USB_DOEP_TSIZ_XFERSIZE_SHIFT;
+	PacketCount  = (Size & _USB_DOEP_TSIZ_PKTCNT_MASK) >> _USB_DOEP_TSIZ_PKTCNT_SHIFT;
+
+	/* The EP0 packet count field is a single bit and every packet completes the transfer */
+	if (!(EPNum))
+	  PacketCount = 1;
+
+	if (!(PacketCount))
+	  return SIM_HANDSHAKE_NAK;
+	else if (Transaction->Length > Sim_PacketSize(EPNum, EP->CTL))
+	  return SIM_HANDSHAKE_BABBLE;
+	else if (EPNum && (Transaction->Length > TransferSize))
+	  return SIM_HANDSHAKE_BABBLE;
+
+	if (Transaction->Length) {
+		memcpy(Sim_DMAPointer(EP->DMAADDR), Transaction->Data, Transaction->Length);
+		EP->DMAADDR += Transaction->Length;
+	}
+
+	TransferSize -= MIN(TransferSize, Transaction->Length);
+	PacketCount--;
+
+	EP->TSIZ = (Size & ~(_USB_DOEP_TSIZ_XFERSIZE_MASK | _USB_DOEP_TSIZ_PKTCNT_MASK)) |
+	           (TransferSize << _USB_DOEP_TSIZ_XFERSIZE_SHIFT) | (PacketCount << _USB_DOEP_TSIZ_PKTCNT_SHIFT);
+
+	if (!(PacketCount) || (Transaction->Length < Sim_PacketSize(EPNum, EP->CTL))) {
+		EP->CTL                 &= ~USB_DOEP_CTL_EPENA;
+		Sim_Core.DOEPINT[EPNum] |= USB_DOEP_INT_XFERCOMPL;
+		Sim_Core.OUTNAK[EPNum]   = true;
+	}
+
+	return SIM_HANDSHAKE_ACK;
+}
+
+static uint8_t Sim_RunIN(Sim_Transaction_t *const Transaction)
+{
+	uint8_t           EPNum = Transaction->Endpoint;
+	USB_DIEP_TypeDef* EP;
+	uint32_t          Size;
+	uint32_t          TransferSize;
+	uint32_t          PacketCount;
+	uint16_t          Length;
+
+	Transaction->Length = 0;
+
+	if (EPNum >= SIM_ENDPOINTS)
+	  return SIM_HANDSHAKE_NONE;
+
+	EP = &USB_DINEPS[EPNum];
+
+	if (EPNum && !(EP->CTL & USB_DIEP_CTL_USBACTEP))
+	  return SIM_HANDSHAKE_NONE;
+	else if (EP->CTL & USB_DIEP_CTL_STALL)
+	  return SIM_HANDSHAKE_STALL;
+	else if (!(EP->CTL & USB_DIEP_CTL_EPENA) || Sim_Core.INNAK[EPNum])
+	  return SIM_HANDSHAKE_NAK;
+
+	Size         = EP->TSIZ;
+	TransferSize = (Size & _USB_DIEP_TSIZ_XFERSIZE_MASK) >> _USB_DIEP_TSIZ_XFERSIZE_SHIFT;
+	PacketCount  = (Size & _USB_DIEP_TSIZ_PKTCNT_MASK) >> _USB_DIEP_TSIZ_PKTCNT_SHIFT;
+
+	if (!(PacketCount))
+	  return SIM_HANDSHAKE_NAK;
+
+	Length = MIN(TransferSize, Sim_PacketSize(EPNum, EP->CTL));
+
+	if (Length) {
+		memcpy(Transaction->Data, Sim_DMAPointer(EP->DMAADDR), Length);
+		EP->DMAADDR += Length;
+	}
+
+	Transaction->Length = Length;
+	TransferSize       -= Length;
+	PacketCount--;
+
+	EP->TSIZ = (Size & ~(_USB_DIEP_TSIZ_XFERSIZE_MASK | _USB_DIEP_TSIZ_PKTCNT_MASK)) |
+	           (TransferSize << _USB_DIEP_TSIZ_XFERSIZE_SHIFT) | (PacketCount << _USB_DIEP_TSIZ_PKTCNT_SHIFT);
+
+	if (!(PacketCount)) {
+		EP->CTL                 &= ~USB_DIEP_CTL_EPENA;
+		Sim_Core.DIEPINT[EPNum] |= USB_DIEP_INT_XFERCOMPL;
+	}
+
+	return SIM_HANDSHAKE_ACK;
+}
+
+static void Sim_CompleteTransaction(Sim_Transaction_t *const Transaction,
+                                    const uint8_t Handshake)
+{
+	Transaction->Handshake = Handshake;
+
+	/* The virtual host is resumed once the firmware needs the next bus slot, see Sim_WaitForHost() */
+	__atomic_store_n(&Sim_Mailbox, NULL, __ATOMIC_RELEASE);
+}
+
+/* Runs the virtual host's pending transaction, if any, in a bus slot after the SOF */
+static void Sim_RunBus(void)
+{
+	Sim_Transaction_t* Transaction = __atomic_load_n(&Sim_Mailbox, __ATOMIC_ACQUIRE);
+	uint8_t            Handshake   = SIM_HANDSHAKE_ACK;
+
+	if (!(Transaction))
+	  return;
+
+	switch (Transaction->Token) {
+		case SIM_TOKEN_SETUP:
+		case SIM_TOKEN_OUT:
+		case SIM_TOKEN_IN:
+			if (!(Sim_IsAddressed(Transaction->Address)))
+			  Handshake = SIM_HANDSHAKE_NONE;
+			else if (Transaction->Token == SIM_TOKEN_SETUP)
+			  Handshake = Sim_RunSETUP(Transaction);
+			else if (Transaction->Token == SIM_TOKEN_OUT)
+			  Handshake = Sim_RunOUT(Transaction);
+			else
+			  Handshake = Sim_RunIN(Transaction);
+
+			Sim_Statistics.Transactions++;
+
+			if (Handshake == SIM_HANDSHAKE_NAK)
+			  Sim_Statistics.NAKs++;
+			else if (Handshake == SIM_HANDSHAKE_STALL)
+			  Sim_Statistics.STALLs++;
+
+			break;
+		case SIM_BUS_ATTACH:
+			Sim_Core.VBUS = true;
+			Sim_Core.IF  |= USB_IF_VREGOSH;
+			break;
+		case SIM_BUS_DETACH:
+			Sim_Core.VBUS       = false;
+			Sim_Core.Enumerated = false;
+			Sim_Core.Suspended  = false;
+			Sim_Core.IF        |= USB_IF_VREGOSL;
+			break;
+		case SIM_BUS_RESET:
+			if (!(Sim_IsConnected())) {
+				Handshake = SIM_HANDSHAKE_NONE;
+				break;
+			}
+
+			/* The reset ends with the next frame, where the transaction is completed */
+			if (Sim_Core.Suspended)
+			  Sim_Core.GINTSTS |= USB_GINTSTS_RESETDET;
+
+			if (!(Sim_Core.Resetting))
+			  Sim_BusReset();
+
+			return;
+		case SIM_BUS_SUSPEND:
+			if (Sim_IsConnected() && Sim_Core.Enumerated && !(Sim_Core.Suspended)) {
+				Sim_Core.Suspended  = true;
+				Sim_Core.GINTSTS   |= USB_GINTSTS_USBSUSP;
+			}
+
+			break;
+		case SIM_BUS_RESUME:
+			if (Sim_Core.Suspended) {
+				Sim_Core.Suspended  = false;
+				Sim_Core.GINTSTS   |= USB_GINTSTS_WKUPINT;
+			}
+
+			break;
+	}
+
+	Sim_CompleteTransaction(Transaction, Handshake);
+}
+
+static void Sim_StartFrame(void)
+{
+	Sim_Transaction_t* Transaction;
+
+	Sim_Statistics.Frames++;
+	__atomic_add_fetch(&Sim_FrameCount, 1, __ATOMIC_RELEASE);
+
+	if (!(Sim_IsConnected())) {
+		Sim_Core.Enumerated = false;
+		Sim_Core.Suspended  = false;
+		Sim_Core.Resetting  = false;
+	}
+
+	if (Sim_Core.Resetting) {
+		Sim_Core.Resetting  = false;
+		Sim_Core.Enumerated = true;
+		Sim_Core.GINTSTS   |= USB_GINTSTS_ENUMDONE;
+
+		Transaction = __atomic_load_n(&Sim_Mailbox, __ATOMIC_ACQUIRE);
+		if (Transaction && (Transaction->Token == SIM_BUS_RESET))
+		  Sim_CompleteTransaction(Transaction, SIM_HANDSHAKE_ACK);
+
+		return;
+	}
+
+	if (!(Sim_Core.Enumerated) || Sim_Core.Suspended)
+	  return;
+
+	Sim_Core.FrameNumber = (Sim_Core.FrameNumber + 1) & 0x07FF;
+	Sim_Core.GINTSTS    |= USB_GINTSTS_SOF;
+}
+
+static void Sim_RunSlot(void)
+{
+	Sim_Statistics.Slots++;
+
+	if (Sim_Exception)
+	  Sim_Statistics.InterruptSlots++;
+	else if (Sim_Sleeping)
+	  Sim_Statistics.SleepSlots++;
+
+	Sim_ApplyWrites();
+
+	if (Sim_SysTickReload && !(--Sim_SysTickCountdown)) {
+		Sim_SysTickCountdown = Sim_SysTickReload;
+		Sim_SysTickPending   = true;
+	}
+
+	if (++Sim_Core.SlotInFrame == SIM_SLOTS_PER_FRAME) {
+		Sim_Core.SlotInFrame = 0;
+		Sim_StartFrame();
+	} else {
+		Sim_RunBus();
+	}
+
+	Sim_Publish();
+}
+
+static void Sim_Lock(void)
+{
+	if (!(__sync_bool_compare_and_swap(&Sim_Busy, 0, 1)))
+	  Sim_Fatal("simulated core re-entered");
+}
+
+static void Sim_Unlock(void)
+{
+	__atomic_store_n(&Sim_Busy, 0, __ATOMIC_RELEASE);
+}
+
+void Sim_SyncRegisters(void)
+{
+	Sim_Lock();
+	Sim_ApplyWrites();
+	Sim_Publish();
+	Sim_Unlock();
+}
+
+static bool Sim_WakeupPending(void)
+{
+	return Sim_SysTickPending || Sim_USBInterruptPending();
+}
+
+/* Takes pending interrupts, one at a time, unless they are masked or a handler is running */
+static void Sim_DispatchInterrupts(void)
+{
+	for (;;) {
+		if (Sim_PRIMASK || !(__sync_bool_compare_and_swap(&Sim_Exception, 0, SIM_EXCEPTION_CLAIMED)))
+		  return;
+
+		Sim_SyncRegisters();
+
+		if (Sim_SysTickPending) {
+			Sim_SysTickPending = false;
+			Sim_Exception      = SIM_EXCEPTION_SYSTICK;
+			Sim_Statistics.SysTickInterrupts++;
+			SysTick_Handler();
+		} else if (Sim_USBInterruptPending()) {
+			Sim_Exception = SIM_EXCEPTION_USB;
+			Sim_Statistics.USBInterrupts++;
+			USB_IRQHandler();
+		} else {
+			Sim_Exception = 0;
+			return;
+		}
+
+		Sim_InterruptsTaken++;
+		Sim_Exception = 0;
+	}
+}
+
+/* Hands the bus to the virtual host until it has queued its next transaction. Only one of the firmware
+ * and the virtual host runs at a time, and the host only between bus slots, so that both always see
+ * the same state at the same point of simulated time.
+ */
+static void Sim_WaitForHost(void)
+{
+	if (__atomic_load_n(&Sim_Mailbox, __ATOMIC_ACQUIRE))
+	  return;
+
+	sem_post(&Sim_MailboxDone);
+
+	while (sem_wait(&Sim_MailboxPosted) && (errno == EINTR));
+}
+
+/* Advances the virtual clock by the given number of CPU cycles, running the bus slots which fall due */
+static void Sim_AdvanceClock(const uint32_t Cycles)
+{
+	Sim_Cycles += Cycles;
+
+	while (Sim_Cycles >= Sim_CyclesPerSlot) {
+		Sim_Cycles -= Sim_CyclesPerSlot;
+
+		Sim_WaitForHost();
+		Sim_Lock();
+		Sim_RunSlot();
+		Sim_Unlock();
+	}
+
+	Sim_DispatchInterrupts();
+}
+
+/* Lets a firmware access to the protected register block through for a single instruction */
+static void Sim_AccessFault(int Signal, siginfo_t *Info, void *Context)
+{
+	ucontext_t* Frame   = Context;
+	uint8_t*    Address = Info->si_addr;
+
+	(void)Signal;
+
+	if ((Address < (uint8_t*)Sim_USBRegisters) || (Address >= ((uint8_t*)Sim_USBRegisters + Sim_RegisterSpan))) {
+		/* A genuine fault, raised again with the default action once this handler returns */
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+
+	mprotect(Sim_USBRegisters, Sim_RegisterSpan, PROT_READ | PROT_WRITE);
+	Frame->uc_mcontext.gregs[REG_EFL] |= SIM_TRAP_FLAG;
+}
+
+/* Protects the register block again after the access, applies any store before the next instruction
+ * and charges the access to the virtual clock */
+static void Sim_AccessStep(int Signal, siginfo_t *Info, void *Context)
+{
+	ucontext_t* Frame = Context;
+	int         SavedErrno = errno;
+
+	(void)Signal;
+	(void)Info;
+
+	Frame->uc_mcontext.gregs[REG_EFL] &= ~SIM_TRAP_FLAG;
+	mprotect(Sim_USBRegisters, Sim_RegisterSpan, PROT_NONE);
+
+	Sim_Statistics.RegisterAccesses++;
+	Sim_SyncRegisters();
+	Sim_AdvanceClock(Sim_CyclesPerAccess);
+
+	errno = SavedErrno;
+}
+
+/* Maps the register block and tick counter twice, inaccessible to the firmware and writable for the core */
+static void Sim_MapRegisters(void)
+{
+	long Page = sysconf(_SC_PAGESIZE);
+	int  File = memfd_create("Sim_USB", 0);
+
+	Sim_RegisterSpan = (sizeof(USB_TypeDef) + sizeof(uint32_t) + Page - 1) & ~(Page - 1);
+
+	if ((File < 0) || ftruncate(File, Sim_RegisterSpan))
+	  Sim_Fatal("cannot create the register block: %s", strerror(errno));
+
+	Sim_USBRegisters  = mmap(NULL, Sim_RegisterSpan, PROT_NONE, MAP_SHARED, File, 0);
+	Sim_CoreRegisters = mmap(NULL, Sim_RegisterSpan, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+
+	if ((Sim_USBRegisters == MAP_FAILED) || (Sim_CoreRegisters == MAP_FAILED))
+	  Sim_Fatal("cannot map the register block: %s", strerror(errno));
+
+	Sim_TickCounter = (volatile uint32_t*)&Sim_USBRegisters[1];
+	close(File);
+}
+
+uint32_t INT_Disable(void)
+{
+	Sim_PRIMASK = true;
+
+	if (Sim_IntLockCount < UINT32_MAX)
+	  Sim_IntLockCount++;
+
+	return Sim_IntLockCount;
+}
+
+uint32_t INT_Enable(void)
+{
+	if (!(Sim_IntLockCount))
+	  return UINT32_MAX;
+
+	if (!(--Sim_IntLockCount)) {
+		Sim_PRIMASK = false;
+		Sim_DispatchInterrupts();
+	}
+
+	return Sim_IntLockCount;
+}
+
+void EMU_EnterEM1(void)
+{
+	uint32_t InterruptsTaken = Sim_InterruptsTaken;
+
+	Sim_Statistics.SleepEntries++;
+
+	/* As with WFI, a pending interrupt ends the sleep even while interrupts are masked */
+	Sim_SyncRegisters();
+	Sim_Sleeping = true;
+
+	/* The sleeping CPU does no work, so the clock skips ahead a bus slot at a time */
+	while (!(Sim_WakeupPending()) && (InterruptsTaken == Sim_InterruptsTaken))
+	  Sim_AdvanceClock(Sim_CyclesPerSlot - Sim_Cycles);
+
+	Sim_Sleeping = false;
+}
+
+void NVIC_EnableIRQ(const int IRQn)
+{
+	__atomic_or_fetch(&Sim_NVICEnabled, (1UL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+void NVIC_DisableIRQ(const int IRQn)
+{
+	__atomic_and_fetch(&Sim_NVICEnabled, ~(1UL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+void NVIC_ClearPendingIRQ(const int IRQn)
+{
+	(void)IRQn;
+}
+
+uint32_t SysTick_Config(const uint32_t Ticks)
+{
+	uint64_t Slots = ((uint64_t)Ticks * SIM_SLOTS_PER_FRAME * 1000) / SystemCoreClockGet();
+
+	Sim_SysTickReload    = (Slots ? Slots : 1);
+	Sim_SysTickCountdown = Sim_SysTickReload;
+
+	return 0;
+}
+
+uint32_t __get_IPSR(void)
+{
+	return Sim_Exception;
+}
+
+/* Waits on the virtual host thread until the firmware hands the bus over */
+static void Sim_WaitForFirmware(void)
+{
+	struct timespec Deadline;
+
+	clock_gettime(CLOCK_REALTIME, &Deadline);
+	Deadline.tv_sec += SIM_WATCHDOG_SECONDS;
+
+	while (sem_timedwait(&Sim_MailboxDone, &Deadline)) {
+		if (errno == ETIMEDOUT)
+		  Sim_Fatal("no bus slot for %d seconds, the firmware has stopped using the simulated core", SIM_WATCHDOG_SECONDS);
+	}
+}
+
+uint8_t Sim_Execute(Sim_Transaction_t *const Transaction)
+{
+	__atomic_store_n(&Sim_Mailbox, Transaction, __ATOMIC_RELEASE);
+	sem_post(&Sim_MailboxPosted);
+
+	Sim_WaitForFirmware();
+	return Transaction->Handshake;
+}
+
+uint32_t Sim_GetFrameCount(void)
+{
+	return __atomic_load_n(&Sim_FrameCount, __ATOMIC_ACQUIRE);
+}
+
+void Sim_GetStatistics(Sim_Statistics_t *const Statistics)
+{
+	*Statistics = Sim_Statistics;
+}
+
+static void* Sim_HostThread(void *Host)
+{
+	Sim_WaitForFirmware();
+
+	((void (*)(void))Host)();
+	Sim_Fatal("virtual host returned without ending the run");
+}
+
+void Sim_Start(const uint32_t CyclesPerAccess,
+               int (*Firmware)(void),
+               void (*Host)(void))
+{
+	struct sigaction Action;
+	pthread_t        HostThread;
+
+	sem_init(&Sim_MailboxPosted, 0, 0);
+	sem_init(&Sim_MailboxDone, 0, 0);
+
+	Sim_CyclesPerAccess = CyclesPerAccess;
+	Sim_CyclesPerSlot   = SystemCoreClockGet() / (1000UL * SIM_SLOTS_PER_FRAME);
+
+	Sim_MapRegisters();
+	Sim_SoftReset();
+	Sim_Publish();
+	USB->GRSTCTL = USB_GRSTCTL_AHBIDLE;
+
+	if (pthread_create(&HostThread, NULL, Sim_HostThread, (void*)Host))
+	  Sim_Fatal("cannot create the virtual host thread");
+
+	memset(&Action, 0, sizeof(Action));
+	/* Handlers nest, so that the hardware keeps running while an interrupt handler waits on it */
+	Action.sa_sigaction = Sim_AccessFault;
+	Action.sa_flags     = SA_SIGINFO | SA_NODEFER;
+	sigemptyset(&Action.sa_mask);
+	sigaction(SIGSEGV, &Action, NULL);
+
+	Action.sa_sigaction = Sim_AccessStep;
+	sigaction(SIGTRAP, &Action, NULL);
+
+	Firmware();
+	Sim_Fatal("firmware returned from main()");
+}
@@ -0,0 +1,205 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated EFM32GG USB core and CPU interrupt model.
+ *
+ *  The simulation runs the unmodified EFM32GG port and a device application natively on Linux. The
+ *  firmware runs on the main thread, against the register block declared in the shim \c em_device.h,
+ *  while a virtual host runs on a second thread and hands bus transactions to the simulated core.
+ *
+ *  The register block is mapped inaccessible to the firmware. Each access faults, is single stepped
+ *  with the page accessible, and any store is then applied by the core before the next instruction,
+ *  so write one to clear status bits, NAK and disable requests and FIFO flushes take effect as on the
+ *  silicon. This needs an x86 host, for its trap flag.
+ *
+ *  Hardware time is kept by a virtual clock rather than the host's, so that every run of a script
+ *  takes the same number of frames. The clock counts CPU cycles: each register access by the firmware
+ *  is charged a fixed number of them, and sleeping in EM1 skips ahead to the next bus slot. Time is
+ *  divided into bus slots, each of which runs a single bus transaction or the start of a frame, then
+ *  raises the USB and SysTick interrupts, which are taken after the access that ended the slot when
+ *  the firmware has not locked interrupts. As on the silicon, the hardware keeps running while an
+ *  interrupt handler busy-waits on a register. The virtual host only runs between bus slots, while
+ *  the firmware waits for its next transaction.
+ *
+ *  Endpoint DMA addresses are 32-bit, so every buffer handed to the core must be a static object of a
+ *  non position independent executable.
+ */
+
+#ifndef __SIMCORE_H__
+#define __SIMCORE_H__
+
+/* Includes: */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+#if !defined(SIM_SLOTS_PER_FRAME) || defined(__DOXYGEN__)
+/** Number of bus slots in each 1ms frame, the first of which carries the SOF. Each slot carries a
+ *  single transaction, so this bounds the packets per frame like the bandwidth of a full speed bus.
+ *
+ *  This value may be overridden in the makefile as the value of the \ref SIM_SLOTS_PER_FRAME token,
+ *  and passed to the compiler using the -D switch.
+ */
+#define SIM_SLOTS_PER_FRAME          20
+#endif
+
+/** Default number of CPU cycles charged to the virtual clock for each firmware access to the register
+ *  block, see \ref Sim_Start(). This covers the access itself and the code around it, which does not
+ *  advance the clock.
+ */
+#define SIM_DEFAULT_ACCESS_CYCLES    20
+
+/** Largest packet the simulated bus can carry. */
+#define SIM_MAX_PACKET_SIZE          1023
+
+/* Enums: */
+/** Enum for the bus operations a \ref Sim_Transaction_t can request from the simulated core. */
+enum Sim_Tokens_t {
+	SIM_TOKEN_IDLE                = 0, /**< Leaves the bus idle for one slot. */
+	SIM_TOKEN_SETUP               = 1, /**< SETUP token followed by an 8 byte DATA0 packet. */
+	SIM_TOKEN_OUT                 = 2, /**< OUT token followed by a data packet of \c Length bytes. */
+	SIM_TOKEN_IN                  = 3, /**< IN token, the device's data packet is returned in \c Data. */
+	SIM_BUS_ATTACH                = 4, /**< Applies VBUS, so that the device may connect. */
+	SIM_BUS_DETACH                = 5, /**< Removes VBUS. */
+	SIM_BUS_RESET                 = 6, /**< Drives a bus reset, which ends after the following frame. */
+	SIM_BUS_SUSPEND               = 7, /**< Stops the frames, suspending the bus. */
+	SIM_BUS_RESUME                = 8, /**< Drives resume signalling and restarts the frames. */
+};
+
+/** Enum for the outcome of a \ref Sim_Transaction_t. */
+enum Sim_Handshakes_t {
+	SIM_HANDSHAKE_ACK             = 0, /**< Transaction completed. */
+	SIM_HANDSHAKE_NAK             = 1, /**< Endpoint was not ready, the transaction may be retried. */
+	SIM_HANDSHAKE_STALL           = 2, /**< Endpoint is halted or the request was rejected. */
+	SIM_HANDSHAKE_NONE            = 3, /**< No device answered, it is detached or not at that address. */
+	SIM_HANDSHAKE_BABBLE          = 4, /**< Packet did not fit the endpoint's packet size or transfer. */
+};
+
+/* Type Defines: */
+/** Type define for a single bus transaction handed from the virtual host to the simulated core. */
+typedef struct {
+	uint8_t  Token; /**< Operation to perform, a value from \ref Sim_Tokens_t. */
+	uint8_t  Address; /**< Device address the token is sent to. */
+	uint8_t  Endpoint; /**< Endpoint number the token is sent to. */
+	uint8_t  Handshake; /**< Outcome, a value from \ref Sim_Handshakes_t, set by the core. */
+	uint16_t Length; /**< Length of the packet in \c Data, sent for OUT and SETUP, received for IN. */
+	uint8_t  Data[SIM_MAX_PACKET_SIZE]; /**< Packet data. */
+} Sim_Transaction_t;
+
+/** Type define for the counters kept by the simulated core, see \ref Sim_GetStatistics(). */
+typedef struct {
+	uint32_t Slots; /**< Bus slots elapsed. */
+	uint32_t Frames; /**< Frames elapsed, including those without an SOF. */
+	uint32_t Transactions; /**< Token transactions run, by any outcome. */
+	uint32_t NAKs; /**< Transactions answered with a NAK. */
+	uint32_t STALLs; /**< Transactions answered with a STALL. */
+	uint32_t USBInterrupts; /**< Entries to USB_IRQHandler(). */
+	uint32_t SysTickInterrupts; /**< Entries to SysTick_Handler(). */
+	uint32_t SleepEntries; /**< Entries to EM1. */
+	uint32_t SleepSlots; /**< Bus slots which started while the firmware slept in EM1. */
+	uint32_t InterruptSlots; /**< Bus slots which started while the firmware ran an interrupt handler. */
+	uint32_t RegisterAccesses; /**< Firmware accesses to the register block, which advance the virtual clock. */
+} Sim_Statistics_t;
+
+/* Function Prototypes: */
+/** Starts the virtual host on a new thread, then runs the firmware on the calling thread. This
+ *  function does not return; the run ends when the virtual host calls \ref Sim_Exit().
+ *
+ *  \param[in] CyclesPerAccess  CPU cycles charged to the virtual clock for each register access.
+ *  \param[in] Firmware         Firmware entry point, the application's renamed \c main().
+ *  \param[in] Host             Virtual host entry point, which must end the run with \ref Sim_Exit().
+ */
+void Sim_Start(const uint32_t CyclesPerAccess,
+               int (*Firmware)(void),
+               void (*Host)(void)) __attribute__((noreturn));
+
+/** Hands a transaction to the simulated core and waits for the bus slot in which it completes. Must
+ *  only be called from the virtual host thread.
+ *
+ *  \param[in,out] Transaction  Transaction to run, the handshake and any IN data are returned in it.
+ *
+ *  \return Handshake of the transaction, a value from \ref Sim_Handshakes_t.
+ */
+uint8_t Sim_Execute(Sim_Transaction_t *const Transaction);
+
+/** Retrieves the number of the current frame, which advances by one every \ref SIM_SLOTS_PER_FRAME
+ *  bus slots whether or not the bus is active.
+ *
+ *  \return Frames elapsed since the simulation started.
+ */
+uint32_t Sim_GetFrameCount(void);
+
+/** Takes a snapshot of the simulated core's counters.
+ *
+ *  \param[out] Statistics  Location to copy the counters to.
+ */
+void Sim_GetStatistics(Sim_Statistics_t *const Statistics);
+
+/** Stops the simulation and ends the process.
+ *
+ *  \param[in] Status  Process exit status.
+ */
+void Sim_Exit(const int Status) __attribute__((noreturn));
+
+/** Applies the register writes the firmware made since the last bus slot. Called by the HAL shim
+ *  before it evaluates registers the simulated core owns, as the silicon would have acted on the
+ *  writes immediately.
+ */
+void Sim_SyncRegisters(void);
+
+/** Converts a 32-bit DMA address programmed by the firmware back into a pointer. Ends the run if
+ *  the address cannot belong to a static buffer of the firmware.
+ *
+ *  \param[in] Address  DMA address to convert.
+ *
+ *  \return Pointer to the memory at the given DMA address.
+ */
+uint8_t* Sim_DMAPointer(const uint32_t Address);
+
+/** Reports a fatal simulation error, such as a firmware access the silicon would not allow, and
+ *  ends the run.
+ *
+ *  \param[in] Format  printf() style format of the message.
+ */
+void Sim_Fatal(const char *Format, ...) __attribute__((format(printf, 1, 2))) __attribute__((noreturn));
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,394 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Simulated Gecko SDK peripheral library, USB HAL and board support. See SimHAL.h for an
+ *  overview.
+ */
+
+#include <stdio.h>
+
+#include "SimCore.h"
+#include "SimHAL.h"
+#include <em_device.h>
+#include <em_assert.h>
+#include <em_cmu.h>
+#include <em_gpio.h>
+#include <em_usart.h>
+#include <em_usbhal.h>
+#include <em_usbd.h>
+#include <bsp.h>
+
+/** Clock frequency of the HFXO fitted to the board, which feeds the core, peripherals and USB. */
+#define SIM_HFXO_FREQUENCY           48000000UL
+
+CMU_TypeDef       Sim_CMU;
+USART_TypeDef     Sim_UART0;
+USART_TypeDef     Sim_UART1;
+USART_TypeDef     Sim_USART0;
+USART_TypeDef     Sim_USART1;
+USART_TypeDef     Sim_USART2;
+DMA_TypeDef       Sim_DMA;
+volatile uint16_t Sim_BoardLEDs;
+volatile uint16_t Sim_BoardButtons;
+
+static uint32_t   Sim_BaudRate;
+
+extern USBD_Device_TypeDef *dev;
+
+uint16_t Sim_GetBoardLEDs(void)
+{
+	return Sim_BoardLEDs;
+}
+
+uint32_t Sim_GetBaudRate(void)
+{
+	return Sim_BaudRate;
+}
+
+void assertEFM(const char *File, int Line)
+{
+	Sim_Fatal("EFM_ASSERT failed at %s:%d", File, Line);
+}
+
+void setupSWOForPrint(void)
+{
+
+}
+
+uint32_t SystemCoreClockGet(void)
+{
+	return SIM_HFXO_FREQUENCY;
+}
+
+void CMU_ClockEnable(const CMU_Clock_TypeDef Clock, const bool Enable)
+{
+	(void)Clock;
+	(void)Enable;
+}
+
+uint32_t CMU_ClockFreqGet(const CMU_Clock_TypeDef Clock)
+{
+	(void)Clock;
+
+	return SIM_HFXO_FREQUENCY;
+}
+
+void CMU_ClockSelectSet(const CMU_Clock_TypeDef Clock, const CMU_Select_TypeDef Ref)
+{
+	(void)Clock;
+	(void)Ref;
+}
+
+void GPIO_PinModeSet(const GPIO_Port_TypeDef Port,
+                     const unsigned int Pin,
+                     const GPIO_Mode_TypeDef Mode,
+                     const unsigned int Out)
+{
+	(void)Port;
+	(void)Pin;
+	(void)Mode;
+	(void)Out;
+}
+
+void USART_InitAsync(USART_TypeDef *const usart,
+                     const USART_InitAsync_TypeDef *const init)
+{
+	USART_BaudrateAsyncSet(usart, init->refFreq, init->baudrate, init->oversampling);
+	USART_Enable(usart, init->enable);
+}
+
+void USART_Enable(USART_TypeDef *const usart,
+                  const USART_Enable_TypeDef Enable)
+{
+	usart->CMD = Enable;
+}
+
+void USART_BaudrateAsyncSet(USART_TypeDef *const usart,
+                            const uint32_t RefFreq,
+                            const uint32_t Baudrate,
+                            const USART_OVS_TypeDef Ovs)
+{
+	static const uint8_t Oversampling[] = {16, 8, 6, 4};
+	uint32_t Reference = (RefFreq ? RefFreq : CMU_ClockFreqGet(cmuClock_HFPER));
+
+	/* Fractional divider in 1/256ths, as programmed by emlib */
+	usart->CLKDIV = (uint32_t)((((uint64_t)Reference * 256) / ((uint64_t)Oversampling[Ovs] * Baudrate)) - 256);
+	Sim_BaudRate  = Baudrate;
+}
+
+int BSP_Init(const uint32_t Flags)
+{
+	(void)Flags;
+
+	return BSP_STATUS_OK;
+}
+
+int BSP_PeripheralAccess(const int Peripheral, const bool Enable)
+{
+	(void)Peripheral;
+	(void)Enable;
+
+	return BSP_STATUS_OK;
+}
+
+uint16_t BSP_PushButtonsGet(void)
+{
+	return Sim_BoardButtons;
+}
+
+void USBHAL_DisableGlobalInt(void)
+{
+	USB->GAHBCFG &= ~USB_GAHBCFG_GLBLINTRMSK;
+}
+
+void USBHAL_EnableGlobalInt(void)
+{
+	USB->GAHBCFG |= USB_GAHBCFG_GLBLINTRMSK;
+}
+
+void USBHAL_FlushRxFifo(void)
+{
+	USB->GRSTCTL = USB_GRSTCTL_RXFFLSH;
+	Sim_SyncRegisters();
+
+	while (USB->GRSTCTL & USB_GRSTCTL_RXFFLSH);
+}
+
+void USBHAL_FlushTxFifo(const uint8_t FIFONum)
+{
+	USB->GRSTCTL = USB_GRSTCTL_TXFFLSH | ((uint32_t)FIFONum << _USB_GRSTCTL_TXFNUM_SHIFT);
+	Sim_SyncRegisters();
+
+	while (USB->GRSTCTL & USB_GRSTCTL_TXFFLSH);
+}
+
+uint32_t USBHAL_GetCoreInts(void)
+{
+	return USB->GINTSTS & USB->GINTMSK;
+}
+
+void USBDHAL_ActivateEp(USBD_Ep_TypeDef *const ep, const bool ForceIdle)
+{
+	USB->DAINTMSK |= ep->mask;
+
+	if (ep->in) {
+		USB_DINEPS[ep->num].CTL = (USB_DINEPS[ep->num].CTL &
+		                           ~(_USB_DIEP_CTL_MPS_MASK | _USB_DIEP_CTL_EPTYPE_MASK |
+		                             _USB_DIEP_CTL_TXFNUM_MASK | DEPCTL_WO_BITMASK)) |
+		                          ((uint32_t)ep->packetSize << _USB_DIEP_CTL_MPS_SHIFT) |
+		                          ((uint32_t)ep->type << _USB_DIEP_CTL_EPTYPE_SHIFT) |
+		                          ((uint32_t)ep->txFifoNum << _USB_DIEP_CTL_TXFNUM_SHIFT) |
+		                          USB_DIEP_CTL_SETD0PIDEF | USB_DIEP_CTL_USBACTEP | USB_DIEP_CTL_SNAK;
+	} else {
+		USB_DOUTEPS[ep->num].CTL = (USB_DOUTEPS[ep->num].CTL &
+		                            ~(_USB_DOEP_CTL_MPS_MASK | _USB_DOEP_CTL_EPTYPE_MASK | DEPCTL_WO_BITMASK)) |
+		                           ((uint32_t)ep->packetSize << _USB_DOEP_CTL_MPS_SHIFT) |
+		                           ((uint32_t)ep->type << _USB_DOEP_CTL_EPTYPE_SHIFT) |
+		                           USB_DOEP_CTL_SETD0PIDEF | USB_DOEP_CTL_USBACTEP | USB_DOEP_CTL_SNAK;
+	}
+
+	if (ForceIdle)
+	  ep->state = D_EP_IDLE;
+}
+
+void USBDHAL_AbortEpIn(USBD_Ep_TypeDef *const ep)
+{
+	/* NAK the endpoint, then disable it once the NAK has taken effect */
+	USB_DINEPS[ep->num].INT = USB_DIEP_INT_EPDISBLD | USB_DIEP_INT_INEPNAKEFF;
+	USB_DINEPS[ep->num].CTL = (USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) | USB_DIEP_CTL_SNAK;
+	Sim_SyncRegisters();
+
+	while (!(USB_DINEPS[ep->num].INT & USB_DIEP_INT_INEPNAKEFF));
+
+	if (USB_DINEPS[ep->num].CTL & USB_DIEP_CTL_EPENA) {
+		USB_DINEPS[ep->num].CTL = (USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) | USB_DIEP_CTL_EPDIS;
+		Sim_SyncRegisters();
+
+		while (!(USB_DINEPS[ep->num].INT & USB_DIEP_INT_EPDISBLD));
+	}
+
+	USB_DINEPS[ep->num].INT = USB_DIEP_INT_EPDISBLD | USB_DIEP_INT_INEPNAKEFF;
+	USBHAL_FlushTxFifo(ep->txFifoNum);
+}
+
+void USBDHAL_AbortEpOut(USBD_Ep_TypeDef *const ep)
+{
+	USB_DOUTEPS[ep->num].INT = USB_DOEP_INT_EPDISBLD;
+	USB_DOUTEPS[ep->num].CTL = (USB_DOUTEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) | USB_DOEP_CTL_SNAK;
+	Sim_SyncRegisters();
+
+	if (USB_DOUTEPS[ep->num].CTL & USB_DOEP_CTL_EPENA) {
+		USB_DOUTEPS[ep->num].CTL = (USB_DOUTEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) | USB_DOEP_CTL_EPDIS;
+		Sim_SyncRegisters();
+
+		while (!(USB_DOUTEPS[ep->num].INT & USB_DOEP_INT_EPDISBLD));
+	}
+
+	USB_DOUTEPS[ep->num].INT = USB_DOEP_INT_EPDISBLD;
+}
+
+void USBDHAL_EnableInts(USBD_Device_TypeDef *const dev)
+{
+	uint32_t Mask = USB_GINTMSK_USBSUSPMSK | USB_GINTMSK_USBRSTMSK | USB_GINTMSK_ENUMDONEMSK |
+	                USB_GINTMSK_IEPINTMSK  | USB_GINTMSK_OEPINTMSK;
+
+	if (dev->callbacks->usbStateChange)
+	  Mask |= USB_GINTMSK_WKUPINTMSK;
+
+	if (dev->callbacks->sofInt)
+	  Mask |= USB_GINTMSK_SOFMSK;
+
+	USB->GINTSTS = 0xFFFFFFFF;
+	USB->GINTMSK = Mask;
+}
+
+void USBDHAL_EnableUsbResetAndSuspendInt(void)
+{
+	USB->GINTMSK = USB_GINTMSK_USBRSTMSK | USB_GINTMSK_USBSUSPMSK;
+}
+
+void USBDHAL_Ep0Activate(const uint32_t Ep0MPS)
+{
+	USB->DCTL     = (USB->DCTL & ~DCTL_WO_BITMASK) | USB_DCTL_CGNPINNAK;
+	USB->DOEP0CTL = (USB->DOEP0CTL & ~DEPCTL_WO_BITMASK) | USB_DOEP_CTL_CNAK | USB_DOEP_CTL_EPENA | Ep0MPS;
+}
+
+bool USBDHAL_EpIsStalled(USBD_Ep_TypeDef *const ep)
+{
+	if (ep->in)
+	  return (USB_DINEPS[ep->num].CTL & USB_DIEP_CTL_STALL) ? true : false;
+	else
+	  return (USB_DOUTEPS[ep->num].CTL & USB_DOEP_CTL_STALL) ? true : false;
+}
+
+uint32_t USBDHAL_GetAllInEpInts(void)
+{
+	return (USB->DAINT & USB->DAINTMSK) & 0xFFFF;
+}
+
+uint32_t USBDHAL_GetAllOutEpInts(void)
+{
+	return ((USB->DAINT & USB->DAINTMSK) >> _USB_DAINTMSK_OUTEPMSK0_SHIFT) & 0xFFFF;
+}
+
+uint32_t USBDHAL_GetInEpInts(USBD_Ep_TypeDef *const ep)
+{
+	return USB_DINEPS[ep->num].INT & USB->DIEPMSK;
+}
+
+uint32_t USBDHAL_GetOutEpInts(USBD_Ep_TypeDef *const ep)
+{
+	return USB_DOUTEPS[ep->num].INT & USB->DOEPMSK;
+}
+
+USB_Status_TypeDef USBDHAL_StallEp(USBD_Ep_TypeDef *const ep)
+{
+	uint32_t Control;
+
+	if (ep->in) {
+		Control = USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK;
+
+		if (Control & USB_DIEP_CTL_EPENA)
+		  Control |= USB_DIEP_CTL_EPDIS;
+
+		USB_DINEPS[ep->num].CTL = Control | USB_DIEP_CTL_STALL;
+	} else {
+		Control = USB_DOUTEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK;
+		USB_DOUTEPS[ep->num].CTL = Control | USB_DOEP_CTL_STALL;
+	}
+
+	return USB_STATUS_OK;
+}
+
+USB_Status_TypeDef USBDHAL_UnStallEp(USBD_Ep_TypeDef *const ep)
+{
+	if (ep->in) {
+		USB_DINEPS[ep->num].CTL = (USB_DINEPS[ep->num].CTL & ~(DEPCTL_WO_BITMASK | USB_DIEP_CTL_STALL)) |
+		                          USB_DIEP_CTL_SETD0PIDEF;
+	} else {
+		USB_DOUTEPS[ep->num].CTL = (USB_DOUTEPS[ep->num].CTL & ~(DEPCTL_WO_BITMASK | USB_DOEP_CTL_STALL)) |
+		                           USB_DOEP_CTL_SETD0PIDEF;
+	}
+
+	return USB_STATUS_OK;
+}
+
+void USBDHAL_StartEpIn(USBD_Ep_TypeDef *const ep)
+{
+	uint32_t PacketCount = 1;
+	uint32_t TransferSize = 0;
+
+	if (ep->remaining) {
+		PacketCount  = (ep->remaining - 1 + ep->packetSize) / ep->packetSize;
+		TransferSize = ep->remaining;
+	}
+
+	USB_DINEPS[ep->num].TSIZ    = (USB_DINEPS[ep->num].TSIZ &
+	                               ~(_USB_DIEP_TSIZ_XFERSIZE_MASK | _USB_DIEP_TSIZ_PKTCNT_MASK)) |
+	                              (TransferSize << _USB_DIEP_TSIZ_XFERSIZE_SHIFT) |
+	                              (PacketCount << _USB_DIEP_TSIZ_PKTCNT_SHIFT);
+	USB_DINEPS[ep->num].DMAADDR = (uint32_t)(uintptr_t)ep->buf;
+	USB_DINEPS[ep->num].CTL     = (USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) |
+	                              USB_DIEP_CTL_CNAK | USB_DIEP_CTL_EPENA;
+}
+
+void USBDHAL_StartEpOut(USBD_Ep_TypeDef *const ep)
+{
+	uint32_t PacketCount = 1;
+	uint32_t TransferSize = ep->packetSize;
+
+	if (ep->remaining) {
+		PacketCount  = (ep->remaining - 1 + ep->packetSize) / ep->packetSize;
+		TransferSize = PacketCount * ep->packetSize;
+	}
+
+	USB_DOUTEPS[ep->num].TSIZ    = (USB_DOUTEPS[ep->num].TSIZ &
+	                                ~(_USB_DOEP_TSIZ_XFERSIZE_MASK | _USB_DOEP_TSIZ_PKTCNT_MASK)) |
+	                               (TransferSize << _USB_DOEP_TSIZ_XFERSIZE_SHIFT) |
+	                               (PacketCount << _USB_DOEP_TSIZ_PKTCNT_SHIFT);
+	ep->hwXferSize               = TransferSize;
+	USB_DOUTEPS[ep->num].DMAADDR = (uint32_t)(uintptr_t)ep->buf;
+	USB_DOUTEPS[ep->num].CTL     = (USB_DOUTEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) |
+	                               USB_DOEP_CTL_CNAK | USB_DOEP_CTL_EPENA;
+}
+
+USBD_Ep_TypeDef *USBD_GetEpFromAddr(const uint8_t EpAddr)
+{
+	uint8_t Index;
+
+	if (EpAddr & USB_SETUP_DIR_MASK)
+	  Index = dev->inEpAddr2EpIndex[EpAddr & USB_EPNUM_MASK];
+	else
+	  Index = dev->outEpAddr2EpIndex[EpAddr & USB_EPNUM_MASK];
+
+	return &dev->ep[Index];
+}
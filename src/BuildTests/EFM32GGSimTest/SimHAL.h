@@ -0,0 +1,71 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Simulated Gecko SDK peripheral library and board support.
+ *
+ *  Stands in for the parts of emlib, the USB HAL and the DK3750 board support package which the
+ *  EFM32GG port and the demos call. The USB HAL functions follow the Gecko SDK implementation
+ *  against the simulated register block, while the clock, GPIO and board functions only record
+ *  what the firmware asked for, so that a script can check it.
+ */
+
+#ifndef __SIMHAL_H__
+#define __SIMHAL_H__
+
+/* Includes: */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Function Prototypes: */
+/** Retrieves the LED states last written by the firmware to the board's LED register.
+ *
+ *  \return Mask of the lit board LEDs.
+ */
+uint16_t Sim_GetBoardLEDs(void);
+
+/** Retrieves the baud rate last programmed into a UART or USART by the firmware.
+ *
+ *  \return Baud rate in bits per second, or zero if none was programmed.
+ */
+uint32_t Sim_GetBaudRate(void);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,438 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Virtual USB host for the simulated EFM32GG USB core. See VirtualHost.h for an overview.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VirtualHost.h"
+
+/** Standard request codes and descriptor types used during enumeration. */
+#define HOST_REQ_SET_ADDRESS         0x05
+#define HOST_REQ_GET_DESCRIPTOR      0x06
+#define HOST_REQ_SET_CONFIGURATION   0x09
+#define HOST_DTYPE_DEVICE            0x01
+#define HOST_DTYPE_CONFIGURATION     0x02
+#define HOST_DTYPE_ENDPOINT          0x05
+
+/** Largest configuration descriptor the virtual host reads. */
+#define HOST_MAX_CONFIGURATION_SIZE  512
+
+static uint8_t  Host_Address;
+static uint32_t Host_TimeoutFrames = HOST_DEFAULT_TIMEOUT_FRAMES;
+static uint16_t Host_ControlSize   = 64;
+static uint16_t Host_EndpointSize[2][16];
+static char     Host_Error[160];
+
+static Sim_Transaction_t Host_Transaction;
+
+static uint8_t Host_Fail(const uint8_t Result, const char *Format, ...) __attribute__((format(printf, 2, 3)));
+static uint8_t Host_Fail(const uint8_t Result, const char *Format, ...)
+{
+	va_list Args;
+
+	va_start(Args, Format);
+	vsnprintf(Host_Error, sizeof(Host_Error), Format, Args);
+	va_end(Args);
+
+	return Result;
+}
+
+static const char* Host_ResultName(const uint8_t Result)
+{
+	static const char* Names[] = {"ACK", "NAK", "STALL", "no response", "babble", "timeout", "mismatch"};
+
+	return (Result < (sizeof(Names) / sizeof(Names[0]))) ? Names[Result] : "unknown";
+}
+
+void Host_SetTimeout(const uint32_t Frames)
+{
+	Host_TimeoutFrames = Frames;
+}
+
+void Host_SetAddress(const uint8_t Address)
+{
+	Host_Address = Address;
+}
+
+uint16_t Host_GetEndpointSize(const uint8_t Address)
+{
+	uint16_t Size = Host_EndpointSize[(Address & 0x80) ? 1 : 0][Address & 0x0F];
+
+	if (!(Address & 0x0F))
+	  return Host_ControlSize;
+
+	return Size ? Size : 64;
+}
+
+const char* Host_GetError(void)
+{
+	return Host_Error;
+}
+
+void Host_WaitFrames(const uint32_t Frames)
+{
+	uint32_t Target = Sim_GetFrameCount() + Frames;
+
+	while ((int32_t)(Target - Sim_GetFrameCount()) > 0) {
+		Host_Transaction.Token = SIM_TOKEN_IDLE;
+		Sim_Execute(&Host_Transaction);
+	}
+}
+
+uint8_t Host_Bus(const uint8_t Token)
+{
+	uint8_t Result;
+
+	Host_Transaction.Token = Token;
+	Result = Sim_Execute(&Host_Transaction);
+
+	if ((Token == SIM_BUS_RESET) || (Token == SIM_BUS_DETACH))
+	  Host_Address = 0;
+
+	if (Result != HOST_RESULT_ACK)
+	  return Host_Fail(Result, "bus operation %u: %s", Token, Host_ResultName(Result));
+
+	return HOST_RESULT_ACK;
+}
+
+/* Runs a single transaction, retrying it while it is NAKed until the timeout */
+static uint8_t Host_Transact(const uint8_t Token,
+                             const uint8_t EPNum,
+                             const uint8_t *const Data,
+                             const uint16_t Length)
+{
+	uint32_t Deadline = Sim_GetFrameCount() + Host_TimeoutFrames;
+	uint8_t  Result;
+
+	for (;;) {
+		Host_Transaction.Token    = Token;
+		Host_Transaction.Address  = Host_Address;
+		Host_Transaction.Endpoint = EPNum;
+		Host_Transaction.Length   = Length;
+
+		if (Length)
+		  memcpy(Host_Transaction.Data, Data, Length);
+
+		if ((Result = Sim_Execute(&Host_Transaction)) != HOST_RESULT_NAK)
+		  break;
+
+		if ((int32_t)(Deadline - Sim_GetFrameCount()) < 0)
+		  return HOST_RESULT_TIMEOUT;
+	}
+
+	return Result;
+}
+
+uint8_t Host_ControlTransfer(const Host_Request_t *const Request,
+                             uint8_t *const Data,
+                             uint16_t *const Length)
+{
+	uint8_t  Setup[8];
+	uint16_t Transferred = 0;
+	bool     ToHost      = (Request->bmRequestType & 0x80) ? true : false;
+	uint8_t  Result;
+
+	*Length = 0;
+
+	Setup[0] = Request->bmRequestType;
+	Setup[1] = Request->bRequest;
+	Setup[2] = (Request->wValue & 0xFF);
+	Setup[3] = (Request->wValue >> 8);
+	Setup[4] = (Request->wIndex & 0xFF);
+	Setup[5] = (Request->wIndex >> 8);
+	Setup[6] = (Request->wLength & 0xFF);
+	Setup[7] = (Request->wLength >> 8);
+
+	if ((Result = Host_Transact(SIM_TOKEN_SETUP, 0, Setup, sizeof(Setup))) != HOST_RESULT_ACK)
+	  return Host_Fail(Result, "control request %02X: SETUP %s", Request->bRequest, Host_ResultName(Result));
+
+	/* Data stage, ended by a short packet or once the requested length has been transferred */
+	while (Transferred < Request->wLength) {
+		uint16_t PacketLength = Request->wLength - Transferred;
+
+		if (PacketLength > Host_ControlSize)
+		  PacketLength = Host_ControlSize;
+
+		if (ToHost) {
+			if ((Result = Host_Transact(SIM_TOKEN_IN, 0, NULL, 0)) != HOST_RESULT_ACK)
+			  return Host_Fail(Result, "control request %02X: data IN %s", Request->bRequest, Host_ResultName(Result));
+
+			if (Host_Transaction.Length > PacketLength)
+			  return Host_Fail(HOST_RESULT_BABBLE, "control request %02X: %u byte packet, %u expected",
+			                   Request->bRequest, Host_Transaction.Length, PacketLength);
+
+			memcpy(&Data[Transferred], Host_Transaction.Data, Host_Transaction.Length);
+			Transferred += Host_Transaction.Length;
+
+			if (Host_Transaction.Length < Host_ControlSize)
+			  break;
+		} else {
+			if ((Result = Host_Transact(SIM_TOKEN_OUT, 0, &Data[Transferred], PacketLength)) != HOST_RESULT_ACK)
+			  return Host_Fail(Result, "control request %02X: data OUT %s", Request->bRequest, Host_ResultName(Result));
+
+			Transferred += PacketLength;
+		}
+	}
+
+	*Length = Transferred;
+
+	/* Status stage, a zero length packet in the opposite direction */
+	if (ToHost && Request->wLength)
+	  Result = Host_Transact(SIM_TOKEN_OUT, 0, NULL, 0);
+	else
+	  Result = Host_Transact(SIM_TOKEN_IN, 0, NULL, 0);
+
+	if (Result != HOST_RESULT_ACK)
+	  return Host_Fail(Result, "control request %02X: status %s", Request->bRequest, Host_ResultName(Result));
+
+	if (!(ToHost && Request->wLength) && Host_Transaction.Length)
+	  return Host_Fail(HOST_RESULT_BABBLE, "control request %02X: %u byte status packet",
+	                   Request->bRequest, Host_Transaction.Length);
+
+	return HOST_RESULT_ACK;
+}
+
+uint8_t Host_OUT(const uint8_t EPNum,
+                 const uint8_t *const Data,
+                 const uint16_t Length)
+{
+	uint16_t PacketSize = Host_GetEndpointSize(EPNum);
+	uint16_t Sent       = 0;
+	uint8_t  Result;
+
+	do {
+		uint16_t PacketLength = Length - Sent;
+
+		if (PacketLength > PacketSize)
+		  PacketLength = PacketSize;
+
+		if ((Result = Host_Transact(SIM_TOKEN_OUT, EPNum, &Data[Sent], PacketLength)) != HOST_RESULT_ACK)
+		  return Host_Fail(Result, "OUT endpoint %u: %s after %u bytes", EPNum, Host_ResultName(Result), Sent);
+
+		Sent += PacketLength;
+	} while (Sent < Length);
+
+	return HOST_RESULT_ACK;
+}
+
+uint8_t Host_IN(const uint8_t EPNum,
+                uint8_t *const Data,
+                const uint16_t MaxLength,
+                uint16_t *const Length)
+{
+	uint16_t PacketSize = Host_GetEndpointSize(0x80 | EPNum);
+	uint8_t  Result;
+
+	*Length = 0;
+
+	do {
+		if ((Result = Host_Transact(SIM_TOKEN_IN, EPNum, NULL, 0)) != HOST_RESULT_ACK)
+		  return Host_Fail(Result, "IN endpoint %u: %s after %u bytes", EPNum, Host_ResultName(Result), *Length);
+
+		if ((Host_Transaction.Length > PacketSize) || (Host_Transaction.Length > (MaxLength - *Length)))
+		  return Host_Fail(HOST_RESULT_BABBLE, "IN endpoint %u: %u byte packet", EPNum, Host_Transaction.Length);
+
+		memcpy(&Data[*Length], Host_Transaction.Data, Host_Transaction.Length);
+		*Length += Host_Transaction.Length;
+	} while ((Host_Transaction.Length == PacketSize) && (*Length < MaxLength));
+
+	return HOST_RESULT_ACK;
+}
+
+static uint8_t Host_PatternByte(const uint32_t Index)
+{
+	return (uint8_t)((Index * 31) ^ (Index >> 8));
+}
+
+uint8_t Host_Loopback(const uint8_t OUTEPNum,
+                      const uint8_t INEPNum,
+                      const uint32_t Length,
+                      const uint16_t PacketSize,
+                      uint32_t *const Frames)
+{
+	uint32_t Start        = Sim_GetFrameCount();
+	uint32_t LastProgress = Start;
+	uint32_t Sent         = 0;
+	uint32_t Received     = 0;
+	uint8_t  Result;
+
+	while (Received < Length) {
+		bool Progress = false;
+
+		if (Sent < Length) {
+			uint16_t PacketLength = ((Length - Sent) < PacketSize) ? (Length - Sent) : PacketSize;
+			uint16_t Index;
+
+			Host_Transaction.Token    = SIM_TOKEN_OUT;
+			Host_Transaction.Address  = Host_Address;
+			Host_Transaction.Endpoint = OUTEPNum;
+			Host_Transaction.Length   = PacketLength;
+
+			for (Index = 0; Index < PacketLength; Index++)
+			  Host_Transaction.Data[Index] = Host_PatternByte(Sent + Index);
+
+			if ((Result = Sim_Execute(&Host_Transaction)) == HOST_RESULT_ACK) {
+				Sent    += PacketLength;
+				Progress = true;
+			} else if (Result != HOST_RESULT_NAK) {
+				return Host_Fail(Result, "loopback OUT: %s after %u bytes", Host_ResultName(Result), Sent);
+			}
+		}
+
+		Host_Transaction.Token    = SIM_TOKEN_IN;
+		Host_Transaction.Address  = Host_Address;
+		Host_Transaction.Endpoint = INEPNum;
+
+		if ((Result = Sim_Execute(&Host_Transaction)) == HOST_RESULT_ACK) {
+			uint16_t Index;
+
+			for (Index = 0; Index < Host_Transaction.Length; Index++) {
+				if ((Received >= Sent) || (Host_Transaction.Data[Index] != Host_PatternByte(Received)))
+				  return Host_Fail(HOST_RESULT_MISMATCH, "loopback IN: byte %u is %02X, expected %02X",
+				                   Received, Host_Transaction.Data[Index], Host_PatternByte(Received));
+
+				Received++;
+			}
+
+			Progress = true;
+		} else if (Result != HOST_RESULT_NAK) {
+			return Host_Fail(Result, "loopback IN: %s after %u bytes", Host_ResultName(Result), Received);
+		}
+
+		if (Progress)
+		  LastProgress = Sim_GetFrameCount();
+		else if ((Sim_GetFrameCount() - LastProgress) > Host_TimeoutFrames)
+		  return Host_Fail(HOST_RESULT_TIMEOUT, "loopback: %u bytes sent, %u received", Sent, Received);
+	}
+
+	*Frames = Sim_GetFrameCount() - Start;
+	return HOST_RESULT_ACK;
+}
+
+static uint8_t Host_GetDescriptor(const uint8_t Type,
+                                  uint8_t *const Buffer,
+                                  const uint16_t Length,
+                                  uint16_t *const Received)
+{
+	Host_Request_t Request = {
+		.bmRequestType = 0x80,
+		.bRequest      = HOST_REQ_GET_DESCRIPTOR,
+		.wValue        = ((uint16_t)Type << 8),
+		.wIndex        = 0,
+		.wLength       = Length,
+	};
+
+	return Host_ControlTransfer(&Request, Buffer, Received);
+}
+
+static uint8_t Host_SetRequest(const uint8_t Request,
+                               const uint16_t Value)
+{
+	Host_Request_t SetRequest = {
+		.bmRequestType = 0x00,
+		.bRequest      = Request,
+		.wValue        = Value,
+		.wIndex        = 0,
+		.wLength       = 0,
+	};
+	uint16_t Received;
+
+	return Host_ControlTransfer(&SetRequest, NULL, &Received);
+}
+
+uint8_t Host_Enumerate(void)
+{
+	static uint8_t Descriptor[HOST_MAX_CONFIGURATION_SIZE];
+	uint16_t       Received;
+	uint16_t       TotalLength;
+	uint16_t       Offset;
+	uint8_t        Result;
+
+	memset(Host_EndpointSize, 0, sizeof(Host_EndpointSize));
+	Host_ControlSize = 64;
+
+	if ((Result = Host_Bus(SIM_BUS_RESET)) != HOST_RESULT_ACK)
+	  return Result;
+
+	Host_WaitFrames(10);
+
+	/* The control endpoint size is taken from the first packet of the device descriptor */
+	if ((Result = Host_GetDescriptor(HOST_DTYPE_DEVICE, Descriptor, 64, &Received)) != HOST_RESULT_ACK)
+	  return Result;
+
+	if ((Received < 8) || (Descriptor[1] != HOST_DTYPE_DEVICE))
+	  return Host_Fail(HOST_RESULT_MISMATCH, "device descriptor: %u bytes of type %02X", Received, Descriptor[1]);
+
+	Host_ControlSize = Descriptor[7];
+
+	if ((Result = Host_SetRequest(HOST_REQ_SET_ADDRESS, HOST_DEVICE_ADDRESS)) != HOST_RESULT_ACK)
+	  return Result;
+
+	Host_Address = HOST_DEVICE_ADDRESS;
+	Host_WaitFrames(2);
+
+	if ((Result = Host_GetDescriptor(HOST_DTYPE_DEVICE, Descriptor, 18, &Received)) != HOST_RESULT_ACK)
+	  return Result;
+
+	if ((Received != 18) || (Descriptor[0] != 18))
+	  return Host_Fail(HOST_RESULT_MISMATCH, "device descriptor: %u bytes at the new address", Received);
+
+	if ((Result = Host_GetDescriptor(HOST_DTYPE_CONFIGURATION, Descriptor, 9, &Received)) != HOST_RESULT_ACK)
+	  return Result;
+
+	TotalLength = Descriptor[2] | ((uint16_t)Descriptor[3] << 8);
+
+	if ((Received != 9) || (TotalLength > sizeof(Descriptor)))
+	  return Host_Fail(HOST_RESULT_MISMATCH, "configuration descriptor: %u bytes, total length %u", Received, TotalLength);
+
+	if ((Result = Host_GetDescriptor(HOST_DTYPE_CONFIGURATION, Descriptor, TotalLength, &Received)) != HOST_RESULT_ACK)
+	  return Result;
+
+	if (Received != TotalLength)
+	  return Host_Fail(HOST_RESULT_MISMATCH, "configuration descriptor: %u of %u bytes", Received, TotalLength);
+
+	for (Offset = 0; (Offset + 2) <= TotalLength; Offset += Descriptor[Offset]) {
+		uint8_t* Header = &Descriptor[Offset];
+
+		if (Header[0] < 2)
+		  return Host_Fail(HOST_RESULT_MISMATCH, "configuration descriptor: bad length at offset %u", Offset);
+
+		if ((Header[1] == HOST_DTYPE_ENDPOINT) && (Header[0] >= 7))
+		  Host_EndpointSize[(Header[2] & 0x80) ? 1 : 0][Header[2] & 0x0F] = Header[4] | ((uint16_t)(Header[5] & 0x07) << 8);
+	}
+
+	return Host_SetRequest(HOST_REQ_SET_CONFIGURATION, Descriptor[5]);
+}
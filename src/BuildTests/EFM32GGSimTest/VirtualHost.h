@@ -0,0 +1,194 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Virtual USB host for the simulated EFM32GG USB core.
+ *
+ *  Builds control, bulk and interrupt transfers out of single bus transactions on the simulated
+ *  core, retrying NAKed transactions until the configured timeout like a host controller. Must
+ *  only be used from the virtual host thread.
+ */
+
+#ifndef __VIRTUALHOST_H__
+#define __VIRTUALHOST_H__
+
+/* Includes: */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SimCore.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+/** Timeout in frames of a transfer which keeps being NAKed, unless changed with \ref Host_SetTimeout(). */
+#define HOST_DEFAULT_TIMEOUT_FRAMES  100
+
+/** Address the virtual host assigns to the device during \ref Host_Enumerate(). */
+#define HOST_DEVICE_ADDRESS          1
+
+/* Enums: */
+/** Enum for the results of the virtual host functions, extending \ref Sim_Handshakes_t. */
+enum Host_Results_t {
+	HOST_RESULT_ACK               = SIM_HANDSHAKE_ACK, /**< Transfer completed. */
+	HOST_RESULT_NAK               = SIM_HANDSHAKE_NAK, /**< Single transaction was NAKed. */
+	HOST_RESULT_STALL             = SIM_HANDSHAKE_STALL, /**< Device stalled the transfer. */
+	HOST_RESULT_NONE              = SIM_HANDSHAKE_NONE, /**< Device did not answer. */
+	HOST_RESULT_BABBLE            = SIM_HANDSHAKE_BABBLE, /**< Packet did not fit the transfer. */
+	HOST_RESULT_TIMEOUT           = 5, /**< Device NAKed the transfer until the timeout. */
+	HOST_RESULT_MISMATCH          = 6, /**< Device returned data other than expected. */
+};
+
+/* Type Defines: */
+/** Type define for a standard control request, as sent in the SETUP packet. */
+typedef struct {
+	uint8_t  bmRequestType; /**< Direction, type and recipient of the request. */
+	uint8_t  bRequest; /**< Request code. */
+	uint16_t wValue; /**< Request specific value. */
+	uint16_t wIndex; /**< Request specific index. */
+	uint16_t wLength; /**< Length of the data stage. */
+} Host_Request_t;
+
+/* Function Prototypes: */
+/** Sets the number of frames after which a NAKed transfer fails with \ref HOST_RESULT_TIMEOUT.
+ *
+ *  \param[in] Frames  Timeout in frames.
+ */
+void Host_SetTimeout(const uint32_t Frames);
+
+/** Sets the device address used for subsequent transfers.
+ *
+ *  \param[in] Address  Device address, zero for a device which has not been addressed.
+ */
+void Host_SetAddress(const uint8_t Address);
+
+/** Retrieves the maximum packet size of a device endpoint, as read from the configuration descriptor
+ *  by \ref Host_Enumerate(), or 64 bytes for an endpoint which is not described.
+ *
+ *  \param[in] Address  Endpoint address, including the direction bit.
+ *
+ *  \return Maximum packet size of the endpoint.
+ */
+uint16_t Host_GetEndpointSize(const uint8_t Address);
+
+/** Leaves the bus idle for a number of frames.
+ *
+ *  \param[in] Frames  Number of frames to wait.
+ */
+void Host_WaitFrames(const uint32_t Frames);
+
+/** Changes the bus state, by applying or removing VBUS, resetting, suspending or resuming the bus.
+ *  Resetting and detaching return the host to address zero.
+ *
+ *  \param[in] Token  Bus operation, a \c SIM_BUS_* value from \ref Sim_Tokens_t.
+ *
+ *  \return Result of the operation, a value from \ref Host_Results_t.
+ */
+uint8_t Host_Bus(const uint8_t Token);
+
+/** Runs a control transfer on the default control endpoint.
+ *
+ *  \param[in]     Request  Request to send in the SETUP packet.
+ *  \param[in,out] Data     Data stage buffer, of at least \c wLength bytes.
+ *  \param[out]    Length   Length of the data stage actually transferred.
+ *
+ *  \return Result of the transfer, a value from \ref Host_Results_t.
+ */
+uint8_t Host_ControlTransfer(const Host_Request_t *const Request,
+                             uint8_t *const Data,
+                             uint16_t *const Length);
+
+/** Sends data to an OUT endpoint as a sequence of packets of the endpoint's size, followed by a
+ *  zero length packet if the data is empty.
+ *
+ *  \param[in] EPNum   Endpoint number.
+ *  \param[in] Data    Data to send.
+ *  \param[in] Length  Length of the data in bytes.
+ *
+ *  \return Result of the transfer, a value from \ref Host_Results_t.
+ */
+uint8_t Host_OUT(const uint8_t EPNum,
+                 const uint8_t *const Data,
+                 const uint16_t Length);
+
+/** Reads packets from an IN endpoint until a short packet ends the transfer or the buffer is full.
+ *
+ *  \param[in]  EPNum      Endpoint number.
+ *  \param[out] Data       Buffer for the received data.
+ *  \param[in]  MaxLength  Size of the buffer in bytes.
+ *  \param[out] Length     Number of bytes received.
+ *
+ *  \return Result of the transfer, a value from \ref Host_Results_t.
+ */
+uint8_t Host_IN(const uint8_t EPNum,
+                uint8_t *const Data,
+                const uint16_t MaxLength,
+                uint16_t *const Length);
+
+/** Sends a pattern to an OUT endpoint while reading it back from an IN endpoint, with the OUT and IN
+ *  transactions interleaved as a host controller schedules two bulk pipes.
+ *
+ *  \param[in]  OUTEPNum    OUT endpoint number.
+ *  \param[in]  INEPNum     IN endpoint number.
+ *  \param[in]  Length      Number of bytes to send and expect back.
+ *  \param[in]  PacketSize  Size of the OUT packets.
+ *  \param[out] Frames      Number of frames the loopback took.
+ *
+ *  \return Result of the loopback, a value from \ref Host_Results_t.
+ */
+uint8_t Host_Loopback(const uint8_t OUTEPNum,
+                      const uint8_t INEPNum,
+                      const uint32_t Length,
+                      const uint16_t PacketSize,
+                      uint32_t *const Frames);
+
+/** Resets the bus and enumerates the device: reads its device descriptor, assigns it the address
+ *  \ref HOST_DEVICE_ADDRESS, reads its configuration descriptor and selects the first configuration.
+ *
+ *  \return Result of the enumeration, a value from \ref Host_Results_t.
+ */
+uint8_t Host_Enumerate(void);
+
+/** Retrieves a description of the last failure reported by the virtual host functions.
+ *
+ *  \return Description of the failure, or an empty string.
+ */
+const char* Host_GetError(void);
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
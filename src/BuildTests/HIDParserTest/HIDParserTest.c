@@ -0,0 +1,148 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Native test of the HID report parser's extraction plans. Each test descriptor is parsed and compiled into a
+ *  plan, after which known reports are decoded and the extracted values checked, covering the sign handling of
+ *  items whose logical extents are encoded with differing widths.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <LUFA/Drivers/USB/USB.h>
+
+/** Single 16-bit input whose negative minimum is encoded in one byte and whose maximum is encoded in two. */
+static const uint8_t MixedWidthDescriptor[] =
+{
+	HID_RI_USAGE_PAGE(8, 0x01),
+	HID_RI_USAGE(8, 0x30),
+	HID_RI_LOGICAL_MINIMUM(8, -100),
+	HID_RI_LOGICAL_MAXIMUM(16, 1000),
+	HID_RI_REPORT_SIZE(8, 16),
+	HID_RI_REPORT_COUNT(8, 1),
+	HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+};
+
+/** Single 8-bit input whose maximum of 255 is encoded in one byte, as many devices do, which must stay unsigned. */
+static const uint8_t UnsignedDescriptor[] =
+{
+	HID_RI_USAGE_PAGE(8, 0x01),
+	HID_RI_USAGE(8, 0x30),
+	HID_RI_LOGICAL_MINIMUM(8, 0),
+	HID_RI_LOGICAL_MAXIMUM(8, 255),
+	HID_RI_REPORT_SIZE(8, 8),
+	HID_RI_REPORT_COUNT(8, 1),
+	HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+};
+
+/** Parsed report information of the descriptor under test. */
+static HID_ReportInfo_t HIDReportInfo;
+
+/** Extraction plan compiled from the descriptor under test. */
+static HID_ReportPlan_t HIDReportPlan;
+
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_t* const CurrentItem)
+{
+	return true;
+}
+
+/** Parses and compiles a descriptor, then decodes a report holding a single item and checks its value.
+ *
+ *  \param[in] Name            Name of the test, for the failure report
+ *  \param[in] Descriptor      HID report descriptor to parse
+ *  \param[in] DescriptorSize  Size in bytes of the descriptor
+ *  \param[in] Report          Report to decode
+ *  \param[in] ReportSize      Size in bytes of the report
+ *  \param[in] ExpectedValue   Value the report's single item must decode to
+ *
+ *  \return Boolean \c true if the report decoded to the expected value, \c false otherwise
+ */
+static bool CheckDecode(const char* Name,
+                        const uint8_t* Descriptor,
+                        const uint16_t DescriptorSize,
+                        const uint8_t* Report,
+                        const uint16_t ReportSize,
+                        const uint32_t ExpectedValue)
+{
+	uint32_t Value = 0;
+
+	memset(&HIDReportInfo, 0, sizeof(HIDReportInfo));
+
+	if (USB_ProcessHIDReport(Descriptor, DescriptorSize, &HIDReportInfo) != HID_PARSE_Successful)
+	{
+		printf("%s: descriptor failed to parse.\n", Name);
+		return false;
+	}
+
+	if (USB_CompileHIDReportPlan(&HIDReportInfo, HID_REPORT_ITEM_In, &HIDReportPlan) != HID_PARSE_Successful)
+	{
+		printf("%s: plan failed to compile.\n", Name);
+		return false;
+	}
+
+	if (USB_DecodeHIDReport(&HIDReportPlan, Report, ReportSize, &Value) != 1)
+	{
+		printf("%s: report was not decoded.\n", Name);
+		return false;
+	}
+
+	if (Value != ExpectedValue)
+	{
+		printf("%s: decoded 0x%08lX, expected 0x%08lX.\n", Name, (unsigned long)Value, (unsigned long)ExpectedValue);
+		return false;
+	}
+
+	printf("%s: decoded 0x%08lX.\n", Name, (unsigned long)Value);
+	return true;
+}
+
+int main(void)
+{
+	static const uint8_t NegativeReport[] = {0x9C, 0xFF};
+	static const uint8_t PositiveReport[] = {0xE8, 0x03};
+	static const uint8_t FullScaleReport[] = {0xFF};
+
+	bool Passed = true;
+
+	Passed &= CheckDecode("Mixed width negative", MixedWidthDescriptor, sizeof(MixedWidthDescriptor),
+	                      NegativeReport, sizeof(NegativeReport), (uint32_t)-100);
+	Passed &= CheckDecode("Mixed width positive", MixedWidthDescriptor, sizeof(MixedWidthDescriptor),
+	                      PositiveReport, sizeof(PositiveReport), 1000);
+	Passed &= CheckDecode("Unsigned full scale", UnsignedDescriptor, sizeof(UnsignedDescriptor),
+	                      FullScaleReport, sizeof(FullScaleReport), 255);
+
+	if (!(Passed))
+	  return EXIT_FAILURE;
+
+	printf("All HID report plans decoded correctly.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Native test of the web asset bundle of the Webserver project, as generated by the HTTP asset packer. Assets are
+ *  looked up by path, and a gzip encoded asset is checked against a set of HTTP Accept-Encoding request headers to
+ *  ensure that it is only sent to clients which accept the gzip content coding.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Lib/WebAssets.h"
+
+/** Accept-Encoding request header value and whether it accepts a gzip encoded asset. */
+typedef struct
+{
+	const char* AcceptEncoding; /**< Value of the request header, or \c NULL if the request has none. */
+	bool        IsAccepted; /**< Boolean \c true if the header accepts the gzip content coding, \c false otherwise. */
+} AcceptEncodingTest_t;
+
+/** Accept-Encoding request headers checked against a gzip encoded asset, \c NULL for a request without the header. */
+static const AcceptEncodingTest_t AcceptEncodingTests[] =
+	{
+		{NULL,                        false},
+		{"",                          false},
+		{"identity",                  false},
+		{"gzipx",                     false},
+		{"gzip",                      true},
+		{"deflate, gzip",             true},
+		{"br,  gzip",                 true},
+		{"deflate, x-gzip ;q=1",      true},
+		{"GZIP;q=0.5",                true},
+		{"gzip;q=0.001",              true},
+		{"gzip;q=0",                  false},
+		{"gzip; q=0.000",             false},
+		{"gzip;Q=0.0 ,deflate",       false},
+		{"gzip;level=1;q=0",          false},
+		{"*",                         true},
+		{"*;q=0",                     false},
+		{"deflate, *",                true},
+		{"gzip;q=0, *",               false},
+		{"*, gzip;q=0",               false},
+		{"*;q=0, gzip",               true},
+		{"gzip;q=0, *, x-gzip;q=0.5", true},
+	};
+
+int main(void)
+{
+	WebAsset_t Asset;
+	bool       Passed = true;
+
+	if (WebAssets_Find("missing.htm", 11, &Asset))
+	{
+		printf("Lookup of a missing asset succeeded.\n");
+		Passed = false;
+	}
+
+	if (!(WebAssets_Find("about.htm", 9, &Asset)) || !(Asset.IsGzipEncoded))
+	{
+		printf("Lookup of the gzip encoded about.htm asset failed.\n");
+		return EXIT_FAILURE;
+	}
+
+	for (uint8_t TestIndex = 0; TestIndex < (sizeof(AcceptEncodingTests) / sizeof(AcceptEncodingTests[0])); TestIndex++)
+	{
+		const AcceptEncodingTest_t* Test   = &AcceptEncodingTests[TestIndex];
+		uint8_t                     Length = ((Test->AcceptEncoding != NULL) ? strlen(Test->AcceptEncoding) : 0);
+
+		if (WebAssets_IsEncodingAccepted(&Asset, Test->AcceptEncoding, Length) != Test->IsAccepted)
+		{
+			printf("Accept-Encoding \"%s\" should %s gzip.\n", (Test->AcceptEncoding ? Test->AcceptEncoding : "(none)"),
+			       (Test->IsAccepted ? "accept" : "refuse"));
+			Passed = false;
+		}
+	}
+
+	if (!(Passed))
+	  return EXIT_FAILURE;
+
+	printf("All web asset lookups and encoding checks passed.\n");
+	return EXIT_SUCCESS;
+}
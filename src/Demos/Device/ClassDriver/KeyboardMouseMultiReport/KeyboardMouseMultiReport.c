@@ -36,9 +36,6 @@
 
 #include "KeyboardMouseMultiReport.h"
 
-/** Buffer to hold the previously generated HID report, for comparison purposes inside the HID class driver. */
-static uint8_t PrevHIDReportBuffer[MAX(sizeof(USB_KeyboardReport_Data_t), sizeof(USB_MouseReport_Data_t))];
-
 /** LUFA HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -54,8 +51,9 @@ USB_ClassInfo_HID_Device_t Device_HID_Interface =
 						.Size                 = HID_EPSIZE,
 						.Banks                = 1,
 					},
-				.PrevReportINBuffer           = PrevHIDReportBuffer,
-				.PrevReportINBufferSize       = sizeof(PrevHIDReportBuffer),
+				.PrevReportINBuffer           = NULL,
+				.PrevReportINBufferSize       = MAX(sizeof(USB_KeyboardReport_Data_t), sizeof(USB_MouseReport_Data_t)),
+				.INReportIDMask               = ((1 << HID_REPORTID_MouseReport) | (1 << HID_REPORTID_KeyboardReport)),
 			},
 	};
 
@@ -72,6 +70,8 @@ int main(void)
 
 	for (;;)
 	{
+		CheckJoystickMovement();
+
 		HID_Device_USBTask(&Device_HID_Interface);
 		USB_USBTask();
 	}
@@ -102,9 +102,40 @@ void SetupHardware()
 	/* Hardware Initialization */
 	Joystick_Init();
 	LEDs_Init();
+	Buttons_Init();
 	USB_Init();
 }
 
+/** Checks for changes in the position of the board joystick and the state of the board button, marking the HID reports
+ *  they affect as changed so that the HID class driver sends them to the host.
+ */
+void CheckJoystickMovement(void)
+{
+	static uint8_t PrevJoyStatus    = 0;
+	static uint8_t PrevButtonStatus = 0;
+
+	uint8_t JoyStatus_LCL    = Joystick_GetStatus();
+	uint8_t ButtonStatus_LCL = Buttons_GetStatus();
+
+	if ((JoyStatus_LCL == PrevJoyStatus) && (ButtonStatus_LCL == PrevButtonStatus))
+	  return;
+
+	/* Both reports change when the button moves the joystick between them, as the other report is released */
+	if ((ButtonStatus_LCL ^ PrevButtonStatus) & BUTTONS_BUTTON1)
+	{
+		HID_Device_ReportChanged(&Device_HID_Interface, HID_REPORTID_KeyboardReport);
+		HID_Device_ReportChanged(&Device_HID_Interface, HID_REPORTID_MouseReport);
+	}
+	else
+	{
+		HID_Device_ReportChanged(&Device_HID_Interface, (ButtonStatus_LCL & BUTTONS_BUTTON1) ?
+		                         HID_REPORTID_MouseReport : HID_REPORTID_KeyboardReport);
+	}
+
+	PrevJoyStatus    = JoyStatus_LCL;
+	PrevButtonStatus = ButtonStatus_LCL;
+}
+
 /** Event handler for the library USB Connection event. */
 void EVENT_USB_Device_Connect(void)
 {
@@ -160,26 +191,29 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
 	uint8_t JoyStatus_LCL    = Joystick_GetStatus();
 	uint8_t ButtonStatus_LCL = Buttons_GetStatus();
 
-	if (!(ButtonStatus_LCL & BUTTONS_BUTTON1))
+	if (*ReportID == HID_REPORTID_KeyboardReport)
 	{
 		USB_KeyboardReport_Data_t* KeyboardReport = (USB_KeyboardReport_Data_t*)ReportData;
 
-		KeyboardReport->Modifier = HID_KEYBOARD_MODIFIER_LEFTSHIFT;
+		/* Joystick only controls the keyboard while the button is released */
+		if (!(ButtonStatus_LCL & BUTTONS_BUTTON1))
+		{
+			KeyboardReport->Modifier = HID_KEYBOARD_MODIFIER_LEFTSHIFT;
 
-		if (JoyStatus_LCL & JOY_UP)
-		  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_A;
-		else if (JoyStatus_LCL & JOY_DOWN)
-		  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_B;
+			if (JoyStatus_LCL & JOY_UP)
+			  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_A;
+			else if (JoyStatus_LCL & JOY_DOWN)
+			  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_B;
 
-		if (JoyStatus_LCL & JOY_LEFT)
-		  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_C;
-		else if (JoyStatus_LCL & JOY_RIGHT)
-		  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_D;
+			if (JoyStatus_LCL & JOY_LEFT)
+			  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_C;
+			else if (JoyStatus_LCL & JOY_RIGHT)
+			  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_D;
 
-		if (JoyStatus_LCL & JOY_PRESS)
-		  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_E;
+			if (JoyStatus_LCL & JOY_PRESS)
+			  KeyboardReport->KeyCode[0] = HID_KEYBOARD_SC_E;
+		}
 
-		*ReportID   = HID_REPORTID_KeyboardReport;
 		*ReportSize = sizeof(USB_KeyboardReport_Data_t);
 		return false;
 	}
@@ -187,22 +221,28 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
 	{
 		USB_MouseReport_Data_t* MouseReport = (USB_MouseReport_Data_t*)ReportData;
 
-		if (JoyStatus_LCL & JOY_UP)
-		  MouseReport->Y = -1;
-		else if (JoyStatus_LCL & JOY_DOWN)
-		  MouseReport->Y =  1;
+		/* Joystick only controls the mouse while the button is pressed */
+		if (ButtonStatus_LCL & BUTTONS_BUTTON1)
+		{
+			if (JoyStatus_LCL & JOY_UP)
+			  MouseReport->Y = -1;
+			else if (JoyStatus_LCL & JOY_DOWN)
+			  MouseReport->Y =  1;
 
-		if (JoyStatus_LCL & JOY_LEFT)
-		  MouseReport->X = -1;
-		else if (JoyStatus_LCL & JOY_RIGHT)
-		  MouseReport->X =  1;
+			if (JoyStatus_LCL & JOY_LEFT)
+			  MouseReport->X = -1;
+			else if (JoyStatus_LCL & JOY_RIGHT)
+			  MouseReport->X =  1;
 
-		if (JoyStatus_LCL & JOY_PRESS)
-		  MouseReport->Button |= (1 << 0);
+			if (JoyStatus_LCL & JOY_PRESS)
+			  MouseReport->Button |= (1 << 0);
+		}
 
 		*ReportID   = HID_REPORTID_MouseReport;
 		*ReportSize = sizeof(USB_MouseReport_Data_t);
-		return true;
+
+		/* Movement is relative, so keep sending mouse reports for as long as the joystick is held */
+		return (MouseReport->X || MouseReport->Y);
 	}
 }
 
@@ -57,6 +57,7 @@ USB_ClassInfo_MIDI_Device_t Keyboard_MIDI_Interface =
 						.Size             = MIDI_STREAM_EPSIZE,
 						.Banks            = 1,
 					},
+				.LatencyTimerMS           = 1,
 			},
 	};
 
@@ -174,8 +175,8 @@ void CheckJoystickMovement(void)
 				.Data3       = MIDI_STANDARD_VELOCITY,
 			};
 
+		/* Event is sent by the MIDI class driver's latency timer within a millisecond, along with any others queued by then */
 		MIDI_Device_SendEventPacket(&Keyboard_MIDI_Interface, &MIDIEvent);
-		MIDI_Device_Flush(&Keyboard_MIDI_Interface);
 	}
 
 	PrevJoystickStatus = JoystickStatus;
@@ -200,6 +201,8 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 
 	ConfigSuccess &= MIDI_Device_ConfigureEndpoints(&Keyboard_MIDI_Interface);
 
+	USB_Device_EnableSOFEvents();
+
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
 }
 
@@ -209,3 +212,9 @@ void EVENT_USB_Device_ControlRequest(void)
 	MIDI_Device_ProcessControlRequest(&Keyboard_MIDI_Interface);
 }
 
+/** Event handler for the USB device Start Of Frame event. */
+void EVENT_USB_Device_StartOfFrame(void)
+{
+	MIDI_Device_MillisecondElapsed(&Keyboard_MIDI_Interface);
+}
+
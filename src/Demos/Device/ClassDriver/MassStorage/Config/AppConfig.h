@@ -47,4 +47,8 @@
 
 	#define DISK_READ_ONLY            false
 
+	#define DISK_CACHE_SETS              2
+	#define DISK_CACHE_WAYS              2
+	#define DISK_CACHE_MAX_WRITE_BLOCKS  2
+
 #endif
@@ -39,281 +39,139 @@
 #define  INCLUDE_FROM_DATAFLASHMANAGER_C
 #include "DataflashManager.h"
 
-/** Writes blocks (OS blocks, not Dataflash pages) to the storage medium, the board Dataflash IC(s), from
- *  the pre-selected data OUT endpoint. This routine reads in OS sized blocks from the endpoint and writes
- *  them to the Dataflash in Dataflash page sized blocks.
- *
- *  \param[in] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state
- *  \param[in] BlockAddress  Data block starting address for the write sequence
- *  \param[in] TotalBlocks   Number of blocks of data to write
+/** Mask of the Dataflash chips whose last page program was started from their second SRAM buffer. New data is
+ *  always loaded into the other buffer of a chip, so that a page program left running in the background by a
+ *  previous write is never disturbed.
  */
-void DataflashManager_WriteBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
-                                  const uint32_t BlockAddress,
-                                  uint16_t TotalBlocks)
-{
-	uint16_t CurrDFPage          = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) / DATAFLASH_PAGE_SIZE);
-	uint16_t CurrDFPageByte      = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) % DATAFLASH_PAGE_SIZE);
-	uint8_t  CurrDFPageByteDiv16 = (CurrDFPageByte >> 4);
-	bool     UsingSecondBuffer   = false;
-
-	/* Select the correct starting Dataflash IC for the block requested */
-	Dataflash_SelectChipFromPage(CurrDFPage);
+static uint8_t SecondBufferChips;
 
-#if (DATAFLASH_PAGE_SIZE > VIRTUAL_MEMORY_BLOCK_SIZE)
-	/* Copy selected dataflash's current page contents to the Dataflash buffer */
-	Dataflash_SendByte(DF_CMD_MAINMEMTOBUFF1);
-	Dataflash_SendAddressBytes(CurrDFPage, 0);
-	Dataflash_WaitWhileBusy();
-#endif
-
-	/* Send the Dataflash buffer write command */
-	Dataflash_SendByte(DF_CMD_BUFF1WRITE);
-	Dataflash_SendAddressBytes(0, CurrDFPageByte);
-
-	/* Wait until endpoint is ready before continuing */
-	if (Endpoint_WaitUntilReady())
-	  return;
-
-	while (TotalBlocks)
+/** Block device interface of the Dataflash media, through which the Mass Storage class driver reads and writes
+ *  blocks during the data phase of READ (10) and WRITE (10) commands.
+ */
+const MS_BlockDevice_t DataflashManager_BlockDevice =
 	{
-		uint8_t BytesInBlockDiv16 = 0;
-
-		/* Write an endpoint packet sized data block to the Dataflash */
-		while (BytesInBlockDiv16 < (VIRTUAL_MEMORY_BLOCK_SIZE >> 4))
-		{
-			/* Check if the endpoint is currently empty */
-			if (!(Endpoint_IsReadWriteAllowed()))
-			{
-				/* Clear the current endpoint bank */
-				Endpoint_ClearOUT();
-
-				/* Wait until the host has sent another packet */
-				if (Endpoint_WaitUntilReady())
-				  return;
-			}
-
-			/* Check if end of Dataflash page reached */
-			if (CurrDFPageByteDiv16 == (DATAFLASH_PAGE_SIZE >> 4))
-			{
-				/* Write the Dataflash buffer contents back to the Dataflash page */
-				Dataflash_WaitWhileBusy();
-				Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
-				Dataflash_SendAddressBytes(CurrDFPage, 0);
-
-				/* Reset the Dataflash buffer counter, increment the page counter */
-				CurrDFPageByteDiv16 = 0;
-				CurrDFPage++;
-
-				/* Once all the Dataflash ICs have had their first buffers filled, switch buffers to maintain throughput */
-				if (Dataflash_GetSelectedChip() == DATAFLASH_CHIP_MASK(DATAFLASH_TOTALCHIPS))
-				  UsingSecondBuffer = !(UsingSecondBuffer);
-
-				/* Select the next Dataflash chip based on the new Dataflash page index */
-				Dataflash_SelectChipFromPage(CurrDFPage);
-
-#if (DATAFLASH_PAGE_SIZE > VIRTUAL_MEMORY_BLOCK_SIZE)
-				/* If less than one Dataflash page remaining, copy over the existing page to preserve trailing data */
-				if ((TotalBlocks * (VIRTUAL_MEMORY_BLOCK_SIZE >> 4)) < (DATAFLASH_PAGE_SIZE >> 4))
-				{
-					/* Copy selected dataflash's current page contents to the Dataflash buffer */
-					Dataflash_WaitWhileBusy();
-					Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_MAINMEMTOBUFF2 : DF_CMD_MAINMEMTOBUFF1);
-					Dataflash_SendAddressBytes(CurrDFPage, 0);
-					Dataflash_WaitWhileBusy();
-				}
-#endif
-
-				/* Send the Dataflash buffer write command */
-				Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2WRITE : DF_CMD_BUFF1WRITE);
-				Dataflash_SendAddressBytes(0, 0);
-			}
-
-			/* Write one 16-byte chunk of data to the Dataflash */
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-			Dataflash_SendByte(Endpoint_Read_8());
-
-			/* Increment the Dataflash page 16 byte block counter */
-			CurrDFPageByteDiv16++;
-
-			/* Increment the block 16 byte block counter */
-			BytesInBlockDiv16++;
-
-			/* Check if the current command is being aborted by the host */
-			if (MSInterfaceInfo->State.IsMassStoreReset)
-			  return;
-		}
-
-		/* Decrement the blocks remaining counter */
-		TotalBlocks--;
-	}
-
-	/* Write the Dataflash buffer contents back to the Dataflash page */
-	Dataflash_WaitWhileBusy();
-	Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
-	Dataflash_SendAddressBytes(CurrDFPage, 0x00);
-	Dataflash_WaitWhileBusy();
-
-	/* If the endpoint is empty, clear it ready for the next packet from the host */
-	if (!(Endpoint_IsReadWriteAllowed()))
-	  Endpoint_ClearOUT();
+		.BlockSize  = VIRTUAL_MEMORY_BLOCK_SIZE,
+		.DeviceData = NULL,
+		.StartRead  = DataflashManager_StartRead,
+		.StartWrite = DataflashManager_StartWrite,
+		.StartFlush = DataflashManager_StartFlush,
+		.Task       = NULL,
+	};
+
+/** Block device read function for the Dataflash media. The blocks are read over SPI before returning, so the
+ *  operation is completed immediately.
+ *
+ *  \param[in]  BlockDevice   Block device the read was started through
+ *  \param[in]  BlockAddress  Data block starting address for the read sequence
+ *  \param[in]  TotalBlocks   Number of blocks of data to read
+ *  \param[out] Buffer        Pointer to the data destination RAM buffer
+ *  \param[in]  Callback      Completion callback of the operation
+ *  \param[in]  Context       Context pointer to pass to the completion callback
+ *
+ *  \return Boolean \c true, as the read is always started.
+ */
+static bool DataflashManager_StartRead(const MS_BlockDevice_t* const BlockDevice,
+                                       const MS_BlockAddress_t BlockAddress,
+                                       const uint16_t TotalBlocks,
+                                       void* const Buffer,
+                                       const MS_BlockDevice_Callback_t Callback,
+                                       void* const Context)
+{
+	DataflashManager_ReadBlocks_RAM(BlockAddress, TotalBlocks, Buffer);
+	Callback(Context, true);
 
-	/* Deselect all Dataflash chips */
-	Dataflash_DeselectChip();
+	return true;
 }
 
-/** Reads blocks (OS blocks, not Dataflash pages) from the storage medium, the board Dataflash IC(s), into
- *  the pre-selected data IN endpoint. This routine reads in Dataflash page sized blocks from the Dataflash
- *  and writes them in OS sized blocks to the endpoint.
+/** Block device write function for the Dataflash media. The blocks are loaded into the Dataflash SRAM buffers
+ *  over SPI before returning, but the final page program is left running inside the Dataflash while the next
+ *  blocks are received from the host.
  *
- *  \param[in] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state
- *  \param[in] BlockAddress  Data block starting address for the read sequence
- *  \param[in] TotalBlocks   Number of blocks of data to read
+ *  \param[in] BlockDevice   Block device the write was started through
+ *  \param[in] BlockAddress  Data block starting address for the write sequence
+ *  \param[in] TotalBlocks   Number of blocks of data to write
+ *  \param[in] Buffer        Pointer to the data source RAM buffer
+ *  \param[in] Callback      Completion callback of the operation
+ *  \param[in] Context       Context pointer to pass to the completion callback
+ *
+ *  \return Boolean \c true, as the write is always started.
  */
-void DataflashManager_ReadBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
-                                 const uint32_t BlockAddress,
-                                 uint16_t TotalBlocks)
+static bool DataflashManager_StartWrite(const MS_BlockDevice_t* const BlockDevice,
+                                        const MS_BlockAddress_t BlockAddress,
+                                        const uint16_t TotalBlocks,
+                                        const void* const Buffer,
+                                        const MS_BlockDevice_Callback_t Callback,
+                                        void* const Context)
 {
-	uint16_t CurrDFPage          = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) / DATAFLASH_PAGE_SIZE);
-	uint16_t CurrDFPageByte      = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) % DATAFLASH_PAGE_SIZE);
-	uint8_t  CurrDFPageByteDiv16 = (CurrDFPageByte >> 4);
-
-	/* Select the correct starting Dataflash IC for the block requested */
-	Dataflash_SelectChipFromPage(CurrDFPage);
-
-	/* Send the Dataflash main memory page read command */
-	Dataflash_SendByte(DF_CMD_MAINMEMPAGEREAD);
-	Dataflash_SendAddressBytes(CurrDFPage, CurrDFPageByte);
-	Dataflash_SendByte(0x00);
-	Dataflash_SendByte(0x00);
-	Dataflash_SendByte(0x00);
-	Dataflash_SendByte(0x00);
-
-	/* Wait until endpoint is ready before continuing */
-	if (Endpoint_WaitUntilReady())
-	  return;
-
-	while (TotalBlocks)
-	{
-		uint8_t BytesInBlockDiv16 = 0;
-
-		/* Write an endpoint packet sized data block to the Dataflash */
-		while (BytesInBlockDiv16 < (VIRTUAL_MEMORY_BLOCK_SIZE >> 4))
-		{
-			/* Check if the endpoint is currently full */
-			if (!(Endpoint_IsReadWriteAllowed()))
-			{
-				/* Clear the endpoint bank to send its contents to the host */
-				Endpoint_ClearIN();
-
-				/* Wait until the endpoint is ready for more data */
-				if (Endpoint_WaitUntilReady())
-				  return;
-			}
+	DataflashManager_WriteBlocks_RAM(BlockAddress, TotalBlocks, Buffer);
+	Callback(Context, true);
 
-			/* Check if end of Dataflash page reached */
-			if (CurrDFPageByteDiv16 == (DATAFLASH_PAGE_SIZE >> 4))
-			{
-				/* Reset the Dataflash buffer counter, increment the page counter */
-				CurrDFPageByteDiv16 = 0;
-				CurrDFPage++;
-
-				/* Select the next Dataflash chip based on the new Dataflash page index */
-				Dataflash_SelectChipFromPage(CurrDFPage);
-
-				/* Send the Dataflash main memory page read command */
-				Dataflash_SendByte(DF_CMD_MAINMEMPAGEREAD);
-				Dataflash_SendAddressBytes(CurrDFPage, 0);
-				Dataflash_SendByte(0x00);
-				Dataflash_SendByte(0x00);
-				Dataflash_SendByte(0x00);
-				Dataflash_SendByte(0x00);
-			}
-
-			/* Read one 16-byte chunk of data from the Dataflash */
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-			Endpoint_Write_8(Dataflash_ReceiveByte());
-
-			/* Increment the Dataflash page 16 byte block counter */
-			CurrDFPageByteDiv16++;
-
-			/* Increment the block 16 byte block counter */
-			BytesInBlockDiv16++;
-
-			/* Check if the current command is being aborted by the host */
-			if (MSInterfaceInfo->State.IsMassStoreReset)
-			  return;
-		}
+	return true;
+}
 
-		/* Decrement the blocks remaining counter */
-		TotalBlocks--;
-	}
+/** Block device flush function for the Dataflash media. This waits for the page programs left running in the
+ *  background by previous writes to complete, so that all written blocks are held in the Dataflash main memory.
+ *
+ *  \param[in] BlockDevice  Block device the flush was started through
+ *  \param[in] Callback     Completion callback of the operation
+ *  \param[in] Context      Context pointer to pass to the completion callback
+ *
+ *  \return Boolean \c true, as the flush is always started.
+ */
+static bool DataflashManager_StartFlush(const MS_BlockDevice_t* const BlockDevice,
+                                        const MS_BlockDevice_Callback_t Callback,
+                                        void* const Context)
+{
+	Dataflash_SelectChip(DATAFLASH_CHIP1);
+	Dataflash_WaitWhileBusy();
 
-	/* If the endpoint is full, send its contents to the host */
-	if (!(Endpoint_IsReadWriteAllowed()))
-	  Endpoint_ClearIN();
+	#if (DATAFLASH_TOTALCHIPS == 2)
+	Dataflash_SelectChip(DATAFLASH_CHIP2);
+	Dataflash_WaitWhileBusy();
+	#endif
 
-	/* Deselect all Dataflash chips */
 	Dataflash_DeselectChip();
+	Callback(Context, true);
+
+	return true;
 }
 
 /** Writes blocks (OS blocks, not Dataflash pages) to the storage medium, the board Dataflash IC(s), from
  *  the given RAM buffer. This routine reads in OS sized blocks from the buffer and writes them to the
  *  Dataflash in Dataflash page sized blocks. This can be linked to FAT libraries to write files to the
- *  Dataflash.
+ *  Dataflash. The program of the last page is not waited for; any later access to the same Dataflash IC
+ *  will wait for it to complete first.
  *
  *  \param[in] BlockAddress  Data block starting address for the write sequence
  *  \param[in] TotalBlocks   Number of blocks of data to write
  *  \param[in] BufferPtr     Pointer to the data source RAM buffer
  */
-void DataflashManager_WriteBlocks_RAM(const uint32_t BlockAddress,
+void DataflashManager_WriteBlocks_RAM(const MS_BlockAddress_t BlockAddress,
                                       uint16_t TotalBlocks,
-                                      uint8_t* BufferPtr)
+                                      const uint8_t* BufferPtr)
 {
 	uint16_t CurrDFPage          = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) / DATAFLASH_PAGE_SIZE);
 	uint16_t CurrDFPageByte      = ((BlockAddress * VIRTUAL_MEMORY_BLOCK_SIZE) % DATAFLASH_PAGE_SIZE);
 	uint8_t  CurrDFPageByteDiv16 = (CurrDFPageByte >> 4);
-	bool     UsingSecondBuffer   = false;
+	bool     UsingSecondBuffer;
 
 	/* Select the correct starting Dataflash IC for the block requested */
 	Dataflash_SelectChipFromPage(CurrDFPage);
 
+	/* Load the buffer which the selected Dataflash IC is not programming from */
+	UsingSecondBuffer = !(SecondBufferChips & Dataflash_GetSelectedChip());
+
 #if (DATAFLASH_PAGE_SIZE > VIRTUAL_MEMORY_BLOCK_SIZE)
 	/* Copy selected dataflash's current page contents to the Dataflash buffer */
-	Dataflash_SendByte(DF_CMD_MAINMEMTOBUFF1);
+	Dataflash_WaitWhileBusy();
+	Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_MAINMEMTOBUFF2 : DF_CMD_MAINMEMTOBUFF1);
 	Dataflash_SendAddressBytes(CurrDFPage, 0);
 	Dataflash_WaitWhileBusy();
 #endif
 
 	/* Send the Dataflash buffer write command */
-	Dataflash_SendByte(DF_CMD_BUFF1WRITE);
+	Dataflash_ToggleSelectedChipCS();
+	Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2WRITE : DF_CMD_BUFF1WRITE);
 	Dataflash_SendAddressBytes(0, CurrDFPageByte);
 
 	while (TotalBlocks)
@@ -330,18 +188,18 @@ void DataflashManager_WriteBlocks_RAM(const uint32_t BlockAddress,
 				Dataflash_WaitWhileBusy();
 				Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
 				Dataflash_SendAddressBytes(CurrDFPage, 0);
+				DataflashManager_RecordProgramBuffer(UsingSecondBuffer);
 
 				/* Reset the Dataflash buffer counter, increment the page counter */
 				CurrDFPageByteDiv16 = 0;
 				CurrDFPage++;
 
-				/* Once all the Dataflash ICs have had their first buffers filled, switch buffers to maintain throughput */
-				if (Dataflash_GetSelectedChip() == DATAFLASH_CHIP_MASK(DATAFLASH_TOTALCHIPS))
-				  UsingSecondBuffer = !(UsingSecondBuffer);
-
 				/* Select the next Dataflash chip based on the new Dataflash page index */
 				Dataflash_SelectChipFromPage(CurrDFPage);
 
+				/* Switch to the buffer this Dataflash IC is not programming from to maintain throughput */
+				UsingSecondBuffer = !(SecondBufferChips & Dataflash_GetSelectedChip());
+
 #if (DATAFLASH_PAGE_SIZE > VIRTUAL_MEMORY_BLOCK_SIZE)
 				/* If less than one Dataflash page remaining, copy over the existing page to preserve trailing data */
 				if ((TotalBlocks * (VIRTUAL_MEMORY_BLOCK_SIZE >> 4)) < (DATAFLASH_PAGE_SIZE >> 4))
@@ -375,11 +233,11 @@ void DataflashManager_WriteBlocks_RAM(const uint32_t BlockAddress,
 		TotalBlocks--;
 	}
 
-	/* Write the Dataflash buffer contents back to the Dataflash page */
+	/* Write the Dataflash buffer contents back to the Dataflash page, leaving the program running in the background */
 	Dataflash_WaitWhileBusy();
 	Dataflash_SendByte(UsingSecondBuffer ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
 	Dataflash_SendAddressBytes(CurrDFPage, 0x00);
-	Dataflash_WaitWhileBusy();
+	DataflashManager_RecordProgramBuffer(UsingSecondBuffer);
 
 	/* Deselect all Dataflash chips */
 	Dataflash_DeselectChip();
@@ -394,7 +252,7 @@ void DataflashManager_WriteBlocks_RAM(const uint32_t BlockAddress,
  *  \param[in] TotalBlocks   Number of blocks of data to read
  *  \param[out] BufferPtr    Pointer to the data destination RAM buffer
  */
-void DataflashManager_ReadBlocks_RAM(const uint32_t BlockAddress,
+void DataflashManager_ReadBlocks_RAM(const MS_BlockAddress_t BlockAddress,
                                      uint16_t TotalBlocks,
                                      uint8_t* BufferPtr)
 {
@@ -405,6 +263,9 @@ void DataflashManager_ReadBlocks_RAM(const uint32_t BlockAddress,
 	/* Select the correct starting Dataflash IC for the block requested */
 	Dataflash_SelectChipFromPage(CurrDFPage);
 
+	/* Wait for any page program left running by a previous write to complete */
+	Dataflash_WaitWhileBusy();
+
 	/* Send the Dataflash main memory page read command */
 	Dataflash_SendByte(DF_CMD_MAINMEMPAGEREAD);
 	Dataflash_SendAddressBytes(CurrDFPage, CurrDFPageByte);
@@ -429,6 +290,7 @@ void DataflashManager_ReadBlocks_RAM(const uint32_t BlockAddress,
 
 				/* Select the next Dataflash chip based on the new Dataflash page index */
 				Dataflash_SelectChipFromPage(CurrDFPage);
+				Dataflash_WaitWhileBusy();
 
 				/* Send the Dataflash main memory page read command */
 				Dataflash_SendByte(DF_CMD_MAINMEMPAGEREAD);
@@ -458,6 +320,18 @@ void DataflashManager_ReadBlocks_RAM(const uint32_t BlockAddress,
 	Dataflash_DeselectChip();
 }
 
+/** Records which SRAM buffer the selected Dataflash IC has started programming a page from.
+ *
+ *  \param[in] UsingSecondBuffer  Boolean \c true if the program was started from the second buffer
+ */
+static void DataflashManager_RecordProgramBuffer(const bool UsingSecondBuffer)
+{
+	if (UsingSecondBuffer)
+	  SecondBufferChips |=  Dataflash_GetSelectedChip();
+	else
+	  SecondBufferChips &= ~Dataflash_GetSelectedChip();
+}
+
 /** Disables the Dataflash memory write protection bits on the board Dataflash ICs, if enabled. */
 void DataflashManager_ResetDataflashProtections(void)
 {
@@ -69,21 +69,37 @@
 		/** Blocks in each LUN, calculated from the total capacity divided by the total number of Logical Units in the device. */
 		#define LUN_MEDIA_BLOCKS                    (VIRTUAL_MEMORY_BLOCKS / TOTAL_LUNS)
 
+	/* External Variables: */
+		extern const MS_BlockDevice_t DataflashManager_BlockDevice;
+
 	/* Function Prototypes: */
-		void DataflashManager_WriteBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
-		                                  const uint32_t BlockAddress,
-		                                  uint16_t TotalBlocks);
-		void DataflashManager_ReadBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
-		                                 const uint32_t BlockAddress,
-		                                 uint16_t TotalBlocks);
-		void DataflashManager_WriteBlocks_RAM(const uint32_t BlockAddress,
+		void DataflashManager_WriteBlocks_RAM(const MS_BlockAddress_t BlockAddress,
 		                                      uint16_t TotalBlocks,
-		                                      uint8_t* BufferPtr) ATTR_NON_NULL_PTR_ARG(3);
-		void DataflashManager_ReadBlocks_RAM(const uint32_t BlockAddress,
+		                                      const uint8_t* BufferPtr) ATTR_NON_NULL_PTR_ARG(3);
+		void DataflashManager_ReadBlocks_RAM(const MS_BlockAddress_t BlockAddress,
 		                                     uint16_t TotalBlocks,
 		                                     uint8_t* BufferPtr) ATTR_NON_NULL_PTR_ARG(3);
 		void DataflashManager_ResetDataflashProtections(void);
 		bool DataflashManager_CheckDataflashOperation(void);
 
+		#if defined(INCLUDE_FROM_DATAFLASHMANAGER_C)
+			static bool DataflashManager_StartRead(const MS_BlockDevice_t* const BlockDevice,
+			                                       const MS_BlockAddress_t BlockAddress,
+			                                       const uint16_t TotalBlocks,
+			                                       void* const Buffer,
+			                                       const MS_BlockDevice_Callback_t Callback,
+			                                       void* const Context);
+			static bool DataflashManager_StartWrite(const MS_BlockDevice_t* const BlockDevice,
+			                                        const MS_BlockAddress_t BlockAddress,
+			                                        const uint16_t TotalBlocks,
+			                                        const void* const Buffer,
+			                                        const MS_BlockDevice_Callback_t Callback,
+			                                        void* const Context);
+			static bool DataflashManager_StartFlush(const MS_BlockDevice_t* const BlockDevice,
+			                                        const MS_BlockDevice_Callback_t Callback,
+			                                        void* const Context);
+			static void DataflashManager_RecordProgramBuffer(const bool UsingSecondBuffer);
+		#endif
+
 #endif
 
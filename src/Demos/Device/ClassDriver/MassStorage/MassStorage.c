@@ -36,6 +36,34 @@
 
 #include "MassStorage.h"
 
+/** Data phase buffer of the Mass Storage interface, holding one block being exchanged with the host while
+ *  another is read from or written to the Dataflash.
+ */
+static uint8_t DiskDataBuffer[2 * VIRTUAL_MEMORY_BLOCK_SIZE];
+
+/** Line descriptors of the Dataflash block cache. */
+static MS_BlockCache_Line_t DiskCacheLines[DISK_CACHE_SETS * DISK_CACHE_WAYS];
+
+/** Block data held by the lines of the Dataflash block cache. */
+static uint8_t DiskCacheData[DISK_CACHE_SETS * DISK_CACHE_WAYS * VIRTUAL_MEMORY_BLOCK_SIZE];
+
+/** Write-back cache in front of the Dataflash, which absorbs the repeated rewrites of the FAT and directory
+ *  sectors by the host so that each reaches the Dataflash once per flush rather than once per update.
+ */
+MS_Device_BlockCache_t Disk_BlockCache =
+	{
+		.Config =
+			{
+				.BlockDevice               = &DataflashManager_BlockDevice,
+				.Lines                     = DiskCacheLines,
+				.LineData                  = DiskCacheData,
+				.TotalSets                 = DISK_CACHE_SETS,
+				.Ways                      = DISK_CACHE_WAYS,
+				.MaxCachedWrite            = DISK_CACHE_MAX_WRITE_BLOCKS,
+				.AbortFlag                 = &Disk_MS_Interface.State.IsMassStoreReset,
+			},
+	};
+
 /** LUFA Mass Storage Class driver interface configuration and state information. This structure is
  *  passed to all Mass Storage Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -58,6 +86,8 @@ USB_ClassInfo_MS_Device_t Disk_MS_Interface =
 						.Banks             = 1,
 					},
 				.TotalLUNs                 = TOTAL_LUNS,
+				.DataBuffer                = DiskDataBuffer,
+				.DataBufferSize            = sizeof(DiskDataBuffer),
 			},
 	};
 
@@ -115,6 +145,12 @@ void SetupHardware(void)
 
 	/* Clear Dataflash sector protections, if enabled */
 	DataflashManager_ResetDataflashProtections();
+
+	/* Start with an empty block cache in front of the Dataflash */
+	MS_Device_InitBlockCache(&Disk_BlockCache);
+
+	/* Divide the cached Dataflash between the disk's logical units */
+	SCSI_Init();
 }
 
 /** Event handler for the library USB Connection event. */
@@ -69,6 +69,10 @@
 		/** LED mask for the library LED driver, to indicate that the USB interface is busy. */
 		#define LEDMASK_USB_BUSY          LEDS_LED2
 
+	/* External Variables: */
+		extern MS_Device_BlockCache_t    Disk_BlockCache;
+		extern USB_ClassInfo_MS_Device_t Disk_MS_Interface;
+
 	/* Function Prototypes: */
 		void SetupHardware(void);
 
@@ -0,0 +1,173 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Internet checksum routines, shared by the IP, ICMP and TCP protocol handlers. Checksums are accumulated as
+ *  a 32-bit partial sum so that the carries out of each 16-bit addition need not be folded back in until the
+ *  sum is complete, allowing a packet to be summed in several pieces - or while it is being copied - before
+ *  \ref Checksum_Fold() produces the final header value.
+ */
+
+#include "Checksum.h"
+
+/** Adds a block of data to a partial Internet checksum. Blocks may be added in any number of calls, however as
+ *  the checksum is calculated over 16-bit words, all blocks except the last must be an even number of bytes long.
+ *
+ *  \param[in] Sum    Partial checksum to add the block to, or zero to start a new checksum
+ *  \param[in] Data   Pointer to the start of the block to add
+ *  \param[in] Bytes  Number of bytes in the block
+ *
+ *  \return Partial checksum including the given block, to be completed with \ref Checksum_Fold()
+ */
+uint32_t Checksum_Add(uint32_t Sum,
+                      const void* Data,
+                      uint16_t Bytes)
+{
+	const uint16_t* Words = (const uint16_t*)Data;
+
+	/* Fold any carries already in the sum, so that a full size block cannot overflow the accumulator */
+	Sum = ((Sum & 0xFFFF) + (Sum >> 16));
+
+	/* Sum four words per iteration to reduce the loop overhead, the bulk of a packet being its payload */
+	for (uint16_t WordBlocks = (Bytes >> 3); WordBlocks > 0; WordBlocks--)
+	{
+		Sum += Words[0];
+		Sum += Words[1];
+		Sum += Words[2];
+		Sum += Words[3];
+
+		Words += 4;
+	}
+
+	for (uint8_t RemainingWords = ((Bytes >> 1) & 0x03); RemainingWords > 0; RemainingWords--)
+	  Sum += *(Words++);
+
+	/* A trailing odd byte is summed as if padded with a zero byte to a complete word */
+	if (Bytes & 0x01)
+	{
+		union
+		{
+			uint8_t  Bytes[2];
+			uint16_t Word;
+		} LastWord = {.Bytes = {*((const uint8_t*)Words), 0}};
+
+		Sum += LastWord.Word;
+	}
+
+	return Sum;
+}
+
+/** Copies a block of data, adding it to a partial Internet checksum as it is copied. This avoids reading the block
+ *  a second time to checksum it once it has been placed into an outgoing packet. As with \ref Checksum_Add(), all
+ *  blocks except the last of a checksum must be an even number of bytes long.
+ *
+ *  \param[in]  Sum          Partial checksum to add the block to, or zero to start a new checksum
+ *  \param[out] Destination  Pointer to the location the block is to be copied to
+ *  \param[in]  Source       Pointer to the start of the block to copy
+ *  \param[in]  Bytes        Number of bytes in the block
+ *
+ *  \return Partial checksum including the given block, to be completed with \ref Checksum_Fold()
+ */
+uint32_t Checksum_Copy(uint32_t Sum,
+                       void* Destination,
+                       const void* Source,
+                       uint16_t Bytes)
+{
+	uint16_t*       DestWords   = (uint16_t*)Destination;
+	const uint16_t* SourceWords = (const uint16_t*)Source;
+
+	Sum = ((Sum & 0xFFFF) + (Sum >> 16));
+
+	for (uint16_t WordBlocks = (Bytes >> 3); WordBlocks > 0; WordBlocks--)
+	{
+		uint16_t Word;
+
+		Word = SourceWords[0]; DestWords[0] = Word; Sum += Word;
+		Word = SourceWords[1]; DestWords[1] = Word; Sum += Word;
+		Word = SourceWords[2]; DestWords[2] = Word; Sum += Word;
+		Word = SourceWords[3]; DestWords[3] = Word; Sum += Word;
+
+		SourceWords += 4;
+		DestWords   += 4;
+	}
+
+	for (uint8_t RemainingWords = ((Bytes >> 1) & 0x03); RemainingWords > 0; RemainingWords--)
+	{
+		uint16_t Word = *(SourceWords++);
+
+		*(DestWords++) = Word;
+		Sum += Word;
+	}
+
+	if (Bytes & 0x01)
+	{
+		*((uint8_t*)DestWords) = *((const uint8_t*)SourceWords);
+
+		/* Copied byte is summed by the normal odd length rules, the data already being in place */
+		Sum = Checksum_Add(Sum, SourceWords, 1);
+	}
+
+	return Sum;
+}
+
+/** Updates a complete Internet checksum after a single 16-bit word of the checksummed data has been changed,
+ *  without summing the rest of the data again, as given by equation 3 of RFC 1624. The old and new words must be
+ *  given in the same byte order as the data, i.e. as read directly from the packet.
+ *
+ *  \param[in] Checksum  Existing checksum value, as stored in the packet header
+ *  \param[in] OldWord   Value of the changed word before it was modified
+ *  \param[in] NewWord   Value of the changed word after it was modified
+ *
+ *  \return Updated 16-bit Internet checksum value
+ */
+uint16_t Checksum_Update16(const uint16_t Checksum,
+                           const uint16_t OldWord,
+                           const uint16_t NewWord)
+{
+	uint32_t Sum = ((uint16_t)~Checksum + (uint32_t)(uint16_t)~OldWord + NewWord);
+
+	return Checksum_Fold(Sum);
+}
+
+/** Calculates the complete Internet checksum of a block of data, consisting of the one's complement of the one's
+ *  complement sum of each 16-bit word in the block.
+ *
+ *  \param[in] Data   Pointer to the block whose checksum must be calculated
+ *  \param[in] Bytes  Number of bytes in the block, which may be odd
+ *
+ *  \return A 16-bit Internet checksum value
+ */
+uint16_t Checksum_Calculate16(const void* Data,
+                              uint16_t Bytes)
+{
+	return Checksum_Fold(Checksum_Add(0, Data, Bytes));
+}
+
@@ -62,8 +62,8 @@ void Ethernet_ProcessPacket(Ethernet_Frame_Info_t* const FrameIN,
 	DecodeEthernetFrameHeader(FrameIN->FrameData);
 
 	/* Cast the incoming Ethernet frame to the Ethernet header type */
-	Ethernet_Frame_Header_t* FrameINHeader  = (Ethernet_Frame_Header_t*)&FrameIN->FrameData;
-	Ethernet_Frame_Header_t* FrameOUTHeader = (Ethernet_Frame_Header_t*)&FrameOUT->FrameData;
+	Ethernet_Frame_Header_t* FrameINHeader  = (Ethernet_Frame_Header_t*)FrameIN->FrameData;
+	Ethernet_Frame_Header_t* FrameOUTHeader = (Ethernet_Frame_Header_t*)FrameOUT->FrameData;
 
 	int16_t                  RetSize        = NO_RESPONSE;
 
@@ -107,26 +107,3 @@ void Ethernet_ProcessPacket(Ethernet_Frame_Info_t* const FrameIN,
 	}
 }
 
-/** Calculates the appropriate ethernet checksum, consisting of the addition of the one's
- *  compliment of each word, complimented.
- *
- *  \param[in] Data   Pointer to the packet buffer data whose checksum must be calculated
- *  \param[in] Bytes  Number of bytes in the data buffer to process
- *
- *  \return A 16-bit Ethernet checksum value
- */
-uint16_t Ethernet_Checksum16(void* Data,
-                             uint16_t Bytes)
-{
-	uint16_t* Words    = (uint16_t*)Data;
-	uint32_t  Checksum = 0;
-
-	for (uint16_t CurrWord = 0; CurrWord < (Bytes >> 1); CurrWord++)
-	  Checksum += Words[CurrWord];
-
-	while (Checksum & 0xFFFF0000)
-	  Checksum = ((Checksum & 0xFFFF) + (Checksum >> 16));
-
-	return ~Checksum;
-}
-
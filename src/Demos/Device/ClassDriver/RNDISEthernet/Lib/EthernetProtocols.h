@@ -78,7 +78,7 @@
 		/** Type define for an Ethernet frame buffer data and information structure. */
 		typedef struct
 		{
-			uint8_t  FrameData[ETHERNET_FRAME_SIZE_MAX]; /**< Ethernet frame contents. */
+			uint8_t* FrameData; /**< Ethernet frame contents, in a buffer of at least \ref ETHERNET_FRAME_SIZE_MAX bytes. */
 			uint16_t FrameLength; /**< Length in bytes of the Ethernet frame stored in the buffer. */
 		} Ethernet_Frame_Info_t;
 
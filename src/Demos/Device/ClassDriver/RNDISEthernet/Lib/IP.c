@@ -105,7 +105,7 @@ int16_t IP_ProcessIPPacket(Ethernet_Frame_Info_t* const FrameIN,
 		IPHeaderOUT->SourceAddress      = IPHeaderIN->DestinationAddress;
 		IPHeaderOUT->DestinationAddress = IPHeaderIN->SourceAddress;
 
-		IPHeaderOUT->HeaderChecksum     = Ethernet_Checksum16(IPHeaderOUT, sizeof(IP_Header_t));
+		IPHeaderOUT->HeaderChecksum     = Checksum_Calculate16(IPHeaderOUT, sizeof(IP_Header_t));
 
 		/* Return the size of the response so far */
 		return (sizeof(IP_Header_t) + RetSize);
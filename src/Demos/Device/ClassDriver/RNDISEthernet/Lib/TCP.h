@@ -48,8 +48,13 @@
 		/** Maximum number of TCP ports which can be open at the one time. */
 		#define MAX_OPEN_TCP_PORTS              1
 
-		/** Maximum number of TCP connections which can be sustained at the one time. */
-		#define MAX_TCP_CONNECTIONS             3
+		/** Number of buckets in the TCP connection hash table, which must be a power of two. Keeping this at least as large as
+		 *  \c MAX_TCP_CONNECTIONS keeps the chain of connections searched in each bucket short.
+		 */
+		#define TCP_CONNECTION_HASH_BUCKETS     8
+
+		/** Connection state table index indicating the end of a hash table bucket's chain of connections. */
+		#define TCP_CONNECTION_NONE             0xFF
 
 		/** TCP window size, giving the maximum number of bytes which can be buffered at the one time. */
 		#define TCP_WINDOW_SIZE                 512
@@ -145,6 +150,11 @@
 		 */
 		#define TCP_APP_CLOSECONNECTION(Connection)  MACROS{ Connection->State = TCP_Connection_Closing;  }MACROE
 
+	/* Preprocessor Checks: */
+		#if (MAX_TCP_CONNECTIONS >= TCP_CONNECTION_NONE)
+			#error MAX_TCP_CONNECTIONS must be less than 255.
+		#endif
+
 	/* Enums: */
 		/** Enum for possible TCP port states. */
 		enum TCP_PortStates_t
@@ -165,7 +175,7 @@
 			TCP_Connection_CloseWait   = 6, /**< Closing, waiting for ACK */
 			TCP_Connection_Closing     = 7, /**< Unused */
 			TCP_Connection_LastACK     = 8, /**< Unused */
-			TCP_Connection_TimeWait    = 9, /**< Unused */
+			TCP_Connection_TimeWait    = 9, /**< Closed, kept to acknowledge a retransmitted FIN until the entry is reused */
 			TCP_Connection_Closed      = 10, /**< Connection closed in both directions */
 		};
 
@@ -198,6 +208,10 @@
 			IP_Address_t           RemoteAddress; /**< Connection protocol IP address of the host */
 			TCP_ConnectionInfo_t   Info; /**< Connection information, including application buffer */
 			uint8_t                State; /**< Current connection state, a value from the \ref TCP_ConnectionStates_t enum */
+			uint8_t                NextInBucket; /**< Table index of the next connection in the same hash table bucket, or
+			                                      *   \ref TCP_CONNECTION_NONE if this is the last
+			                                      */
+			uint16_t               LastActivity; /**< Packet count at which a packet was last processed for the connection */
 		} TCP_ConnectionState_t;
 
 		/** Type define for a TCP port state. */
@@ -228,32 +242,43 @@
 		} TCP_Header_t;
 
 	/* Function Prototypes: */
-		void                  TCP_TCPTask(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
-		                                  Ethernet_Frame_Info_t* const FrameOUT);
-		void                  TCP_Init(void);
-		bool                  TCP_SetPortState(const uint16_t Port,
-		                                       const uint8_t State,
-		                                       void (*Handler)(TCP_ConnectionState_t*, TCP_ConnectionBuffer_t*));
-		uint8_t               TCP_GetPortState(const uint16_t Port);
-		bool                  TCP_SetConnectionState(const uint16_t Port,
-		                                             const IP_Address_t* RemoteAddress,
-		                                             const uint16_t RemotePort,
-		                                             const uint8_t State);
-		uint8_t               TCP_GetConnectionState(const uint16_t Port,
+		void                   TCP_TCPTask(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+		                                   Ethernet_Frame_Info_t* const FrameOUT);
+		void                   TCP_Init(void);
+		bool                   TCP_SetPortState(const uint16_t Port,
+		                                        const uint8_t State,
+		                                        void (*Handler)(TCP_ConnectionState_t*, TCP_ConnectionBuffer_t*));
+		uint8_t                TCP_GetPortState(const uint16_t Port);
+		bool                   TCP_SetConnectionState(const uint16_t Port,
+		                                              const IP_Address_t* RemoteAddress,
+		                                              const uint16_t RemotePort,
+		                                              const uint8_t State);
+		uint8_t                TCP_GetConnectionState(const uint16_t Port,
+		                                              const IP_Address_t* RemoteAddress,
+		                                              const uint16_t RemotePort);
+		TCP_ConnectionInfo_t*  TCP_GetConnectionInfo(const uint16_t Port,
 		                                             const IP_Address_t* RemoteAddress,
 		                                             const uint16_t RemotePort);
-		TCP_ConnectionInfo_t* TCP_GetConnectionInfo(const uint16_t Port,
+		TCP_ConnectionState_t* TCP_FindConnection(const uint16_t Port,
+		                                          const IP_Address_t* RemoteAddress,
+		                                          const uint16_t RemotePort);
+		TCP_ConnectionState_t* TCP_CreateConnection(const uint16_t Port,
 		                                            const IP_Address_t* RemoteAddress,
 		                                            const uint16_t RemotePort);
-		int16_t               TCP_ProcessTCPPacket(void* IPHeaderInStart,
-		                                           void* TCPHeaderInStart,
-		                                           void* TCPHeaderOutStart);
+		int16_t                TCP_ProcessTCPPacket(void* IPHeaderInStart,
+		                                            void* TCPHeaderInStart,
+		                                            void* TCPHeaderOutStart);
 
 		#if defined(INCLUDE_FROM_TCP_C)
+			static uint8_t  TCP_HashConnection(const uint16_t Port,
+			                                   const IP_Address_t* RemoteAddress,
+			                                   const uint16_t RemotePort);
+			static void     TCP_UnlinkConnection(const uint8_t CSTableEntry);
 			static uint16_t TCP_Checksum16(void* TCPHeaderOutStart,
 			                               const IP_Address_t* SourceAddress,
 			                               const IP_Address_t* DestinationAddress,
-			                               uint16_t TCPOutSize);
+			                               uint16_t TCPOutSize,
+			                               uint32_t DataChecksum);
 		#endif
 
 #endif
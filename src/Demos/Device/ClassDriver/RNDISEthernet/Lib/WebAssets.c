@@ -0,0 +1,299 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Web asset bundle, holding the contents of the web root directory as pre-encoded assets in FLASH memory.
+ *
+ *  This file was generated by http_asset_packer.py and should not be edited directly. Modify the files in the
+ *  web root directory instead, and regenerate the bundle from them.
+ */
+
+#include "WebAssets.h"
+
+/** Seed of the path hash function, chosen so that no two asset paths hash to the same slot. */
+#define WEB_ASSETS_HASH_SEED        0x0000
+
+/** Number of slots in the asset hash table, a power of two. */
+#define WEB_ASSETS_HASH_SLOTS       1
+
+/** Value of an asset hash table slot which does not hold an asset. */
+#define WEB_ASSETS_EMPTY_SLOT       0xFF
+
+/** Accept-Encoding header element which does not refer to the gzip content coding. */
+#define WEB_ASSETS_CODING_NONE      0
+
+/** Accept-Encoding header element which names the gzip content coding. */
+#define WEB_ASSETS_CODING_NAMED     1
+
+/** Accept-Encoding header element which refers to the gzip content coding through the "*" wildcard. */
+#define WEB_ASSETS_CODING_WILDCARD  2
+
+/* Asset 0: index.htm (471 bytes, encoded to 300 bytes) */
+static const char    PROGMEM Asset0Path[]    = "index.htm";
+static const char    PROGMEM Asset0Headers[] = "Content-Type: text/html\r\nContent-Encoding: gzip\r\nVary: Accept-Encoding\r\nContent-Length: 300\r\nETag: \"7c21e371b23c358c\"\r\n";
+static const char    PROGMEM Asset0ETag[]    = "\"7c21e371b23c358c\"";
+static const uint8_t PROGMEM Asset0Data[]    =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x91, 0xCD, 0x6E, 0xC2, 0x30,
+		0x10, 0x84, 0xCF, 0xF4, 0x29, 0x16, 0xCE, 0x34, 0x16, 0x57, 0xE4, 0x46, 0x6A, 0x8B, 0x2A, 0x90,
+		0xAA, 0x2A, 0x82, 0xD0, 0x9E, 0x37, 0xC4, 0xC1, 0x69, 0x1D, 0x6F, 0xB4, 0x59, 0x88, 0x78, 0xFB,
+		0x3A, 0x06, 0x4A, 0x7B, 0xE8, 0xC5, 0x3F, 0xF2, 0xCC, 0x7C, 0xB6, 0x47, 0x5B, 0x69, 0x5C, 0x7A,
+		0x37, 0xD2, 0xD6, 0x60, 0x19, 0xE6, 0x91, 0x96, 0x5A, 0x9C, 0x19, 0x56, 0xA3, 0xD7, 0xED, 0xCB,
+		0x23, 0x7C, 0x98, 0xA2, 0x33, 0x7C, 0x34, 0x0C, 0x0B, 0xD3, 0xD0, 0x20, 0x50, 0x57, 0x85, 0x56,
+		0x17, 0x93, 0x2E, 0xA8, 0x3C, 0x45, 0xB3, 0x9D, 0xA5, 0x4B, 0xE3, 0x1C, 0x41, 0xC5, 0xD4, 0xC0,
+		0x89, 0x0E, 0x0C, 0xDB, 0xCD, 0x13, 0x3C, 0xBE, 0xAF, 0xC7, 0x41, 0x3D, 0x8B, 0x9A, 0x36, 0x86,
+		0x47, 0xD9, 0x38, 0xC4, 0xBB, 0x1D, 0x35, 0x06, 0x84, 0x40, 0xAC, 0x81, 0x88, 0x5C, 0xBF, 0x2D,
+		0x56, 0x9B, 0x88, 0xFB, 0x45, 0x17, 0xD3, 0x09, 0xB4, 0xB8, 0x37, 0x53, 0xE0, 0x83, 0xF7, 0xB5,
+		0xDF, 0x03, 0xF9, 0x3F, 0x04, 0x38, 0xD6, 0x78, 0x0B, 0x71, 0x75, 0xC1, 0xC8, 0xA7, 0x04, 0x72,
+		0x5B, 0x77, 0x50, 0x86, 0x30, 0xDF, 0x09, 0x63, 0x88, 0x89, 0x9A, 0x65, 0x9E, 0x67, 0xD0, 0x5F,
+		0xD3, 0xA7, 0x90, 0x3F, 0x67, 0x6A, 0x95, 0x41, 0x27, 0xB8, 0xFB, 0x02, 0xF4, 0xE5, 0xE5, 0x12,
+		0x83, 0x0F, 0xD0, 0xB9, 0x1F, 0x26, 0x0A, 0xB5, 0x37, 0xC8, 0x40, 0x8E, 0x96, 0x64, 0x78, 0x92,
+		0x2E, 0x18, 0x54, 0x7A, 0x1E, 0xE3, 0xBE, 0x6B, 0x82, 0x35, 0xCD, 0x98, 0x3E, 0xCD, 0x4E, 0x60,
+		0xE5, 0x2B, 0xE2, 0x06, 0xA5, 0x26, 0x3F, 0x07, 0x8D, 0x60, 0xD9, 0x54, 0x0F, 0x13, 0x2B, 0xD2,
+		0xCE, 0x95, 0xEA, 0xFB, 0x3E, 0x71, 0x87, 0x0A, 0xEF, 0xC3, 0xBD, 0x13, 0xE2, 0xFD, 0x24, 0xFD,
+		0xE7, 0x40, 0x2B, 0x4C, 0x13, 0xAD, 0xCE, 0xD1, 0xB1, 0x8E, 0x36, 0x56, 0x71, 0xAE, 0x20, 0x7C,
+		0x72, 0xEC, 0xF3, 0x1B, 0x93, 0x34, 0x88, 0x92, 0xD7, 0x01, 0x00, 0x00,
+	};
+
+/** Table of the assets stored in the bundle. */
+static const WebAsset_t PROGMEM AssetTable[WEB_ASSETS_TOTAL_ASSETS] =
+	{
+		{.Path = Asset0Path, .Headers = Asset0Headers, .ETag = Asset0ETag, .Data = Asset0Data, .Length = 300, .IsGzipEncoded = true},
+	};
+
+/** Perfect hash table of asset indexes, indexed by the hash of each asset's path. */
+static const uint8_t PROGMEM AssetHashTable[WEB_ASSETS_HASH_SLOTS] =
+	{
+		0,
+	};
+
+
+/** Hashes the given path to locate its slot in the asset hash table.
+ *
+ *  \param[in] Path        Path to hash
+ *  \param[in] PathLength  Length of the path in characters
+ *
+ *  \return Hash of the given path
+ */
+static uint16_t WebAssets_HashPath(const char* Path,
+                                   uint8_t PathLength)
+{
+	uint16_t Hash = WEB_ASSETS_HASH_SEED;
+
+	while (PathLength--)
+	  Hash = (((Hash << 5) + Hash) ^ (uint8_t)*(Path++));
+
+	return Hash;
+}
+
+/** Compares a string in RAM of the given length against a null terminated string stored in FLASH memory.
+ *
+ *  \param[in] String        String in RAM to compare, which need not be null terminated
+ *  \param[in] StringLength  Length of the string in RAM in characters
+ *  \param[in] FlashString   Null terminated string in FLASH to compare against
+ *
+ *  \return Boolean \c true if the two strings are identical, \c false otherwise
+ */
+static bool WebAssets_CompareString(const char* String,
+                                    uint8_t StringLength,
+                                    const char* FlashString)
+{
+	while (StringLength--)
+	{
+		if ((uint8_t)*(String++) != pgm_read_byte(FlashString++))
+		  return false;
+	}
+
+	return (pgm_read_byte(FlashString) == '\0');
+}
+
+/** Locates the asset stored under the given path in the bundle.
+ *
+ *  \param[in]  Path        Path of the asset relative to the web root without a leading '/', need not be null terminated
+ *  \param[in]  PathLength  Length of the path in characters
+ *  \param[out] Asset       Pointer to a location where the located asset's information is to be stored
+ *
+ *  \return Boolean \c true if the asset was found, \c false otherwise
+ */
+bool WebAssets_Find(const char* Path,
+                    const uint8_t PathLength,
+                    WebAsset_t* const Asset)
+{
+	uint8_t AssetIndex = pgm_read_byte(&AssetHashTable[WebAssets_HashPath(Path, PathLength) & (WEB_ASSETS_HASH_SLOTS - 1)]);
+
+	if (AssetIndex == WEB_ASSETS_EMPTY_SLOT)
+	  return false;
+
+	memcpy_P(Asset, &AssetTable[AssetIndex], sizeof(WebAsset_t));
+
+	/* Each slot holds the only asset that hashes to it, confirm that it is the one requested */
+	return WebAssets_CompareString(Path, PathLength, Asset->Path);
+}
+
+/** Determines if an entity tag supplied by the client, such as in a HTTP If-None-Match request header, matches the
+ *  current contents of an asset.
+ *
+ *  \param[in] Asset       Pointer to the asset to compare against
+ *  \param[in] ETag        Quoted entity tag supplied by the client, need not be null terminated
+ *  \param[in] ETagLength  Length of the entity tag in characters
+ *
+ *  \return Boolean \c true if the client's copy of the asset is current, \c false otherwise
+ */
+bool WebAssets_MatchETag(const WebAsset_t* const Asset,
+                         const char* ETag,
+                         const uint8_t ETagLength)
+{
+	return WebAssets_CompareString(ETag, ETagLength, Asset->ETag);
+}
+
+/** Determines if an element of a HTTP Accept-Encoding request header refers to the gzip content coding, either by name or
+ *  through the "*" wildcard, and if so whether it accepts the coding, i.e. does not give it a quality value of zero.
+ *
+ *  \param[in]  Element        Element of the header's comma separated list, need not be null terminated
+ *  \param[in]  ElementLength  Length of the element in characters
+ *  \param[out] IsAccepted     Set to \c true if the element's quality value is non-zero, when the element refers to gzip
+ *
+ *  \return One of the \c WEB_ASSETS_CODING_* values, giving how the element refers to the gzip coding
+ */
+static uint8_t WebAssets_MatchGzipCoding(const char* Element,
+                                         const uint8_t ElementLength,
+                                         bool* const IsAccepted)
+{
+	uint8_t Match;
+	uint8_t Start = 0;
+	uint8_t End;
+
+	while ((Start < ElementLength) && ((Element[Start] == ' ') || (Element[Start] == '\t')))
+	  Start++;
+
+	End = Start;
+
+	/* Coding name runs to the start of its parameters or the whitespace following it */
+	while ((End < ElementLength) && (Element[End] != ';') && (Element[End] != ' ') && (Element[End] != '\t'))
+	  End++;
+
+	if ((((End - Start) == 4) && (strncasecmp(&Element[Start], "gzip", 4) == 0)) ||
+	    (((End - Start) == 6) && (strncasecmp(&Element[Start], "x-gzip", 6) == 0)))
+	{
+		Match = WEB_ASSETS_CODING_NAMED;
+	}
+	else if (((End - Start) == 1) && (Element[Start] == '*'))
+	{
+		Match = WEB_ASSETS_CODING_WILDCARD;
+	}
+	else
+	{
+		return WEB_ASSETS_CODING_NONE;
+	}
+
+	*IsAccepted = true;
+
+	/* Search the coding's parameters for a quality value, which rejects the coding if it is zero */
+	for (uint8_t i = End; i < ElementLength; i++)
+	{
+		if (Element[i] != ';')
+		  continue;
+
+		while (((i + 1) < ElementLength) && ((Element[i + 1] == ' ') || (Element[i + 1] == '\t')))
+		  i++;
+
+		if (((i + 3) > ElementLength) || ((Element[i + 1] != 'q') && (Element[i + 1] != 'Q')) || (Element[i + 2] != '='))
+		  continue;
+
+		i += 3;
+
+		if ((i == ElementLength) || (Element[i] != '0'))
+		  break;
+
+		/* Any non-zero digit after the leading zero gives a non-zero quality value */
+		while ((++i < ElementLength) && ((Element[i] == '0') || (Element[i] == '.')));
+
+		*IsAccepted = ((i < ElementLength) && (Element[i] >= '1') && (Element[i] <= '9'));
+		break;
+	}
+
+	return Match;
+}
+
+/** Determines if an asset may be sent to a client, given the contents of the HTTP Accept-Encoding header of its request.
+ *  Assets which are stored gzip encoded may only be sent to clients which accept that coding; a client which does not
+ *  send the header is assumed to accept only uncompressed content.
+ *
+ *  \param[in] Asset                 Pointer to the asset to be sent
+ *  \param[in] AcceptEncoding        Value of the client's Accept-Encoding header, or \c NULL if the request has none
+ *  \param[in] AcceptEncodingLength  Length of the header value in characters
+ *
+ *  \return Boolean \c true if the asset may be sent to the client, \c false otherwise
+ */
+bool WebAssets_IsEncodingAccepted(const WebAsset_t* const Asset,
+                                  const char* AcceptEncoding,
+                                  uint8_t AcceptEncodingLength)
+{
+	bool IsNamed            = false;
+	bool IsNamedAccepted    = false;
+	bool IsWildcardAccepted = false;
+
+	if (!(Asset->IsGzipEncoded))
+	  return true;
+
+	if (AcceptEncoding == NULL)
+	  return false;
+
+	/* Every element of the header's comma separated list is checked, as naming gzip overrides the "*" wildcard */
+	while (AcceptEncodingLength)
+	{
+		uint8_t ElementLength = 0;
+		bool    IsAccepted    = false;
+
+		while ((ElementLength < AcceptEncodingLength) && (AcceptEncoding[ElementLength] != ','))
+		  ElementLength++;
+
+		switch (WebAssets_MatchGzipCoding(AcceptEncoding, ElementLength, &IsAccepted))
+		{
+			case WEB_ASSETS_CODING_NAMED:
+				IsNamed          = true;
+				IsNamedAccepted |= IsAccepted;
+				break;
+			case WEB_ASSETS_CODING_WILDCARD:
+				IsWildcardAccepted |= IsAccepted;
+				break;
+		}
+
+		if (ElementLength < AcceptEncodingLength)
+		  ElementLength++;
+
+		AcceptEncoding       += ElementLength;
+		AcceptEncodingLength -= ElementLength;
+	}
+
+	return (IsNamed ? IsNamedAccepted : IsWildcardAccepted);
+}
+
@@ -31,18 +31,24 @@
 /** \file
  *
  *  Simple webserver application for demonstrating the RNDIS demo and TCP/IP stack. This
- *  application will serve up a static HTTP web page when requested by the host.
+ *  application will serve up static HTTP web pages from the web asset bundle when requested by the host.
  */
 
 #include "Webserver.h"
 
 /** HTTP server response header, for transmission before the page contents. This indicates to the host that a page exists at the
- *  given location, and gives extra connection information.
+ *  given location, and gives extra connection information. The requested asset's own headers follow it.
  */
 const char HTTP200Header[] PROGMEM = "HTTP/1.1 200 OK\r\n"
                                      "Server: LUFA RNDIS\r\n"
-                                     "Content-type: text/html\r\n"
-                                     "Connection: close\r\n\r\n";
+                                     "Connection: close\r\n";
+
+/** HTTP server response header, for transmission when the host's cached copy of the requested page is current. The
+ *  requested asset's entity tag follows it.
+ */
+const char HTTP304Header[] PROGMEM = "HTTP/1.1 304 Not Modified\r\n"
+                                     "Server: LUFA RNDIS\r\n"
+                                     "Connection: close\r\n";
 
 /** HTTP server response header, for transmission before a resource not found error. This indicates to the host that the given
  *  given URL is invalid, and gives extra error information.
@@ -51,27 +57,16 @@ const char HTTP404Header[] PROGMEM = "HTTP/1.1 404 Not Found\r\n"
                                      "Server: LUFA RNDIS\r\n"
                                      "Connection: close\r\n\r\n";
 
-/** HTTP page to serve to the host when a HTTP request is made. This page is too long for a single response, thus it is automatically
- *  broken up into smaller blocks and sent as a series of packets each time the webserver application callback is run.
+/** HTTP server response header, for transmission when the requested page is stored compressed but the host does not accept
+ *  compressed content. This indicates to the host that the page cannot be sent in an encoding it accepts.
  */
-const char HTTPPage[] PROGMEM =
-		"<html>"
-		"	<head>"
-		"		<title>"
-		"			LUFA Webserver Demo"
-		"		</title>"
-		"	</head>"
-		"	<body>"
-		"		<h1>Hello from your USB AVR!</h1>"
-		"		<p>"
-		"			Hello! Welcome to the LUFA RNDIS Demo Webserver test page, running on your USB AVR via the LUFA library. This demonstrates the HTTP webserver, TCP/IP stack and RNDIS demo all running atop the LUFA USB stack."
-		"			<br /><br />"
-		"			<small>Project Information: <a href=\"http://www.lufa-lib.org\">http://www.lufa-lib.org</a>.</small>"
-		"			<hr />"
-		"			<i>LUFA Version: </i>" LUFA_VERSION_STRING
-		"		</p>"
-		"	</body>"
-		"</html>";
+const char HTTP406Header[] PROGMEM = "HTTP/1.1 406 Not Acceptable\r\n"
+                                     "Server: LUFA RNDIS\r\n"
+                                     "Vary: Accept-Encoding\r\n"
+                                     "Connection: close\r\n\r\n";
+
+/** Default filename to fetch when the root directory is requested. */
+const char DefaultDirFileName[] PROGMEM = "index.htm";
 
 
 /** Initializes the Webserver application, opening the appropriate HTTP port in the TCP handler and registering the application
@@ -97,8 +92,87 @@ static bool IsHTTPCommand(uint8_t* RequestHeader,
 	return (strncmp((char*)RequestHeader, Command, strlen(Command)) == 0);
 }
 
+/** Locates the path of the resource requested by the host, following the HTTP command at the start of the request.
+ *
+ *  \param[in]  Buffer      Pointer to the application's buffer holding the received request
+ *  \param[out] PathLength  Length of the requested path in characters
+ *
+ *  \return Pointer to the requested path within the buffer without its leading '/', or \c NULL if no path was found
+ */
+static char* GetRequestedPath(TCP_ConnectionBuffer_t* const Buffer,
+                              uint8_t* const PathLength)
+{
+	char* RequestEnd = (char*)&Buffer->Data[Buffer->Length];
+	char* Path       = memchr(Buffer->Data, ' ', Buffer->Length);
+
+	/* Path must follow the command, and must be an absolute path */
+	if ((Path == NULL) || (++Path == RequestEnd) || (*(Path++) != '/'))
+	  return NULL;
+
+	*PathLength = 0;
+
+	/* Path ends at the start of the query string or at the space before the HTTP version */
+	while (((Path + *PathLength) != RequestEnd) && (Path[*PathLength] != ' ') && (Path[*PathLength] != '?'))
+	{
+		if (++(*PathLength) == 0)
+		  return NULL;
+	}
+
+	return Path;
+}
+
+/** Locates the value of a header line in the request received from the host. This is kept identical to the
+ *  \c HTTPServerApp_GetRequestHeader() function of the Webserver project.
+ *
+ *  \param[in]  Request        Pointer to the received request
+ *  \param[in]  RequestLength  Length of the received request in bytes
+ *  \param[in]  HeaderName     Name of the header to locate, including the trailing ':' separator
+ *  \param[out] ValueLength    Length of the header value in characters
+ *
+ *  \return Pointer to the header value within the request, or \c NULL if the request does not contain the header
+ */
+static char* GetRequestHeader(char* const Request,
+                              const uint16_t RequestLength,
+                              const char* HeaderName,
+                              uint8_t* const ValueLength)
+{
+	char*   Line             = Request;
+	char*   RequestEnd       = &Request[RequestLength];
+	uint8_t HeaderNameLength = strlen(HeaderName);
+
+	/* Skip over the request line, then search each header line in turn */
+	while ((Line = memchr(Line, '\n', (RequestEnd - Line))) != NULL)
+	{
+		Line++;
+
+		if (((RequestEnd - Line) < HeaderNameLength) || (strncasecmp(Line, HeaderName, HeaderNameLength) != 0))
+		  continue;
+
+		char* Value = &Line[HeaderNameLength];
+
+		while ((Value != RequestEnd) && ((*Value == ' ') || (*Value == '\t')))
+		  Value++;
+
+		*ValueLength = 0;
+
+		/* Value runs to the end of the header line, omitting any trailing whitespace */
+		while (((Value + *ValueLength) != RequestEnd) && (Value[*ValueLength] != '\r') && (Value[*ValueLength] != '\n'))
+		{
+			if (++(*ValueLength) == 0)
+			  return NULL;
+		}
+
+		while (*ValueLength && ((Value[*ValueLength - 1] == ' ') || (Value[*ValueLength - 1] == '\t')))
+		  (*ValueLength)--;
+
+		return Value;
+	}
+
+	return NULL;
+}
+
 /** Application callback routine, executed each time the TCP processing task runs. This callback determines what request
- *  has been made (if any), and serves up appropriate responses.
+ *  has been made (if any), and serves up appropriate responses from the web asset bundle.
  *
  *  \param[in] ConnectionState  Pointer to a TCP Connection State structure giving connection information
  *  \param[in,out] Buffer       Pointer to the application's send/receive packet buffer
@@ -106,31 +180,52 @@ static bool IsHTTPCommand(uint8_t* RequestHeader,
 void Webserver_ApplicationCallback(TCP_ConnectionState_t* const ConnectionState,
                                    TCP_ConnectionBuffer_t* const Buffer)
 {
-	char*          BufferDataStr = (char*)Buffer->Data;
-	static uint8_t PageBlock     = 0;
+	char*             BufferDataStr = (char*)Buffer->Data;
+	static WebAsset_t CurrentAsset;
+	static uint16_t   AssetOffset   = 0;
 
 	/* Check to see if a packet has been received on the HTTP port from a remote host */
 	if (TCP_APP_HAS_RECEIVED_PACKET(Buffer))
 	{
-		if (IsHTTPCommand(Buffer->Data, "GET"))
+		if (IsHTTPCommand(Buffer->Data, "GET") || IsHTTPCommand(Buffer->Data, "HEAD"))
 		{
-			if (IsHTTPCommand(Buffer->Data, "GET / "))
+			bool    SendContents = IsHTTPCommand(Buffer->Data, "GET");
+			char    DefaultPath[sizeof(DefaultDirFileName)];
+			uint8_t PathLength;
+			uint8_t ETagLength;
+			uint8_t AcceptEncodingLength;
+
+			char* Path           = GetRequestedPath(Buffer, &PathLength);
+			char* ETag           = GetRequestHeader(BufferDataStr, Buffer->Length, "If-None-Match:", &ETagLength);
+			char* AcceptEncoding = GetRequestHeader(BufferDataStr, Buffer->Length, "Accept-Encoding:", &AcceptEncodingLength);
+
+			/* If the root directory is requested, serve the default file */
+			if ((Path != NULL) && !(PathLength))
 			{
-				PageBlock = 0;
+				strcpy_P(DefaultPath, DefaultDirFileName);
 
-				/* Copy the HTTP 200 response header into the packet buffer */
-				strcpy_P(BufferDataStr, HTTP200Header);
+				Path       = DefaultPath;
+				PathLength = strlen(DefaultPath);
+			}
+
+			if ((Path == NULL) || !(WebAssets_Find(Path, PathLength, &CurrentAsset)))
+			{
+				/* Copy the HTTP 404 response header into the packet buffer */
+				strcpy_P(BufferDataStr, HTTP404Header);
 
 				/* Send the buffer contents to the host */
 				TCP_APP_SEND_BUFFER(Buffer, strlen(BufferDataStr));
 
-				/* Lock the buffer to Device->Host transmissions only while we send the page contents */
-				TCP_APP_CAPTURE_BUFFER(Buffer);
+				/* All data sent, close the connection */
+				TCP_APP_CLOSECONNECTION(ConnectionState);
 			}
-			else
+			else if ((ETag != NULL) && WebAssets_MatchETag(&CurrentAsset, ETag, ETagLength))
 			{
-				/* Copy the HTTP 404 response header into the packet buffer */
-				strcpy_P(BufferDataStr, HTTP404Header);
+				/* Host already holds the current page, copy over the HTTP 304 response header and the page's entity tag */
+				strcpy_P(BufferDataStr, HTTP304Header);
+				strcat_P(BufferDataStr, PSTR("ETag: "));
+				strcat_P(BufferDataStr, CurrentAsset.ETag);
+				strcat_P(BufferDataStr, PSTR("\r\n\r\n"));
 
 				/* Send the buffer contents to the host */
 				TCP_APP_SEND_BUFFER(Buffer, strlen(BufferDataStr));
@@ -138,28 +233,40 @@ void Webserver_ApplicationCallback(TCP_ConnectionState_t* const ConnectionState,
 				/* All data sent, close the connection */
 				TCP_APP_CLOSECONNECTION(ConnectionState);
 			}
-		}
-		else if (IsHTTPCommand(Buffer->Data, "HEAD"))
-		{
-			if (IsHTTPCommand(Buffer->Data, "HEAD / "))
+			else if (!(WebAssets_IsEncodingAccepted(&CurrentAsset, AcceptEncoding, AcceptEncodingLength)))
 			{
-				/* Copy the HTTP response header into the packet buffer */
-				strcpy_P(BufferDataStr, HTTP200Header);
+				/* Copy the HTTP 406 response header into the packet buffer */
+				strcpy_P(BufferDataStr, HTTP406Header);
 
 				/* Send the buffer contents to the host */
 				TCP_APP_SEND_BUFFER(Buffer, strlen(BufferDataStr));
+
+				/* All data sent, close the connection */
+				TCP_APP_CLOSECONNECTION(ConnectionState);
 			}
 			else
 			{
-				/* Copy the HTTP response header into the packet buffer */
-				strcpy_P(BufferDataStr, HTTP404Header);
+				/* Copy the HTTP 200 response header and the page's precomputed headers into the packet buffer */
+				strcpy_P(BufferDataStr, HTTP200Header);
+				strcat_P(BufferDataStr, CurrentAsset.Headers);
+				strcat_P(BufferDataStr, PSTR("\r\n"));
 
 				/* Send the buffer contents to the host */
 				TCP_APP_SEND_BUFFER(Buffer, strlen(BufferDataStr));
-			}
 
-			/* All data sent, close the connection */
-			TCP_APP_CLOSECONNECTION(ConnectionState);
+				if (SendContents)
+				{
+					AssetOffset = 0;
+
+					/* Lock the buffer to Device->Host transmissions only while we send the page contents */
+					TCP_APP_CAPTURE_BUFFER(Buffer);
+				}
+				else
+				{
+					/* All data sent, close the connection */
+					TCP_APP_CLOSECONNECTION(ConnectionState);
+				}
+			}
 		}
 		else if (IsHTTPCommand(Buffer->Data, "TRACE"))
 		{
@@ -177,20 +284,21 @@ void Webserver_ApplicationCallback(TCP_ConnectionState_t* const ConnectionState,
 	}
 	else if (TCP_APP_HAVE_CAPTURED_BUFFER(Buffer))
 	{
-		uint16_t RemLength = strlen_P(&HTTPPage[PageBlock * HTTP_REPLY_BLOCK_SIZE]);
+		uint16_t RemLength = (CurrentAsset.Length - AssetOffset);
 		uint16_t Length;
 
 		/* Determine the length of the loaded block */
 		Length = ((RemLength > HTTP_REPLY_BLOCK_SIZE) ? HTTP_REPLY_BLOCK_SIZE : RemLength);
 
 		/* Copy the next buffer sized block of the page to the packet buffer */
-		strncpy_P(BufferDataStr, &HTTPPage[PageBlock * HTTP_REPLY_BLOCK_SIZE], Length);
+		memcpy_P(Buffer->Data, &CurrentAsset.Data[AssetOffset], Length);
+		AssetOffset += Length;
 
 		/* Send the buffer contents to the host */
 		TCP_APP_SEND_BUFFER(Buffer, Length);
 
 		/* Check to see if the entire page has been sent */
-		if (PageBlock++ == (sizeof(HTTPPage) / HTTP_REPLY_BLOCK_SIZE))
+		if (AssetOffset == CurrentAsset.Length)
 		{
 			/* Unlock the buffer so that the host can fill it with future packets */
 			TCP_APP_RELEASE_BUFFER(Buffer);
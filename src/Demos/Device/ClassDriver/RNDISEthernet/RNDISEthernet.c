@@ -36,6 +36,9 @@
 
 #include "RNDISEthernet.h"
 
+/** Receive pool of the RNDIS interface, into which frames from the host are received and then processed in place. */
+static uint8_t RxFrameBuffers[RX_FRAME_BUFFERS][RNDIS_DEVICE_RX_BUFFER_SIZE] ATTR_ALIGNED(4);
+
 /** LUFA RNDIS Class driver interface configuration and state information. This structure is
  *  passed to all RNDIS Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -65,14 +68,19 @@ USB_ClassInfo_RNDIS_Device_t Ethernet_RNDIS_Interface =
 					},
 				.AdapterVendorDescription       = "LUFA RNDIS Demo Adapter",
 				.AdapterMACAddress              = {ADAPTER_MAC_ADDRESS},
+				.RxFrameBuffers                 = RxFrameBuffers,
+				.TotalRxFrameBuffers            = RX_FRAME_BUFFERS,
 			},
 	};
 
-/** Global to store the incoming frame from the host before it is processed by the device. */
+/** Global to store the location of the incoming frame from the host in the receive pool while it is processed by the device. */
 static Ethernet_Frame_Info_t FrameIN;
 
+/** Buffer holding the outgoing frame created in the device before it is sent to the host. */
+static uint8_t FrameOUTData[ETHERNET_FRAME_SIZE_MAX];
+
 /** Global to store the outgoing frame created in the device before it is sent to the host. */
-static Ethernet_Frame_Info_t FrameOUT;
+static Ethernet_Frame_Info_t FrameOUT = {.FrameData = FrameOUTData};
 
 /** Main program entry point. This routine contains the overall program flow, including initial
  *  setup of all components and the main program loop.
@@ -89,16 +97,17 @@ int main(void)
 
 	for (;;)
 	{
-		if (RNDIS_Device_IsPacketReceived(&Ethernet_RNDIS_Interface))
+		if (RNDIS_Device_GetReceivedFrame(&Ethernet_RNDIS_Interface, &FrameIN.FrameData, &FrameIN.FrameLength))
 		{
 			LEDs_SetAllLEDs(LEDMASK_USB_BUSY);
 
-			RNDIS_Device_ReadPacket(&Ethernet_RNDIS_Interface, &FrameIN.FrameData, &FrameIN.FrameLength);
+			/* The frame is processed where it was received, and its pool buffer handed back once the response is built */
 			Ethernet_ProcessPacket(&FrameIN, &FrameOUT);
+			RNDIS_Device_ReleaseFrame(&Ethernet_RNDIS_Interface);
 
 			if (FrameOUT.FrameLength)
 			{
-				RNDIS_Device_SendPacket(&Ethernet_RNDIS_Interface, &FrameOUT.FrameData, FrameOUT.FrameLength);
+				RNDIS_Device_SendPacket(&Ethernet_RNDIS_Interface, FrameOUT.FrameData, FrameOUT.FrameLength);
 				FrameOUT.FrameLength = 0;
 			}
 
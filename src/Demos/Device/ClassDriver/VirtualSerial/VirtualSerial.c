@@ -63,6 +63,7 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 						.Size             = CDC_NOTIFICATION_EPSIZE,
 						.Banks            = 1,
 					},
+				.LatencyTimerMS           = 1,
 			},
 	};
 
@@ -149,7 +150,8 @@ void CheckJoystickMovement(void)
 	{
 		ActionSent = true;
 
-		/* Write the string to the virtual COM port via the created character stream */
+		/* Write the string to the virtual COM port via the created character stream, the CDC class driver's
+		 * latency timer sends it within a millisecond as one packet rather than one packet per character */
 		fputs(ReportString, &USBSerialStream);
 
 		/* Alternatively, without the stream: */
@@ -176,6 +178,8 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 
 	ConfigSuccess &= CDC_Device_ConfigureEndpoints(&VirtualSerial_CDC_Interface);
 
+	USB_Device_EnableSOFEvents();
+
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
 }
 
@@ -185,3 +189,9 @@ void EVENT_USB_Device_ControlRequest(void)
 	CDC_Device_ProcessControlRequest(&VirtualSerial_CDC_Interface);
 }
 
+/** Event handler for the USB device Start Of Frame event. */
+void EVENT_USB_Device_StartOfFrame(void)
+{
+	CDC_Device_MillisecondElapsed(&VirtualSerial_CDC_Interface);
+}
+
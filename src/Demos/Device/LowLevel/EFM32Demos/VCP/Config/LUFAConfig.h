@@ -125,6 +125,11 @@
 		/* General USB Driver Related Tokens: */
 		#define USE_STATIC_OPTIONS               (USB_DEVICE_OPT_FULLSPEED)
 //		#define USB_STREAM_TIMEOUT_MS            {Insert Value Here}
+//		#define USB_ENDPOINT_RAM_SIZE            {Insert Value Here}
+//		#define USB_BULK_ENDPOINT_BANKS          {Insert Value Here}
+//		#define USB_ENDPOINT_EVENT_QUEUE_SIZE    {Insert Value Here}
+//		#define USB_PIPE_RAM_SIZE                {Insert Value Here}
+//		#define USB_HOST_ONLY
 
 		/* USB Device Mode Driver Related Tokens: */
 		#define USE_FLASH_DESCRIPTORS
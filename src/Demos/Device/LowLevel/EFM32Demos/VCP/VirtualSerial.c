@@ -36,6 +36,10 @@
 
 #include "VirtualSerial.h"
 #include "em_usart.h"
+#include "em_emu.h"
+#if defined(VCOM_BRIDGE)
+#include "em_dma.h"
+#endif
 
 extern void setupSWOForPrint(void);
 #define SYSTICKHZ             1000
@@ -78,6 +82,44 @@ uint8_t EndpointDescriptors[] __attribute__((aligned(4))) = {
 };
 
 volatile uint32_t msTicks; /* counts 1ms timeTicks */
+
+/** Milliseconds for which echoed data has been waiting in the bulk IN bank, advanced from the SOF interrupt. */
+static volatile uint8_t LatencyTimerElapsedMS;
+
+#if defined(VCOM_BRIDGE)
+/** Marker for a receive buffer slot which holds no buffer. */
+#define BRIDGE_NO_BUFFER      0xFF
+
+/** DMA controller descriptor table. With up to 16 channels the primary and alternate descriptors take
+ *  16 entries each, and the table must be aligned to its own size.
+ */
+static DMA_DESCRIPTOR_TypeDef DMA_ControlBlock[16 * 2] __attribute__((aligned(512)));
+
+/** UART receive buffers, filled by the DMA controller and sent to the host as bulk IN transfers. */
+static uint8_t  BridgeRxBuffers[VCOM_BRIDGE_RX_BUFFERS][VCOM_BRIDGE_RX_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint16_t BridgeRxLength[VCOM_BRIDGE_RX_BUFFERS];
+static uint8_t  BridgeRxQueue[VCOM_BRIDGE_RX_BUFFERS]; /* filled buffers waiting for the host, oldest first */
+static uint8_t  BridgeRxQueueTail;
+static uint8_t  BridgeRxQueued;
+static uint8_t  BridgeRxFree;                          /* mask of buffers owned by neither the DMA nor USB */
+static uint8_t  BridgeRxSlot[2];                       /* buffers in the primary and alternate descriptors */
+static uint8_t  BridgeRxFillSlot;                      /* descriptor currently being filled */
+static uint8_t  BridgeRxSending = BRIDGE_NO_BUFFER;
+static bool     BridgeRxRunning;
+static uint16_t BridgeRxLastCount;
+static uint8_t  BridgeRxIdleTicks;
+
+/** USB OUT buffers, filled by bulk OUT transfers and sent out of the UART by the DMA controller. */
+static uint8_t  BridgeTxBuffers[2][VCOM_BRIDGE_TX_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint16_t BridgeTxLength[2];
+static uint8_t  BridgeTxState[2];
+
+static DMA_CB_TypeDef BridgeRxCallback;
+static DMA_CB_TypeDef BridgeTxCallback;
+
+static void Bridge_RxTimeout(void);
+#endif
+
 /**************************************************************************//**
  * @brief SysTick_Handler
  * Interrupt Service Routine for system tick counter
@@ -86,6 +128,10 @@ void SysTick_Handler(void)
 {
 	INT_Disable();
 	msTicks++;       /* increment counter necessary in Delay()*/
+
+#if defined(VCOM_BRIDGE)
+	Bridge_RxTimeout();
+#endif
 	INT_Enable();
 }
 
@@ -117,8 +163,11 @@ int main(void)
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 	for (;;) {
+#if defined(VCOM_BRIDGE)
+		VCOM_Bridge();
+#else
 		VCOM_Echo();
-		// VCOM_Bridge();
+#endif
 	}
 }
 
@@ -126,6 +175,12 @@ int main(void)
 static void UartConfiguration(CDC_LineEncoding_t *LineCoding)
 {
 	uint32_t frame = 0;
+	uint32_t refFreq;
+	USART_OVS_TypeDef ovs;
+
+	if (!(LineCoding->BaudRateBPS))
+		return;
+
 	switch (LineCoding->DataBits) {
 	case 5:
 		frame |= UART_FRAME_DATABITS_FIVE;
@@ -173,11 +228,346 @@ static void UartConfiguration(CDC_LineEncoding_t *LineCoding)
 	default:
 		return;
 	}
+
+	/* Use the highest oversampling which can still reach the baud rate, so that rates of
+	   921600 and above remain available from the peripheral clock */
+	refFreq = CMU_ClockFreqGet(cmuClock_HFPER);
+
+	if (LineCoding->BaudRateBPS <= (refFreq / 16))
+		ovs = usartOVS16;
+	else if (LineCoding->BaudRateBPS <= (refFreq / 8))
+		ovs = usartOVS8;
+	else if (LineCoding->BaudRateBPS <= (refFreq / 6))
+		ovs = usartOVS6;
+	else
+		ovs = usartOVS4;
+
     /* Program new UART baudrate etc. */
     UART_PORT->FRAME = frame;
-    USART_BaudrateAsyncSet(UART_PORT, 0, LineCoding->BaudRateBPS, usartOVS16);
+    USART_BaudrateAsyncSet(UART_PORT, refFreq, LineCoding->BaudRateBPS, ovs);
+}
+
+#if defined(VCOM_BRIDGE)
+static int Bridge_INComplete(USB_Status_TypeDef Status, uint32_t Transferred, uint32_t Remaining);
+static int Bridge_OUTComplete(USB_Status_TypeDef Status, uint32_t Transferred, uint32_t Remaining);
+
+/** Takes a free UART receive buffer, returning \ref BRIDGE_NO_BUFFER if all are in use. */
+static uint8_t Bridge_RxAlloc(void)
+{
+	uint8_t Index;
+
+	for (Index = 0; Index < VCOM_BRIDGE_RX_BUFFERS; Index++) {
+		if (BridgeRxFree & (1 << Index)) {
+			BridgeRxFree &= ~(1 << Index);
+			return Index;
+		}
+	}
+
+	return BRIDGE_NO_BUFFER;
+}
+
+/** Number of bytes the DMA controller has stored in the receive buffer currently being filled. */
+static uint16_t Bridge_RxFillCount(void)
+{
+	DMA_DESCRIPTOR_TypeDef *Descr = (DMA_DESCRIPTOR_TypeDef *)(uintptr_t)(BridgeRxFillSlot ? DMA->ALTCTRLBASE : DMA->CTRLBASE);
+	uint32_t Ctrl = Descr[VCOM_BRIDGE_DMA_RX].CTRL;
+
+	/* A finished descriptor is invalidated by the controller, its count is left at zero */
+	if ((Ctrl & _DMA_CTRL_CYCLE_CTRL_MASK) == DMA_CTRL_CYCLE_CTRL_INVALID)
+		return VCOM_BRIDGE_RX_BUFFER_SIZE;
+
+	return (VCOM_BRIDGE_RX_BUFFER_SIZE - 1) - ((Ctrl & _DMA_CTRL_N_MINUS_1_MASK) >> _DMA_CTRL_N_MINUS_1_SHIFT);
+}
+
+/** Adds a filled receive buffer to the queue of buffers waiting to be sent to the host. */
+static void Bridge_RxQueueBuffer(const uint8_t Index, const uint16_t Length)
+{
+	BridgeRxLength[Index] = Length;
+	BridgeRxQueue[(BridgeRxQueueTail + BridgeRxQueued++) % VCOM_BRIDGE_RX_BUFFERS] = Index;
+}
+
+/** Sends the oldest filled receive buffer to the host, unless an IN transfer is already in progress. */
+static void Bridge_SendToHost(void)
+{
+	uint8_t Index;
+
+	if ((BridgeRxSending != BRIDGE_NO_BUFFER) || !(BridgeRxQueued) ||
+	    (USB_DeviceState != DEVICE_STATE_Configured))
+		return;
+
+	Index = BridgeRxQueue[BridgeRxQueueTail];
+
+	if (Endpoint_StartTransfer(CDC_TX_EPADDR, BridgeRxBuffers[Index], BridgeRxLength[Index],
+	                           Bridge_INComplete) != ENDPOINT_XFER_NoError)
+		return;
+
+	BridgeRxSending   = Index;
+	BridgeRxQueueTail = (BridgeRxQueueTail + 1) % VCOM_BRIDGE_RX_BUFFERS;
+	BridgeRxQueued--;
+}
+
+/** Starts UART reception into a fresh pair of receive buffers, if it is stopped and two buffers are free. */
+static void Bridge_RxStart(void)
+{
+	uint8_t Primary;
+	uint8_t Alternate;
+
+	if (BridgeRxRunning)
+		return;
+
+	Primary   = Bridge_RxAlloc();
+	Alternate = Bridge_RxAlloc();
+
+	if (Alternate == BRIDGE_NO_BUFFER) {
+		if (Primary != BRIDGE_NO_BUFFER)
+			BridgeRxFree |= (1 << Primary);
+
+		return;
+	}
+
+	BridgeRxSlot[0]   = Primary;
+	BridgeRxSlot[1]   = Alternate;
+	BridgeRxFillSlot  = 0;
+	BridgeRxLastCount = 0;
+	BridgeRxIdleTicks = 0;
+	BridgeRxRunning   = true;
+
+	DMA_ActivatePingPong(VCOM_BRIDGE_DMA_RX, false,
+	                     BridgeRxBuffers[Primary], (void *)&UART_PORT->RXDATA, VCOM_BRIDGE_RX_BUFFER_SIZE - 1,
+	                     BridgeRxBuffers[Alternate], (void *)&UART_PORT->RXDATA, VCOM_BRIDGE_RX_BUFFER_SIZE - 1);
+}
+
+/** DMA callback for a filled receive buffer. The controller has already moved on to the other descriptor,
+ *  so the finished one is refreshed with a free buffer while the filled one is queued for the host.
+ */
+static void Bridge_RxComplete(unsigned int Channel, bool Primary, void *User)
+{
+	uint8_t Slot = (Primary ? 0 : 1);
+
+	INT_Disable();
+
+	Bridge_RxQueueBuffer(BridgeRxSlot[Slot], VCOM_BRIDGE_RX_BUFFER_SIZE);
+	BridgeRxSlot[Slot] = BRIDGE_NO_BUFFER;
+	BridgeRxFillSlot   = !(Slot);
+	BridgeRxLastCount  = 0;
+	BridgeRxIdleTicks  = 0;
+
+	if (BridgeRxSlot[!(Slot)] == BRIDGE_NO_BUFFER) {
+		/* The other descriptor could not be refreshed earlier, so the channel has now stopped */
+		BridgeRxRunning = false;
+		Bridge_RxStart();
+	} else if ((BridgeRxSlot[Slot] = Bridge_RxAlloc()) != BRIDGE_NO_BUFFER) {
+		DMA_RefreshPingPong(VCOM_BRIDGE_DMA_RX, Primary, false, BridgeRxBuffers[BridgeRxSlot[Slot]],
+		                    NULL, VCOM_BRIDGE_RX_BUFFER_SIZE - 1, false);
+	}
+
+	/* With no free buffer the host is not keeping up, and reception stops once the other buffer fills.
+	 * It is restarted as soon as the host has taken a buffer. */
+	Bridge_SendToHost();
+
+	INT_Enable();
+}
+
+/** Hands the partially filled receive buffer to the host, once the UART line has been idle for
+ *  \ref VCOM_BRIDGE_RX_TIMEOUT_MS. Called every millisecond from the SysTick interrupt.
+ */
+static void Bridge_RxTimeout(void)
+{
+	uint8_t  Slot = BridgeRxFillSlot;
+	uint16_t Count;
+
+	if (!(BridgeRxRunning))
+		return;
+
+	Count = Bridge_RxFillCount();
+
+	if (Count != BridgeRxLastCount) {
+		BridgeRxLastCount = Count;
+		BridgeRxIdleTicks = 0;
+		return;
+	}
+
+	if (!(Count) || (Count == VCOM_BRIDGE_RX_BUFFER_SIZE) || (++BridgeRxIdleTicks < VCOM_BRIDGE_RX_TIMEOUT_MS))
+		return;
+
+	DMA_ChannelEnable(VCOM_BRIDGE_DMA_RX, false);
+
+	/* The buffer may have been completed just before the channel stopped, leave it to the DMA callback */
+	if (DMA->IF & (1 << VCOM_BRIDGE_DMA_RX)) {
+		DMA_ChannelEnable(VCOM_BRIDGE_DMA_RX, true);
+		return;
+	}
+
+	/* Data arriving meanwhile waits in the UART receive buffer until reception is restarted */
+	Bridge_RxQueueBuffer(BridgeRxSlot[Slot], Bridge_RxFillCount());
+
+	if (BridgeRxSlot[!(Slot)] != BRIDGE_NO_BUFFER)
+		BridgeRxFree |= (1 << BridgeRxSlot[!(Slot)]);
+
+	BridgeRxRunning = false;
+	Bridge_RxStart();
+	Bridge_SendToHost();
+}
+
+/** USB callback for a finished bulk IN transfer, releasing its receive buffer and sending the next one. */
+static int Bridge_INComplete(USB_Status_TypeDef Status, uint32_t Transferred, uint32_t Remaining)
+{
+	INT_Disable();
+
+	BridgeRxFree   |= (1 << BridgeRxSending);
+	BridgeRxSending = BRIDGE_NO_BUFFER;
+
+	Bridge_RxStart();
+
+	/* Data of an aborted transfer is lost, sending resumes once the host configures the device again */
+	if (Status == USB_STATUS_OK)
+		Bridge_SendToHost();
+
+	INT_Enable();
+	return USB_STATUS_OK;
+}
+
+/** Finds the USB OUT buffer in the given state, returning \ref BRIDGE_NO_BUFFER if there is none. */
+static uint8_t Bridge_TxFind(const uint8_t State)
+{
+	uint8_t Index;
+
+	for (Index = 0; Index < 2; Index++) {
+		if (BridgeTxState[Index] == State)
+			return Index;
+	}
+
+	return BRIDGE_NO_BUFFER;
+}
+
+/** Starts a bulk OUT transfer into a free USB OUT buffer, unless one is already in progress. With neither
+ *  buffer free, the endpoint NAKs the host until the UART has drained one.
+ */
+static void Bridge_ArmOUT(void)
+{
+	uint8_t Index;
+
+	if ((USB_DeviceState != DEVICE_STATE_Configured) || (Bridge_TxFind(BRIDGE_BUFFER_USB) != BRIDGE_NO_BUFFER))
+		return;
+
+	if ((Index = Bridge_TxFind(BRIDGE_BUFFER_Free)) == BRIDGE_NO_BUFFER)
+		return;
+
+	if (Endpoint_StartTransfer(CDC_RX_EPADDR, BridgeTxBuffers[Index], VCOM_BRIDGE_TX_BUFFER_SIZE,
+	                           Bridge_OUTComplete) == ENDPOINT_XFER_NoError)
+		BridgeTxState[Index] = BRIDGE_BUFFER_USB;
+}
+
+/** Starts sending a pending USB OUT buffer out of the UART, unless one is already being sent. */
+static void Bridge_UARTSend(void)
+{
+	uint8_t Index;
+
+	if ((Bridge_TxFind(BRIDGE_BUFFER_UART) != BRIDGE_NO_BUFFER) ||
+	    ((Index = Bridge_TxFind(BRIDGE_BUFFER_Pending)) == BRIDGE_NO_BUFFER))
+		return;
+
+	BridgeTxState[Index] = BRIDGE_BUFFER_UART;
+	DMA_ActivateBasic(VCOM_BRIDGE_DMA_TX, true, false, (void *)&UART_PORT->TXDATA,
+	                  BridgeTxBuffers[Index], BridgeTxLength[Index] - 1);
+}
+
+/** USB callback for a finished bulk OUT transfer, passing its data on to the UART. */
+static int Bridge_OUTComplete(USB_Status_TypeDef Status, uint32_t Transferred, uint32_t Remaining)
+{
+	uint8_t Index;
+
+	INT_Disable();
+
+	if ((Index = Bridge_TxFind(BRIDGE_BUFFER_USB)) != BRIDGE_NO_BUFFER) {
+		if ((Status == USB_STATUS_OK) && Transferred) {
+			BridgeTxLength[Index] = Transferred;
+			BridgeTxState[Index]  = BRIDGE_BUFFER_Pending;
+		} else {
+			BridgeTxState[Index]  = BRIDGE_BUFFER_Free;
+		}
+	}
+
+	Bridge_UARTSend();
+	Bridge_ArmOUT();
+
+	INT_Enable();
+	return USB_STATUS_OK;
 }
 
+/** DMA callback for a USB OUT buffer which has been written to the UART, freeing it for the host. */
+static void Bridge_TxComplete(unsigned int Channel, bool Primary, void *User)
+{
+	uint8_t Index;
+
+	INT_Disable();
+
+	if ((Index = Bridge_TxFind(BRIDGE_BUFFER_UART)) != BRIDGE_NO_BUFFER)
+		BridgeTxState[Index] = BRIDGE_BUFFER_Free;
+
+	Bridge_UARTSend();
+	Bridge_ArmOUT();
+
+	INT_Enable();
+}
+
+/** Configures the DMA controller channels used by the bridge. */
+static void Bridge_Init(void)
+{
+	DMA_Init_TypeDef       DMAInit;
+	DMA_CfgChannel_TypeDef ChannelConfig;
+	DMA_CfgDescr_TypeDef   DescrConfig;
+
+	BridgeRxFree = ((1 << VCOM_BRIDGE_RX_BUFFERS) - 1);
+
+	DMAInit.hprot        = 0;
+	DMAInit.controlBlock = DMA_ControlBlock;
+	DMA_Init(&DMAInit);
+
+	/* Reception is given priority, as a late request loses UART data */
+	BridgeRxCallback.cbFunc  = Bridge_RxComplete;
+	BridgeRxCallback.userPtr = NULL;
+
+	ChannelConfig.highPri   = true;
+	ChannelConfig.enableInt = true;
+	ChannelConfig.select    = UART_DMAREQ_RX;
+	ChannelConfig.cb        = &BridgeRxCallback;
+	DMA_CfgChannel(VCOM_BRIDGE_DMA_RX, &ChannelConfig);
+
+	DescrConfig.dstInc  = dmaDataInc1;
+	DescrConfig.srcInc  = dmaDataIncNone;
+	DescrConfig.size    = dmaDataSize1;
+	DescrConfig.arbRate = dmaArbitrate1;
+	DescrConfig.hprot   = 0;
+	DMA_CfgDescr(VCOM_BRIDGE_DMA_RX, true, &DescrConfig);
+	DMA_CfgDescr(VCOM_BRIDGE_DMA_RX, false, &DescrConfig);
+
+	BridgeTxCallback.cbFunc  = Bridge_TxComplete;
+	BridgeTxCallback.userPtr = NULL;
+
+	ChannelConfig.highPri   = false;
+	ChannelConfig.select    = UART_DMAREQ_TX;
+	ChannelConfig.cb        = &BridgeTxCallback;
+	DMA_CfgChannel(VCOM_BRIDGE_DMA_TX, &ChannelConfig);
+
+	DescrConfig.dstInc  = dmaDataIncNone;
+	DescrConfig.srcInc  = dmaDataInc1;
+	DMA_CfgDescr(VCOM_BRIDGE_DMA_TX, true, &DescrConfig);
+
+	/* The UART is received from whether or not the host is connected */
+	Bridge_RxStart();
+}
+
+/** Hands both bulk data endpoints over to the bridge, once the host has configured the device. */
+static void Bridge_Start(void)
+{
+	INT_Disable();
+	Bridge_ArmOUT();
+	Bridge_RxStart();
+	Bridge_SendToHost();
+	INT_Enable();
+}
+#endif
 
 /** Configures the board hardware and chip peripherals for the demo's functionality. */
 void SetupHardware(void)
@@ -205,7 +595,14 @@ void SetupHardware(void)
 	LEDs_Init();
 	SerialPortInit();
 
-	USB_Init(EndpointDescriptors);
+#if defined(VCOM_BRIDGE)
+	CMU_ClockEnable(cmuClock_DMA, true);
+	Bridge_Init();
+#endif
+
+	/* Endpoint table does not fit the USB RAM pool or FIFOs, see USB_Endpoint_Layout.Error */
+	if (!(USB_Init(EndpointDescriptors)))
+	  LEDs_SetAllLEDs(LEDMASK_USB_ERROR);
 }
 
 /** Event handler for the USB_Connect event. This indicates that the device is enumerating via the status LEDs and
@@ -235,8 +632,8 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 
 	/* Setup CDC Data Endpoints */
 	ConfigSuccess &= Endpoint_ConfigureEndpoint(CDC_NOTIFICATION_EPADDR, EP_TYPE_INTERRUPT, CDC_NOTIFICATION_EPSIZE, 1);
-	ConfigSuccess &= Endpoint_ConfigureEndpoint(CDC_TX_EPADDR, EP_TYPE_BULK, CDC_TXRX_EPSIZE, 1);
-	ConfigSuccess &= Endpoint_ConfigureEndpoint(CDC_RX_EPADDR, EP_TYPE_BULK,  CDC_TXRX_EPSIZE, 1);
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(CDC_TX_EPADDR, EP_TYPE_BULK, CDC_TXRX_EPSIZE, 2);
+	ConfigSuccess &= Endpoint_ConfigureEndpoint(CDC_RX_EPADDR, EP_TYPE_BULK,  CDC_TXRX_EPSIZE, 2);
 
 	/* Reset line encoding baud rate so that the host knows to send new values */
 	LineEncoding.BaudRateBPS = 0;
@@ -244,12 +641,29 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 	/* Indicate endpoint configuration success or failure */
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
 
+	/* Start of frame events run the bulk IN latency timer */
+	USB_Device_EnableSOFEvents();
+
+#if defined(VCOM_BRIDGE)
+	/* Bulk endpoints are driven by DMA transfers in bridge mode */
+	Bridge_Start();
+#else
 	/* Set BULK out endpoint enabled ready to receive data */
 	Endpoint_SelectEndpoint(CDC_RX_EPADDR);
 	Endpoint_ClearOUT();
+#endif
 }
 
 
+/** Event handler for the USB_StartOfFrame event. This runs the latency timer which decides when a partially
+ *  filled bulk IN packet is sent to the host.
+ */
+void EVENT_USB_Device_StartOfFrame(void)
+{
+	if (LatencyTimerElapsedMS < VCOM_LATENCY_TIMER_MS)
+		LatencyTimerElapsedMS++;
+}
+
 /** Event handler for the USB_ControlRequest event. This is used to catch and process control requests sent to
  *  the device from the USB host before passing along unhandled control requests to the library for processing
  *  internally.
@@ -299,6 +713,7 @@ bool EVENT_USB_Device_ControlRequest(void)
 void VCOM_Echo(void)
 {
 	uint8_t tmp;
+	USB_Endpoint_Event_t Event;
 	/* Select the Serial Rx Endpoint */
 
 	while (1) {
@@ -307,32 +722,37 @@ void VCOM_Echo(void)
 			tmp = Endpoint_Read_8();
 			Endpoint_ClearOUT();
 			Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+			/* Sleeps in EM1 only while both banks are still queued for the host */
+			if (Endpoint_WaitUntilReady() != ENDPOINT_READYWAIT_NoError)
+				continue;
 			Endpoint_Write_8(tmp);
+			/* Echoed bytes are coalesced, a full packet is sent at once */
+			if (!(Endpoint_IsReadWriteAllowed()))
+				Endpoint_ClearIN();
+			continue;
+		}
+
+		Endpoint_SelectEndpoint(CDC_TX_EPADDR);
+		if (!(Endpoint_BytesInEndpoint())) {
+			LatencyTimerElapsedMS = 0;
+			/* Sleep in EM1 until the USB interrupt reports endpoint activity */
+			Endpoint_WaitForEvent(&Event);
+		} else if ((LatencyTimerElapsedMS >= VCOM_LATENCY_TIMER_MS) && Endpoint_IsINReady()) {
+			/* Partial packet has waited out the latency timer */
 			Endpoint_ClearIN();
-			while (!Endpoint_IsINReady());
+		} else {
+			/* Woken at least once per frame by the SOF interrupt */
+			EMU_EnterEM1();
 		}
 	}
 }
 
+/** Function to bridge the virtual serial port to the board's UART. All data is moved by the DMA controller
+ *  and the USB core, and handed over from their interrupts, so the CPU only sleeps here.
+ */
 void VCOM_Bridge(void)
 {
-	uint8_t tmp;
-	USART_TypeDef           *uart = UART_PORT;
-	/* Select the Serial Rx Endpoint */
-
 	while (1) {
-		Endpoint_SelectEndpoint(CDC_RX_EPADDR);
-		if (Endpoint_IsOUTReceived()) {
-			tmp = Endpoint_Read_8();
-			Endpoint_ClearOUT();
-			USART_Tx(uart, tmp);
-		}
-		if (uart->STATUS & USART_STATUS_RXDATAV) {
-			tmp = uart->RXDATA;
-			Endpoint_SelectEndpoint(CDC_TX_EPADDR);
-			Endpoint_Write_8(tmp);
-			Endpoint_ClearIN();
-			while (!Endpoint_IsINReady());
-		}
+		EMU_EnterEM1();
 	}
 }
@@ -59,6 +59,64 @@
 /** LED mask for the library LED driver, to indicate that an error has occurred in the USB interface. */
 #define LEDMASK_USB_ERROR           (LEDS_NO_LEDS)
 
+/** Time in milliseconds that echoed data may wait in a partially filled bulk IN packet before it is sent, so that
+ *  bytes received close together are returned to the host in a single packet.
+ */
+#if !defined(VCOM_LATENCY_TIMER_MS)
+#define VCOM_LATENCY_TIMER_MS       4
+#endif
+
+/** Number of UART receive buffers used by the bridge. Two are always being filled by the DMA controller
+ *  while the rest wait for, or are being sent to, the host.
+ */
+#if !defined(VCOM_BRIDGE_RX_BUFFERS)
+#define VCOM_BRIDGE_RX_BUFFERS      4
+#endif
+
+/** Size in bytes of each UART receive buffer used by the bridge. A full buffer is sent to the host at once. */
+#if !defined(VCOM_BRIDGE_RX_BUFFER_SIZE)
+#define VCOM_BRIDGE_RX_BUFFER_SIZE  512
+#endif
+
+/** Time in milliseconds that the UART receive line must be idle before a partially filled buffer is sent. */
+#if !defined(VCOM_BRIDGE_RX_TIMEOUT_MS)
+#define VCOM_BRIDGE_RX_TIMEOUT_MS   2
+#endif
+
+/** Size in bytes of each of the two USB OUT buffers used by the bridge, a multiple of \ref CDC_TXRX_EPSIZE. */
+#if !defined(VCOM_BRIDGE_TX_BUFFER_SIZE)
+#define VCOM_BRIDGE_TX_BUFFER_SIZE  512
+#endif
+
+/** DMA channel moving received UART data into the bridge's receive buffers. */
+#define VCOM_BRIDGE_DMA_RX          0
+
+/** DMA channel moving data from the host out of the UART. */
+#define VCOM_BRIDGE_DMA_TX          1
+
+/* Preprocessor Checks: */
+#if ((VCOM_BRIDGE_RX_BUFFERS < 3) || (VCOM_BRIDGE_RX_BUFFERS > 8))
+#error VCOM_BRIDGE_RX_BUFFERS must be between 3 and 8.
+#endif
+
+#if ((VCOM_BRIDGE_RX_BUFFER_SIZE > 1024) || (VCOM_BRIDGE_RX_BUFFER_SIZE % 4))
+#error VCOM_BRIDGE_RX_BUFFER_SIZE must be a multiple of 4, no larger than 1024 bytes.
+#endif
+
+#if ((VCOM_BRIDGE_TX_BUFFER_SIZE > 1024) || (VCOM_BRIDGE_TX_BUFFER_SIZE % CDC_TXRX_EPSIZE))
+#error VCOM_BRIDGE_TX_BUFFER_SIZE must be a multiple of CDC_TXRX_EPSIZE, no larger than 1024 bytes.
+#endif
+
+/* Enums: */
+/** Enum for the possible states of the bridge's USB OUT buffers. */
+enum VCOM_Bridge_BufferStates_t
+{
+	BRIDGE_BUFFER_Free    = 0, /**< Buffer is not in use. */
+	BRIDGE_BUFFER_USB     = 1, /**< Buffer is being filled by a USB OUT transfer. */
+	BRIDGE_BUFFER_Pending = 2, /**< Buffer holds data from the host, waiting for the UART. */
+	BRIDGE_BUFFER_UART    = 3, /**< Buffer is being sent out of the UART. */
+};
+
 /* Function Prototypes: */
 void SetupHardware(void);
 void VCOM_Echo(void);
@@ -68,6 +126,7 @@ void EVENT_USB_Device_Connect(void);
 void EVENT_USB_Device_Disconnect(void);
 void EVENT_USB_Device_ConfigurationChanged(void);
 bool EVENT_USB_Device_ControlRequest(void);
+void EVENT_USB_Device_StartOfFrame(void);
 
 #endif
 
@@ -49,6 +49,8 @@
 	#define ADAPTER_MAC_ADDRESS              {0x02, 0x00, 0x02, 0x00, 0x02, 0x00}
 	#define SERVER_MAC_ADDRESS               {0x00, 0x01, 0x00, 0x01, 0x00, 0x01}
 
+	#define MAX_TCP_CONNECTIONS              6
+
 	#define NO_DECODE_ETHERNET
 	#define NO_DECODE_ARP
 	#define NO_DECODE_IP
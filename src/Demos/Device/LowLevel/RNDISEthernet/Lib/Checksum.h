@@ -0,0 +1,73 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for Checksum.c.
+ */
+
+#ifndef _CHECKSUM_H_
+#define _CHECKSUM_H_
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Inline Functions: */
+		/** Folds a partial checksum accumulated by \ref Checksum_Add() or \ref Checksum_Copy() down to 16 bits, and
+		 *  complements it to give the final value to be stored into a packet header.
+		 *
+		 *  \param[in] Sum  Partial checksum to fold
+		 *
+		 *  \return A 16-bit Internet checksum value, in the same byte order as the summed data
+		 */
+		static inline uint16_t Checksum_Fold(uint32_t Sum)
+		{
+			Sum = ((Sum & 0xFFFF) + (Sum >> 16));
+			Sum = ((Sum & 0xFFFF) + (Sum >> 16));
+
+			return ~Sum;
+		}
+
+	/* Function Prototypes: */
+		uint32_t Checksum_Add(uint32_t Sum,
+		                      const void* Data,
+		                      uint16_t Bytes);
+		uint32_t Checksum_Copy(uint32_t Sum,
+		                       void* Destination,
+		                       const void* Source,
+		                       uint16_t Bytes);
+		uint16_t Checksum_Update16(const uint16_t Checksum,
+		                           const uint16_t OldWord,
+		                           const uint16_t NewWord);
+		uint16_t Checksum_Calculate16(const void* Data,
+		                              uint16_t Bytes);
+
+#endif
+
@@ -43,6 +43,7 @@
 		#include "Config/AppConfig.h"
 
 		#include "EthernetProtocols.h"
+		#include "Checksum.h"
 		#include "ProtocolDecoders.h"
 		#include "ICMP.h"
 		#include "TCP.h"
@@ -103,9 +104,7 @@
 		extern const IP_Address_t  ClientIPAddress;
 
 	/* Function Prototypes: */
-		void     Ethernet_ProcessPacket(void);
-		uint16_t Ethernet_Checksum16(void* Data,
-		                             uint16_t Bytes);
+		void Ethernet_ProcessPacket(void);
 
 #endif
 
@@ -70,7 +70,10 @@ int16_t ICMP_ProcessICMPPacket(void* InDataStart,
 		        &((uint8_t*)InDataStart)[sizeof(ICMP_Header_t)],
 			    DataSize);
 
-		ICMPHeaderOUT->Checksum = Ethernet_Checksum16(ICMPHeaderOUT, (DataSize + sizeof(ICMP_Header_t)));
+		/* Only the message type differs from the request, so the request's checksum is updated rather than the whole
+		   echoed payload being summed again */
+		ICMPHeaderOUT->Checksum = Checksum_Update16(ICMPHeaderIN->Checksum, *((uint16_t*)&ICMPHeaderIN->Type),
+		                                            *((uint16_t*)&ICMPHeaderOUT->Type));
 
 		/* Return the size of the response so far */
 		return (DataSize + sizeof(ICMP_Header_t));
@@ -50,6 +50,15 @@ TCP_PortState_t        PortStateTable[MAX_OPEN_TCP_PORTS];
  */
 TCP_ConnectionState_t  ConnectionStateTable[MAX_TCP_CONNECTIONS];
 
+/** Connection hash table array. Each bucket holds the connection state table index of the first connection whose port, remote
+ *  address and remote port hash to the bucket, with the rest of the bucket's connections chained on from it, so that the
+ *  connection a packet belongs to can be found without searching the whole connection state table.
+ */
+static uint8_t         ConnectionHashTable[TCP_CONNECTION_HASH_BUCKETS];
+
+/** Count of the packets processed for connections, used to find the least recently used connection state table entries. */
+static uint16_t        ConnectionActivityCounter;
+
 
 /** Task to handle the calling of each registered application's callback function, to process and generate TCP packets at the application
  *  level. If an application produces a response, this task constructs the appropriate Ethernet frame and places it into the Ethernet OUT
@@ -107,13 +116,14 @@ void TCP_Task(void)
 			TCPHeaderOUT->Checksum             = 0;
 			TCPHeaderOUT->Reserved             = 0;
 
-			memcpy(TCPDataOUT, ConnectionStateTable[CSTableEntry].Info.Buffer.Data, PacketSize);
+			/* Payload is summed as it is copied into the frame, rather than read back again to checksum it */
+			uint32_t DataChecksum = Checksum_Copy(0, TCPDataOUT, ConnectionStateTable[CSTableEntry].Info.Buffer.Data, PacketSize);
 
 			ConnectionStateTable[CSTableEntry].Info.SequenceNumberOut += PacketSize;
 
 			TCPHeaderOUT->Checksum             = TCP_Checksum16(TCPHeaderOUT, &ServerIPAddress,
 			                                                    &ConnectionStateTable[CSTableEntry].RemoteAddress,
-			                                                    (sizeof(TCP_Header_t) + PacketSize));
+			                                                    (sizeof(TCP_Header_t) + PacketSize), DataChecksum);
 
 			PacketSize += sizeof(TCP_Header_t);
 
@@ -131,7 +141,7 @@ void TCP_Task(void)
 			IPHeaderOUT->SourceAddress      = ServerIPAddress;
 			IPHeaderOUT->DestinationAddress = ConnectionStateTable[CSTableEntry].RemoteAddress;
 
-			IPHeaderOUT->HeaderChecksum     = Ethernet_Checksum16(IPHeaderOUT, sizeof(IP_Header_t));
+			IPHeaderOUT->HeaderChecksum     = Checksum_Calculate16(IPHeaderOUT, sizeof(IP_Header_t));
 
 			PacketSize += sizeof(IP_Header_t);
 
@@ -164,6 +174,10 @@ void TCP_Init(void)
 	/* Initialize the connection table with all CLOSED entries */
 	for (uint8_t CSTableEntry = 0; CSTableEntry < MAX_TCP_CONNECTIONS; CSTableEntry++)
 	  ConnectionStateTable[CSTableEntry].State = TCP_Connection_Closed;
+
+	/* Closed entries are not yet part of any connection, so are not in the hash table */
+	for (uint8_t Bucket = 0; Bucket < TCP_CONNECTION_HASH_BUCKETS; Bucket++)
+	  ConnectionHashTable[Bucket] = TCP_CONNECTION_NONE;
 }
 
 /** Sets the state and callback handler of the given port, specified in big endian to the given state.
@@ -255,32 +269,16 @@ bool TCP_SetConnectionState(const uint16_t Port,
 {
 	/* Note, Port number should be specified in BIG endian to simplify network code */
 
-	for (uint8_t CSTableEntry = 0; CSTableEntry < MAX_TCP_CONNECTIONS; CSTableEntry++)
-	{
-		/* Find port entry in the table */
-		if ((ConnectionStateTable[CSTableEntry].Port == Port) &&
-		     IP_COMPARE(&ConnectionStateTable[CSTableEntry].RemoteAddress, RemoteAddress) &&
-			 ConnectionStateTable[CSTableEntry].RemotePort == RemotePort)
-		{
-			ConnectionStateTable[CSTableEntry].State = State;
-			return true;
-		}
-	}
+	TCP_ConnectionState_t* Connection = TCP_FindConnection(Port, RemoteAddress, RemotePort);
 
-	for (uint8_t CSTableEntry = 0; CSTableEntry < MAX_TCP_CONNECTIONS; CSTableEntry++)
-	{
-		/* Find empty entry in the table */
-		if (ConnectionStateTable[CSTableEntry].State == TCP_Connection_Closed)
-		{
-			ConnectionStateTable[CSTableEntry].Port          = Port;
-			ConnectionStateTable[CSTableEntry].RemoteAddress = *RemoteAddress;
-			ConnectionStateTable[CSTableEntry].RemotePort    = RemotePort;
-			ConnectionStateTable[CSTableEntry].State         = State;
-			return true;
-		}
-	}
+	if (!(Connection))
+	  Connection = TCP_CreateConnection(Port, RemoteAddress, RemotePort);
+
+	if (!(Connection))
+	  return false;
 
-	return false;
+	Connection->State = State;
+	return true;
 }
 
 /** Retrieves the current state of a given TCP connection to a host.
@@ -297,47 +295,120 @@ uint8_t TCP_GetConnectionState(const uint16_t Port,
 {
 	/* Note, Port number should be specified in BIG endian to simplify network code */
 
-	for (uint8_t CSTableEntry = 0; CSTableEntry < MAX_TCP_CONNECTIONS; CSTableEntry++)
+	TCP_ConnectionState_t* Connection = TCP_FindConnection(Port, RemoteAddress, RemotePort);
+
+	return (Connection ? Connection->State : TCP_Connection_Closed);
+}
+
+/** Retrieves the connection info structure of a given connection to a host.
+ *
+ *  \param[in] Port           TCP port on the device in the connection, specified in big endian
+ *  \param[in] RemoteAddress  Remote protocol IP address of the connected host
+ *  \param[in] RemotePort     Remote TCP port of the connected host, specified in big endian
+ *
+ *  \return ConnectionInfo structure of the connection if found, NULL otherwise
+ */
+TCP_ConnectionInfo_t* TCP_GetConnectionInfo(const uint16_t Port,
+                                            const IP_Address_t* RemoteAddress,
+                                            const uint16_t RemotePort)
+{
+	/* Note, Port number should be specified in BIG endian to simplify network code */
+
+	TCP_ConnectionState_t* Connection = TCP_FindConnection(Port, RemoteAddress, RemotePort);
+
+	return (Connection ? &Connection->Info : NULL);
+}
+
+/** Looks up a connection in the connection state table by its port, remote address and remote port. Only the connections in
+ *  the hash table bucket for the given connection are examined, so the cost of a lookup does not grow with the table size.
+ *
+ *  \param[in] Port           TCP port on the device in the connection, specified in big endian
+ *  \param[in] RemoteAddress  Remote protocol IP address of the connected host
+ *  \param[in] RemotePort     Remote TCP port of the connected host, specified in big endian
+ *
+ *  \return Connection state table entry of the connection if found, NULL otherwise
+ */
+TCP_ConnectionState_t* TCP_FindConnection(const uint16_t Port,
+                                          const IP_Address_t* RemoteAddress,
+                                          const uint16_t RemotePort)
+{
+	uint8_t CSTableEntry = ConnectionHashTable[TCP_HashConnection(Port, RemoteAddress, RemotePort)];
+
+	while (CSTableEntry != TCP_CONNECTION_NONE)
 	{
-		/* Find port entry in the table */
-		if ((ConnectionStateTable[CSTableEntry].Port == Port) &&
-		     IP_COMPARE(&ConnectionStateTable[CSTableEntry].RemoteAddress, RemoteAddress) &&
-			 ConnectionStateTable[CSTableEntry].RemotePort == RemotePort)
+		TCP_ConnectionState_t* Connection = &ConnectionStateTable[CSTableEntry];
 
+		if ((Connection->Port == Port) &&
+		     IP_COMPARE(&Connection->RemoteAddress, RemoteAddress) &&
+		    (Connection->RemotePort == RemotePort))
 		{
-			return ConnectionStateTable[CSTableEntry].State;
+			return Connection;
 		}
+
+		CSTableEntry = Connection->NextInBucket;
 	}
 
-	return TCP_Connection_Closed;
+	return NULL;
 }
 
-/** Retrieves the connection info structure of a given connection to a host.
+/** Creates a new connection in the connection state table, in the \ref TCP_Connection_Closed state. The least recently
+ *  used closed entry in the table is reused for the connection if there is one, otherwise the least recently used entry
+ *  in the \ref TCP_Connection_TimeWait state is evicted to make room for it.
  *
  *  \param[in] Port           TCP port on the device in the connection, specified in big endian
  *  \param[in] RemoteAddress  Remote protocol IP address of the connected host
  *  \param[in] RemotePort     Remote TCP port of the connected host, specified in big endian
  *
- *  \return ConnectionInfo structure of the connection if found, NULL otherwise
+ *  \return Connection state table entry of the new connection, NULL if all entries are in use by other connections
  */
-TCP_ConnectionInfo_t* TCP_GetConnectionInfo(const uint16_t Port,
+TCP_ConnectionState_t* TCP_CreateConnection(const uint16_t Port,
                                             const IP_Address_t* RemoteAddress,
                                             const uint16_t RemotePort)
 {
-	/* Note, Port number should be specified in BIG endian to simplify network code */
+	uint8_t  FreeEntry       = TCP_CONNECTION_NONE;
+	uint16_t FreeEntryAge    = 0;
+	bool     FreeEntryClosed = false;
 
 	for (uint8_t CSTableEntry = 0; CSTableEntry < MAX_TCP_CONNECTIONS; CSTableEntry++)
 	{
-		/* Find port entry in the table */
-		if ((ConnectionStateTable[CSTableEntry].Port == Port) &&
-		     IP_COMPARE(&ConnectionStateTable[CSTableEntry].RemoteAddress, RemoteAddress) &&
-			 ConnectionStateTable[CSTableEntry].RemotePort == RemotePort)
+		TCP_ConnectionState_t* Connection = &ConnectionStateTable[CSTableEntry];
+
+		bool     EntryClosed = (Connection->State == TCP_Connection_Closed);
+		uint16_t EntryAge    = (ConnectionActivityCounter - Connection->LastActivity);
+
+		if (!(EntryClosed) && (Connection->State != TCP_Connection_TimeWait))
+		  continue;
+
+		/* Closed entries are always preferred over TIME-WAIT entries, with the oldest of either kind being chosen */
+		if ((FreeEntry == TCP_CONNECTION_NONE) || (EntryClosed && !(FreeEntryClosed)) ||
+		    ((EntryClosed == FreeEntryClosed) && (EntryAge > FreeEntryAge)))
 		{
-			return &ConnectionStateTable[CSTableEntry].Info;
+			FreeEntry       = CSTableEntry;
+			FreeEntryAge    = EntryAge;
+			FreeEntryClosed = EntryClosed;
 		}
 	}
 
-	return NULL;
+	if (FreeEntry == TCP_CONNECTION_NONE)
+	  return NULL;
+
+	TCP_ConnectionState_t* Connection = &ConnectionStateTable[FreeEntry];
+
+	/* Move the entry from the hash table bucket of its previous connection to that of the new one */
+	TCP_UnlinkConnection(FreeEntry);
+
+	Connection->Port          = Port;
+	Connection->RemoteAddress = *RemoteAddress;
+	Connection->RemotePort    = RemotePort;
+	Connection->State         = TCP_Connection_Closed;
+	Connection->LastActivity  = ConnectionActivityCounter;
+
+	uint8_t Bucket = TCP_HashConnection(Port, RemoteAddress, RemotePort);
+
+	Connection->NextInBucket     = ConnectionHashTable[Bucket];
+	ConnectionHashTable[Bucket]  = FreeEntry;
+
+	return Connection;
 }
 
 /** Processes a TCP packet inside an Ethernet frame, and writes the appropriate response
@@ -359,55 +430,76 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 	TCP_Header_t* TCPHeaderIN  = (TCP_Header_t*)TCPHeaderInStart;
 	TCP_Header_t* TCPHeaderOUT = (TCP_Header_t*)TCPHeaderOutStart;
 
-	TCP_ConnectionInfo_t* ConnectionInfo;
+	TCP_ConnectionState_t* Connection = NULL;
+	TCP_ConnectionInfo_t*  ConnectionInfo;
 
 	DecodeTCPHeader(TCPHeaderInStart);
 
+	uint16_t IPOffset   = (IPHeaderIN->HeaderLength * sizeof(uint32_t));
+	uint16_t TCPOffset  = (TCPHeaderIN->DataOffset * sizeof(uint32_t));
+	uint16_t DataLength = (SwapEndian_16(IPHeaderIN->TotalLength) - IPOffset - TCPOffset);
+
 	bool PacketResponse = false;
 
 	/* Check if the destination port is open and allows incoming connections */
 	if (TCP_GetPortState(TCPHeaderIN->DestinationPort) == TCP_Port_Open)
 	{
+		/* The connection is looked up once, and the table entry used for the rest of the packet's processing */
+		Connection = TCP_FindConnection(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress, TCPHeaderIN->SourcePort);
+
 		/* Detect SYN from host to start a connection */
 		if (TCPHeaderIN->Flags & TCP_FLAG_SYN)
-		  TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress, TCPHeaderIN->SourcePort, TCP_Connection_Listen);
+		{
+			if (!(Connection))
+			  Connection = TCP_CreateConnection(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress, TCPHeaderIN->SourcePort);
+
+			if (Connection)
+			  Connection->State = TCP_Connection_Listen;
+		}
+
+		if (Connection)
+		  Connection->LastActivity = ++ConnectionActivityCounter;
 
 		/* Detect RST from host to abort existing connection */
 		if (TCPHeaderIN->Flags & TCP_FLAG_RST)
 		{
-			if (TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-			                           TCPHeaderIN->SourcePort, TCP_Connection_Closed))
+			if (Connection)
 			{
+				Connection->State = TCP_Connection_Closed;
+
 				TCPHeaderOUT->Flags = (TCP_FLAG_RST | TCP_FLAG_ACK);
 				PacketResponse = true;
 			}
 		}
+		else if (!(Connection))
+		{
+			/* Connection state table is full, refuse the connection rather than leaving the host to retry it */
+			if (TCPHeaderIN->Flags == TCP_FLAG_SYN)
+			{
+				TCPHeaderOUT->Flags = (TCP_FLAG_RST | TCP_FLAG_ACK);
+				PacketResponse      = true;
+			}
+		}
 		else
 		{
+			ConnectionInfo = &Connection->Info;
+
 			/* Process the incoming TCP packet based on the current connection state for the sender and port */
-			switch (TCP_GetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress, TCPHeaderIN->SourcePort))
+			switch (Connection->State)
 			{
 				case TCP_Connection_Listen:
 					if (TCPHeaderIN->Flags == TCP_FLAG_SYN)
 					{
 						/* SYN connection starts a connection with a peer */
-						if (TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-						                           TCPHeaderIN->SourcePort, TCP_Connection_SYNReceived))
-						{
-							TCPHeaderOUT->Flags = (TCP_FLAG_SYN | TCP_FLAG_ACK);
-
-							ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress, TCPHeaderIN->SourcePort);
-
-							ConnectionInfo->SequenceNumberIn  = (SwapEndian_32(TCPHeaderIN->SequenceNumber) + 1);
-							ConnectionInfo->SequenceNumberOut = 0;
-							ConnectionInfo->Buffer.InUse      = false;
-						}
-						else
-						{
-							TCPHeaderOUT->Flags = TCP_FLAG_RST;
-						}
+						Connection->State   = TCP_Connection_SYNReceived;
 
+						TCPHeaderOUT->Flags = (TCP_FLAG_SYN | TCP_FLAG_ACK);
 						PacketResponse      = true;
+
+						ConnectionInfo->SequenceNumberIn  = (SwapEndian_32(TCPHeaderIN->SequenceNumber) + 1);
+						ConnectionInfo->SequenceNumberOut = 0;
+						ConnectionInfo->Buffer.InUse      = false;
+						ConnectionInfo->Buffer.Ready      = false;
 					}
 
 					break;
@@ -415,12 +507,7 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 					if (TCPHeaderIN->Flags == TCP_FLAG_ACK)
 					{
 						/* ACK during the connection process completes the connection to a peer */
-
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_Established);
-
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
+						Connection->State = TCP_Connection_Established;
 
 						ConnectionInfo->SequenceNumberOut++;
 					}
@@ -434,20 +521,13 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 						TCPHeaderOUT->Flags = (TCP_FLAG_FIN | TCP_FLAG_ACK);
 						PacketResponse      = true;
 
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_CloseWait);
-
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
+						Connection->State   = TCP_Connection_CloseWait;
 
 						ConnectionInfo->SequenceNumberIn++;
 						ConnectionInfo->SequenceNumberOut++;
 					}
 					else if ((TCPHeaderIN->Flags == TCP_FLAG_ACK) || (TCPHeaderIN->Flags == (TCP_FLAG_ACK | TCP_FLAG_PSH)))
 					{
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
-
 						/* Check if the buffer is currently in use either by a buffered data to send, or receive */
 						if ((ConnectionInfo->Buffer.InUse == false) && (ConnectionInfo->Buffer.Ready == false))
 						{
@@ -460,10 +540,6 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 						if ((ConnectionInfo->Buffer.Direction == TCP_PACKETDIR_IN) &&
 							(ConnectionInfo->Buffer.Length != TCP_WINDOW_SIZE))
 						{
-							uint16_t IPOffset   = (IPHeaderIN->HeaderLength * sizeof(uint32_t));
-							uint16_t TCPOffset  = (TCPHeaderIN->DataOffset * sizeof(uint32_t));
-							uint16_t DataLength = (SwapEndian_16(IPHeaderIN->TotalLength) - IPOffset - TCPOffset);
-
 							/* Copy the packet data into the buffer */
 							memcpy(&ConnectionInfo->Buffer.Data[ConnectionInfo->Buffer.Length],
 								   &((uint8_t*)TCPHeaderInStart)[TCPOffset],
@@ -491,63 +567,45 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 
 					break;
 				case TCP_Connection_Closing:
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
-
 						TCPHeaderOUT->Flags = (TCP_FLAG_ACK | TCP_FLAG_FIN);
 						PacketResponse      = true;
 
 						ConnectionInfo->Buffer.InUse = false;
 
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_FINWait1);
+						Connection->State   = TCP_Connection_FINWait1;
 
 					break;
 				case TCP_Connection_FINWait1:
+				case TCP_Connection_FINWait2:
 					if (TCPHeaderIN->Flags == (TCP_FLAG_FIN | TCP_FLAG_ACK))
 					{
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
-
 						TCPHeaderOUT->Flags = TCP_FLAG_ACK;
 						PacketResponse      = true;
 
 						ConnectionInfo->SequenceNumberIn++;
 						ConnectionInfo->SequenceNumberOut++;
 
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_Closed);
+						/* Connection is kept in the table to acknowledge any retransmitted FIN, until its entry is reused */
+						Connection->State   = TCP_Connection_TimeWait;
 					}
-					else if (TCPHeaderIN->Flags == TCP_FLAG_ACK)
+					else if ((Connection->State == TCP_Connection_FINWait1) && (TCPHeaderIN->Flags == TCP_FLAG_ACK))
 					{
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_FINWait2);
+						Connection->State   = TCP_Connection_FINWait2;
 					}
 
 					break;
-				case TCP_Connection_FINWait2:
+				case TCP_Connection_TimeWait:
 					if (TCPHeaderIN->Flags == (TCP_FLAG_FIN | TCP_FLAG_ACK))
 					{
-						ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-															   TCPHeaderIN->SourcePort);
-
+						/* Host did not receive the final ACK of the connection, send it again */
 						TCPHeaderOUT->Flags = TCP_FLAG_ACK;
 						PacketResponse      = true;
-
-						ConnectionInfo->SequenceNumberIn++;
-						ConnectionInfo->SequenceNumberOut++;
-
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_Closed);
 					}
 
 					break;
 				case TCP_Connection_CloseWait:
 					if (TCPHeaderIN->Flags == TCP_FLAG_ACK)
-					{
-						TCP_SetConnectionState(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-											   TCPHeaderIN->SourcePort, TCP_Connection_Closed);
-					}
+					  Connection->State = TCP_Connection_Closed;
 
 					break;
 			}
@@ -563,26 +621,44 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 	/* Check if we need to respond to the sent packet */
 	if (PacketResponse)
 	{
-		ConnectionInfo = TCP_GetConnectionInfo(TCPHeaderIN->DestinationPort, &IPHeaderIN->SourceAddress,
-		                                       TCPHeaderIN->SourcePort);
-
 		TCPHeaderOUT->SourcePort           = TCPHeaderIN->DestinationPort;
 		TCPHeaderOUT->DestinationPort      = TCPHeaderIN->SourcePort;
-		TCPHeaderOUT->SequenceNumber       = SwapEndian_32(ConnectionInfo->SequenceNumberOut);
-		TCPHeaderOUT->AcknowledgmentNumber = SwapEndian_32(ConnectionInfo->SequenceNumberIn);
 		TCPHeaderOUT->DataOffset           = (sizeof(TCP_Header_t) / sizeof(uint32_t));
 
-		if (!(ConnectionInfo->Buffer.InUse))
-		  TCPHeaderOUT->WindowSize         = SwapEndian_16(TCP_WINDOW_SIZE);
+		if (Connection)
+		{
+			ConnectionInfo = &Connection->Info;
+
+			TCPHeaderOUT->SequenceNumber       = SwapEndian_32(ConnectionInfo->SequenceNumberOut);
+			TCPHeaderOUT->AcknowledgmentNumber = SwapEndian_32(ConnectionInfo->SequenceNumberIn);
+
+			if (!(ConnectionInfo->Buffer.InUse))
+			  TCPHeaderOUT->WindowSize         = SwapEndian_16(TCP_WINDOW_SIZE);
+			else
+			  TCPHeaderOUT->WindowSize         = SwapEndian_16(TCP_WINDOW_SIZE - ConnectionInfo->Buffer.Length);
+		}
 		else
-		  TCPHeaderOUT->WindowSize         = SwapEndian_16(TCP_WINDOW_SIZE - ConnectionInfo->Buffer.Length);
+		{
+			/* Refused segments have no connection to take sequence numbers from, so the reset acknowledges the segment itself */
+			uint32_t SegmentLength = DataLength;
+
+			if (TCPHeaderIN->Flags & TCP_FLAG_SYN)
+			  SegmentLength++;
+
+			if (TCPHeaderIN->Flags & TCP_FLAG_FIN)
+			  SegmentLength++;
+
+			TCPHeaderOUT->SequenceNumber       = (TCPHeaderIN->Flags & TCP_FLAG_ACK) ? TCPHeaderIN->AcknowledgmentNumber : 0;
+			TCPHeaderOUT->AcknowledgmentNumber = SwapEndian_32(SwapEndian_32(TCPHeaderIN->SequenceNumber) + SegmentLength);
+			TCPHeaderOUT->WindowSize           = 0;
+		}
 
 		TCPHeaderOUT->UrgentPointer        = 0;
 		TCPHeaderOUT->Checksum             = 0;
 		TCPHeaderOUT->Reserved             = 0;
 
 		TCPHeaderOUT->Checksum             = TCP_Checksum16(TCPHeaderOUT, &IPHeaderIN->DestinationAddress,
-		                                                    &IPHeaderIN->SourceAddress, sizeof(TCP_Header_t));
+		                                                    &IPHeaderIN->SourceAddress, sizeof(TCP_Header_t), 0);
 
 		return sizeof(TCP_Header_t);
 	}
@@ -590,20 +666,64 @@ int16_t TCP_ProcessTCPPacket(void* IPHeaderInStart,
 	return NO_RESPONSE;
 }
 
+/** Calculates the hash table bucket of a connection from its port, remote address and remote port.
+ *
+ *  \param[in] Port           TCP port on the device in the connection, specified in big endian
+ *  \param[in] RemoteAddress  Remote protocol IP address of the connected host
+ *  \param[in] RemotePort     Remote TCP port of the connected host, specified in big endian
+ *
+ *  \return Index of the connection's bucket in the connection hash table
+ */
+static uint8_t TCP_HashConnection(const uint16_t Port,
+                                  const IP_Address_t* RemoteAddress,
+                                  const uint16_t RemotePort)
+{
+	/* Hosts allocate their ports in sequence, so folding both bytes of the remote port in spreads a host's connections
+	   over the buckets regardless of the byte order the port is stored in */
+	uint16_t Hash = (Port ^ RemotePort ^ ((const uint16_t*)RemoteAddress)[0] ^ ((const uint16_t*)RemoteAddress)[1]);
+
+	return ((Hash ^ (Hash >> 8)) & (TCP_CONNECTION_HASH_BUCKETS - 1));
+}
+
+/** Removes a connection state table entry from the chain of its hash table bucket, if it is in one.
+ *
+ *  \param[in] CSTableEntry  Index of the entry in the connection state table
+ */
+static void TCP_UnlinkConnection(const uint8_t CSTableEntry)
+{
+	TCP_ConnectionState_t* Connection = &ConnectionStateTable[CSTableEntry];
+	uint8_t*               ChainLink  = &ConnectionHashTable[TCP_HashConnection(Connection->Port, &Connection->RemoteAddress,
+	                                                                                Connection->RemotePort)];
+
+	while (*ChainLink != TCP_CONNECTION_NONE)
+	{
+		if (*ChainLink == CSTableEntry)
+		{
+			*ChainLink = Connection->NextInBucket;
+			return;
+		}
+
+		ChainLink = &ConnectionStateTable[*ChainLink].NextInBucket;
+	}
+}
+
 /** Calculates the appropriate TCP checksum, consisting of the addition of the one's compliment of each word,
- *  complimented.
+ *  complimented. Only the TCP header is summed here, the payload following it being given as a partial checksum
+ *  accumulated while it was copied into the packet.
  *
  *  \param[in] TCPHeaderOutStart   Pointer to the start of the packet's outgoing TCP header
  *  \param[in] SourceAddress       Source protocol IP address of the outgoing IP header
  *  \param[in] DestinationAddress  Destination protocol IP address of the outgoing IP header
  *  \param[in] TCPOutSize          Size in bytes of the TCP data header and payload
+ *  \param[in] DataChecksum        Partial checksum of the payload from \ref Checksum_Copy(), or zero if there is no payload
  *
  *  \return A 16-bit TCP checksum value
  */
 static uint16_t TCP_Checksum16(void* TCPHeaderOutStart,
                                const IP_Address_t* SourceAddress,
                                const IP_Address_t* DestinationAddress,
-                               uint16_t TCPOutSize)
+                               uint16_t TCPOutSize,
+                               uint32_t DataChecksum)
 {
 	uint32_t Checksum = 0;
 
@@ -617,15 +737,9 @@ static uint16_t TCP_Checksum16(void* TCPHeaderOutStart,
 	Checksum += SwapEndian_16(PROTOCOL_TCP);
 	Checksum += SwapEndian_16(TCPOutSize);
 
-	for (uint16_t CurrWord = 0; CurrWord < (TCPOutSize >> 1); CurrWord++)
-	  Checksum += ((uint16_t*)TCPHeaderOutStart)[CurrWord];
-
-	if (TCPOutSize & 0x01)
-	  Checksum += (((uint16_t*)TCPHeaderOutStart)[TCPOutSize >> 1] & 0x00FF);
-
-	while (Checksum & 0xFFFF0000)
-	  Checksum = ((Checksum & 0xFFFF) + (Checksum >> 16));
+	/* Header is an even number of bytes long, so the payload's sum lines up with the header's words */
+	Checksum  = Checksum_Add(Checksum, TCPHeaderOutStart, sizeof(TCP_Header_t));
 
-	return ~Checksum;
+	return Checksum_Fold(Checksum + (DataChecksum & 0xFFFF) + (DataChecksum >> 16));
 }
 
@@ -0,0 +1,76 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for WebAssets.c.
+ *
+ *  This file was generated by http_asset_packer.py and should not be edited directly. Modify the files in the
+ *  web root directory instead, and regenerate the bundle from them.
+ */
+
+#ifndef _WEB_ASSETS_H_
+#define _WEB_ASSETS_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of assets stored in the bundle. */
+		#define WEB_ASSETS_TOTAL_ASSETS     1
+
+	/* Type Defines: */
+		/** Type define for an asset stored in the web asset bundle. All pointers reference FLASH memory. */
+		typedef struct
+		{
+			const char*    Path; /**< Path of the asset relative to the web root, without a leading '/' */
+			const char*    Headers; /**< HTTP response header lines describing the encoded asset */
+			const char*    ETag; /**< Quoted HTTP entity tag of the asset's contents */
+			const uint8_t* Data; /**< Asset contents, gzip encoded if indicated by the response headers */
+			uint16_t       Length; /**< Length in bytes of the asset contents */
+			bool           IsGzipEncoded; /**< Indicates if the asset contents are gzip encoded */
+		} WebAsset_t;
+
+	/* Function Prototypes: */
+		bool WebAssets_Find(const char* Path,
+		                    const uint8_t PathLength,
+		                    WebAsset_t* const Asset);
+		bool WebAssets_MatchETag(const WebAsset_t* const Asset,
+		                         const char* ETag,
+		                         const uint8_t ETagLength);
+		bool WebAssets_IsEncodingAccepted(const WebAsset_t* const Asset,
+		                                  const char* AcceptEncoding,
+		                                  uint8_t AcceptEncodingLength);
+
+#endif
+
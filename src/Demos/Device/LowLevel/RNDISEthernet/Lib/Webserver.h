@@ -43,6 +43,7 @@
 		#include <LUFA/Version.h>
 
 		#include "TCP.h"
+		#include "WebAssets.h"
 
 	/* Macros: */
 		/** Maximum size of a HTTP response per transmission */
@@ -39,6 +39,9 @@
 /** Processed HID report descriptor items structure, containing information on each HID report element */
 static HID_ReportInfo_t HIDReportInfo;
 
+/** Extraction plan of the joystick's IN report items, compiled from the processed HID report descriptor items */
+static HID_ReportPlan_t HIDReportPlan;
+
 /** LUFA HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -118,21 +121,26 @@ void JoystickHost_Task(void)
 		uint8_t JoystickReport[Joystick_HID_Interface.State.LargestReportSize];
 		HID_Host_ReceiveReport(&Joystick_HID_Interface, &JoystickReport);
 
-		uint8_t LEDMask = LEDS_NO_LEDS;
+		uint8_t  LEDMask = LEDS_NO_LEDS;
+		uint32_t ReportValues[HID_MAX_REPORTITEMS];
+
+		/* Extract every joystick item in the report at once - reports with no joystick items are ignored */
+		if (!(USB_DecodeHIDReport(&HIDReportPlan, JoystickReport, sizeof(JoystickReport), ReportValues)))
+		  return;
 
 		for (uint8_t ReportNumber = 0; ReportNumber < HIDReportInfo.TotalReportItems; ReportNumber++)
 		{
 			HID_ReportItem_t* ReportItem = &HIDReportInfo.ReportItems[ReportNumber];
 
-			/* Update the report item value if it is contained within the current report */
-			if (!(USB_GetHIDReportItemInfo(JoystickReport, ReportItem)))
+			/* Skip the report item if it is not contained within the current report */
+			if (ReportItem->ReportID && (ReportItem->ReportID != JoystickReport[0]))
 			  continue;
 
 			/* Determine what report item is being tested, process updated value as needed */
 			if ((ReportItem->Attributes.Usage.Page        == USAGE_PAGE_BUTTON) &&
 			    (ReportItem->ItemType                     == HID_REPORT_ITEM_In))
 			{
-				if (ReportItem->Value)
+				if (ReportValues[ReportNumber])
 				  LEDMask = LEDS_ALL_LEDS;
 			}
 			else if ((ReportItem->Attributes.Usage.Page   == USAGE_PAGE_GENERIC_DCTRL) &&
@@ -140,7 +148,7 @@ void JoystickHost_Task(void)
 			          (ReportItem->Attributes.Usage.Usage == USAGE_Y))                 &&
 			         (ReportItem->ItemType                == HID_REPORT_ITEM_In))
 			{
-				int16_t DeltaMovement = HID_ALIGN_DATA(ReportItem, int16_t);
+				int16_t DeltaMovement = (int16_t)ReportValues[ReportNumber];
 
 				if (DeltaMovement)
 				{
@@ -215,6 +223,15 @@ void EVENT_USB_Host_DeviceEnumerationComplete(void)
 		return;
 	}
 
+	/* Compile the parsed IN items, so that each report can be decoded in a single pass */
+	if (USB_CompileHIDReportPlan(&HIDReportInfo, HID_REPORT_ITEM_In, &HIDReportPlan) != HID_PARSE_Successful)
+	{
+		puts_P(PSTR("Too Many Report Items to Compile.\r\n"));
+		LEDs_SetAllLEDs(LEDMASK_USB_ERROR);
+		USB_Host_SetDeviceConfiguration(0);
+		return;
+	}
+
 	puts_P(PSTR("Joystick Enumerated.\r\n"));
 	LEDs_SetAllLEDs(LEDMASK_USB_READY);
 }
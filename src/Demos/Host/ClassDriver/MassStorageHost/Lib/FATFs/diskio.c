@@ -0,0 +1,218 @@
+/*-----------------------------------------------------------------------*/
+/* Low level disk I/O module skeleton for FatFs     (C)ChaN, 2007        */
+/*-----------------------------------------------------------------------*/
+/* This is a stub disk I/O module that acts as front end of the existing */
+/* disk I/O modules and attach it to FatFs module with common interface. */
+/*-----------------------------------------------------------------------*/
+
+#include "diskio.h"
+
+/* Number of sectors held in RAM while waiting to be written to the disk */
+#define WRITE_BEHIND_SECTORS	4
+
+/* Sector size of the disk, fixed by the FatFs configuration */
+#define SECTOR_SIZE				512
+
+/* Write-behind sector, queued on the Mass Storage class driver until written */
+typedef struct {
+	MS_Host_BlockRequest_t	Request;
+	BYTE					Buffer[SECTOR_SIZE] ATTR_ALIGNED(4);
+} WriteBehindSector_t;
+
+static WriteBehindSector_t WriteSectors[WRITE_BEHIND_SECTORS];
+static BYTE NextWriteSector;
+static BYTE WriteFailed;
+
+
+/*-----------------------------------------------------------------------*/
+/* Queue a block request and run the class driver until it is accepted   */
+
+static DRESULT queue_request (
+	MS_Host_BlockRequest_t *req	/* Request to queue */
+)
+{
+	while (!MS_Host_QueueBlockRequest(&FlashDisk_MS_Interface, req)) {
+		if (USB_HostState != HOST_STATE_Configured)
+		  return RES_NOTRDY;
+
+		MS_Host_USBTask(&FlashDisk_MS_Interface);
+	}
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Run the class driver until a block request has completed             */
+
+static DRESULT wait_request (
+	MS_Host_BlockRequest_t *req	/* Request to wait for */
+)
+{
+	while (req->Status == MS_HOST_REQUEST_PENDING)
+	  MS_Host_USBTask(&FlashDisk_MS_Interface);
+
+	if (req->Status != PIPE_RWSTREAM_NoError) {
+		WriteFailed = 1;
+		return RES_ERROR;
+	}
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Initialize a Drive                                                    */
+
+DSTATUS disk_initialize (
+	BYTE drv				/* Physical drive number (0..) */
+)
+{
+	SCSI_Capacity_t DiskCapacity;
+	BYTE i;
+
+	if (USB_HostState != HOST_STATE_Configured)
+	  return STA_NOINIT | STA_NODISK;
+
+	if (MS_Host_ReadDeviceCapacity(&FlashDisk_MS_Interface, 0, &DiskCapacity) ||
+	    (DiskCapacity.BlockSize != SECTOR_SIZE))
+	  return STA_NOINIT;
+
+	for (i = 0; i < WRITE_BEHIND_SECTORS; i++)
+	  WriteSectors[i].Request.Status = PIPE_RWSTREAM_NoError;
+
+	NextWriteSector = 0;
+	WriteFailed     = 0;
+
+	return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Return Disk Status                                                    */
+
+DSTATUS disk_status (
+	BYTE drv		/* Physical drive number (0..) */
+)
+{
+	if (USB_HostState != HOST_STATE_Configured)
+	  return STA_NOINIT | STA_NODISK;
+
+	return 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read Sector(s)                                                        */
+
+DRESULT disk_read (
+	BYTE drv,		/* Physical drive number (0..) */
+	BYTE *buff,		/* Data buffer to store read data */
+	DWORD sector,	/* Sector address (LBA) */
+	BYTE count		/* Number of sectors to read (1..128) */
+)
+{
+	/* Queued writes are flushed by the class driver before the read is issued */
+	if (MS_Host_ReadDeviceBlocks(&FlashDisk_MS_Interface, 0, sector, count, SECTOR_SIZE, buff))
+	  return RES_ERROR;
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write Sector(s)                                                       */
+
+#if _READONLY == 0
+DRESULT disk_write (
+	BYTE drv,			/* Physical drive number (0..) */
+	const BYTE *buff,	/* Data to be written */
+	DWORD sector,		/* Sector address (LBA) */
+	BYTE count			/* Number of sectors to write (1..128) */
+)
+{
+	MS_Host_BlockRequest_t req;
+	WriteBehindSector_t *ws;
+	DRESULT res;
+
+	/* Large writes are issued straight from the caller's buffer, which must be kept until written */
+	if (count > WRITE_BEHIND_SECTORS) {
+		req.BlockBuffer  = (void*)buff;
+		req.BlockAddress = sector;
+		req.Blocks       = count;
+		req.BlockSize    = SECTOR_SIZE;
+		req.LUNIndex     = 0;
+		req.IsWrite      = true;
+
+		if ((res = queue_request(&req)) != RES_OK)
+		  return res;
+
+		return wait_request(&req);
+	}
+
+	/* Each sector is copied into its own request, so the class driver merges adjacent sectors into one command */
+	while (count--) {
+		ws = &WriteSectors[NextWriteSector];
+
+		if ((res = wait_request(&ws->Request)) != RES_OK)
+		  return res;
+
+		memcpy(ws->Buffer, buff, SECTOR_SIZE);
+
+		ws->Request.BlockBuffer  = ws->Buffer;
+		ws->Request.BlockAddress = sector++;
+		ws->Request.Blocks       = 1;
+		ws->Request.BlockSize    = SECTOR_SIZE;
+		ws->Request.LUNIndex     = 0;
+		ws->Request.IsWrite      = true;
+
+		if ((res = queue_request(&ws->Request)) != RES_OK)
+		  return res;
+
+		buff += SECTOR_SIZE;
+		NextWriteSector = (NextWriteSector + 1) % WRITE_BEHIND_SECTORS;
+	}
+
+	return RES_OK;
+}
+#endif /* _READONLY */
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Miscellaneous Functions                                               */
+
+DRESULT disk_ioctl (
+	BYTE drv,		/* Physical drive number (0..) */
+	BYTE ctrl,		/* Control code */
+	void *buff		/* Buffer to send/receive control data */
+)
+{
+	BYTE i;
+
+	if (ctrl != CTRL_SYNC)
+	  return RES_PARERR;
+
+	MS_Host_FlushRequests(&FlashDisk_MS_Interface);
+
+	for (i = 0; i < WRITE_BEHIND_SECTORS; i++)
+	  wait_request(&WriteSectors[i].Request);
+
+	/* Write errors are reported on every sync until the drive is initialized again */
+	return WriteFailed ? RES_ERROR : RES_OK;
+}
+
+
+DWORD get_fattime (void)
+{
+	/* No real time clock is available, so all files are stamped 01/01/2014 00:00:00 */
+	return ((DWORD)(2014 - 1980) << 25) |
+	                      ((DWORD)1 << 21) |
+	                      ((DWORD)1 << 16);
+}
+
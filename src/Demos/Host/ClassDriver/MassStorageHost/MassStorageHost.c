@@ -57,6 +57,12 @@ USB_ClassInfo_MS_Host_t FlashDisk_MS_Interface =
 			},
 	};
 
+/** FAT Fs structure to hold the internal state of the FAT driver for the attached disk. */
+static FATFS DiskFATState;
+
+/** FAT Fs structure to hold the current open log file on the attached disk. */
+static FIL LogFile;
+
 
 /** Main program entry point. This routine configures the hardware required by the application, then
  *  enters a loop to run the application tasks in sequence.
@@ -101,7 +107,7 @@ void SetupHardware(void)
 }
 
 /** Task to manage an enumerated USB Mass Storage device once connected, to print out
- *  data from the device.
+ *  data from the device and append to the log file on its FAT formatted partition.
  */
 void MassStorageHost_Task(void)
 {
@@ -177,6 +183,42 @@ void MassStorageHost_Task(void)
 		printf_P(PSTR("\r\n"));
 	}
 
+	puts_P(PSTR("\r\nAppending to log file...\r\n"));
+
+	/* Mount the disk and open the log file, the disk's sectors are accessed through the FAT Fs diskio layer */
+	f_mount(0, &DiskFATState);
+
+	if (f_open(&LogFile, LOG_FILE_NAME, FA_OPEN_ALWAYS | FA_WRITE) != FR_OK)
+	{
+		puts_P(PSTR("Error opening log file.\r\n"));
+		LEDs_SetAllLEDs(LEDMASK_USB_ERROR);
+		USB_Host_SetDeviceConfiguration(0);
+		return;
+	}
+
+	f_lseek(&LogFile, LogFile.fsize);
+
+	/* Written sectors are queued on the class driver and merged into multi-block commands in the background */
+	for (uint16_t Line = 0; Line < LOG_FILE_LINES; Line++)
+	{
+		char LineBuffer[40];
+		UINT BytesWritten;
+
+		BytesWritten = sprintf_P(LineBuffer, PSTR("Mass Storage Host Demo, line %u\r\n"), Line);
+		f_write(&LogFile, LineBuffer, BytesWritten, &BytesWritten);
+	}
+
+	/* Closing the file flushes all queued sectors to the disk */
+	if (f_close(&LogFile) != FR_OK)
+	{
+		puts_P(PSTR("Error writing log file.\r\n"));
+		LEDs_SetAllLEDs(LEDMASK_USB_ERROR);
+		USB_Host_SetDeviceConfiguration(0);
+		return;
+	}
+
+	printf_P(PSTR("%u lines appended to " LOG_FILE_NAME ".\r\n"), LOG_FILE_LINES);
+
 	LEDs_SetAllLEDs(LEDMASK_USB_READY);
 	USB_Host_SetDeviceConfiguration(0);
 }
@@ -51,6 +51,8 @@
 		#include <LUFA/Drivers/USB/USB.h>
 		#include <LUFA/Platform/Platform.h>
 
+		#include "Lib/FATFs/ff.h"
+
 	/* Macros: */
 		/** LED mask for the library LED driver, to indicate that the USB interface is not ready. */
 		#define LEDMASK_USB_NOTREADY      LEDS_LED1
@@ -67,6 +69,15 @@
 		/** LED mask for the library LED driver, to indicate that the USB interface is busy. */
 		#define LEDMASK_USB_BUSY          LEDS_LED2
 
+		/** Name of the log file appended to on the attached disk's FAT formatted partition. */
+		#define LOG_FILE_NAME             "LOGFILE.TXT"
+
+		/** Number of lines appended to the log file each time a disk is attached. */
+		#define LOG_FILE_LINES            256
+
+	/* External Variables: */
+		extern USB_ClassInfo_MS_Host_t FlashDisk_MS_Interface;
+
 	/* Function Prototypes: */
 		void SetupHardware(void);
 		void MassStorageHost_Task(void);
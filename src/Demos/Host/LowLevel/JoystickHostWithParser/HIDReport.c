@@ -36,6 +36,9 @@ uint16_t         HIDReportSize;
 /** Processed HID report descriptor items structure, containing information on each HID report element */
 HID_ReportInfo_t HIDReportInfo;
 
+/** Extraction plan of the joystick's IN report items, compiled from the processed HID report descriptor items */
+HID_ReportPlan_t HIDReportPlan;
+
 
 /** Function to read in the HID report descriptor from the attached device, and process it into easy-to-read
  *  structures via the HID parser routines in the LUFA library.
@@ -67,6 +70,10 @@ uint8_t GetHIDReportData(void)
 	if (USB_ProcessHIDReport(HIDReportData, HIDReportSize, &HIDReportInfo) != HID_PARSE_Successful)
 	  return ParseError;
 
+	/* Compile the parsed IN items, so that each report can be decoded in a single pass */
+	if (USB_CompileHIDReportPlan(&HIDReportInfo, HID_REPORT_ITEM_In, &HIDReportPlan) != HID_PARSE_Successful)
+	  return ParseError;
+
 	return ParseSuccessful;
 }
 
@@ -69,6 +69,7 @@
 	/* External Variables: */
 		extern uint16_t         HIDReportSize;
 		extern HID_ReportInfo_t HIDReportInfo;
+		extern HID_ReportPlan_t HIDReportPlan;
 
 	/* Function Prototypes: */
 		uint8_t GetHIDReportData(void);
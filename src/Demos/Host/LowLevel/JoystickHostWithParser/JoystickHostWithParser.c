@@ -196,10 +196,10 @@ void JoystickHost_Task(void)
 			uint8_t JoystickReport[Pipe_BytesInPipe()];
 
 			/* Load in the joystick report */
-			Pipe_Read_Stream_LE(JoystickReport, Pipe_BytesInPipe(), NULL);
+			Pipe_Read_Stream_LE(JoystickReport, sizeof(JoystickReport), NULL);
 
 			/* Process the read in joystick report from the device */
-			ProcessJoystickReport(JoystickReport);
+			ProcessJoystickReport(JoystickReport, sizeof(JoystickReport));
 		}
 
 		/* Clear the IN endpoint, ready for next data packet */
@@ -214,10 +214,17 @@ void JoystickHost_Task(void)
  *  as required and displays movement and button presses on the board LEDs.
  *
  *  \param[in] JoystickReport  Pointer to a HID report from an attached joystick device
+ *  \param[in] ReportSize      Size in bytes of the HID report
  */
-void ProcessJoystickReport(uint8_t* JoystickReport)
+void ProcessJoystickReport(uint8_t* JoystickReport,
+                           const uint16_t ReportSize)
 {
-	uint8_t LEDMask = LEDS_NO_LEDS;
+	uint8_t  LEDMask = LEDS_NO_LEDS;
+	uint32_t ReportValues[HID_MAX_REPORTITEMS];
+
+	/* Extract every joystick item in the report at once - reports with no joystick items are ignored */
+	if (!(USB_DecodeHIDReport(&HIDReportPlan, JoystickReport, ReportSize, ReportValues)))
+	  return;
 
 	/* Check each HID report item in turn, looking for joystick X/Y/button reports */
 	for (uint8_t ReportNumber = 0; ReportNumber < HIDReportInfo.TotalReportItems; ReportNumber++)
@@ -225,20 +232,15 @@ void ProcessJoystickReport(uint8_t* JoystickReport)
 		/* Create a temporary item pointer to the next report item */
 		HID_ReportItem_t* ReportItem = &HIDReportInfo.ReportItems[ReportNumber];
 
-		bool FoundData;
+		/* For multi-report devices - if the item was not in the issued report, continue */
+		if (ReportItem->ReportID && (ReportItem->ReportID != JoystickReport[0]))
+		  continue;
 
 		if ((ReportItem->Attributes.Usage.Page        == USAGE_PAGE_BUTTON) &&
 			(ReportItem->ItemType                     == HID_REPORT_ITEM_In))
 		{
-			/* Get the joystick button value */
-			FoundData = USB_GetHIDReportItemInfo(JoystickReport, ReportItem);
-
-			/* For multi-report devices - if the requested data was not in the issued report, continue */
-			if (!(FoundData))
-			  continue;
-
 			/* If button is pressed, all LEDs are turned on */
-			if (ReportItem->Value)
+			if (ReportValues[ReportNumber])
 			  LEDMask = LEDS_ALL_LEDS;
 		}
 		else if ((ReportItem->Attributes.Usage.Page   == USAGE_PAGE_GENERIC_DCTRL) &&
@@ -246,14 +248,8 @@ void ProcessJoystickReport(uint8_t* JoystickReport)
 				  (ReportItem->Attributes.Usage.Usage == USAGE_Y))                 &&
 				 (ReportItem->ItemType                == HID_REPORT_ITEM_In))
 		{
-			/* Get the joystick relative position value */
-			FoundData = USB_GetHIDReportItemInfo(JoystickReport, ReportItem);
-
-			/* For multi-report devices - if the requested data was not in the issued report, continue */
-			if (!(FoundData))
-			  continue;
-
-			int16_t DeltaMovement = HID_ALIGN_DATA(ReportItem, int16_t);
+			/* Joystick position value is already sign extended if the device reports it as signed */
+			int16_t DeltaMovement = (int16_t)ReportValues[ReportNumber];
 
 			/* Check to see if a (non-zero) delta movement has been indicated */
 			if (DeltaMovement)
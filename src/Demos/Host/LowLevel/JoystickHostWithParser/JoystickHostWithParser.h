@@ -77,7 +77,8 @@
 		                                            const uint8_t SubErrorCode);
 		void EVENT_USB_Host_DeviceEnumerationComplete(void);
 
-		void ProcessJoystickReport(uint8_t* JoystickReport);
+		void ProcessJoystickReport(uint8_t* JoystickReport,
+		                           const uint16_t ReportSize);
 
 #endif
 
@@ -0,0 +1,540 @@
+"""
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+"""
+
+"""
+    Web asset bundle generator for the LUFA embedded webservers. This script
+    packs every file in a web root directory into a pair of C source files
+    holding the files as FLASH resident, pre-encoded assets, so that a
+    webserver can serve them without a filesystem or any per-request parsing.
+
+    Each asset is gzip compressed where doing so makes it smaller, and is
+    stored alongside a precomputed block of HTTP response headers giving its
+    Content-Type, Content-Encoding, Content-Length and ETag. Assets are
+    located at runtime through a perfect hash table, so that a lookup costs a
+    single hash of the requested path and one string comparison. Compressed
+    assets may only be sent to clients whose Accept-Encoding request header
+    accepts gzip, which the webserver checks with the generated
+    WebAssets_IsEncodingAccepted() function.
+
+    Usage:
+        python http_asset_packer.py <Web_Root> <Output_Base>
+
+    Example:
+        python http_asset_packer.py WebRoot Lib/WebAssets
+
+    The example above generates Lib/WebAssets.c and Lib/WebAssets.h from the
+    contents of the WebRoot directory.
+"""
+
+import sys
+import os
+import gzip
+import hashlib
+
+# MIME types of each supported file extension, others are sent as plain text
+mime_types = {
+    "htm":  "text/html",
+    "html": "text/html",
+    "css":  "text/css",
+    "js":   "application/javascript",
+    "json": "application/json",
+    "txt":  "text/plain",
+    "xml":  "text/xml",
+    "svg":  "image/svg+xml",
+    "jpg":  "image/jpeg",
+    "gif":  "image/gif",
+    "bmp":  "image/bmp",
+    "png":  "image/png",
+    "ico":  "image/x-icon",
+    "exe":  "application/octet-stream",
+    "gz":   "application/x-gzip",
+    "zip":  "application/zip",
+    "pdf":  "application/pdf",
+}
+default_mime_type = "text/plain"
+
+# Largest number of hash table slots, limited by the 8-bit asset indexes
+max_hash_slots = 256
+
+license_header = """/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+"""
+
+header_template = license_header + """
+/** \\file
+ *
+ *  Header file for WebAssets.c.
+ *
+ *  This file was generated by http_asset_packer.py and should not be edited directly. Modify the files in the
+ *  web root directory instead, and regenerate the bundle from them.
+ */
+
+#ifndef _WEB_ASSETS_H_
+#define _WEB_ASSETS_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of assets stored in the bundle. */
+		#define WEB_ASSETS_TOTAL_ASSETS     {asset_count}
+
+	/* Type Defines: */
+		/** Type define for an asset stored in the web asset bundle. All pointers reference FLASH memory. */
+		typedef struct
+		{{
+			const char*    Path; /**< Path of the asset relative to the web root, without a leading '/' */
+			const char*    Headers; /**< HTTP response header lines describing the encoded asset */
+			const char*    ETag; /**< Quoted HTTP entity tag of the asset's contents */
+			const uint8_t* Data; /**< Asset contents, gzip encoded if indicated by the response headers */
+			uint16_t       Length; /**< Length in bytes of the asset contents */
+			bool           IsGzipEncoded; /**< Indicates if the asset contents are gzip encoded */
+		}} WebAsset_t;
+
+	/* Function Prototypes: */
+		bool WebAssets_Find(const char* Path,
+		                    const uint8_t PathLength,
+		                    WebAsset_t* const Asset);
+		bool WebAssets_MatchETag(const WebAsset_t* const Asset,
+		                         const char* ETag,
+		                         const uint8_t ETagLength);
+		bool WebAssets_IsEncodingAccepted(const WebAsset_t* const Asset,
+		                                  const char* AcceptEncoding,
+		                                  uint8_t AcceptEncodingLength);
+
+#endif
+
+"""
+
+source_template = license_header + """
+/** \\file
+ *
+ *  Web asset bundle, holding the contents of the web root directory as pre-encoded assets in FLASH memory.
+ *
+ *  This file was generated by http_asset_packer.py and should not be edited directly. Modify the files in the
+ *  web root directory instead, and regenerate the bundle from them.
+ */
+
+#include "WebAssets.h"
+
+/** Seed of the path hash function, chosen so that no two asset paths hash to the same slot. */
+#define WEB_ASSETS_HASH_SEED        {hash_seed}
+
+/** Number of slots in the asset hash table, a power of two. */
+#define WEB_ASSETS_HASH_SLOTS       {hash_slots}
+
+/** Value of an asset hash table slot which does not hold an asset. */
+#define WEB_ASSETS_EMPTY_SLOT       0xFF
+
+/** Accept-Encoding header element which does not refer to the gzip content coding. */
+#define WEB_ASSETS_CODING_NONE      0
+
+/** Accept-Encoding header element which names the gzip content coding. */
+#define WEB_ASSETS_CODING_NAMED     1
+
+/** Accept-Encoding header element which refers to the gzip content coding through the "*" wildcard. */
+#define WEB_ASSETS_CODING_WILDCARD  2
+
+{asset_data}/** Table of the assets stored in the bundle. */
+static const WebAsset_t PROGMEM AssetTable[WEB_ASSETS_TOTAL_ASSETS] =
+	{{
+{asset_table}	}};
+
+/** Perfect hash table of asset indexes, indexed by the hash of each asset's path. */
+static const uint8_t PROGMEM AssetHashTable[WEB_ASSETS_HASH_SLOTS] =
+	{{
+{hash_table}	}};
+
+
+/** Hashes the given path to locate its slot in the asset hash table.
+ *
+ *  \\param[in] Path        Path to hash
+ *  \\param[in] PathLength  Length of the path in characters
+ *
+ *  \\return Hash of the given path
+ */
+static uint16_t WebAssets_HashPath(const char* Path,
+                                   uint8_t PathLength)
+{{
+	uint16_t Hash = WEB_ASSETS_HASH_SEED;
+
+	while (PathLength--)
+	  Hash = (((Hash << 5) + Hash) ^ (uint8_t)*(Path++));
+
+	return Hash;
+}}
+
+/** Compares a string in RAM of the given length against a null terminated string stored in FLASH memory.
+ *
+ *  \\param[in] String        String in RAM to compare, which need not be null terminated
+ *  \\param[in] StringLength  Length of the string in RAM in characters
+ *  \\param[in] FlashString   Null terminated string in FLASH to compare against
+ *
+ *  \\return Boolean \\c true if the two strings are identical, \\c false otherwise
+ */
+static bool WebAssets_CompareString(const char* String,
+                                    uint8_t StringLength,
+                                    const char* FlashString)
+{{
+	while (StringLength--)
+	{{
+		if ((uint8_t)*(String++) != pgm_read_byte(FlashString++))
+		  return false;
+	}}
+
+	return (pgm_read_byte(FlashString) == '\\0');
+}}
+
+/** Locates the asset stored under the given path in the bundle.
+ *
+ *  \\param[in]  Path        Path of the asset relative to the web root without a leading '/', need not be null terminated
+ *  \\param[in]  PathLength  Length of the path in characters
+ *  \\param[out] Asset       Pointer to a location where the located asset's information is to be stored
+ *
+ *  \\return Boolean \\c true if the asset was found, \\c false otherwise
+ */
+bool WebAssets_Find(const char* Path,
+                    const uint8_t PathLength,
+                    WebAsset_t* const Asset)
+{{
+	uint8_t AssetIndex = pgm_read_byte(&AssetHashTable[WebAssets_HashPath(Path, PathLength) & (WEB_ASSETS_HASH_SLOTS - 1)]);
+
+	if (AssetIndex == WEB_ASSETS_EMPTY_SLOT)
+	  return false;
+
+	memcpy_P(Asset, &AssetTable[AssetIndex], sizeof(WebAsset_t));
+
+	/* Each slot holds the only asset that hashes to it, confirm that it is the one requested */
+	return WebAssets_CompareString(Path, PathLength, Asset->Path);
+}}
+
+/** Determines if an entity tag supplied by the client, such as in a HTTP If-None-Match request header, matches the
+ *  current contents of an asset.
+ *
+ *  \\param[in] Asset       Pointer to the asset to compare against
+ *  \\param[in] ETag        Quoted entity tag supplied by the client, need not be null terminated
+ *  \\param[in] ETagLength  Length of the entity tag in characters
+ *
+ *  \\return Boolean \\c true if the client's copy of the asset is current, \\c false otherwise
+ */
+bool WebAssets_MatchETag(const WebAsset_t* const Asset,
+                         const char* ETag,
+                         const uint8_t ETagLength)
+{{
+	return WebAssets_CompareString(ETag, ETagLength, Asset->ETag);
+}}
+
+/** Determines if an element of a HTTP Accept-Encoding request header refers to the gzip content coding, either by name or
+ *  through the "*" wildcard, and if so whether it accepts the coding, i.e. does not give it a quality value of zero.
+ *
+ *  \\param[in]  Element        Element of the header's comma separated list, need not be null terminated
+ *  \\param[in]  ElementLength  Length of the element in characters
+ *  \\param[out] IsAccepted     Set to \\c true if the element's quality value is non-zero, when the element refers to gzip
+ *
+ *  \\return One of the \\c WEB_ASSETS_CODING_* values, giving how the element refers to the gzip coding
+ */
+static uint8_t WebAssets_MatchGzipCoding(const char* Element,
+                                         const uint8_t ElementLength,
+                                         bool* const IsAccepted)
+{{
+	uint8_t Match;
+	uint8_t Start = 0;
+	uint8_t End;
+
+	while ((Start < ElementLength) && ((Element[Start] == ' ') || (Element[Start] == '\\t')))
+	  Start++;
+
+	End = Start;
+
+	/* Coding name runs to the start of its parameters or the whitespace following it */
+	while ((End < ElementLength) && (Element[End] != ';') && (Element[End] != ' ') && (Element[End] != '\\t'))
+	  End++;
+
+	if ((((End - Start) == 4) && (strncasecmp(&Element[Start], "gzip", 4) == 0)) ||
+	    (((End - Start) == 6) && (strncasecmp(&Element[Start], "x-gzip", 6) == 0)))
+	{{
+		Match = WEB_ASSETS_CODING_NAMED;
+	}}
+	else if (((End - Start) == 1) && (Element[Start] == '*'))
+	{{
+		Match = WEB_ASSETS_CODING_WILDCARD;
+	}}
+	else
+	{{
+		return WEB_ASSETS_CODING_NONE;
+	}}
+
+	*IsAccepted = true;
+
+	/* Search the coding's parameters for a quality value, which rejects the coding if it is zero */
+	for (uint8_t i = End; i < ElementLength; i++)
+	{{
+		if (Element[i] != ';')
+		  continue;
+
+		while (((i + 1) < ElementLength) && ((Element[i + 1] == ' ') || (Element[i + 1] == '\\t')))
+		  i++;
+
+		if (((i + 3) > ElementLength) || ((Element[i + 1] != 'q') && (Element[i + 1] != 'Q')) || (Element[i + 2] != '='))
+		  continue;
+
+		i += 3;
+
+		if ((i == ElementLength) || (Element[i] != '0'))
+		  break;
+
+		/* Any non-zero digit after the leading zero gives a non-zero quality value */
+		while ((++i < ElementLength) && ((Element[i] == '0') || (Element[i] == '.')));
+
+		*IsAccepted = ((i < ElementLength) && (Element[i] >= '1') && (Element[i] <= '9'));
+		break;
+	}}
+
+	return Match;
+}}
+
+/** Determines if an asset may be sent to a client, given the contents of the HTTP Accept-Encoding header of its request.
+ *  Assets which are stored gzip encoded may only be sent to clients which accept that coding; a client which does not
+ *  send the header is assumed to accept only uncompressed content.
+ *
+ *  \\param[in] Asset                 Pointer to the asset to be sent
+ *  \\param[in] AcceptEncoding        Value of the client's Accept-Encoding header, or \\c NULL if the request has none
+ *  \\param[in] AcceptEncodingLength  Length of the header value in characters
+ *
+ *  \\return Boolean \\c true if the asset may be sent to the client, \\c false otherwise
+ */
+bool WebAssets_IsEncodingAccepted(const WebAsset_t* const Asset,
+                                  const char* AcceptEncoding,
+                                  uint8_t AcceptEncodingLength)
+{{
+	bool IsNamed            = false;
+	bool IsNamedAccepted    = false;
+	bool IsWildcardAccepted = false;
+
+	if (!(Asset->IsGzipEncoded))
+	  return true;
+
+	if (AcceptEncoding == NULL)
+	  return false;
+
+	/* Every element of the header's comma separated list is checked, as naming gzip overrides the "*" wildcard */
+	while (AcceptEncodingLength)
+	{{
+		uint8_t ElementLength = 0;
+		bool    IsAccepted    = false;
+
+		while ((ElementLength < AcceptEncodingLength) && (AcceptEncoding[ElementLength] != ','))
+		  ElementLength++;
+
+		switch (WebAssets_MatchGzipCoding(AcceptEncoding, ElementLength, &IsAccepted))
+		{{
+			case WEB_ASSETS_CODING_NAMED:
+				IsNamed          = true;
+				IsNamedAccepted |= IsAccepted;
+				break;
+			case WEB_ASSETS_CODING_WILDCARD:
+				IsWildcardAccepted |= IsAccepted;
+				break;
+		}}
+
+		if (ElementLength < AcceptEncodingLength)
+		  ElementLength++;
+
+		AcceptEncoding       += ElementLength;
+		AcceptEncodingLength -= ElementLength;
+	}}
+
+	return (IsNamed ? IsNamedAccepted : IsWildcardAccepted);
+}}
+
+"""
+
+
+def hash_path(path, seed):
+    path_hash = seed
+
+    for char in path.encode("ascii"):
+        path_hash = (((path_hash << 5) + path_hash) ^ char) & 0xFFFF
+
+    return path_hash
+
+
+def find_perfect_hash(paths):
+    hash_slots = 1
+    while hash_slots < len(paths):
+        hash_slots *= 2
+
+    while hash_slots <= max_hash_slots:
+        for seed in range(0x10000):
+            slots = [hash_path(path, seed) & (hash_slots - 1) for path in paths]
+
+            if len(set(slots)) == len(slots):
+                return seed, hash_slots
+
+        hash_slots *= 2
+
+    return None, None
+
+
+def load_assets(web_root):
+    assets = []
+
+    for directory, subdirectories, files in os.walk(web_root):
+        subdirectories.sort()
+
+        for file_name in sorted(files):
+            file_path = os.path.join(directory, file_name)
+            asset_path = os.path.relpath(file_path, web_root).replace(os.sep, "/")
+
+            with open(file_path, "rb") as asset_file:
+                contents = asset_file.read()
+
+            extension = os.path.splitext(file_name)[1][1:].lower()
+            mime_type = mime_types.get(extension, default_mime_type)
+
+            # Only keep the compressed contents if they are actually smaller
+            encoded = gzip.compress(contents, compresslevel=9, mtime=0)
+            compressed = len(encoded) < len(contents)
+            if not compressed:
+                encoded = contents
+
+            if len(encoded) > 0xFFFF:
+                print("Asset \"%s\" is too large to be stored in the bundle." % asset_path)
+                sys.exit(1)
+
+            etag = "\"%s\"" % hashlib.sha1(contents).hexdigest()[:16]
+
+            headers = "Content-Type: %s\r\n" % mime_type
+            if compressed:
+                headers += "Content-Encoding: gzip\r\n"
+                headers += "Vary: Accept-Encoding\r\n"
+            headers += "Content-Length: %d\r\n" % len(encoded)
+            headers += "ETag: %s\r\n" % etag
+
+            assets.append({"path": asset_path, "headers": headers,
+                           "etag": etag, "data": encoded, "compressed": compressed,
+                           "original_length": len(contents)})
+
+    return assets
+
+
+def c_string(string):
+    return "\"%s\"" % string.replace("\\", "\\\\").replace("\"", "\\\"") \
+                            .replace("\r", "\\r").replace("\n", "\\n")
+
+
+def generate_asset_data(assets):
+    asset_data = ""
+
+    for index, asset in enumerate(assets):
+        asset_data += "/* Asset %d: %s (%d bytes, encoded to %d bytes) */\n" % \
+                      (index, asset["path"], asset["original_length"], len(asset["data"]))
+        asset_data += "static const char    PROGMEM Asset%dPath[]    = %s;\n" % (index, c_string(asset["path"]))
+        asset_data += "static const char    PROGMEM Asset%dHeaders[] = %s;\n" % (index, c_string(asset["headers"]))
+        asset_data += "static const char    PROGMEM Asset%dETag[]    = %s;\n" % (index, c_string(asset["etag"]))
+        asset_data += "static const uint8_t PROGMEM Asset%dData[]    =\n\t{\n" % index
+
+        for offset in range(0, len(asset["data"]), 16):
+            line = asset["data"][offset : offset + 16]
+            asset_data += "\t\t" + " ".join("0x%02X," % byte for byte in line) + "\n"
+
+        asset_data += "\t};\n\n"
+
+    return asset_data
+
+
+def generate_asset_table(assets):
+    asset_table = ""
+
+    for index, asset in enumerate(assets):
+        asset_table += "\t\t{.Path = Asset%dPath, .Headers = Asset%dHeaders, .ETag = Asset%dETag, .Data = Asset%dData, .Length = %d, .IsGzipEncoded = %s},\n" % \
+                       (index, index, index, index, len(asset["data"]), "true" if asset["compressed"] else "false")
+
+    return asset_table
+
+
+def generate_hash_table(assets, seed, hash_slots):
+    slot_assets = ["WEB_ASSETS_EMPTY_SLOT"] * hash_slots
+
+    for index, asset in enumerate(assets):
+        slot_assets[hash_path(asset["path"], seed) & (hash_slots - 1)] = str(index)
+
+    hash_table = ""
+    for offset in range(0, hash_slots, 8):
+        hash_table += "\t\t" + " ".join("%s," % slot for slot in slot_assets[offset : offset + 8]) + "\n"
+
+    return hash_table
+
+
+def main(web_root, output_base):
+    assets = load_assets(web_root)
+
+    if len(assets) == 0:
+        print("No assets found in web root \"%s\"." % web_root)
+        sys.exit(1)
+
+    if len(assets) >= max_hash_slots:
+        print("Too many assets in web root \"%s\", a bundle may hold at most %d." % (web_root, max_hash_slots - 1))
+        sys.exit(1)
+
+    seed, hash_slots = find_perfect_hash([asset["path"] for asset in assets])
+
+    if seed is None:
+        print("Unable to find a perfect hash for the asset paths.")
+        sys.exit(1)
+
+    with open(output_base + ".h", "w", newline="\n") as header_file:
+        header_file.write(header_template.format(asset_count=len(assets)))
+
+    with open(output_base + ".c", "w", newline="\n") as source_file:
+        source_file.write(source_template.format(hash_seed="0x%04X" % seed, hash_slots=hash_slots,
+                                                 asset_data=generate_asset_data(assets),
+                                                 asset_table=generate_asset_table(assets),
+                                                 hash_table=generate_hash_table(assets, seed, hash_slots)))
+
+    for asset in assets:
+        print("Packed \"%s\": %d bytes, encoded to %d bytes." %
+              (asset["path"], asset["original_length"], len(asset["data"])))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print("Usage: python %s <Web_Root> <Output_Base>" % os.path.basename(sys.argv[0]))
+        sys.exit(1)
+
+    main(sys.argv[1], sys.argv[2])
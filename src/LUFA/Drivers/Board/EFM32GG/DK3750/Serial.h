@@ -62,6 +62,12 @@ extern "C" {
 /** UART PORT in STK3750 is UART1 */
 #define UART_PORT          UART1
 
+/** DMA request signal raised when UART_PORT has received data */
+#define UART_DMAREQ_RX     DMAREQ_UART1_RXDATAV
+
+/** DMA request signal raised when UART_PORT has room in its transmit buffer */
+#define UART_DMAREQ_TX     DMAREQ_UART1_TXBL
+
 /* Inline Functions: */
 #if !defined(__DOXYGEN__)
 /**************************************************************************//**
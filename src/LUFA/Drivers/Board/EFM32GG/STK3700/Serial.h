@@ -62,6 +62,12 @@ extern "C" {
 /** UART PORT in STK3700 is USART1 */
 #define UART_PORT          USART1
 
+/** DMA request signal raised when UART_PORT has received data */
+#define UART_DMAREQ_RX     DMAREQ_USART1_RXDATAV
+
+/** DMA request signal raised when UART_PORT has room in its transmit buffer */
+#define UART_DMAREQ_TX     DMAREQ_USART1_TXBL
+
 /* Inline Functions: */
 #if !defined(__DOXYGEN__)
 /**************************************************************************//**
@@ -57,6 +57,11 @@
  *  or deletions) must not overlap. If there is possibility of two or more of the same kind of
  *  operating occurring at the same point in time, atomic (mutex) locking should be used.
  *
+ *  A second, lock-free variant (\ref RingBufferSPSC_t) is provided for the common case of exactly one
+ *  producer and one consumer, such as a UART ISR feeding the main loop. It never disables interrupts,
+ *  requires a power of two buffer size, and can insert or remove whole blocks at once, either by
+ *  copying or by handing out the contiguous span of the buffer for use by \c memcpy() or a DMA engine.
+ *
  *  \section Sec_RingBuff_ExampleUsage Example Usage
  *  The following snippet is an example of how this module may be used within a typical
  *  application.
@@ -87,6 +92,29 @@
  *        putc(RingBuffer_Remove(&Buffer));
  *  \endcode
  *
+ *  The lock-free variant is used in the same way, with the addition of the block and span operations:
+ *
+ *  \code
+ *      // Create the buffer structure and its underlying storage array, which must be a power of two in size
+ *      RingBufferSPSC_t Buffer;
+ *      uint8_t          BufferData[128];
+ *
+ *      RingBufferSPSC_InitBuffer(&Buffer, BufferData, sizeof(BufferData));
+ *
+ *      // Producer (e.g. a UART receive ISR) inserts a whole block
+ *      RingBufferSPSC_InsertBlock(&Buffer, "HELLO", 5);
+ *
+ *      // Consumer sends the stored data straight from the buffer, one contiguous span at a time
+ *      const uint8_t* Span;
+ *      uint16_t       SpanLength;
+ *
+ *      while ((SpanLength = RingBufferSPSC_GetRemoveSpan(&Buffer, &Span)) != 0)
+ *      {
+ *          fwrite(Span, 1, SpanLength, stdout);
+ *          RingBufferSPSC_CommitRemove(&Buffer, SpanLength);
+ *      }
+ *  \endcode
+ *
  *  @{
  */
 
@@ -117,6 +145,22 @@
 			uint16_t Count; /**< Number of bytes currently stored in the buffer. */
 		} RingBuffer_t;
 
+		/** \brief Lock-free Single Producer, Single Consumer Ring Buffer Management Structure.
+		 *
+		 *  Type define for a new lock-free ring buffer object. Buffers should be initialized via a call to
+		 *  \ref RingBufferSPSC_InitBuffer() before use.
+		 *
+		 *  The head and tail are free running byte counters of the machine register width, each written by
+		 *  only one side, so that neither side ever needs to disable interrupts to update them.
+		 */
+		typedef struct
+		{
+			uint8_t*            Data; /**< Pointer to the start of the buffer's underlying storage array. */
+			uint_reg_t          Mask; /**< Size of the buffer's underlying storage array, minus one. */
+			volatile uint_reg_t Head; /**< Total bytes ever inserted, written only by the producer. */
+			volatile uint_reg_t Tail; /**< Total bytes ever removed, written only by the consumer. */
+		} RingBufferSPSC_t;
+
 	/* Inline Functions: */
 		/** Initializes a ring buffer ready for use. Buffers must be initialized via this function
 		 *  before any operations are called upon them. Already initialized buffers may be reset
@@ -297,6 +341,296 @@
 			return *Buffer->Out;
 		}
 
+		/** Initializes a lock-free ring buffer ready for use. Buffers must be initialized via this function
+		 *  before any operations are called upon them, and must not be in use by either side while being
+		 *  (re-)initialized.
+		 *
+		 *  \note The size of the storage array must be a power of two, and may be at most half the range of
+		 *        the architecture's \c uint_reg_t type (i.e. 128 bytes on 8-bit AVR architectures).
+		 *
+		 *  \param[out] Buffer   Pointer to a ring buffer structure to initialize.
+		 *  \param[out] DataPtr  Pointer to a global array that will hold the data stored into the ring buffer.
+		 *  \param[out] Size     Number of bytes in the underlying data array, a power of two.
+		 */
+		static inline void RingBufferSPSC_InitBuffer(RingBufferSPSC_t* Buffer,
+		                                             uint8_t* const DataPtr,
+		                                             const uint16_t Size) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline void RingBufferSPSC_InitBuffer(RingBufferSPSC_t* Buffer,
+		                                             uint8_t* const DataPtr,
+		                                             const uint16_t Size)
+		{
+			Buffer->Data = DataPtr;
+			Buffer->Mask = (Size - 1);
+			Buffer->Head = 0;
+			Buffer->Tail = 0;
+		}
+
+		/** Retrieves the current number of bytes stored in a lock-free buffer. When called by the consumer
+		 *  this is the minimum number of bytes that may be removed, as the producer may be inserting more.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure whose count is to be computed.
+		 *
+		 *  \return Number of bytes currently stored in the buffer.
+		 */
+		static inline uint16_t RingBufferSPSC_GetCount(RingBufferSPSC_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBufferSPSC_GetCount(RingBufferSPSC_t* const Buffer)
+		{
+			return (uint_reg_t)(Buffer->Head - Buffer->Tail);
+		}
+
+		/** Retrieves the free space in a lock-free buffer. When called by the producer this is the minimum
+		 *  number of bytes that may be inserted, as the consumer may be removing more.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure whose free count is to be computed.
+		 *
+		 *  \return Number of free bytes in the buffer.
+		 */
+		static inline uint16_t RingBufferSPSC_GetFreeCount(RingBufferSPSC_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBufferSPSC_GetFreeCount(RingBufferSPSC_t* const Buffer)
+		{
+			return ((uint16_t)Buffer->Mask + 1) - RingBufferSPSC_GetCount(Buffer);
+		}
+
+		/** Determines if the specified lock-free ring buffer contains any data.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure to check.
+		 *
+		 *  \return Boolean \c true if the buffer contains no data, \c false otherwise.
+		 */
+		static inline bool RingBufferSPSC_IsEmpty(RingBufferSPSC_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool RingBufferSPSC_IsEmpty(RingBufferSPSC_t* const Buffer)
+		{
+			return (Buffer->Head == Buffer->Tail);
+		}
+
+		/** Determines if the specified lock-free ring buffer contains any free space.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure to check.
+		 *
+		 *  \return Boolean \c true if the buffer contains no free space, \c false otherwise.
+		 */
+		static inline bool RingBufferSPSC_IsFull(RingBufferSPSC_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool RingBufferSPSC_IsFull(RingBufferSPSC_t* const Buffer)
+		{
+			return (RingBufferSPSC_GetCount(Buffer) > Buffer->Mask);
+		}
+
+		/** Retrieves the largest contiguous span of free space in a lock-free buffer, starting at the current
+		 *  insertion point, so that it may be filled directly (e.g. by \c memcpy() or a DMA engine). Once
+		 *  filled, the data is made visible to the consumer with \ref RingBufferSPSC_CommitInsert().
+		 *
+		 *  \warning Only the producer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[out]    Span    Location to store the start of the free span.
+		 *
+		 *  \return Number of bytes which may be written to the span.
+		 */
+		static inline uint16_t RingBufferSPSC_GetInsertSpan(RingBufferSPSC_t* const Buffer,
+		                                                    uint8_t** const Span) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBufferSPSC_GetInsertSpan(RingBufferSPSC_t* const Buffer,
+		                                                    uint8_t** const Span)
+		{
+			uint16_t Offset = (Buffer->Head & Buffer->Mask);
+			uint16_t ToEnd  = ((uint16_t)Buffer->Mask + 1) - Offset;
+
+			*Span = &Buffer->Data[Offset];
+			return MIN(RingBufferSPSC_GetFreeCount(Buffer), ToEnd);
+		}
+
+		/** Makes the given number of bytes, written to the span returned by \ref RingBufferSPSC_GetInsertSpan(),
+		 *  available to the consumer.
+		 *
+		 *  \warning Only the producer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Length  Number of bytes written, no larger than the span length.
+		 */
+		static inline void RingBufferSPSC_CommitInsert(RingBufferSPSC_t* const Buffer,
+		                                               const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBufferSPSC_CommitInsert(RingBufferSPSC_t* const Buffer,
+		                                               const uint16_t Length)
+		{
+			/* Data must be in the buffer before the consumer can see the new head */
+			GCC_MEMORY_BARRIER();
+			Buffer->Head = (uint_reg_t)(Buffer->Head + Length);
+		}
+
+		/** Retrieves the largest contiguous span of stored data in a lock-free buffer, starting at the current
+		 *  removal point, so that it may be read directly (e.g. by \c memcpy() or a DMA engine). Once consumed,
+		 *  the space is handed back to the producer with \ref RingBufferSPSC_CommitRemove().
+		 *
+		 *  \warning Only the consumer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out]    Span    Location to store the start of the stored span.
+		 *
+		 *  \return Number of bytes which may be read from the span.
+		 */
+		static inline uint16_t RingBufferSPSC_GetRemoveSpan(RingBufferSPSC_t* const Buffer,
+		                                                    const uint8_t** const Span) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBufferSPSC_GetRemoveSpan(RingBufferSPSC_t* const Buffer,
+		                                                    const uint8_t** const Span)
+		{
+			uint16_t Offset = (Buffer->Tail & Buffer->Mask);
+			uint16_t ToEnd  = ((uint16_t)Buffer->Mask + 1) - Offset;
+			uint16_t Count  = RingBufferSPSC_GetCount(Buffer);
+
+			/* Stored data must not be read before the head that published it */
+			GCC_MEMORY_BARRIER();
+
+			*Span = &Buffer->Data[Offset];
+			return MIN(Count, ToEnd);
+		}
+
+		/** Releases the given number of bytes, read from the span returned by \ref RingBufferSPSC_GetRemoveSpan(),
+		 *  back to the producer.
+		 *
+		 *  \warning Only the consumer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[in]     Length  Number of bytes read, no larger than the span length.
+		 */
+		static inline void RingBufferSPSC_CommitRemove(RingBufferSPSC_t* const Buffer,
+		                                               const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBufferSPSC_CommitRemove(RingBufferSPSC_t* const Buffer,
+		                                               const uint16_t Length)
+		{
+			/* Data must be read out before the producer may overwrite it */
+			GCC_MEMORY_BARRIER();
+			Buffer->Tail = (uint_reg_t)(Buffer->Tail + Length);
+		}
+
+		/** Inserts an element into the lock-free ring buffer. The caller must first ensure that the buffer
+		 *  is not full.
+		 *
+		 *  \warning Only the producer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Data    Data element to insert into the buffer.
+		 */
+		static inline void RingBufferSPSC_Insert(RingBufferSPSC_t* const Buffer,
+		                                         const uint8_t Data) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBufferSPSC_Insert(RingBufferSPSC_t* const Buffer,
+		                                         const uint8_t Data)
+		{
+			Buffer->Data[Buffer->Head & Buffer->Mask] = Data;
+			RingBufferSPSC_CommitInsert(Buffer, 1);
+		}
+
+		/** Removes an element from the lock-free ring buffer. The caller must first ensure that the buffer
+		 *  is not empty.
+		 *
+		 *  \warning Only the consumer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *
+		 *  \return Next data element stored in the buffer.
+		 */
+		static inline uint8_t RingBufferSPSC_Remove(RingBufferSPSC_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint8_t RingBufferSPSC_Remove(RingBufferSPSC_t* const Buffer)
+		{
+			/* Stored data must not be read before the head that published it */
+			GCC_MEMORY_BARRIER();
+
+			uint8_t Data = Buffer->Data[Buffer->Tail & Buffer->Mask];
+
+			RingBufferSPSC_CommitRemove(Buffer, 1);
+			return Data;
+		}
+
+		/** Returns the next element stored in the lock-free ring buffer, without removing it.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *
+		 *  \return Next data element stored in the buffer.
+		 */
+		static inline uint8_t RingBufferSPSC_Peek(RingBufferSPSC_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint8_t RingBufferSPSC_Peek(RingBufferSPSC_t* const Buffer)
+		{
+			GCC_MEMORY_BARRIER();
+
+			return Buffer->Data[Buffer->Tail & Buffer->Mask];
+		}
+
+		/** Inserts as much of a block of data as will fit into the lock-free ring buffer, using at most two
+		 *  \c memcpy() operations.
+		 *
+		 *  \warning Only the producer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Data    Pointer to the block of data to insert.
+		 *  \param[in]     Length  Number of bytes in the block.
+		 *
+		 *  \return Number of bytes actually inserted.
+		 */
+		static inline uint16_t RingBufferSPSC_InsertBlock(RingBufferSPSC_t* const Buffer,
+		                                                  const void* Data,
+		                                                  uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBufferSPSC_InsertBlock(RingBufferSPSC_t* const Buffer,
+		                                                  const void* Data,
+		                                                  uint16_t Length)
+		{
+			const uint8_t* DataPtr  = (const uint8_t*)Data;
+			uint16_t       Inserted = 0;
+
+			while (Length)
+			{
+				uint8_t* Span;
+				uint16_t SpanLength = MIN(RingBufferSPSC_GetInsertSpan(Buffer, &Span), Length);
+
+				if (!(SpanLength))
+				  break;
+
+				memcpy(Span, &DataPtr[Inserted], SpanLength);
+				RingBufferSPSC_CommitInsert(Buffer, SpanLength);
+
+				Inserted += SpanLength;
+				Length   -= SpanLength;
+			}
+
+			return Inserted;
+		}
+
+		/** Removes up to the given number of bytes from the lock-free ring buffer into a block of memory,
+		 *  using at most two \c memcpy() operations.
+		 *
+		 *  \warning Only the consumer may call this function.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out]    Data    Pointer to the block of memory to fill.
+		 *  \param[in]     Length  Maximum number of bytes to remove.
+		 *
+		 *  \return Number of bytes actually removed.
+		 */
+		static inline uint16_t RingBufferSPSC_RemoveBlock(RingBufferSPSC_t* const Buffer,
+		                                                  void* Data,
+		                                                  uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBufferSPSC_RemoveBlock(RingBufferSPSC_t* const Buffer,
+		                                                  void* Data,
+		                                                  uint16_t Length)
+		{
+			uint8_t* DataPtr = (uint8_t*)Data;
+			uint16_t Removed = 0;
+
+			while (Length)
+			{
+				const uint8_t* Span;
+				uint16_t       SpanLength = MIN(RingBufferSPSC_GetRemoveSpan(Buffer, &Span), Length);
+
+				if (!(SpanLength))
+				  break;
+
+				memcpy(&DataPtr[Removed], Span, SpanLength);
+				RingBufferSPSC_CommitRemove(Buffer, SpanLength);
+
+				Removed += SpanLength;
+				Length  -= SpanLength;
+			}
+
+			return Removed;
+		}
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
@@ -30,6 +30,7 @@
 
 #define  __INCLUDE_FROM_USB_DRIVER
 #define  __INCLUDE_FROM_HID_DRIVER
+#define  __INCLUDE_FROM_HIDPARSER_C
 #include "HIDParser.h"
 
 uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
@@ -43,13 +44,45 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 	uint16_t              UsageList[HID_USAGE_STACK_DEPTH];
 	uint8_t               UsageListSize      = 0;
 	HID_MinMax_t          UsageMinMax        = {0, 0};
+	HID_ReportItem_t*     ReportItems;
+	HID_CollectionPath_t* CollectionsTop;
+
+	#if defined(HID_USE_PARSER_ARENA)
+	uint16_t DescriptorSize = ReportSize;
+	uint16_t DescriptorCRC  = USB_CalculateHIDReportCRC(ReportData, ReportSize);
+
+	if (ParserData->ParsedDescriptorSize && (ParserData->ParsedDescriptorSize == DescriptorSize) &&
+	    (ParserData->ParsedDescriptorCRC == DescriptorCRC))
+	{
+		return HID_PARSE_Successful;
+	}
+
+	ParserData->ParsedDescriptorSize = 0;
+
+	/* Report items grow upwards from the aligned start of the arena, and collections downwards from its aligned end */
+	uintptr_t ArenaStart = (((uintptr_t)ParserData->Arena + (__alignof__(HID_ReportItem_t) - 1)) &
+	                        ~(uintptr_t)(__alignof__(HID_ReportItem_t) - 1));
+	uintptr_t ArenaEnd   = (((uintptr_t)ParserData->Arena + ParserData->ArenaSize) &
+	                        ~(uintptr_t)(__alignof__(HID_ReportItem_t) - 1));
+
+	ReportItems    = (HID_ReportItem_t*)ArenaStart;
+	CollectionsTop = (HID_CollectionPath_t*)MAX(ArenaStart, ArenaEnd);
+
+	ParserData->ReportItems = ReportItems;
+	#else
+	ReportItems    = ParserData->ReportItems;
+	CollectionsTop = &ParserData->CollectionPaths[HID_MAX_COLLECTIONS];
+	#endif
+
+	/* Only the summary is reset, item and collection entries being written as they are stored */
+	ParserData->TotalReportItems      = 0;
+	ParserData->TotalDeviceReports    = 1;
+	ParserData->LargestReportSizeBits = 0;
+	ParserData->UsingReportIDs        = false;
 
-	memset(ParserData,       0x00, sizeof(HID_ReportInfo_t));
 	memset(CurrStateTable,   0x00, sizeof(HID_StateTable_t));
 	memset(CurrReportIDInfo, 0x00, sizeof(HID_ReportSizeInfo_t));
 
-	ParserData->TotalDeviceReports = 1;
-
 	while (ReportSize)
 	{
 		uint8_t  HIDReportItem  = *ReportData;
@@ -58,7 +91,13 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 		ReportData++;
 		ReportSize--;
 
-		switch (HIDReportItem & HID_RI_DATA_SIZE_MASK)
+		uint8_t DataSize = (HIDReportItem & HID_RI_DATA_SIZE_MASK);
+
+		/* Stop at a truncated final item rather than reading beyond the end of the descriptor */
+		if (((DataSize == HID_RI_DATA_BITS_32) ? 4 : DataSize) > ReportSize)
+		  break;
+
+		switch (DataSize)
 		{
 			case HID_RI_DATA_BITS_32:
 				ReportItemData  = (((uint32_t)ReportData[3] << 24) | ((uint32_t)ReportData[2] << 16) |
@@ -92,7 +131,7 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 
 				memcpy((CurrStateTable + 1),
 				       CurrStateTable,
-				       sizeof(HID_ReportItem_t));
+				       sizeof(HID_StateTable_t));
 
 				CurrStateTable++;
 				break;
@@ -112,6 +151,12 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 				break;
 
 			case HID_RI_LOGICAL_MINIMUM(0):
+				/* Logical minimums are signed, so extend short encodings to keep their sign across mixed item widths */
+				if (DataSize == HID_RI_DATA_BITS_8)
+				  ReportItemData = (int8_t)ReportItemData;
+				else if (DataSize == HID_RI_DATA_BITS_16)
+				  ReportItemData = (int16_t)ReportItemData;
+
 				CurrStateTable->Attributes.Logical.Minimum  = ReportItemData;
 				break;
 
@@ -190,29 +235,20 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 				break;
 
 			case HID_RI_COLLECTION(0):
-				if (CurrCollectionPath == NULL)
-				{
-					CurrCollectionPath = &ParserData->CollectionPaths[0];
-				}
-				else
-				{
-					HID_CollectionPath_t* ParentCollectionPath = CurrCollectionPath;
-
-					CurrCollectionPath = &ParserData->CollectionPaths[1];
+				#if defined(HID_USE_PARSER_ARENA)
+				if ((uintptr_t)(CollectionsTop - 1) < (uintptr_t)&ReportItems[ParserData->TotalReportItems])
+				#else
+				if (CollectionsTop == &ParserData->CollectionPaths[0])
+				#endif
+				  return HID_PARSE_InsufficientCollectionPaths;
 
-					while (CurrCollectionPath->Parent != NULL)
-					{
-						if (CurrCollectionPath == &ParserData->CollectionPaths[HID_MAX_COLLECTIONS - 1])
-						  return HID_PARSE_InsufficientCollectionPaths;
-
-						CurrCollectionPath++;
-					}
+				CollectionsTop--;
+				CollectionsTop->Parent = CurrCollectionPath;
+				CurrCollectionPath     = CollectionsTop;
 
-					CurrCollectionPath->Parent = ParentCollectionPath;
-				}
-
-				CurrCollectionPath->Type       = ReportItemData;
-				CurrCollectionPath->Usage.Page = CurrStateTable->Attributes.Usage.Page;
+				CurrCollectionPath->Type        = ReportItemData;
+				CurrCollectionPath->Usage.Page  = CurrStateTable->Attributes.Usage.Page;
+				CurrCollectionPath->Usage.Usage = 0;
 
 				if (UsageListSize)
 				{
@@ -234,6 +270,14 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 				if (CurrCollectionPath == NULL)
 				  return HID_PARSE_UnexpectedEndCollection;
 
+				/* A collection with no stored items in it or its children is released; the newest stored item is checked,
+				 * as any item referencing the collection's children would also have kept the child collection allocated */
+				if ((CurrCollectionPath == CollectionsTop) && (!(ParserData->TotalReportItems) ||
+				    (ReportItems[ParserData->TotalReportItems - 1].CollectionPath != CurrCollectionPath)))
+				{
+					CollectionsTop++;
+				}
+
 				CurrCollectionPath = CurrCollectionPath->Parent;
 				break;
 
@@ -281,14 +325,19 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 
 					ParserData->LargestReportSizeBits = MAX(ParserData->LargestReportSizeBits, CurrReportIDInfo->ReportSizeBits[NewReportItem.ItemType]);
 
+					if ((ReportItemData & HID_IOF_CONSTANT) || !(CALLBACK_HIDParser_FilterHIDReportItem(&NewReportItem)))
+					  continue;
+
+					#if defined(HID_USE_PARSER_ARENA)
+					if ((ParserData->TotalReportItems == UINT8_MAX) ||
+					    ((uintptr_t)&ReportItems[ParserData->TotalReportItems + 1] > (uintptr_t)CollectionsTop))
+					#else
 					if (ParserData->TotalReportItems == HID_MAX_REPORTITEMS)
+					#endif
 					  return HID_PARSE_InsufficientReportItems;
 
-					memcpy(&ParserData->ReportItems[ParserData->TotalReportItems],
+					memcpy(&ReportItems[ParserData->TotalReportItems++],
 					       &NewReportItem, sizeof(HID_ReportItem_t));
-
-					if (!(ReportItemData & HID_IOF_CONSTANT) && CALLBACK_HIDParser_FilterHIDReportItem(&NewReportItem))
-					  ParserData->TotalReportItems++;
 				}
 
 				break;
@@ -308,6 +357,11 @@ uint8_t USB_ProcessHIDReport(const uint8_t* ReportData,
 	if (!(ParserData->TotalReportItems))
 	  return HID_PARSE_NoUnfilteredReportItems;
 
+	#if defined(HID_USE_PARSER_ARENA)
+	ParserData->ParsedDescriptorSize = DescriptorSize;
+	ParserData->ParsedDescriptorCRC  = DescriptorCRC;
+	#endif
+
 	return HID_PARSE_Successful;
 }
 
@@ -364,14 +418,211 @@ void USB_SetHIDReportItemInfo(uint8_t* ReportData,
 
 	while (DataBitsRem--)
 	{
-		if (ReportItem->Value & (1 << (CurrentBit % 8)))
-		  ReportData[CurrentBit / 8] |= BitMask;
+		if (ReportItem->Value & BitMask)
+		  ReportData[CurrentBit / 8] |= (1 << (CurrentBit % 8));
 
 		CurrentBit++;
 		BitMask <<= 1;
 	}
 }
 
+uint8_t USB_CompileHIDReportPlan(const HID_ReportInfo_t* const ParserData,
+                                 const uint8_t ReportType,
+                                 HID_ReportPlan_t* const Plan)
+{
+	Plan->ReportType   = ReportType;
+	Plan->TotalReports = 0;
+	Plan->TotalFields  = 0;
+
+	for (uint8_t ReportIndex = 0; ReportIndex < ParserData->TotalDeviceReports; ReportIndex++)
+	{
+		HID_ReportPlanReport_t* PlanReport = &Plan->Reports[Plan->TotalReports];
+
+		PlanReport->ReportID    = ParserData->ReportIDSizes[ReportIndex].ReportID;
+		PlanReport->FirstField  = Plan->TotalFields;
+		PlanReport->TotalFields = 0;
+
+		for (uint8_t ItemIndex = 0; ItemIndex < ParserData->TotalReportItems; ItemIndex++)
+		{
+			const HID_ReportItem_t* ReportItem = &ParserData->ReportItems[ItemIndex];
+
+			if ((ReportItem->ItemType != ReportType) || (ReportItem->ReportID != PlanReport->ReportID) ||
+			    !(ReportItem->Attributes.BitSize))
+			{
+				continue;
+			}
+
+			/* Leave the plan without any reports if its items do not fit, so that it cannot decode or encode reports */
+			if (Plan->TotalFields == HID_MAX_REPORTITEMS)
+			{
+				Plan->TotalReports = 0;
+				return HID_PARSE_InsufficientReportItems;
+			}
+
+			HID_ReportPlanField_t* Field = &Plan->Fields[Plan->TotalFields++];
+
+			/* Only the lowest 32 bits of larger items are extracted, as with USB_GetHIDReportItemInfo() */
+			uint8_t BitSize = MIN(ReportItem->Attributes.BitSize, 32);
+
+			Field->ByteOffset = ((ReportItem->BitOffset / 8) + (PlanReport->ReportID ? 1 : 0));
+			Field->Shift      = (ReportItem->BitOffset % 8);
+			Field->ByteSpan   = ((Field->Shift + BitSize + 7) / 8);
+			Field->BitSize    = BitSize;
+			Field->ItemIndex  = ItemIndex;
+			Field->Mask       = ((BitSize == 32) ? 0xFFFFFFFF : ((1UL << BitSize) - 1));
+			Field->Flags      = 0;
+
+			if (!(Field->Shift) && !(BitSize % 8))
+			  Field->Flags |= HID_PLAN_FIELD_ALIGNED;
+
+			/* The logical minimum is sign extended at parse time, so a negative minimum marks a signed field */
+			if ((BitSize < 32) && ((int32_t)ReportItem->Attributes.Logical.Minimum < 0))
+			  Field->Flags |= HID_PLAN_FIELD_SIGNED;
+
+			PlanReport->TotalFields++;
+		}
+
+		if (PlanReport->TotalFields)
+		  Plan->TotalReports++;
+	}
+
+	return HID_PARSE_Successful;
+}
+
+uint8_t USB_DecodeHIDReport(const HID_ReportPlan_t* const Plan,
+                            const uint8_t* ReportData,
+                            const uint16_t ReportSize,
+                            uint32_t* const Values)
+{
+	if (!(ReportSize) || !(Plan->TotalReports))
+	  return 0;
+
+	const HID_ReportPlanReport_t* PlanReport = USB_FindHIDPlanReport(Plan, (Plan->Reports[0].ReportID ? ReportData[0] : 0));
+
+	if (PlanReport == NULL)
+	  return 0;
+
+	const HID_ReportPlanField_t* Field = &Plan->Fields[PlanReport->FirstField];
+	uint8_t ValuesDecoded = 0;
+
+	for (uint8_t FieldsRem = PlanReport->TotalFields; FieldsRem > 0; FieldsRem--, Field++)
+	{
+		if ((Field->ByteOffset + Field->ByteSpan) > ReportSize)
+		  continue;
+
+		const uint8_t* FieldData = &ReportData[Field->ByteOffset];
+		uint32_t       Value;
+
+		if (Field->Flags & HID_PLAN_FIELD_ALIGNED)
+		{
+			switch (Field->ByteSpan)
+			{
+				case 1:
+					Value = FieldData[0];
+					break;
+				case 2:
+					Value = (((uint16_t)FieldData[1] << 8) | FieldData[0]);
+					break;
+				case 3:
+					Value = (((uint32_t)FieldData[2] << 16) | ((uint16_t)FieldData[1] << 8) | FieldData[0]);
+					break;
+				default:
+					Value = (((uint32_t)FieldData[3] << 24) | ((uint32_t)FieldData[2] << 16) |
+					         ((uint16_t)FieldData[1] << 8)  | FieldData[0]);
+					break;
+			}
+		}
+		else
+		{
+			Value = 0;
+
+			for (uint8_t CurrByte = MIN(Field->ByteSpan, 4); CurrByte > 0; CurrByte--)
+			  Value = ((Value << 8) | FieldData[CurrByte - 1]);
+
+			Value >>= Field->Shift;
+
+			/* A 32-bit item not starting on a byte boundary spills into a fifth byte */
+			if (Field->ByteSpan > 4)
+			  Value |= ((uint32_t)FieldData[4] << (32 - Field->Shift));
+
+			Value &= Field->Mask;
+		}
+
+		if ((Field->Flags & HID_PLAN_FIELD_SIGNED) && (Value & (Field->Mask ^ (Field->Mask >> 1))))
+		  Value |= ~Field->Mask;
+
+		Values[Field->ItemIndex] = Value;
+		ValuesDecoded++;
+	}
+
+	return ValuesDecoded;
+}
+
+uint8_t USB_EncodeHIDReport(const HID_ReportPlan_t* const Plan,
+                            const uint8_t ReportID,
+                            uint8_t* ReportData,
+                            const uint32_t* const Values)
+{
+	const HID_ReportPlanReport_t* PlanReport = USB_FindHIDPlanReport(Plan, ReportID);
+
+	if (PlanReport == NULL)
+	  return 0;
+
+	if (ReportID)
+	  ReportData[0] = ReportID;
+
+	const HID_ReportPlanField_t* Field = &Plan->Fields[PlanReport->FirstField];
+
+	for (uint8_t FieldsRem = PlanReport->TotalFields; FieldsRem > 0; FieldsRem--, Field++)
+	{
+		uint8_t* FieldData = &ReportData[Field->ByteOffset];
+		uint32_t Value     = (Values[Field->ItemIndex] & Field->Mask);
+
+		/* Each byte spanned keeps any bits belonging to neighbouring items */
+		FieldData[0] = ((FieldData[0] & ~(uint8_t)(Field->Mask << Field->Shift)) | (uint8_t)(Value << Field->Shift));
+
+		for (uint8_t CurrByte = 1; CurrByte < Field->ByteSpan; CurrByte++)
+		{
+			uint8_t BitShift = ((CurrByte * 8) - Field->Shift);
+
+			FieldData[CurrByte] = ((FieldData[CurrByte] & ~(uint8_t)(Field->Mask >> BitShift)) | (uint8_t)(Value >> BitShift));
+		}
+	}
+
+	return PlanReport->TotalFields;
+}
+
+#if defined(HID_USE_PARSER_ARENA)
+static uint16_t USB_CalculateHIDReportCRC(const uint8_t* ReportData,
+                                          uint16_t ReportSize)
+{
+	uint16_t CRC = 0xFFFF;
+
+	/* CRC16-CCITT, calculated bitwise as descriptors are only checked once per enumeration */
+	while (ReportSize--)
+	{
+		CRC ^= ((uint16_t)*(ReportData++) << 8);
+
+		for (uint8_t BitsRem = 8; BitsRem > 0; BitsRem--)
+		  CRC = ((CRC & 0x8000) ? ((CRC << 1) ^ 0x1021) : (CRC << 1));
+	}
+
+	return CRC;
+}
+#endif
+
+static const HID_ReportPlanReport_t* USB_FindHIDPlanReport(const HID_ReportPlan_t* const Plan,
+                                                           const uint8_t ReportID)
+{
+	for (uint8_t ReportIndex = 0; ReportIndex < Plan->TotalReports; ReportIndex++)
+	{
+		if (Plan->Reports[ReportIndex].ReportID == ReportID)
+		  return &Plan->Reports[ReportIndex];
+	}
+
+	return NULL;
+}
+
 uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData,
                               const uint8_t ReportID,
                               const uint8_t ReportType)
@@ -130,6 +130,10 @@
 			#define HID_MAX_REPORT_IDS            10
 		#endif
 
+		#if (HID_MAX_REPORTITEMS > 255)
+			#error HID_MAX_REPORTITEMS must not exceed 255, as report items are counted and indexed in 8-bit values.
+		#endif
+
 		/** Returns the value a given HID report item (once its value has been fetched via \ref USB_GetHIDReportItemInfo())
 		 *  left-aligned to the given data type. This allows for signed data to be interpreted correctly, by shifting the data
 		 *  leftwards until the data's sign bit is in the correct position.
@@ -149,9 +153,9 @@
 				HID_PARSE_Successful                  = 0, /**< Successful parse of the HID report descriptor, no error. */
 				HID_PARSE_HIDStackOverflow            = 1, /**< More than \ref HID_STATETABLE_STACK_DEPTH nested PUSHes in the report. */
 				HID_PARSE_HIDStackUnderflow           = 2, /**< A POP was found when the state table stack was empty. */
-				HID_PARSE_InsufficientReportItems     = 3, /**< More than \ref HID_MAX_REPORTITEMS report items in the report. */
+				HID_PARSE_InsufficientReportItems     = 3, /**< More than \ref HID_MAX_REPORTITEMS report items in the report or report plan, or the parser arena is full. */
 				HID_PARSE_UnexpectedEndCollection     = 4, /**< An END COLLECTION item found without matching COLLECTION item. */
-				HID_PARSE_InsufficientCollectionPaths = 5, /**< More than \ref HID_MAX_COLLECTIONS collections in the report. */
+				HID_PARSE_InsufficientCollectionPaths = 5, /**< More than \ref HID_MAX_COLLECTIONS collections in the report, or the parser arena is full. */
 				HID_PARSE_UsageListOverflow           = 6, /**< More than \ref HID_USAGE_STACK_DEPTH usages listed in a row. */
 				HID_PARSE_InsufficientReportIDItems   = 7, /**< More than \ref HID_MAX_REPORT_IDS report IDs in the device. */
 				HID_PARSE_NoUnfilteredReportItems     = 8, /**< All report items from the device were filtered by the filtering callback routine. */
@@ -210,7 +214,9 @@
 
 				HID_Usage_t  Usage;    /**< Usage of the report item. */
 				HID_Unit_t   Unit;     /**< Unit type and exponent of the report item. */
-				HID_MinMax_t Logical;  /**< Logical minimum and maximum of the report item. */
+				HID_MinMax_t Logical;  /**< Logical minimum and maximum of the report item. The minimum is sign extended from its
+				                        *   encoded size, so a negative minimum reads as a negative value when cast to \c int32_t.
+				                        */
 				HID_MinMax_t Physical; /**< Physical minimum and maximum of the report item. */
 			} HID_ReportItem_Attributes_t;
 
@@ -253,12 +259,38 @@
 			typedef struct
 			{
 				uint8_t              TotalReportItems; /**< Total number of report items stored in the \c ReportItems array. */
+				#if defined(HID_USE_PARSER_ARENA) || defined(__DOXYGEN__)
+				HID_ReportItem_t*    ReportItems; /**< Report items array, including all IN, OUT and FEATURE items accepted by
+				                                   *   \ref CALLBACK_HIDParser_FilterHIDReportItem(), stored at the start of the arena.
+				                                   *   Only present when the \c HID_USE_PARSER_ARENA token is defined.
+				                                   */
+				void*                Arena; /**< Buffer supplied by the application to hold the accepted report items and the
+				                             *   collections they reference, which must be set before the descriptor is processed
+				                             *   and remain valid while the parsed data is in use. Only present when the
+				                             *   \c HID_USE_PARSER_ARENA token is defined.
+				                             */
+				uint16_t             ArenaSize; /**< Size in bytes of the \c Arena buffer. Only present when the
+				                                 *   \c HID_USE_PARSER_ARENA token is defined.
+				                                 */
+				uint16_t             ParsedDescriptorSize; /**< Size of the last successfully processed HID report descriptor, or zero if
+				                                            *   none has been processed. While the same descriptor is given again, the
+				                                            *   parsed data is reused instead of being processed a second time; this may be
+				                                            *   set to zero by the application to force the next descriptor to be processed.
+				                                            *   Only present when the \c HID_USE_PARSER_ARENA token is defined.
+				                                            */
+				uint16_t             ParsedDescriptorCRC; /**< CRC16 of the last successfully processed HID report descriptor. Only
+				                                           *   present when the \c HID_USE_PARSER_ARENA token is defined.
+				                                           */
+				#endif
+				#if !defined(HID_USE_PARSER_ARENA) || defined(__DOXYGEN__)
 				HID_ReportItem_t     ReportItems[HID_MAX_REPORTITEMS]; /**< Report items array, including all IN, OUT
 			                                                            *   and FEATURE items.
 				                                                        */
 				HID_CollectionPath_t CollectionPaths[HID_MAX_COLLECTIONS]; /**< All collection items, referenced
-				                                                            *   by the report items.
+				                                                            *   by the report items. Only present when the
+				                                                            *   \c HID_USE_PARSER_ARENA token is not defined.
 				                                                            */
+				#endif
 				uint8_t              TotalDeviceReports; /**< Number of reports within the HID interface */
 				HID_ReportSizeInfo_t ReportIDSizes[HID_MAX_REPORT_IDS]; /**< Report sizes for each report in the interface */
 				uint16_t             LargestReportSizeBits; /**< Largest report that the attached device will generate, in bits */
@@ -267,10 +299,60 @@
 				                                      */
 			} HID_ReportInfo_t;
 
+			/** \brief HID Report Plan Field Structure.
+			 *
+			 *  Type define for the precomputed location of a single report item within a report, as created by
+			 *  \ref USB_CompileHIDReportPlan(). The contents of this structure are for use by the library only.
+			 */
+			typedef struct
+			{
+				uint16_t ByteOffset; /**< Offset of the first byte of the item's data in the report, including any report ID byte. */
+				uint8_t  Shift; /**< Bit position of the item's least significant bit within the first byte. */
+				uint8_t  ByteSpan; /**< Number of report bytes the item's data spans. */
+				uint8_t  BitSize; /**< Size in bits of the item's data. */
+				uint8_t  Flags; /**< Mask of \c HID_PLAN_FIELD_* flags for the field. */
+				uint8_t  ItemIndex; /**< Index of the item in the parsed \ref HID_ReportInfo_t ReportItems array. */
+				uint32_t Mask; /**< Mask of the item's data once shifted down to bit zero. */
+			} HID_ReportPlanField_t;
+
+			/** \brief HID Report Plan Report Structure.
+			 *
+			 *  Type define for the range of fields in a report plan belonging to a single report ID.
+			 */
+			typedef struct
+			{
+				uint8_t ReportID; /**< Report ID of the report, or 0x00 if the device has only one report. */
+				uint8_t FirstField; /**< Index of the report's first field in the plan's \c Fields array. */
+				uint8_t TotalFields; /**< Number of fields in the report. */
+			} HID_ReportPlanReport_t;
+
+			/** \brief HID Report Extraction Plan Structure.
+			 *
+			 *  Type define for a compiled extraction plan of all the parsed report items of one report type, created
+			 *  from a \ref HID_ReportInfo_t structure by \ref USB_CompileHIDReportPlan(). Once compiled, a plan allows
+			 *  every item of a received report to be extracted in a single pass by \ref USB_DecodeHIDReport(), without
+			 *  the per-bit processing of \ref USB_GetHIDReportItemInfo().
+			 */
+			typedef struct
+			{
+				uint8_t                ReportType; /**< Type of the reports in the plan, a value from the \ref HID_ReportItemTypes_t enum. */
+				uint8_t                TotalReports; /**< Number of reports stored in the \c Reports array. */
+				HID_ReportPlanReport_t Reports[HID_MAX_REPORT_IDS]; /**< Field ranges of each report ID with at least one item. */
+				uint8_t                TotalFields; /**< Number of fields stored in the \c Fields array. */
+				HID_ReportPlanField_t  Fields[HID_MAX_REPORTITEMS]; /**< Precomputed locations of each report item. */
+			} HID_ReportPlan_t;
+
 		/* Function Prototypes: */
 			/** Function to process a given HID report returned from an attached device, and store it into a given
 			 *  \ref HID_ReportInfo_t structure.
 			 *
+			 *  When the \c HID_USE_PARSER_ARENA token is defined, the descriptor is processed as a stream and only the report
+			 *  items accepted by \ref CALLBACK_HIDParser_FilterHIDReportItem() are stored, growing upwards from the start of
+			 *  the structure's \c Arena buffer, while the collections referenced by them grow downwards from its end. The
+			 *  \ref HID_MAX_REPORTITEMS and \ref HID_MAX_COLLECTIONS limits then do not apply, the parse instead failing
+			 *  only once the arena is full or holds 255 report items. A descriptor identical to the one last processed into the structure is not
+			 *  processed again, the existing parsed data being kept.
+			 *
 			 *  \param[in]  ReportData  Buffer containing the device's HID report table.
 			 *  \param[in]  ReportSize  Size in bytes of the HID report table.
 			 *  \param[out] ParserData  Pointer to a \ref HID_ReportInfo_t instance for the parser output.
@@ -313,6 +395,61 @@
 			void USB_SetHIDReportItemInfo(uint8_t* ReportData,
 			                              HID_ReportItem_t* const ReportItem) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Compiles the report items of a given type in a processed HID report descriptor into an extraction plan,
+			 *  precomputing the byte offset, shift, mask and sign handling of each item so that whole reports may then be
+			 *  decoded with \ref USB_DecodeHIDReport() or encoded with \ref USB_EncodeHIDReport(). Items whose logical
+			 *  minimum is negative are sign-extended when decoded. The plan refers to items by their index in the
+			 *  \ref HID_ReportInfo_t ReportItems array, and must be recompiled whenever the report info is reprocessed.
+			 *
+			 *  A plan holds at most \ref HID_MAX_REPORTITEMS report items, which may be fewer than a report info parsed
+			 *  into an arena holds. If the items of the given type do not fit, the plan is left without any reports.
+			 *
+			 *  \param[in]  ParserData  Pointer to a \ref HID_ReportInfo_t instance containing the parser output.
+			 *  \param[in]  ReportType  Type of the report items to compile, a value from the \ref HID_ReportItemTypes_t enum.
+			 *  \param[out] Plan        Pointer to a \ref HID_ReportPlan_t instance where the compiled plan is to be stored.
+			 *
+			 *  \return \ref HID_PARSE_Successful if the plan was compiled, or \ref HID_PARSE_InsufficientReportItems if the
+			 *          report items of the given type do not fit into the plan.
+			 */
+			uint8_t USB_CompileHIDReportPlan(const HID_ReportInfo_t* const ParserData,
+			                                 const uint8_t ReportType,
+			                                 HID_ReportPlan_t* const Plan) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(3);
+
+			/** Extracts the value of every planned report item contained in a given HID report in one pass, storing
+			 *  each into a flat array indexed in the same manner as the \ref HID_ReportInfo_t ReportItems array the
+			 *  plan was compiled from. Only the entries of items within the given report are written; items lying
+			 *  beyond the end of a short report are left unmodified.
+			 *
+			 *  \param[in]  Plan        Pointer to a \ref HID_ReportPlan_t instance compiled by \ref USB_CompileHIDReportPlan().
+			 *  \param[in]  ReportData  Buffer containing an IN or FEATURE report from an attached device.
+			 *  \param[in]  ReportSize  Size in bytes of the report in the \c ReportData buffer, including any report ID.
+			 *  \param[out] Values      Array of report item values, at least as large as the parsed report item count.
+			 *
+			 *  \return Number of report item values extracted, zero if the report's ID is not in the plan.
+			 */
+			uint8_t USB_DecodeHIDReport(const HID_ReportPlan_t* const Plan,
+			                            const uint8_t* ReportData,
+			                            const uint16_t ReportSize,
+			                            uint32_t* const Values) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2) ATTR_NON_NULL_PTR_ARG(4);
+
+			/** Places the values of every planned report item in a given report ID into a HID report buffer in one pass,
+			 *  taking each value from a flat array indexed in the same manner as the \ref HID_ReportInfo_t ReportItems
+			 *  array the plan was compiled from. Only the bits of each item are modified, so unlike
+			 *  \ref USB_SetHIDReportItemInfo() the buffer need not be cleared first. If the device has multiple HID
+			 *  reports, the first byte in the report is set to the given report ID.
+			 *
+			 *  \param[in]  Plan        Pointer to a \ref HID_ReportPlan_t instance compiled by \ref USB_CompileHIDReportPlan().
+			 *  \param[in]  ReportID    Report ID of the report to create, or 0x00 if the device has only one report.
+			 *  \param[out] ReportData  Buffer holding the OUT or FEATURE report data to update.
+			 *  \param[in]  Values      Array of report item values to place into the report.
+			 *
+			 *  \return Number of report item values placed into the report, zero if the report ID is not in the plan.
+			 */
+			uint8_t USB_EncodeHIDReport(const HID_ReportPlan_t* const Plan,
+			                            const uint8_t ReportID,
+			                            uint8_t* ReportData,
+			                            const uint32_t* const Values) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(3) ATTR_NON_NULL_PTR_ARG(4);
+
 			/** Retrieves the size of a given HID report in bytes from its Report ID.
 			 *
 			 *  \param[in] ParserData  Pointer to a \ref HID_ReportInfo_t instance containing the parser output.
@@ -344,6 +481,10 @@
 
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define HID_PLAN_FIELD_ALIGNED        (1 << 0)
+			#define HID_PLAN_FIELD_SIGNED         (1 << 1)
+
 		/* Type Defines: */
 			typedef struct
 			{
@@ -351,6 +492,17 @@
 				 uint8_t                     ReportCount;
 				 uint8_t                     ReportID;
 			} HID_StateTable_t;
+
+		/* Function Prototypes: */
+			#if defined(__INCLUDE_FROM_HIDPARSER_C)
+				#if defined(HID_USE_PARSER_ARENA)
+				static uint16_t USB_CalculateHIDReportCRC(const uint8_t* ReportData,
+				                                          uint16_t ReportSize) ATTR_NON_NULL_PTR_ARG(1);
+				#endif
+
+				static const HID_ReportPlanReport_t* USB_FindHIDPlanReport(const HID_ReportPlan_t* const Plan,
+				                                                           const uint8_t ReportID) ATTR_NON_NULL_PTR_ARG(1);
+			#endif
 	#endif
 
 	/* Disable C linkage for C++ Compilers: */
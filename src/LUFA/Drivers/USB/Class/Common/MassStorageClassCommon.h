@@ -119,6 +119,41 @@
 
 		/** SCSI Command Code for a MODE SENSE (10) command. */
 		#define SCSI_CMD_MODE_SENSE_10                         0x5A
+
+		/** SCSI Command Code for a READ (12) command. */
+		#define SCSI_CMD_READ_12                               0xA8
+
+		/** SCSI Command Code for a WRITE (12) command. */
+		#define SCSI_CMD_WRITE_12                              0xAA
+
+		/** SCSI Command Code for a READ (16) command. */
+		#define SCSI_CMD_READ_16                               0x88
+
+		/** SCSI Command Code for a WRITE (16) command. */
+		#define SCSI_CMD_WRITE_16                              0x8A
+
+		/** SCSI Command Code for a VERIFY (16) command. */
+		#define SCSI_CMD_VERIFY_16                             0x8F
+
+		/** SCSI Command Code for a SERVICE ACTION IN (16) command, whose service action is given in the second
+		 *  byte of the command as one of the \c SCSI_SERVICE_ACTION_* values.
+		 */
+		#define SCSI_CMD_SERVICE_ACTION_IN_16                  0x9E
+
+		/** SCSI Command Code for a SYNCHRONIZE CACHE (10) command. */
+		#define SCSI_CMD_SYNCHRONIZE_CACHE_10                  0x35
+
+		/** SCSI Command Code for a SYNCHRONIZE CACHE (16) command. */
+		#define SCSI_CMD_SYNCHRONIZE_CACHE_16                  0x91
+
+		/** SCSI Command Code for an UNMAP command. */
+		#define SCSI_CMD_UNMAP                                 0x42
+		//@}
+
+		/** \name SCSI Service Actions */
+		//@{
+		/** SCSI Service Action of a \ref SCSI_CMD_SERVICE_ACTION_IN_16 command for a READ CAPACITY (16) command. */
+		#define SCSI_SERVICE_ACTION_READ_CAPACITY_16           0x10
 		//@}
 
 		/** \name SCSI Sense Key Values */
@@ -198,6 +233,18 @@
 
 		/** SCSI Additional Sense Code to indicate that no removable medium is inserted into the device. */
 		#define SCSI_ASENSE_MEDIUM_NOT_PRESENT                 0x3A
+
+		/** SCSI Additional Sense Code to indicate that an error occurred while writing to the medium. */
+		#define SCSI_ASENSE_WRITE_ERROR                        0x0C
+
+		/** SCSI Additional Sense Code to indicate that data could not be read back from the medium. */
+		#define SCSI_ASENSE_UNRECOVERED_READ_ERROR             0x11
+
+		/** SCSI Additional Sense Code to indicate that the parameter list length of the issued command was invalid. */
+		#define SCSI_ASENSE_PARAMETER_LIST_LENGTH_ERROR        0x1A
+
+		/** SCSI Additional Sense Code to indicate an invalid field was encountered in the parameter list of the issued command. */
+		#define SCSI_ASENSE_INVALID_FIELD_IN_PARAMETER_LIST    0x26
 		//@}
 
 		/** \name SCSI Additional Sense Key Code Qualifiers */
@@ -140,7 +140,13 @@ void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 	#if !defined(NO_CLASS_DRIVER_AUTOFLUSH)
 	Endpoint_SelectEndpoint(CDCInterfaceInfo->Config.DataINEndpoint.Address);
 
-	if (Endpoint_IsINReady())
+	if (!(Endpoint_IsINReady()))
+	  return;
+
+	/* The latency timer only runs while data is waiting in the bank, full packets having already been sent */
+	if (!(Endpoint_BytesInEndpoint()))
+	  CDCInterfaceInfo->State.LatencyTimerElapsedMS = 0;
+	else if (CDCInterfaceInfo->State.LatencyTimerElapsedMS >= CDCInterfaceInfo->Config.LatencyTimerMS)
 	  CDC_Device_Flush(CDCInterfaceInfo);
 	#endif
 }
@@ -197,6 +203,8 @@ uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 
 	Endpoint_SelectEndpoint(CDCInterfaceInfo->Config.DataINEndpoint.Address);
 
+	CDCInterfaceInfo->State.LatencyTimerElapsedMS = 0;
+
 	if (!(Endpoint_BytesInEndpoint()))
 	  return ENDPOINT_READYWAIT_NoError;
 
@@ -104,6 +104,13 @@
 					USB_Endpoint_Table_t DataINEndpoint; /**< Data IN endpoint configuration table. */
 					USB_Endpoint_Table_t DataOUTEndpoint; /**< Data OUT endpoint configuration table. */
 					USB_Endpoint_Table_t NotificationEndpoint; /**< Notification IN Endpoint configuration table. */
+
+					uint8_t LatencyTimerMS; /**< Latency timer of the data IN endpoint, in milliseconds. When non-zero, partially filled
+					                         *   packets are held back by \ref CDC_Device_USBTask() until this much time has passed, so
+					                         *   that small writes are coalesced into full packets. Requires \ref CDC_Device_MillisecondElapsed()
+					                         *   to be called once per millisecond. When zero, partial packets are sent as soon as the
+					                         *   endpoint is ready.
+					                         */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -124,6 +131,10 @@
 					                                  *   This is generally only used if the virtual serial port data is to be
 					                                  *   reconstructed on a physical UART.
 					                                  */
+
+					volatile uint8_t LatencyTimerElapsedMS; /**< Milliseconds for which data has been waiting in the data IN
+					                                         *   endpoint's bank, see \ref CDC_Device_MillisecondElapsed().
+					                                         */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -150,6 +161,9 @@
 			/** General management task for a given CDC class interface, required for the correct operation of the interface. This should
 			 *  be called frequently in the main program loop, before the master USB management task \ref USB_USBTask().
 			 *
+			 *  Unless the \c NO_CLASS_DRIVER_AUTOFLUSH token is defined, this sends any partially filled data IN packet to the
+			 *  host, once the interface's latency timer has expired if one is set in \c Config.LatencyTimerMS.
+			 *
 			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class configuration and state.
 			 */
 			void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
@@ -317,6 +331,21 @@
 			                                     FILE* const Stream) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 			#endif
 
+		/* Inline Functions: */
+			/** Indicates that a millisecond has elapsed on the given CDC interface, advancing its data IN latency timer. This
+			 *  should be called once per millisecond when \c Config.LatencyTimerMS is set. It is recommended that this be called
+			 *  by the \ref EVENT_USB_Device_StartOfFrame() event, once SOF events have been enabled via
+			 *  \ref USB_Device_EnableSOFEvents().
+			 *
+			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class configuration and state.
+			 */
+			static inline void CDC_Device_MillisecondElapsed(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_ALWAYS_INLINE ATTR_NON_NULL_PTR_ARG(1);
+			static inline void CDC_Device_MillisecondElapsed(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+			{
+				if (CDCInterfaceInfo->State.LatencyTimerElapsedMS < CDCInterfaceInfo->Config.LatencyTimerMS)
+				  CDCInterfaceInfo->State.LatencyTimerElapsedMS++;
+			}
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
@@ -140,6 +140,7 @@ bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t* const HIDInterfac
 	memset(&HIDInterfaceInfo->State, 0x00, sizeof(HIDInterfaceInfo->State));
 	HIDInterfaceInfo->State.UsingReportProtocol = true;
 	HIDInterfaceInfo->State.IdleCount           = 500;
+	HIDInterfaceInfo->State.ChangedReports      = HIDInterfaceInfo->Config.INReportIDMask;
 
 	HIDInterfaceInfo->Config.ReportINEndpoint.Type = EP_TYPE_INTERRUPT;
 
@@ -166,7 +167,53 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 
 	Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.ReportINEndpoint.Address);
 
-	if (Endpoint_IsReadWriteAllowed())
+	if (!(Endpoint_IsReadWriteAllowed()))
+	  return;
+
+	if (HIDInterfaceInfo->Config.INReportIDMask)
+	{
+		if (HIDInterfaceInfo->State.IdleCount && !(HIDInterfaceInfo->State.IdleMSRemaining))
+		{
+			HIDInterfaceInfo->State.IdleMSRemaining = HIDInterfaceInfo->State.IdleCount;
+			HIDInterfaceInfo->State.ChangedReports |= HIDInterfaceInfo->Config.INReportIDMask;
+		}
+
+		if (!(HIDInterfaceInfo->State.ChangedReports))
+		  return;
+
+		/* Send the first changed report at or after the last one sent, so that every report ID gets its turn */
+		uint8_t ChangedReportID = HIDInterfaceInfo->State.NextReportID;
+
+		while (!(HIDInterfaceInfo->State.ChangedReports & (1 << ChangedReportID)))
+		  ChangedReportID = ((ChangedReportID + 1) & 0x07);
+
+		HIDInterfaceInfo->State.ChangedReports &= ~(1 << ChangedReportID);
+		HIDInterfaceInfo->State.NextReportID    = ((ChangedReportID + 1) & 0x07);
+
+		uint8_t  ReportINData[HIDInterfaceInfo->Config.PrevReportINBufferSize];
+		uint8_t  ReportID     = ChangedReportID;
+		uint16_t ReportINSize = 0;
+
+		memset(ReportINData, 0, sizeof(ReportINData));
+
+		if (CALLBACK_HID_Device_CreateHIDReport(HIDInterfaceInfo, &ReportID, HID_REPORT_ITEM_In, ReportINData, &ReportINSize))
+		  HIDInterfaceInfo->State.ChangedReports |= (1 << ChangedReportID);
+
+		if (ReportINSize)
+		{
+			HIDInterfaceInfo->State.IdleMSRemaining = HIDInterfaceInfo->State.IdleCount;
+
+			Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.ReportINEndpoint.Address);
+
+			if (ReportID)
+			  Endpoint_Write_8(ReportID);
+
+			Endpoint_Write_Stream_LE(ReportINData, ReportINSize, NULL);
+
+			Endpoint_ClearIN();
+		}
+	}
+	else
 	{
 		uint8_t  ReportINData[HIDInterfaceInfo->Config.PrevReportINBufferSize];
 		uint8_t  ReportID     = 0;
@@ -182,7 +229,9 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 		if (HIDInterfaceInfo->Config.PrevReportINBuffer != NULL)
 		{
 			StatesChanged = (memcmp(ReportINData, HIDInterfaceInfo->Config.PrevReportINBuffer, ReportINSize) != 0);
-			memcpy(HIDInterfaceInfo->Config.PrevReportINBuffer, ReportINData, HIDInterfaceInfo->Config.PrevReportINBufferSize);
+
+			if (StatesChanged)
+			  memcpy(HIDInterfaceInfo->Config.PrevReportINBuffer, ReportINData, HIDInterfaceInfo->Config.PrevReportINBufferSize);
 		}
 
 		if (ReportINSize && (ForceSend || StatesChanged || IdlePeriodElapsed))
@@ -198,9 +247,9 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 
 			Endpoint_ClearIN();
 		}
-
-		HIDInterfaceInfo->State.PrevFrameNum = USB_Device_GetFrameNumber();
 	}
+
+	HIDInterfaceInfo->State.PrevFrameNum = USB_Device_GetFrameNumber();
 }
 
 #endif
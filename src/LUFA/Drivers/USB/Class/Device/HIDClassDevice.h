@@ -105,6 +105,17 @@
 					                                  *  exclusively (i.e. \c PrevReportINBuffer is \c NULL) this value must still be
 					                                  *  set to the size of the largest report the device can issue to the host.
 					                                  */
+					uint8_t  INReportIDMask; /**< Mask of the report IDs of the input reports sent by the interface, with bit \c n set
+					                          *   for report ID \c n, or bit 0 for an interface whose single input report has no report
+					                          *   ID. If non-zero, the driver only creates and sends each input report once the user
+					                          *   application has marked it as changed via \ref HID_Device_ReportChanged(), or once
+					                          *   the idle period elapses, instead of creating and comparing a report on every frame.
+					                          *   Changed reports are sent in turn so that no report ID can starve the others. If zero,
+					                          *   reports are created and compared on every frame as described above.
+					                          *
+					                          *  \note Only report IDs 0 to 7 can be used when this mask is set, and \c PrevReportINBuffer
+					                          *        should be \c NULL as it is not used.
+					                          */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -115,6 +126,10 @@
 					uint16_t IdleCount; /**< Report idle period, in milliseconds, set by the host. */
 					uint16_t IdleMSRemaining; /**< Total number of milliseconds remaining before the idle period elapsed - this
 				                               *   should be decremented by the user application if non-zero each millisecond. */
+					uint8_t  ChangedReports; /**< Mask of the input report IDs marked as changed and waiting to be sent, when
+					                          *   \c INReportIDMask is set.
+					                          */
+					uint8_t  NextReportID; /**< Report ID checked first when choosing the next changed input report to send. */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -158,7 +173,9 @@
 			 *  \param[out]    ReportSize        Number of bytes in the generated input report, or zero if no report is to be sent.
 			 *
 			 *  \return Boolean \c true to force the sending of the report even if it is identical to the previous report and still within
-			 *          the idle period (useful for devices which report relative movement), \c false otherwise.
+			 *          the idle period (useful for devices which report relative movement), \c false otherwise. If the interface's
+			 *          \c INReportIDMask is set, \c true instead leaves the report marked as changed, so that it is created again
+			 *          at its next turn.
 			 */
 			bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
 			                                         uint8_t* const ReportID,
@@ -199,6 +216,24 @@
 				  HIDInterfaceInfo->State.IdleMSRemaining--;
 			}
 
+			/** Marks an input report of the given HID interface as changed, so that it is created and sent to the host at its next
+			 *  turn. This is only used when the interface's \c INReportIDMask is set, and should be called from the main program
+			 *  context rather than from an interrupt.
+			 *
+			 *  \note Only report IDs 0 to 7 can be marked as changed, higher report IDs are ignored.
+			 *
+			 *  \param[in,out] HIDInterfaceInfo  Pointer to a structure containing a HID Class configuration and state.
+			 *  \param[in]     ReportID          Report ID of the changed input report, or zero if the interface's report has no ID.
+			 */
+			static inline void HID_Device_ReportChanged(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+			                                            const uint8_t ReportID) ATTR_ALWAYS_INLINE ATTR_NON_NULL_PTR_ARG(1);
+			static inline void HID_Device_ReportChanged(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+			                                            const uint8_t ReportID)
+			{
+				if (ReportID < 8)
+				  HIDInterfaceInfo->State.ChangedReports |= (1 << ReportID);
+			}
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
@@ -61,13 +61,26 @@ void MIDI_Device_USBTask(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 	#if !defined(NO_CLASS_DRIVER_AUTOFLUSH)
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataINEndpoint.Address);
 
-	if (Endpoint_IsINReady())
+	if (!(Endpoint_IsINReady()))
+	  return;
+
+	/* The latency timer only runs while events are waiting in the bank, full packets having already been sent */
+	if (!(Endpoint_BytesInEndpoint()))
+	  MIDIInterfaceInfo->State.LatencyTimerElapsedMS = 0;
+	else if (MIDIInterfaceInfo->State.LatencyTimerElapsedMS >= MIDIInterfaceInfo->Config.LatencyTimerMS)
 	  MIDI_Device_Flush(MIDIInterfaceInfo);
 	#endif
 }
 
 uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
                                     const MIDI_EventPacket_t* const Event)
+{
+	return MIDI_Device_SendEvents(MIDIInterfaceInfo, Event, 1);
+}
+
+uint8_t MIDI_Device_SendEvents(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+                               const MIDI_EventPacket_t* const Events,
+                               const uint8_t TotalEvents)
 {
 	if (USB_DeviceState != DEVICE_STATE_Configured)
 	  return ENDPOINT_RWSTREAM_DeviceDisconnected;
@@ -76,7 +89,8 @@ uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataINEndpoint.Address);
 
-	if ((ErrorCode = Endpoint_Write_Stream_LE(Event, sizeof(MIDI_EventPacket_t), NULL)) != ENDPOINT_RWSTREAM_NoError)
+	/* The stream write sends each bank as it fills, so only the final partial packet is left for the flush */
+	if ((ErrorCode = Endpoint_Write_Stream_LE(Events, ((uint16_t)TotalEvents * sizeof(MIDI_EventPacket_t)), NULL)) != ENDPOINT_RWSTREAM_NoError)
 	  return ErrorCode;
 
 	if (!(Endpoint_IsReadWriteAllowed()))
@@ -94,6 +108,8 @@ uint8_t MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataINEndpoint.Address);
 
+	MIDIInterfaceInfo->State.LatencyTimerElapsedMS = 0;
+
 	if (Endpoint_BytesInEndpoint())
 	{
 		Endpoint_ClearIN();
@@ -108,23 +124,42 @@ uint8_t MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 bool MIDI_Device_ReceiveEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
                                     MIDI_EventPacket_t* const Event)
 {
-	if (USB_DeviceState != DEVICE_STATE_Configured)
-	  return false;
-
-	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataOUTEndpoint.Address);
+	return (MIDI_Device_ReceiveEvents(MIDIInterfaceInfo, Event, 1) != 0);
+}
 
-	if (!(Endpoint_IsOUTReceived()))
-		return false;
+uint8_t MIDI_Device_ReceiveEvents(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+                                  MIDI_EventPacket_t* const Events,
+                                  const uint8_t MaxEvents)
+{
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	  return 0;
 
-	if (!(Endpoint_IsReadWriteAllowed()))
-	  return false;
+	uint8_t EventsReceived = 0;
 
-	Endpoint_Read_Stream_LE(Event, sizeof(MIDI_EventPacket_t), NULL);
+	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.DataOUTEndpoint.Address);
 
-	if (!(Endpoint_IsReadWriteAllowed()))
-	  Endpoint_ClearOUT();
+	while ((EventsReceived < MaxEvents) && Endpoint_IsOUTReceived())
+	{
+		uint8_t EventsInBank = (Endpoint_BytesInEndpoint() / sizeof(MIDI_EventPacket_t));
+
+		if (EventsInBank > (MaxEvents - EventsReceived))
+		  EventsInBank = (MaxEvents - EventsReceived);
+
+		/* Read all the events wanted from the current bank at once, rather than re-selecting the endpoint for each */
+		if (EventsInBank)
+		{
+			Endpoint_Read_Stream_LE(&Events[EventsReceived], ((uint16_t)EventsInBank * sizeof(MIDI_EventPacket_t)), NULL);
+			EventsReceived += EventsInBank;
+		}
+
+		/* Banks holding only a truncated event cannot be read, and are discarded along with the emptied ones */
+		if (Endpoint_BytesInEndpoint() < sizeof(MIDI_EventPacket_t))
+		  Endpoint_ClearOUT();
+		else
+		  break;
+	}
 
-	return true;
+	return EventsReceived;
 }
 
 #endif
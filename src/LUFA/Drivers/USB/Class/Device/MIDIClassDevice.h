@@ -83,13 +83,22 @@
 
 					USB_Endpoint_Table_t DataINEndpoint; /**< Data IN endpoint configuration table. */
 					USB_Endpoint_Table_t DataOUTEndpoint; /**< Data OUT endpoint configuration table. */
+
+					uint8_t LatencyTimerMS; /**< Latency timer of the data IN endpoint, in milliseconds. When non-zero, partially filled
+					                         *   packets are held back by \ref MIDI_Device_USBTask() until this much time has passed, so
+					                         *   that events sent in quick succession share a packet. Requires \ref MIDI_Device_MillisecondElapsed()
+					                         *   to be called once per millisecond. When zero, partial packets are sent as soon as the
+					                         *   endpoint is ready.
+					                         */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
 
 				struct
 				{
-					uint8_t RESERVED; // No state information for this class
+					volatile uint8_t LatencyTimerElapsedMS; /**< Milliseconds for which events have been waiting in the data IN
+					                                         *   endpoint's bank, see \ref MIDI_Device_MillisecondElapsed().
+					                                         */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -109,6 +118,9 @@
 			/** General management task for a given MIDI class interface, required for the correct operation of the interface. This should
 			 *  be called frequently in the main program loop, before the master USB management task \ref USB_USBTask().
 			 *
+			 *  Unless the \c NO_CLASS_DRIVER_AUTOFLUSH token is defined, this sends any partially filled data IN packet to the
+			 *  host, once the interface's latency timer has expired if one is set in \c Config.LatencyTimerMS.
+			 *
 			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
 			 */
 			void MIDI_Device_USBTask(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
@@ -128,6 +140,22 @@
 			uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
 			                                    const MIDI_EventPacket_t* const Event) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 
+			/** Sends an array of MIDI event packets to the host, in a single endpoint stream write. If no host is connected, the
+			 *  events are discarded. Each endpoint bank is sent to the host as it fills, with any remaining events queued into the
+			 *  endpoint bank in the same manner as \ref MIDI_Device_SendEventPacket().
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 *  \param[in]     Events             Pointer to an array of populated \ref MIDI_EventPacket_t structures to send.
+			 *  \param[in]     TotalEvents        Number of events in the \c Events array.
+			 *
+			 *  \return A value from the \ref Endpoint_Stream_RW_ErrorCodes_t enum.
+			 */
+			uint8_t MIDI_Device_SendEvents(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+			                               const MIDI_EventPacket_t* const Events,
+			                               const uint8_t TotalEvents) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 
 			/** Flushes the MIDI send buffer, sending any queued MIDI events to the host. This should be called to override the
 			 *  \ref MIDI_Device_SendEventPacket() function's packing behavior, to flush queued events.
@@ -152,6 +180,23 @@
 			bool MIDI_Device_ReceiveEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
 			                                    MIDI_EventPacket_t* const Event) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 
+			/** Receives as many MIDI event packets from the host as are waiting, up to the given limit. All the wanted events in
+			 *  an endpoint bank are read at once, with each emptied bank released back to the host; a single call can therefore
+			 *  return every event of a full packet.
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 *  \param[out]    Events             Pointer to an array of \ref MIDI_EventPacket_t structures where received events are to be placed.
+			 *  \param[in]     MaxEvents          Maximum number of events to place into the \c Events array.
+			 *
+			 *  \return Number of MIDI event packets received, or zero if none were waiting.
+			 */
+			uint8_t MIDI_Device_ReceiveEvents(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+			                                  MIDI_EventPacket_t* const Events,
+			                                  const uint8_t MaxEvents) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
 		/* Inline Functions: */
 			/** Processes incoming control requests from the host, that are directed to the given MIDI class interface. This should be
 			 *  linked to the library \ref EVENT_USB_Device_ControlRequest() event.
@@ -164,6 +209,20 @@
 				(void)MIDIInterfaceInfo;
 			}
 
+			/** Indicates that a millisecond has elapsed on the given MIDI interface, advancing its data IN latency timer. This
+			 *  should be called once per millisecond when \c Config.LatencyTimerMS is set. It is recommended that this be called
+			 *  by the \ref EVENT_USB_Device_StartOfFrame() event, once SOF events have been enabled via
+			 *  \ref USB_Device_EnableSOFEvents().
+			 *
+			 *  \param[in,out] MIDIInterfaceInfo  Pointer to a structure containing a MIDI Class configuration and state.
+			 */
+			static inline void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo) ATTR_ALWAYS_INLINE ATTR_NON_NULL_PTR_ARG(1);
+			static inline void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
+			{
+				if (MIDIInterfaceInfo->State.LatencyTimerElapsedMS < MIDIInterfaceInfo->Config.LatencyTimerMS)
+				  MIDIInterfaceInfo->State.LatencyTimerElapsedMS++;
+			}
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
@@ -131,6 +131,210 @@ void MS_Device_USBTask(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo)
 	}
 }
 
+uint8_t MS_Device_TransferBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                 const MS_BlockDevice_t* const BlockDevice,
+                                 const bool IsDataRead,
+                                 MS_BlockAddress_t BlockAddress,
+                                 uint32_t TotalBlocks)
+{
+	uint16_t HalfBufferSize  = (MSInterfaceInfo->Config.DataBufferSize / 2);
+	uint16_t BlocksPerBuffer = (HalfBufferSize / BlockDevice->BlockSize);
+	uint8_t* Buffers[2]      = {MSInterfaceInfo->Config.DataBuffer, &MSInterfaceInfo->Config.DataBuffer[HalfBufferSize]};
+	uint8_t  CurrentBuffer   = 0;
+	uint8_t  ErrorCode       = MS_TRANSFER_NoError;
+	uint16_t ChunkBlocks;
+
+	if ((MSInterfaceInfo->Config.DataBuffer == NULL) || !(BlocksPerBuffer))
+	  return MS_TRANSFER_InvalidBuffer;
+
+	if (!(MS_Device_ClaimMedia(MSInterfaceInfo, BlockDevice)))
+	  return MS_TRANSFER_Aborted;
+
+	if (IsDataRead)
+	{
+		ChunkBlocks = MIN(TotalBlocks, BlocksPerBuffer);
+
+		if (TotalBlocks && !(MS_Device_StartMedia(MSInterfaceInfo, BlockDevice, true, BlockAddress, ChunkBlocks, Buffers[0])))
+		  return MS_TRANSFER_MediaError;
+
+		while (TotalBlocks)
+		{
+			uint16_t SendBlocks = ChunkBlocks;
+
+			if (!(MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice)))
+			{
+				ErrorCode = MS_TRANSFER_MediaError;
+				break;
+			}
+
+			BlockAddress += SendBlocks;
+			TotalBlocks  -= SendBlocks;
+
+			/* Prefetch the next buffer of blocks from the media while the current one is sent to the host */
+			if (TotalBlocks)
+			{
+				ChunkBlocks = MIN(TotalBlocks, BlocksPerBuffer);
+
+				if (!(MS_Device_StartMedia(MSInterfaceInfo, BlockDevice, true, BlockAddress, ChunkBlocks, Buffers[CurrentBuffer ^ 1])))
+				{
+					ErrorCode = MS_TRANSFER_MediaError;
+					break;
+				}
+			}
+
+			if ((ErrorCode = MS_Device_StreamBuffer(MSInterfaceInfo, BlockDevice, true, Buffers[CurrentBuffer],
+			                                        (SendBlocks * BlockDevice->BlockSize))) != MS_TRANSFER_NoError)
+			{
+				break;
+			}
+
+			CurrentBuffer ^= 1;
+		}
+
+		/* If the endpoint is full, send its contents to the host */
+		if ((ErrorCode == MS_TRANSFER_NoError) && !(Endpoint_IsReadWriteAllowed()))
+		  Endpoint_ClearIN();
+	}
+	else
+	{
+		while (TotalBlocks)
+		{
+			ChunkBlocks = MIN(TotalBlocks, BlocksPerBuffer);
+
+			if ((ErrorCode = MS_Device_StreamBuffer(MSInterfaceInfo, BlockDevice, false, Buffers[CurrentBuffer],
+			                                        (ChunkBlocks * BlockDevice->BlockSize))) != MS_TRANSFER_NoError)
+			{
+				break;
+			}
+
+			/* The previous buffer has been committed to the media while this one was received from the host */
+			if (!(MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice)) ||
+			    !(MS_Device_StartMedia(MSInterfaceInfo, BlockDevice, false, BlockAddress, ChunkBlocks, Buffers[CurrentBuffer])))
+			{
+				ErrorCode = MS_TRANSFER_MediaError;
+				break;
+			}
+
+			BlockAddress  += ChunkBlocks;
+			TotalBlocks   -= ChunkBlocks;
+			CurrentBuffer ^= 1;
+		}
+
+		/* If the endpoint is empty, clear it ready for the next packet from the host */
+		if ((ErrorCode == MS_TRANSFER_NoError) && !(Endpoint_IsReadWriteAllowed()))
+		  Endpoint_ClearOUT();
+	}
+
+	/* Any media operation still outstanding owns one of the buffer halves, and must complete before they are reused */
+	if (!(MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice)) && (ErrorCode == MS_TRANSFER_NoError))
+	  ErrorCode = MS_TRANSFER_MediaError;
+
+	return ErrorCode;
+}
+
+uint8_t MS_Device_VerifyBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                               const MS_BlockDevice_t* const BlockDevice,
+                               MS_BlockAddress_t BlockAddress,
+                               uint32_t TotalBlocks)
+{
+	uint16_t BlocksPerBuffer = (MSInterfaceInfo->Config.DataBufferSize / BlockDevice->BlockSize);
+
+	if ((MSInterfaceInfo->Config.DataBuffer == NULL) || !(BlocksPerBuffer))
+	  return MS_TRANSFER_InvalidBuffer;
+
+	if (!(MS_Device_ClaimMedia(MSInterfaceInfo, BlockDevice)))
+	  return MS_TRANSFER_Aborted;
+
+	/* Nothing is sent to the host, so both halves of the data buffer are read into at once */
+	while (TotalBlocks)
+	{
+		uint16_t ChunkBlocks = MIN(TotalBlocks, BlocksPerBuffer);
+
+		MSInterfaceInfo->State.IsMediaFailed = false;
+
+		if (!(MS_Device_StartMedia(MSInterfaceInfo, BlockDevice, true, BlockAddress, ChunkBlocks, MSInterfaceInfo->Config.DataBuffer)) ||
+		    !(MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice)))
+		{
+			return MS_TRANSFER_MediaError;
+		}
+
+		if (MSInterfaceInfo->State.IsMassStoreReset)
+		  return MS_TRANSFER_Aborted;
+
+		BlockAddress += ChunkBlocks;
+		TotalBlocks  -= ChunkBlocks;
+	}
+
+	return MS_TRANSFER_NoError;
+}
+
+uint8_t MS_Device_ReceiveParameterList(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                       const MS_BlockDevice_t* const BlockDevice,
+                                       const uint16_t Length)
+{
+	uint8_t ErrorCode;
+
+	if ((MSInterfaceInfo->Config.DataBuffer == NULL) || (Length > MSInterfaceInfo->Config.DataBufferSize))
+	  return MS_TRANSFER_InvalidBuffer;
+
+	if (!(MS_Device_ClaimMedia(MSInterfaceInfo, BlockDevice)))
+	  return MS_TRANSFER_Aborted;
+
+	if ((ErrorCode = MS_Device_StreamBuffer(MSInterfaceInfo, BlockDevice, false, MSInterfaceInfo->Config.DataBuffer,
+	                                        Length)) != MS_TRANSFER_NoError)
+	{
+		return ErrorCode;
+	}
+
+	/* If the endpoint is empty, clear it ready for the next packet from the host */
+	if (!(Endpoint_IsReadWriteAllowed()))
+	  Endpoint_ClearOUT();
+
+	return MS_TRANSFER_NoError;
+}
+
+bool MS_Device_FlushBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                           const MS_BlockDevice_t* const BlockDevice)
+{
+	if (BlockDevice->StartFlush == NULL)
+	  return true;
+
+	if (!(MS_Device_ClaimMedia(MSInterfaceInfo, BlockDevice)))
+	  return false;
+
+	MSInterfaceInfo->State.IsMediaBusy = true;
+
+	if (!(BlockDevice->StartFlush(BlockDevice, MS_Device_MediaComplete, MSInterfaceInfo)))
+	{
+		MSInterfaceInfo->State.IsMediaBusy = false;
+		return false;
+	}
+
+	return MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice);
+}
+
+bool MS_Device_UnmapBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                           const MS_BlockDevice_t* const BlockDevice,
+                           const MS_BlockAddress_t BlockAddress,
+                           const uint32_t TotalBlocks)
+{
+	if (BlockDevice->StartUnmap == NULL)
+	  return false;
+
+	if (!(MS_Device_ClaimMedia(MSInterfaceInfo, BlockDevice)))
+	  return false;
+
+	MSInterfaceInfo->State.IsMediaBusy = true;
+
+	if (!(BlockDevice->StartUnmap(BlockDevice, BlockAddress, TotalBlocks, MS_Device_MediaComplete, MSInterfaceInfo)))
+	{
+		MSInterfaceInfo->State.IsMediaBusy = false;
+		return false;
+	}
+
+	return MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice);
+}
+
 static bool MS_Device_ReadInCommandBlock(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo)
 {
 	uint16_t BytesProcessed;
@@ -211,5 +415,501 @@ static void MS_Device_ReturnCommandStatus(USB_ClassInfo_MS_Device_t* const MSInt
 	Endpoint_ClearIN();
 }
 
+static void MS_Device_MediaComplete(void* const Context,
+                                    const bool Success)
+{
+	USB_ClassInfo_MS_Device_t* const MSInterfaceInfo = (USB_ClassInfo_MS_Device_t*)Context;
+
+	if (!(Success))
+	  MSInterfaceInfo->State.IsMediaFailed = true;
+
+	MSInterfaceInfo->State.IsMediaBusy = false;
+}
+
+static bool MS_Device_StartMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                 const MS_BlockDevice_t* const BlockDevice,
+                                 const bool IsDataRead,
+                                 const MS_BlockAddress_t BlockAddress,
+                                 const uint16_t TotalBlocks,
+                                 uint8_t* const Buffer)
+{
+	bool Started;
+
+	/* Marked busy before starting, as a synchronous block device completes before its start function returns */
+	MSInterfaceInfo->State.IsMediaBusy = true;
+
+	if (IsDataRead)
+	  Started = BlockDevice->StartRead(BlockDevice, BlockAddress, TotalBlocks, Buffer, MS_Device_MediaComplete, MSInterfaceInfo);
+	else
+	  Started = BlockDevice->StartWrite(BlockDevice, BlockAddress, TotalBlocks, Buffer, MS_Device_MediaComplete, MSInterfaceInfo);
+
+	if (!(Started))
+	  MSInterfaceInfo->State.IsMediaBusy = false;
+
+	return Started;
+}
+
+static bool MS_Device_WaitForMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                   const MS_BlockDevice_t* const BlockDevice)
+{
+	while (MSInterfaceInfo->State.IsMediaBusy)
+	{
+		/* The command is abandoned on a reset or loss of configuration, leaving the operation to finish in the background */
+		if (MSInterfaceInfo->State.IsMassStoreReset || (USB_DeviceState != DEVICE_STATE_Configured))
+		  return false;
+
+		if (BlockDevice->Task != NULL)
+		  BlockDevice->Task(BlockDevice);
+	}
+
+	return !(MSInterfaceInfo->State.IsMediaFailed);
+}
+
+static bool MS_Device_ClaimMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                 const MS_BlockDevice_t* const BlockDevice)
+{
+	/* An operation abandoned by an earlier command still owns part of the data buffer, and must complete first */
+	MS_Device_WaitForMedia(MSInterfaceInfo, BlockDevice);
+
+	MSInterfaceInfo->State.IsMediaFailed = false;
+
+	return !(MSInterfaceInfo->State.IsMediaBusy);
+}
+
+static uint8_t MS_Device_StreamBuffer(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                      const MS_BlockDevice_t* const BlockDevice,
+                                      const bool IsDataRead,
+                                      uint8_t* const Buffer,
+                                      const uint16_t Length)
+{
+	uint16_t BytesProcessed = 0;
+	uint8_t  ErrorCode;
+
+	/* The stream returns after each endpoint bank, so that the media can be serviced between packets */
+	for (;;)
+	{
+		if (IsDataRead)
+		  ErrorCode = Endpoint_Write_Stream_LE(Buffer, Length, &BytesProcessed);
+		else
+		  ErrorCode = Endpoint_Read_Stream_LE(Buffer, Length, &BytesProcessed);
+
+		if (ErrorCode != ENDPOINT_RWSTREAM_IncompleteTransfer)
+		  break;
+
+		if (MSInterfaceInfo->State.IsMassStoreReset)
+		  return MS_TRANSFER_Aborted;
+
+		if (BlockDevice->Task != NULL)
+		  BlockDevice->Task(BlockDevice);
+	}
+
+	if (ErrorCode != ENDPOINT_RWSTREAM_NoError)
+	  return MS_TRANSFER_EndpointError;
+
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength =
+	    cpu_to_le32(le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength) - Length);
+
+	return MS_TRANSFER_NoError;
+}
+
+void MS_Device_InitBlockCache(MS_Device_BlockCache_t* const Cache)
+{
+	uint16_t TotalLines = ((uint16_t)Cache->Config.TotalSets * Cache->Config.Ways);
+
+	memset(&Cache->State, 0x00, sizeof(Cache->State));
+
+	Cache->State.BlockDevice.BlockSize  = Cache->Config.BlockDevice->BlockSize;
+	Cache->State.BlockDevice.DeviceData = Cache;
+	Cache->State.BlockDevice.StartRead  = MS_Device_BlockCacheStartRead;
+	Cache->State.BlockDevice.StartWrite = MS_Device_BlockCacheStartWrite;
+	Cache->State.BlockDevice.StartFlush = MS_Device_BlockCacheStartFlush;
+	Cache->State.BlockDevice.Task       = MS_Device_BlockCacheTask;
+
+	if (Cache->Config.BlockDevice->StartUnmap != NULL)
+	  Cache->State.BlockDevice.StartUnmap = MS_Device_BlockCacheStartUnmap;
+
+	for (uint16_t LineIndex = 0; LineIndex < TotalLines; LineIndex++)
+	{
+		Cache->Config.Lines[LineIndex].Flags = 0;
+		Cache->Config.Lines[LineIndex].Age   = (LineIndex % Cache->Config.Ways);
+	}
+}
+
+bool MS_Device_FlushBlockCache(MS_Device_BlockCache_t* const Cache)
+{
+	const MS_BlockDevice_t* BlockDevice = Cache->Config.BlockDevice;
+	uint16_t TotalLines = ((uint16_t)Cache->Config.TotalSets * Cache->Config.Ways);
+	bool     Success    = true;
+
+	if (!(MS_Device_BlockCacheClaimMedia(Cache)))
+	  return false;
+
+	for (uint16_t LineIndex = 0; LineIndex < TotalLines; LineIndex++)
+	{
+		MS_BlockCache_Line_t* Line = &Cache->Config.Lines[LineIndex];
+
+		if (!(Line->Flags & MS_BLOCKCACHE_LINE_DIRTY))
+		  continue;
+
+		/* A line which cannot be written back stays dirty, so that a later flush can retry it */
+		if (MS_Device_BlockCacheMediaIO(Cache, false, Line->BlockAddress, 1, MS_Device_BlockCacheLineData(Cache, Line)))
+		  Line->Flags &= ~MS_BLOCKCACHE_LINE_DIRTY;
+		else
+		  Success = false;
+	}
+
+	if (Success && (BlockDevice->StartFlush != NULL))
+	{
+		Cache->State.IsMediaBusy = true;
+
+		if (!(BlockDevice->StartFlush(BlockDevice, MS_Device_BlockCacheMediaComplete, Cache)))
+		{
+			Cache->State.IsMediaBusy = false;
+			return false;
+		}
+
+		Success = MS_Device_BlockCacheWaitForMedia(Cache);
+	}
+
+	return Success;
+}
+
+static void MS_Device_BlockCacheMediaComplete(void* const Context,
+                                              const bool Success)
+{
+	MS_Device_BlockCache_t* const Cache    = (MS_Device_BlockCache_t*)Context;
+	MS_BlockDevice_Callback_t     Callback = Cache->State.AbandonedCallback;
+
+	if (!(Success))
+	  Cache->State.IsMediaFailed = true;
+
+	Cache->State.IsMediaBusy = false;
+
+	/* A request whose wait was abandoned completes along with the media operation still holding its buffers */
+	if (Callback != NULL)
+	{
+		Cache->State.AbandonedCallback = NULL;
+		Callback(Cache->State.AbandonedContext, false);
+	}
+}
+
+static bool MS_Device_BlockCacheWaitForMedia(MS_Device_BlockCache_t* const Cache)
+{
+	const MS_BlockDevice_t* BlockDevice = Cache->Config.BlockDevice;
+
+	while (Cache->State.IsMediaBusy)
+	{
+		/* The wait is abandoned on a reset or loss of configuration, leaving the operation to finish in the background */
+		if (((Cache->Config.AbortFlag != NULL) && *(Cache->Config.AbortFlag)) || (USB_DeviceState != DEVICE_STATE_Configured))
+		  return false;
+
+		if (BlockDevice->Task != NULL)
+		  BlockDevice->Task(BlockDevice);
+	}
+
+	return !(Cache->State.IsMediaFailed);
+}
+
+static bool MS_Device_BlockCacheClaimMedia(MS_Device_BlockCache_t* const Cache)
+{
+	/* An operation abandoned by an earlier request still owns a cache line or a request buffer, and must complete first */
+	MS_Device_BlockCacheWaitForMedia(Cache);
+
+	Cache->State.IsMediaFailed = false;
+
+	return !(Cache->State.IsMediaBusy);
+}
+
+static void MS_Device_BlockCacheComplete(MS_Device_BlockCache_t* const Cache,
+                                         const MS_BlockDevice_Callback_t Callback,
+                                         void* const Context,
+                                         const bool Success)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	/* Checked with interrupts disabled, so that a media operation completing from an interrupt cannot miss the callback */
+	if (Cache->State.IsMediaBusy)
+	{
+		Cache->State.AbandonedCallback = Callback;
+		Cache->State.AbandonedContext  = Context;
+
+		SetGlobalInterruptMask(CurrentGlobalInt);
+		return;
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	Callback(Context, Success);
+}
+
+static void MS_Device_BlockCacheTask(const MS_BlockDevice_t* const BlockDevice)
+{
+	const MS_BlockDevice_t* MediaDevice = ((MS_Device_BlockCache_t*)BlockDevice->DeviceData)->Config.BlockDevice;
+
+	if (MediaDevice->Task != NULL)
+	  MediaDevice->Task(MediaDevice);
+}
+
+static bool MS_Device_BlockCacheMediaIO(MS_Device_BlockCache_t* const Cache,
+                                        const bool IsDataRead,
+                                        const MS_BlockAddress_t BlockAddress,
+                                        const uint16_t TotalBlocks,
+                                        uint8_t* const Buffer)
+{
+	const MS_BlockDevice_t* BlockDevice = Cache->Config.BlockDevice;
+	bool Started;
+
+	if (!(MS_Device_BlockCacheClaimMedia(Cache)))
+	  return false;
+
+	Cache->State.IsMediaBusy = true;
+
+	if (IsDataRead)
+	  Started = BlockDevice->StartRead(BlockDevice, BlockAddress, TotalBlocks, Buffer, MS_Device_BlockCacheMediaComplete, Cache);
+	else
+	  Started = BlockDevice->StartWrite(BlockDevice, BlockAddress, TotalBlocks, Buffer, MS_Device_BlockCacheMediaComplete, Cache);
+
+	if (!(Started))
+	{
+		Cache->State.IsMediaBusy = false;
+		return false;
+	}
+
+	return MS_Device_BlockCacheWaitForMedia(Cache);
+}
+
+static MS_BlockCache_Line_t* MS_Device_BlockCacheFind(MS_Device_BlockCache_t* const Cache,
+                                                      const MS_BlockAddress_t BlockAddress)
+{
+	MS_BlockCache_Line_t* Line = &Cache->Config.Lines[(BlockAddress % Cache->Config.TotalSets) * Cache->Config.Ways];
+
+	for (uint8_t Way = 0; Way < Cache->Config.Ways; Way++)
+	{
+		if ((Line->Flags & MS_BLOCKCACHE_LINE_VALID) && (Line->BlockAddress == BlockAddress))
+		  return Line;
+
+		Line++;
+	}
+
+	return NULL;
+}
+
+static MS_BlockCache_Line_t* MS_Device_BlockCacheAllocate(MS_Device_BlockCache_t* const Cache,
+                                                          const MS_BlockAddress_t BlockAddress)
+{
+	MS_BlockCache_Line_t* Line   = &Cache->Config.Lines[(BlockAddress % Cache->Config.TotalSets) * Cache->Config.Ways];
+	MS_BlockCache_Line_t* Victim = Line;
+
+	/* Replace an unused line of the set if there is one, otherwise the least recently used line */
+	for (uint8_t Way = 0; Way < Cache->Config.Ways; Way++)
+	{
+		if (!(Line->Flags & MS_BLOCKCACHE_LINE_VALID))
+		{
+			Victim = Line;
+			break;
+		}
+
+		if (Line->Age > Victim->Age)
+		  Victim = Line;
+
+		Line++;
+	}
+
+	if (Victim->Flags & MS_BLOCKCACHE_LINE_DIRTY)
+	{
+		if (!(MS_Device_BlockCacheMediaIO(Cache, false, Victim->BlockAddress, 1, MS_Device_BlockCacheLineData(Cache, Victim))))
+		  return NULL;
+	}
+
+	Victim->BlockAddress = BlockAddress;
+	Victim->Flags        = 0;
+
+	return Victim;
+}
+
+static void MS_Device_BlockCacheTouch(MS_Device_BlockCache_t* const Cache,
+                                      MS_BlockCache_Line_t* const Line)
+{
+	MS_BlockCache_Line_t* SetLine = &Cache->Config.Lines[(Line->BlockAddress % Cache->Config.TotalSets) * Cache->Config.Ways];
+
+	/* Age every line of the set which was more recently used than this one, keeping the ages a permutation */
+	for (uint8_t Way = 0; Way < Cache->Config.Ways; Way++)
+	{
+		if (SetLine->Age < Line->Age)
+		  SetLine->Age++;
+
+		SetLine++;
+	}
+
+	Line->Age = 0;
+}
+
+static uint8_t* MS_Device_BlockCacheLineData(MS_Device_BlockCache_t* const Cache,
+                                             MS_BlockCache_Line_t* const Line)
+{
+	return &Cache->Config.LineData[(uint32_t)(Line - Cache->Config.Lines) * Cache->State.BlockDevice.BlockSize];
+}
+
+static bool MS_Device_BlockCacheStartRead(const MS_BlockDevice_t* const BlockDevice,
+                                          const MS_BlockAddress_t BlockAddress,
+                                          const uint16_t TotalBlocks,
+                                          void* const Buffer,
+                                          const MS_BlockDevice_Callback_t Callback,
+                                          void* const Context)
+{
+	MS_Device_BlockCache_t* Cache     = (MS_Device_BlockCache_t*)BlockDevice->DeviceData;
+	uint16_t                BlockSize = BlockDevice->BlockSize;
+	uint8_t*                BlockData = (uint8_t*)Buffer;
+	uint16_t                RunStart  = 0;
+	uint16_t                RunLength = 0;
+	bool                    Success   = true;
+
+	if (!(MS_Device_BlockCacheClaimMedia(Cache)))
+	  return false;
+
+	/* Cached blocks are copied out of the cache, and each run of uncached blocks is read from the media at once */
+	for (uint16_t BlockIndex = 0; BlockIndex <= TotalBlocks; BlockIndex++)
+	{
+		MS_BlockCache_Line_t* Line = NULL;
+
+		if (BlockIndex < TotalBlocks)
+		{
+			Line = MS_Device_BlockCacheFind(Cache, (BlockAddress + BlockIndex));
+
+			if (Line == NULL)
+			{
+				if (!(RunLength++))
+				  RunStart = BlockIndex;
+
+				continue;
+			}
+		}
+
+		if (RunLength)
+		{
+			if (!(MS_Device_BlockCacheMediaIO(Cache, true, (BlockAddress + RunStart), RunLength,
+			                                  &BlockData[(uint32_t)RunStart * BlockSize])))
+			{
+				Success = false;
+				break;
+			}
+
+			RunLength = 0;
+		}
+
+		if (Line != NULL)
+		{
+			memcpy(&BlockData[(uint32_t)BlockIndex * BlockSize], MS_Device_BlockCacheLineData(Cache, Line), BlockSize);
+			MS_Device_BlockCacheTouch(Cache, Line);
+		}
+	}
+
+	MS_Device_BlockCacheComplete(Cache, Callback, Context, Success);
+	return true;
+}
+
+static bool MS_Device_BlockCacheStartWrite(const MS_BlockDevice_t* const BlockDevice,
+                                           const MS_BlockAddress_t BlockAddress,
+                                           const uint16_t TotalBlocks,
+                                           const void* const Buffer,
+                                           const MS_BlockDevice_Callback_t Callback,
+                                           void* const Context)
+{
+	MS_Device_BlockCache_t* Cache     = (MS_Device_BlockCache_t*)BlockDevice->DeviceData;
+	uint16_t                BlockSize = BlockDevice->BlockSize;
+	const uint8_t*          BlockData = (const uint8_t*)Buffer;
+	bool                    Success   = true;
+
+	if (!(MS_Device_BlockCacheClaimMedia(Cache)))
+	  return false;
+
+	if (TotalBlocks > Cache->Config.MaxCachedWrite)
+	{
+		/* Large writes bypass the cache, with any cached copies of the blocks replaced by the new data */
+		if (MS_Device_BlockCacheMediaIO(Cache, false, BlockAddress, TotalBlocks, (uint8_t*)BlockData))
+		{
+			for (uint16_t BlockIndex = 0; BlockIndex < TotalBlocks; BlockIndex++)
+			{
+				MS_BlockCache_Line_t* Line = MS_Device_BlockCacheFind(Cache, (BlockAddress + BlockIndex));
+
+				if (Line == NULL)
+				  continue;
+
+				memcpy(MS_Device_BlockCacheLineData(Cache, Line), &BlockData[(uint32_t)BlockIndex * BlockSize], BlockSize);
+				Line->Flags &= ~MS_BLOCKCACHE_LINE_DIRTY;
+			}
+		}
+		else
+		{
+			Success = false;
+		}
+	}
+	else
+	{
+		for (uint16_t BlockIndex = 0; BlockIndex < TotalBlocks; BlockIndex++)
+		{
+			MS_BlockCache_Line_t* Line = MS_Device_BlockCacheFind(Cache, (BlockAddress + BlockIndex));
+
+			if ((Line == NULL) && ((Line = MS_Device_BlockCacheAllocate(Cache, (BlockAddress + BlockIndex))) == NULL))
+			{
+				Success = false;
+				break;
+			}
+
+			memcpy(MS_Device_BlockCacheLineData(Cache, Line), &BlockData[(uint32_t)BlockIndex * BlockSize], BlockSize);
+			Line->Flags = (MS_BLOCKCACHE_LINE_VALID | MS_BLOCKCACHE_LINE_DIRTY);
+			MS_Device_BlockCacheTouch(Cache, Line);
+		}
+	}
+
+	MS_Device_BlockCacheComplete(Cache, Callback, Context, Success);
+	return true;
+}
+
+static bool MS_Device_BlockCacheStartFlush(const MS_BlockDevice_t* const BlockDevice,
+                                           const MS_BlockDevice_Callback_t Callback,
+                                           void* const Context)
+{
+	MS_Device_BlockCache_t* Cache = (MS_Device_BlockCache_t*)BlockDevice->DeviceData;
+
+	MS_Device_BlockCacheComplete(Cache, Callback, Context, MS_Device_FlushBlockCache(Cache));
+	return true;
+}
+
+static bool MS_Device_BlockCacheStartUnmap(const MS_BlockDevice_t* const BlockDevice,
+                                           const MS_BlockAddress_t BlockAddress,
+                                           const uint32_t TotalBlocks,
+                                           const MS_BlockDevice_Callback_t Callback,
+                                           void* const Context)
+{
+	MS_Device_BlockCache_t* Cache       = (MS_Device_BlockCache_t*)BlockDevice->DeviceData;
+	const MS_BlockDevice_t* MediaDevice = Cache->Config.BlockDevice;
+	uint16_t                TotalLines  = ((uint16_t)Cache->Config.TotalSets * Cache->Config.Ways);
+
+	if (!(MS_Device_BlockCacheClaimMedia(Cache)))
+	  return false;
+
+	/* Cached copies of discarded blocks are dropped, so that dirty lines are not later written back over the unmap */
+	for (uint16_t LineIndex = 0; LineIndex < TotalLines; LineIndex++)
+	{
+		MS_BlockCache_Line_t* Line = &Cache->Config.Lines[LineIndex];
+
+		if ((Line->BlockAddress >= BlockAddress) && ((Line->BlockAddress - BlockAddress) < TotalBlocks))
+		  Line->Flags = 0;
+	}
+
+	Cache->State.IsMediaBusy = true;
+
+	if (!(MediaDevice->StartUnmap(MediaDevice, BlockAddress, TotalBlocks, MS_Device_BlockCacheMediaComplete, Cache)))
+	{
+		Cache->State.IsMediaBusy = false;
+		return false;
+	}
+
+	MS_Device_BlockCacheComplete(Cache, Callback, Context, MS_Device_BlockCacheWaitForMedia(Cache));
+	return true;
+}
+
 #endif
 
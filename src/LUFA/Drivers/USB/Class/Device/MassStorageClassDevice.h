@@ -68,7 +68,176 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Flag for \ref MS_BlockCache_Line_t, indicating that the line holds a valid copy of a block. */
+			#define MS_BLOCKCACHE_LINE_VALID       (1 << 0)
+
+			/** Flag for \ref MS_BlockCache_Line_t, indicating that the line holds data not yet written to the media. */
+			#define MS_BLOCKCACHE_LINE_DIRTY       (1 << 1)
+
+			#if defined(__DOXYGEN__)
+				/** Compile time token which widens \ref MS_BlockAddress_t to 64 bits, for media of more than 2^32 blocks
+				 *  (2TB of 512 byte blocks). Without it block addresses are 32 bits wide, which is smaller and faster on
+				 *  8-bit architectures, and larger media is reported to the host truncated to 2^32 blocks.
+				 */
+				#define MS_DEVICE_64BIT_BLOCK_ADDRESSES
+			#endif
+
+		/* Enums: */
+			/** Enum for the possible error return codes of the \ref MS_Device_TransferBlocks() function. */
+			enum MS_Device_TransferBlocks_ErrorCodes_t
+			{
+				MS_TRANSFER_NoError            = 0, /**< All requested blocks were transferred between the host and the media. */
+				MS_TRANSFER_MediaError         = 1, /**< The block device failed to start or complete a read or write operation. */
+				MS_TRANSFER_EndpointError      = 2, /**< The data endpoint stalled, or the device was disconnected, suspended or
+				                                     *   timed out while waiting for the host.
+				                                     */
+				MS_TRANSFER_Aborted            = 3, /**< The host issued a Mass Storage Reset request, or deconfigured the device, during the transfer. */
+				MS_TRANSFER_InvalidBuffer      = 4, /**< No data buffer was configured, or its halves are smaller than one block. */
+			};
+
 		/* Type Defines: */
+			#if defined(MS_DEVICE_64BIT_BLOCK_ADDRESSES) || defined(__DOXYGEN__)
+				/** Type define for the address of a media block, 32 bits wide unless \c MS_DEVICE_64BIT_BLOCK_ADDRESSES is defined. */
+				typedef uint64_t MS_BlockAddress_t;
+			#else
+				typedef uint32_t MS_BlockAddress_t;
+			#endif
+
+			/** Type define for the completion callback of a block device operation. The block device must call this
+			 *  exactly once for each operation it accepted, either from within the start function itself for a
+			 *  synchronous media, or later (e.g. from an interrupt) once the media has finished the operation.
+			 *
+			 *  \param[in] Context  Context pointer given to the block device when the operation was started.
+			 *  \param[in] Success  Boolean \c true if the operation completed successfully, \c false on a media error.
+			 */
+			typedef void (*MS_BlockDevice_Callback_t)(void* const Context,
+			                                          const bool Success);
+
+			/** \brief Mass Storage Class Device Mode Block Device Interface.
+			 *
+			 *  Interface through which a storage media backend (e.g. an external Dataflash or SPI NOR/NAND flash, internal
+			 *  microcontroller flash or a RAM disk) is plugged into \ref MS_Device_TransferBlocks(). Operations are started
+			 *  by the class driver and complete asynchronously through the given callback, so that the media can commit or
+			 *  fetch one buffer of blocks while the next buffer is exchanged with the host. At most one operation is
+			 *  outstanding on a block device at any time. Each function is passed the block device it was called through,
+			 *  so that one implementation may serve several instances through their \c DeviceData.
+			 */
+			typedef struct MS_BlockDevice
+			{
+				uint16_t BlockSize; /**< Size in bytes of each block of the media. */
+				void*    DeviceData; /**< Backend specific data for the functions of the block device, may be \c NULL. */
+
+				bool (*StartRead)(const struct MS_BlockDevice* const BlockDevice,
+				                  const MS_BlockAddress_t BlockAddress,
+				                  const uint16_t TotalBlocks,
+				                  void* const Buffer,
+				                  const MS_BlockDevice_Callback_t Callback,
+				                  void* const Context); /**< Starts reading the given blocks from the media into the buffer,
+				                                         *   returning \c false if the read could not be started. The buffer
+				                                         *   is owned by the block device until the callback is made.
+				                                         */
+				bool (*StartWrite)(const struct MS_BlockDevice* const BlockDevice,
+				                   const MS_BlockAddress_t BlockAddress,
+				                   const uint16_t TotalBlocks,
+				                   const void* const Buffer,
+				                   const MS_BlockDevice_Callback_t Callback,
+				                   void* const Context); /**< Starts writing the given blocks from the buffer to the media,
+				                                          *   returning \c false if the write could not be started. The buffer
+				                                          *   is owned by the block device until the callback is made.
+				                                          */
+				bool (*StartFlush)(const struct MS_BlockDevice* const BlockDevice,
+				                   const MS_BlockDevice_Callback_t Callback,
+				                   void* const Context); /**< Starts committing all previously written blocks to non-volatile
+				                                          *   storage, returning \c false if the flush could not be started.
+				                                          *   May be \c NULL if writes are committed as they complete.
+				                                          */
+				bool (*StartUnmap)(const struct MS_BlockDevice* const BlockDevice,
+				                   const MS_BlockAddress_t BlockAddress,
+				                   const uint32_t TotalBlocks,
+				                   const MS_BlockDevice_Callback_t Callback,
+				                   void* const Context); /**< Starts discarding the contents of the given blocks, which the host
+				                                          *   no longer uses (a TRIM), returning \c false if the unmap could not
+				                                          *   be started. Discarded blocks may read back as any data until they
+				                                          *   are next written. May be \c NULL if the media cannot make use of
+				                                          *   the information.
+				                                          */
+				void (*Task)(const struct MS_BlockDevice* const BlockDevice); /**< Optional routine called repeatedly while the
+				                                                              *   class driver waits on the host or on the
+				                                                              *   media, for block devices which advance their
+				                                                              *   operations by polling. May be \c NULL.
+				                                                              */
+			} MS_BlockDevice_t;
+
+			/** \brief Mass Storage Class Device Mode Block Cache Line.
+			 *
+			 *  Descriptor of a single line of a \ref MS_Device_BlockCache_t, each holding one media block. An array of
+			 *  these must be supplied for each cache, but its contents are managed entirely by the class driver.
+			 */
+			typedef struct
+			{
+				MS_BlockAddress_t BlockAddress; /**< Media address of the block held in the line. */
+				uint8_t           Flags; /**< Mask of \c MS_BLOCKCACHE_LINE_* flags describing the line's contents. */
+				uint8_t           Age; /**< Least recently used order of the line within its set, zero for the most recent. */
+			} MS_BlockCache_Line_t;
+
+			/** \brief Mass Storage Class Device Mode Write-Back Block Cache.
+			 *
+			 *  Set associative write-back cache of media blocks, placed in front of a slower block device. Blocks written
+			 *  in small runs are held in RAM until they are evicted or the cache is flushed, so that sectors which a host
+			 *  file system rewrites repeatedly (such as the FAT and directory entries) reach the media once instead of on
+			 *  every update, saving erase cycles. Blocks are mapped to a set by their address modulo the number of sets,
+			 *  and the least recently used line of the set is replaced. Reads are served from the cache where possible,
+			 *  with the remaining runs of blocks read directly from the media without being cached.
+			 *
+			 *  The cache is itself a block device, available as \c State.BlockDevice once \ref MS_Device_InitBlockCache()
+			 *  has been called. Its operations wait on the underlying block device, and so normally complete before their
+			 *  start function returns. If the wait is abandoned by a reset or deconfiguration, the operation instead
+			 *  completes, unsuccessfully, once the underlying block device has finished with it. Unmapping is passed through to the underlying block device where it is supported,
+			 *  discarding any cached copies of the unmapped blocks.
+			 */
+			typedef struct
+			{
+				struct
+				{
+					const MS_BlockDevice_t* BlockDevice; /**< Underlying block device holding the media. */
+
+					MS_BlockCache_Line_t* Lines; /**< Array of \c TotalSets * \c Ways line descriptors. */
+					uint8_t*              LineData; /**< Buffer of \c TotalSets * \c Ways blocks, holding the cached data. */
+					uint8_t               TotalSets; /**< Number of sets in the cache, must be non-zero. */
+					uint8_t               Ways; /**< Number of lines in each set, must be non-zero. */
+
+					uint16_t MaxCachedWrite; /**< Largest number of blocks in a single write which is cached. Larger writes,
+					                          *   such as file data, go directly to the underlying block device (updating
+					                          *   any copies held in the cache) so that they do not evict the small and
+					                          *   frequently rewritten blocks.
+					                          */
+
+					volatile bool* AbortFlag; /**< Flag which abandons a wait on the underlying block device when set, normally
+					                           *   the \c State.IsMassStoreReset flag of the Mass Storage interface using the
+					                           *   cache. Waits are also abandoned while the device is not configured. May be
+					                           *   \c NULL.
+					                           */
+				} Config; /**< Config data for the block cache. All elements in this section <b>must</b> be set before
+				           *   \ref MS_Device_InitBlockCache() is called.
+				           */
+				struct
+				{
+					MS_BlockDevice_t BlockDevice; /**< Block device interface of the cache, to pass to \ref MS_Device_TransferBlocks(). */
+
+					volatile bool IsMediaBusy; /**< Flag indicating that an operation on the underlying block device is in progress. */
+					volatile bool IsMediaFailed; /**< Flag indicating that the last operation on the underlying block device failed. */
+
+					MS_BlockDevice_Callback_t AbandonedCallback; /**< Completion callback of a request whose wait on the
+					                                              *   underlying block device was abandoned, made once the
+					                                              *   outstanding operation completes.
+					                                              */
+					void*                     AbandonedContext; /**< Context pointer for \c AbandonedCallback. */
+				} State; /**< State data for the block cache. All elements in this section are reset by
+				          *   \ref MS_Device_InitBlockCache().
+				          */
+			} MS_Device_BlockCache_t;
+
 			/** \brief Mass Storage Class Device Mode Configuration and State Structure.
 			 *
 			 *  Class state structure. An instance of this structure should be made for each Mass Storage interface
@@ -85,6 +254,17 @@
 					USB_Endpoint_Table_t DataOUTEndpoint; /**< Data OUT endpoint configuration table. */
 
 					uint8_t  TotalLUNs; /**< Total number of logical drives in the Mass Storage interface. */
+
+					uint8_t* DataBuffer; /**< Buffer used by \ref MS_Device_TransferBlocks() for the data phase of block commands,
+					                      *   split into two equal halves so that one half can be exchanged with the host while
+					                      *   the other is being committed to or fetched from the media. Each half should hold
+					                      *   a whole number of media blocks. May be \c NULL if \ref MS_Device_TransferBlocks()
+					                      *   is not used by the application.
+					                      *
+					                      *   \note On architectures with a DMA capable USB controller, this buffer should be
+					                      *         32-bit word aligned.
+					                      */
+					uint16_t DataBufferSize; /**< Size of the \c DataBuffer buffer in bytes, covering both halves. */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -99,6 +279,10 @@
 					volatile bool IsMassStoreReset; /**< Flag indicating that the host has requested that the Mass Storage interface be reset
 											         *   and that all current Mass Storage operations should immediately abort.
 											         */
+					volatile bool IsMediaBusy; /**< Flag indicating that a block device operation started by \ref MS_Device_TransferBlocks()
+					                            *   has not yet completed.
+					                            */
+					volatile bool IsMediaFailed; /**< Flag indicating that a block device operation of the current transfer has failed. */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -140,16 +324,183 @@
 			 */
 			bool CALLBACK_MS_Device_SCSICommandReceived(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Transfers the data phase of a block read or write command between the host and a block device, for use from
+			 *  within \ref CALLBACK_MS_Device_SCSICommandReceived(). The transfer is pipelined through the two halves of the
+			 *  interface's \c DataBuffer: when writing, the next buffer of blocks is received from the host while the previous
+			 *  one is being committed to the media, and when reading, the next buffer of blocks is prefetched from the media
+			 *  while the previous one is being sent to the host. The data transfer length of the current command block is
+			 *  reduced by the number of bytes exchanged with the host.
+			 *
+			 *  \pre The data endpoint for the command's direction must be selected, as it is on entry to
+			 *       \ref CALLBACK_MS_Device_SCSICommandReceived().
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in]     BlockDevice      Block device holding the media to transfer to or from.
+			 *  \param[in]     IsDataRead       Boolean \c true to read blocks from the media to the host, \c false to write
+			 *                                  blocks from the host to the media.
+			 *  \param[in]     BlockAddress     Address of the first media block to transfer.
+			 *  \param[in]     TotalBlocks      Number of blocks to transfer.
+			 *
+			 *  \return A value from the \ref MS_Device_TransferBlocks_ErrorCodes_t enum.
+			 */
+			uint8_t MS_Device_TransferBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                                 const MS_BlockDevice_t* const BlockDevice,
+			                                 const bool IsDataRead,
+			                                 MS_BlockAddress_t BlockAddress,
+			                                 uint32_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Reads blocks from a block device into the interface's \c DataBuffer without sending them to the host, to check
+			 *  that they can be read back from the media (e.g. for a SCSI VERIFY command). There is no data phase.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in]     BlockDevice      Block device holding the media to verify.
+			 *  \param[in]     BlockAddress     Address of the first media block to verify.
+			 *  \param[in]     TotalBlocks      Number of blocks to verify.
+			 *
+			 *  \return A value from the \ref MS_Device_TransferBlocks_ErrorCodes_t enum.
+			 */
+			uint8_t MS_Device_VerifyBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                               const MS_BlockDevice_t* const BlockDevice,
+			                               MS_BlockAddress_t BlockAddress,
+			                               uint32_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Receives a command's parameter list from the host into the interface's \c DataBuffer (e.g. for a SCSI UNMAP
+			 *  command). Any block device operation abandoned by an earlier command still owns the buffer, so is waited on
+			 *  before the data phase starts.
+			 *
+			 *  \pre The OUT data endpoint must be selected, as it is on entry to \ref CALLBACK_MS_Device_SCSICommandReceived()
+			 *       for a command which sends data to the device.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in]     BlockDevice      Block device which may still hold the data buffer.
+			 *  \param[in]     Length           Length in bytes of the parameter list, which must fit into the data buffer.
+			 *
+			 *  \return A value from the \ref MS_Device_TransferBlocks_ErrorCodes_t enum.
+			 */
+			uint8_t MS_Device_ReceiveParameterList(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                                       const MS_BlockDevice_t* const BlockDevice,
+			                                       const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Flushes a block device, waiting until all previously written blocks have been committed to the media. Block
+			 *  devices which do not support flushing are considered to always be flushed.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in]     BlockDevice      Block device to flush.
+			 *
+			 *  \return Boolean \c true if the block device was flushed, \c false on a media error.
+			 */
+			bool MS_Device_FlushBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                           const MS_BlockDevice_t* const BlockDevice) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Discards the contents of a range of blocks on a block device, waiting until the block device has accepted the
+			 *  request.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in]     BlockDevice      Block device holding the media, which must support unmapping.
+			 *  \param[in]     BlockAddress     Address of the first media block to discard.
+			 *  \param[in]     TotalBlocks      Number of blocks to discard.
+			 *
+			 *  \return Boolean \c true if the blocks were discarded, \c false if the block device does not support unmapping
+			 *          or failed the request.
+			 */
+			bool MS_Device_UnmapBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                           const MS_BlockDevice_t* const BlockDevice,
+			                           const MS_BlockAddress_t BlockAddress,
+			                           const uint32_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Initializes a write-back block cache, invalidating all of its lines and setting up its block device
+			 *  interface in \c State.BlockDevice. This must be called before the cache is first used, after its
+			 *  configuration has been set, and may be called again to discard the cache contents (e.g. after the
+			 *  media has been changed).
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing a block cache configuration and state.
+			 */
+			void MS_Device_InitBlockCache(MS_Device_BlockCache_t* const Cache) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Writes all dirty lines of a write-back block cache to the underlying block device, and then flushes the
+			 *  underlying block device if it supports flushing. This should be called when the host requests that the
+			 *  media be synchronized, or when the host may be about to remove power (e.g. when it prevents or allows
+			 *  medium removal, or stops the unit).
+			 *
+			 *  \param[in,out] Cache  Pointer to a structure containing a block cache configuration and state.
+			 *
+			 *  \return Boolean \c true if all cached data was committed to the media, \c false otherwise.
+			 */
+			bool MS_Device_FlushBlockCache(MS_Device_BlockCache_t* const Cache) ATTR_NON_NULL_PTR_ARG(1);
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
 			#if defined(__INCLUDE_FROM_MASSSTORAGE_DEVICE_C)
 				static void MS_Device_ReturnCommandStatus(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 				static bool MS_Device_ReadInCommandBlock(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+				static void MS_Device_MediaComplete(void* const Context,
+				                                    const bool Success);
+				static bool MS_Device_StartMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                 const MS_BlockDevice_t* const BlockDevice,
+				                                 const bool IsDataRead,
+				                                 const MS_BlockAddress_t BlockAddress,
+				                                 const uint16_t TotalBlocks,
+				                                 uint8_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_Device_WaitForMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                   const MS_BlockDevice_t* const BlockDevice) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_Device_ClaimMedia(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                 const MS_BlockDevice_t* const BlockDevice) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static uint8_t MS_Device_StreamBuffer(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                      const MS_BlockDevice_t* const BlockDevice,
+				                                      const bool IsDataRead,
+				                                      uint8_t* const Buffer,
+				                                      const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+				static void MS_Device_BlockCacheMediaComplete(void* const Context,
+				                                              const bool Success);
+				static bool MS_Device_BlockCacheWaitForMedia(MS_Device_BlockCache_t* const Cache) ATTR_NON_NULL_PTR_ARG(1);
+				static bool MS_Device_BlockCacheClaimMedia(MS_Device_BlockCache_t* const Cache) ATTR_NON_NULL_PTR_ARG(1);
+				static void MS_Device_BlockCacheComplete(MS_Device_BlockCache_t* const Cache,
+				                                         const MS_BlockDevice_Callback_t Callback,
+				                                         void* const Context,
+				                                         const bool Success) ATTR_NON_NULL_PTR_ARG(1);
+				static void MS_Device_BlockCacheTask(const MS_BlockDevice_t* const BlockDevice);
+				static bool MS_Device_BlockCacheMediaIO(MS_Device_BlockCache_t* const Cache,
+				                                        const bool IsDataRead,
+				                                        const MS_BlockAddress_t BlockAddress,
+				                                        const uint16_t TotalBlocks,
+				                                        uint8_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1);
+				static MS_BlockCache_Line_t* MS_Device_BlockCacheFind(MS_Device_BlockCache_t* const Cache,
+				                                                      const MS_BlockAddress_t BlockAddress) ATTR_NON_NULL_PTR_ARG(1);
+				static MS_BlockCache_Line_t* MS_Device_BlockCacheAllocate(MS_Device_BlockCache_t* const Cache,
+				                                                          const MS_BlockAddress_t BlockAddress) ATTR_NON_NULL_PTR_ARG(1);
+				static void MS_Device_BlockCacheTouch(MS_Device_BlockCache_t* const Cache,
+				                                      MS_BlockCache_Line_t* const Line) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static uint8_t* MS_Device_BlockCacheLineData(MS_Device_BlockCache_t* const Cache,
+				                                             MS_BlockCache_Line_t* const Line) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_Device_BlockCacheStartRead(const MS_BlockDevice_t* const BlockDevice,
+				                                          const MS_BlockAddress_t BlockAddress,
+				                                          const uint16_t TotalBlocks,
+				                                          void* const Buffer,
+				                                          const MS_BlockDevice_Callback_t Callback,
+				                                          void* const Context);
+				static bool MS_Device_BlockCacheStartWrite(const MS_BlockDevice_t* const BlockDevice,
+				                                           const MS_BlockAddress_t BlockAddress,
+				                                           const uint16_t TotalBlocks,
+				                                           const void* const Buffer,
+				                                           const MS_BlockDevice_Callback_t Callback,
+				                                           void* const Context);
+				static bool MS_Device_BlockCacheStartFlush(const MS_BlockDevice_t* const BlockDevice,
+				                                           const MS_BlockDevice_Callback_t Callback,
+				                                           void* const Context);
+				static bool MS_Device_BlockCacheStartUnmap(const MS_BlockDevice_t* const BlockDevice,
+				                                           const MS_BlockAddress_t BlockAddress,
+				                                           const uint32_t TotalBlocks,
+				                                           const MS_BlockDevice_Callback_t Callback,
+				                                           void* const Context);
 			#endif
 
 	#endif
 
+	/* Includes: */
+		#include "MassStorageSCSITarget.h"
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
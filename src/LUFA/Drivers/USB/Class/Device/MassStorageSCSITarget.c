@@ -0,0 +1,631 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../../Core/USBMode.h"
+
+#if defined(USB_CAN_BE_DEVICE)
+
+#define  __INCLUDE_FROM_MS_DRIVER
+#define  __INCLUDE_FROM_MASSSTORAGE_SCSITARGET_C
+#include "MassStorageSCSITarget.h"
+
+bool MS_Device_ProcessSCSICommand(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                  MS_SCSI_LUN_t* const LUNs)
+{
+	MS_SCSI_LUN_t* LUN            = &LUNs[MSInterfaceInfo->State.CommandBlock.LUN];
+	uint8_t*       CommandData    = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	bool           CommandSuccess = false;
+
+	switch (CommandData[0])
+	{
+		case SCSI_CMD_INQUIRY:
+			CommandSuccess = MS_SCSI_Command_Inquiry(MSInterfaceInfo, LUN);
+			break;
+		case SCSI_CMD_REQUEST_SENSE:
+			CommandSuccess = MS_SCSI_Command_RequestSense(MSInterfaceInfo, LUN);
+			break;
+		case SCSI_CMD_TEST_UNIT_READY:
+			/* Hosts poll this regularly while idle, so it is also used to commit any written data */
+			CommandSuccess = (MS_SCSI_CheckMedium(LUN) && MS_SCSI_Command_SynchronizeCache(MSInterfaceInfo, LUN));
+			break;
+		case SCSI_CMD_START_STOP_UNIT:
+		case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+		case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+		case SCSI_CMD_SYNCHRONIZE_CACHE_16:
+			CommandSuccess = MS_SCSI_Command_SynchronizeCache(MSInterfaceInfo, LUN);
+			break;
+		case SCSI_CMD_READ_CAPACITY_10:
+			CommandSuccess = MS_SCSI_Command_ReadCapacity(MSInterfaceInfo, LUN, false);
+			break;
+		case SCSI_CMD_SERVICE_ACTION_IN_16:
+			if ((CommandData[1] & 0x1F) == SCSI_SERVICE_ACTION_READ_CAPACITY_16)
+			{
+				CommandSuccess = MS_SCSI_Command_ReadCapacity(MSInterfaceInfo, LUN, true);
+			}
+			else
+			{
+				MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+				                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+				                       SCSI_ASENSEQ_NO_QUALIFIER);
+			}
+
+			break;
+		case SCSI_CMD_READ_10:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, true, 10);
+			break;
+		case SCSI_CMD_READ_12:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, true, 12);
+			break;
+		case SCSI_CMD_READ_16:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, true, 16);
+			break;
+		case SCSI_CMD_WRITE_10:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, false, 10);
+			break;
+		case SCSI_CMD_WRITE_12:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, false, 12);
+			break;
+		case SCSI_CMD_WRITE_16:
+			CommandSuccess = MS_SCSI_Command_ReadWrite(MSInterfaceInfo, LUN, false, 16);
+			break;
+		case SCSI_CMD_VERIFY_10:
+			CommandSuccess = MS_SCSI_Command_Verify(MSInterfaceInfo, LUN, 10);
+			break;
+		case SCSI_CMD_VERIFY_16:
+			CommandSuccess = MS_SCSI_Command_Verify(MSInterfaceInfo, LUN, 16);
+			break;
+		case SCSI_CMD_UNMAP:
+			CommandSuccess = MS_SCSI_Command_Unmap(MSInterfaceInfo, LUN);
+			break;
+		case SCSI_CMD_MODE_SENSE_6:
+			CommandSuccess = MS_SCSI_Command_ModeSense(MSInterfaceInfo, LUN, false);
+			break;
+		case SCSI_CMD_MODE_SENSE_10:
+			CommandSuccess = MS_SCSI_Command_ModeSense(MSInterfaceInfo, LUN, true);
+			break;
+		case SCSI_CMD_SEND_DIAGNOSTIC:
+			/* Only the self-test is supported, which passes if the medium is present */
+			if (!(CommandData[1] & (1 << 2)))
+			{
+				MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+				                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+				                       SCSI_ASENSEQ_NO_QUALIFIER);
+			}
+			else
+			{
+				CommandSuccess = MS_SCSI_CheckMedium(LUN);
+				MSInterfaceInfo->State.CommandBlock.DataTransferLength = 0;
+			}
+
+			break;
+		default:
+			MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+			                       SCSI_ASENSE_INVALID_COMMAND,
+			                       SCSI_ASENSEQ_NO_QUALIFIER);
+			break;
+	}
+
+	if (CommandSuccess)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_GOOD,
+		                       SCSI_ASENSE_NO_ADDITIONAL_INFORMATION,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+	}
+
+	return CommandSuccess;
+}
+
+static bool MS_SCSI_ReadBlockAddress(const uint8_t* Data,
+                                     uint8_t Length,
+                                     MS_BlockAddress_t* const BlockAddress)
+{
+	MS_BlockAddress_t Address = 0;
+
+	*BlockAddress = 0;
+
+	while (Length--)
+	{
+		/* Addresses too wide for a block address cannot be within any logical unit */
+		if (Address >> ((sizeof(MS_BlockAddress_t) - 1) * 8))
+		  return false;
+
+		Address = ((Address << 8) | *(Data++));
+	}
+
+	*BlockAddress = Address;
+	return true;
+}
+
+static uint32_t MS_SCSI_ReadBE32(const uint8_t* const Data)
+{
+	return (((uint32_t)Data[0] << 24) | ((uint32_t)Data[1] << 16) | ((uint16_t)Data[2] << 8) | Data[3]);
+}
+
+static void MS_SCSI_WriteBE(uint8_t* Data,
+                            uint8_t Length,
+                            MS_BlockAddress_t Value)
+{
+	Data += Length;
+
+	while (Length--)
+	{
+		*(--Data) = (uint8_t)Value;
+		Value >>= 8;
+	}
+}
+
+static bool MS_SCSI_SendResponse(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                 const void* const Data,
+                                 const uint16_t Length,
+                                 uint32_t AllocationLength)
+{
+	uint32_t DataTransferLength = le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength);
+	uint16_t BytesTransferred;
+
+	/* Nothing can be sent if the host did not expect data from the device */
+	if (!(MSInterfaceInfo->State.CommandBlock.Flags & MS_COMMAND_DIR_DATA_IN))
+	  DataTransferLength = 0;
+
+	/* The response is truncated to the host's allocation length, and padded with zeros up to it */
+	AllocationLength = MIN(AllocationLength, MIN(DataTransferLength, UINT16_MAX));
+	BytesTransferred = MIN(Length, AllocationLength);
+
+	if (!(AllocationLength))
+	  return true;
+
+	if ((Endpoint_Write_Stream_LE(Data, BytesTransferred, NULL) != ENDPOINT_RWSTREAM_NoError) ||
+	    (Endpoint_Null_Stream((AllocationLength - BytesTransferred), NULL) != ENDPOINT_RWSTREAM_NoError))
+	{
+		return false;
+	}
+
+	Endpoint_ClearIN();
+
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength = cpu_to_le32(DataTransferLength - AllocationLength);
+
+	return true;
+}
+
+static bool MS_SCSI_CheckMedium(MS_SCSI_LUN_t* const LUN)
+{
+	/* A LUN without any blocks has no valid last block address to report, so is treated as empty */
+	if ((LUN->Config.BlockDevice == NULL) || !(LUN->Config.TotalBlocks))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_NOT_READY,
+		                       SCSI_ASENSE_MEDIUM_NOT_PRESENT,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	return true;
+}
+
+static bool MS_SCSI_CheckBlockRange(MS_SCSI_LUN_t* const LUN,
+                                    const bool IsAddressValid,
+                                    const MS_BlockAddress_t BlockAddress,
+                                    const uint32_t TotalBlocks)
+{
+	/* Compared without adding the block count to the address, which could overflow */
+	if (!(IsAddressValid) || (BlockAddress > LUN->Config.TotalBlocks) ||
+	    (TotalBlocks > (LUN->Config.TotalBlocks - BlockAddress)))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	return true;
+}
+
+static bool MS_SCSI_Command_Inquiry(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                    MS_SCSI_LUN_t* const LUN)
+{
+	uint8_t* CommandData      = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint16_t AllocationLength = (((uint16_t)CommandData[3] << 8) | CommandData[4]);
+	bool     CanUnmap         = ((LUN->Config.BlockDevice != NULL) && (LUN->Config.BlockDevice->StartUnmap != NULL));
+	uint8_t  Response[64];
+	uint8_t  ResponseLength = 0;
+
+	/* Obsolete CmdDt bit, or a page code without the EVPD bit */
+	if ((CommandData[1] & (1 << 1)) || (!(CommandData[1] & (1 << 0)) && CommandData[2]))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	if (!(CommandData[1] & (1 << 0)))
+	  return MS_SCSI_SendResponse(MSInterfaceInfo, LUN->Config.InquiryData, sizeof(SCSI_Inquiry_Response_t), AllocationLength);
+
+	memset(Response, 0x00, sizeof(Response));
+
+	/* Vital product data pages start with the peripheral qualifier and device type of the standard data */
+	Response[0] = *((const uint8_t*)LUN->Config.InquiryData);
+	Response[1] = CommandData[2];
+
+	switch (CommandData[2])
+	{
+		case SCSI_VPD_PAGE_SUPPORTED_PAGES:
+			ResponseLength = 4;
+			Response[ResponseLength++] = SCSI_VPD_PAGE_SUPPORTED_PAGES;
+			Response[ResponseLength++] = SCSI_VPD_PAGE_BLOCK_LIMITS;
+
+			if (CanUnmap)
+			  Response[ResponseLength++] = SCSI_VPD_PAGE_LOGICAL_BLOCK_PROVISION;
+
+			Response[3] = (ResponseLength - 4);
+			break;
+		case SCSI_VPD_PAGE_BLOCK_LIMITS:
+			ResponseLength = 64;
+			Response[3]    = (ResponseLength - 4);
+
+			/* An UNMAP parameter list must fit in the data buffer, after its 8 byte header */
+			if (CanUnmap && (MSInterfaceInfo->Config.DataBufferSize > 8))
+			{
+				MS_SCSI_WriteBE(&Response[20], 4, UINT32_MAX);
+				MS_SCSI_WriteBE(&Response[24], 4, ((MSInterfaceInfo->Config.DataBufferSize - 8) / 16));
+			}
+
+			break;
+		case SCSI_VPD_PAGE_LOGICAL_BLOCK_PROVISION:
+			/* The page is only supported when the medium can be unmapped, advertising UNMAP on thin provisioned media */
+			if (CanUnmap)
+			{
+				ResponseLength = 8;
+				Response[3]    = (ResponseLength - 4);
+				Response[5]    = (1 << 7);
+				Response[6]    = 0x02;
+			}
+
+			break;
+	}
+
+	if (!(ResponseLength))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	return MS_SCSI_SendResponse(MSInterfaceInfo, Response, ResponseLength, AllocationLength);
+}
+
+static bool MS_SCSI_Command_RequestSense(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                         MS_SCSI_LUN_t* const LUN)
+{
+	SCSI_Request_Sense_Response_t SenseData;
+
+	memset(&SenseData, 0x00, sizeof(SenseData));
+
+	SenseData.ResponseCode             = 0x70;
+	SenseData.AdditionalLength         = 0x0A;
+	SenseData.SenseKey                 = LUN->State.SenseKey;
+	SenseData.AdditionalSenseCode      = LUN->State.AdditionalSenseCode;
+	SenseData.AdditionalSenseQualifier = LUN->State.AdditionalSenseQualifier;
+
+	return MS_SCSI_SendResponse(MSInterfaceInfo, &SenseData, sizeof(SenseData),
+	                            MSInterfaceInfo->State.CommandBlock.SCSICommandData[4]);
+}
+
+static bool MS_SCSI_Command_ReadCapacity(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                         MS_SCSI_LUN_t* const LUN,
+                                         const bool IsLongForm)
+{
+	uint8_t*          CommandData = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint8_t           Response[32];
+	MS_BlockAddress_t LastBlockAddress;
+
+	if (!(MS_SCSI_CheckMedium(LUN)))
+	  return false;
+
+	LastBlockAddress = (LUN->Config.TotalBlocks - 1);
+
+	memset(Response, 0x00, sizeof(Response));
+
+	if (IsLongForm)
+	{
+		MS_SCSI_WriteBE(&Response[0], 8, LastBlockAddress);
+		MS_SCSI_WriteBE(&Response[8], 4, LUN->Config.BlockDevice->BlockSize);
+
+		/* Logical block provisioning management is enabled when the host may unmap blocks */
+		if (LUN->Config.BlockDevice->StartUnmap != NULL)
+		  Response[14] = (1 << 7);
+
+		return MS_SCSI_SendResponse(MSInterfaceInfo, Response, sizeof(Response), MS_SCSI_ReadBE32(&CommandData[10]));
+	}
+
+	#if defined(MS_DEVICE_64BIT_BLOCK_ADDRESSES)
+	/* Media too large for READ CAPACITY (10) reports the maximum address, so that the host uses READ CAPACITY (16) */
+	if (LastBlockAddress > UINT32_MAX)
+	  LastBlockAddress = UINT32_MAX;
+	#endif
+
+	MS_SCSI_WriteBE(&Response[0], 4, LastBlockAddress);
+	MS_SCSI_WriteBE(&Response[4], 4, LUN->Config.BlockDevice->BlockSize);
+
+	return MS_SCSI_SendResponse(MSInterfaceInfo, Response, 8, 8);
+}
+
+static bool MS_SCSI_Command_ReadWrite(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                      MS_SCSI_LUN_t* const LUN,
+                                      const bool IsDataRead,
+                                      const uint8_t CommandLength)
+{
+	uint8_t*          CommandData   = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint8_t           AddressLength = ((CommandLength == 16) ? 8 : 4);
+	bool              IsDataIn      = ((MSInterfaceInfo->State.CommandBlock.Flags & MS_COMMAND_DIR_DATA_IN) != 0);
+	MS_BlockAddress_t BlockAddress;
+	uint32_t          TotalBlocks;
+	bool              IsAddressValid;
+
+	IsAddressValid = MS_SCSI_ReadBlockAddress(&CommandData[2], AddressLength, &BlockAddress);
+
+	if (CommandLength == 10)
+	  TotalBlocks = (((uint16_t)CommandData[7] << 8) | CommandData[8]);
+	else
+	  TotalBlocks = MS_SCSI_ReadBE32(&CommandData[2 + AddressLength]);
+
+	if (!(MS_SCSI_CheckMedium(LUN)))
+	  return false;
+
+	if (!(IsDataRead) && LUN->Config.IsReadOnly)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_DATA_PROTECT,
+		                       SCSI_ASENSE_WRITE_PROTECTED,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	if (!(MS_SCSI_CheckBlockRange(LUN, IsAddressValid, BlockAddress, TotalBlocks)))
+	  return false;
+
+	if (!(TotalBlocks))
+	  return true;
+
+	/* The host must expect the whole of the data, in the direction of the command */
+	if ((IsDataIn != IsDataRead) ||
+	    (TotalBlocks > (le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength) / LUN->Config.BlockDevice->BlockSize)))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	switch (MS_Device_TransferBlocks(MSInterfaceInfo, LUN->Config.BlockDevice, IsDataRead,
+	                                 (LUN->Config.FirstBlock + BlockAddress), TotalBlocks))
+	{
+		case MS_TRANSFER_NoError:
+			return true;
+		case MS_TRANSFER_MediaError:
+			MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_MEDIUM_ERROR,
+			                       (IsDataRead ? SCSI_ASENSE_UNRECOVERED_READ_ERROR : SCSI_ASENSE_WRITE_ERROR),
+			                       SCSI_ASENSEQ_NO_QUALIFIER);
+			break;
+		case MS_TRANSFER_InvalidBuffer:
+			MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_HARDWARE_ERROR,
+			                       SCSI_ASENSE_NO_ADDITIONAL_INFORMATION,
+			                       SCSI_ASENSEQ_NO_QUALIFIER);
+			break;
+		default:
+			MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ABORTED_COMMAND,
+			                       SCSI_ASENSE_NO_ADDITIONAL_INFORMATION,
+			                       SCSI_ASENSEQ_NO_QUALIFIER);
+			break;
+	}
+
+	return false;
+}
+
+static bool MS_SCSI_Command_Verify(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                   MS_SCSI_LUN_t* const LUN,
+                                   const uint8_t CommandLength)
+{
+	uint8_t*          CommandData   = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint8_t           AddressLength = ((CommandLength == 16) ? 8 : 4);
+	MS_BlockAddress_t BlockAddress;
+	uint32_t          TotalBlocks;
+	bool              IsAddressValid;
+
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength = 0;
+
+	/* Comparing against data sent by the host (BYTCHK) is not supported, only checking that the blocks are readable */
+	if (CommandData[1] & ((1 << 1) | (1 << 2)))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	IsAddressValid = MS_SCSI_ReadBlockAddress(&CommandData[2], AddressLength, &BlockAddress);
+
+	if (CommandLength == 10)
+	  TotalBlocks = (((uint16_t)CommandData[7] << 8) | CommandData[8]);
+	else
+	  TotalBlocks = MS_SCSI_ReadBE32(&CommandData[10]);
+
+	if (!(MS_SCSI_CheckMedium(LUN)) || !(MS_SCSI_CheckBlockRange(LUN, IsAddressValid, BlockAddress, TotalBlocks)))
+	  return false;
+
+	if (MS_Device_VerifyBlocks(MSInterfaceInfo, LUN->Config.BlockDevice, (LUN->Config.FirstBlock + BlockAddress),
+	                           TotalBlocks) != MS_TRANSFER_NoError)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_MEDIUM_ERROR,
+		                       SCSI_ASENSE_UNRECOVERED_READ_ERROR,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	return true;
+}
+
+static bool MS_SCSI_Command_SynchronizeCache(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                             MS_SCSI_LUN_t* const LUN)
+{
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength = 0;
+
+	/* The whole block device is flushed, regardless of the range of blocks given by the host */
+	if ((LUN->Config.BlockDevice != NULL) && !(MS_Device_FlushBlocks(MSInterfaceInfo, LUN->Config.BlockDevice)))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_MEDIUM_ERROR,
+		                       SCSI_ASENSE_WRITE_ERROR,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	return true;
+}
+
+static bool MS_SCSI_Command_Unmap(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                  MS_SCSI_LUN_t* const LUN)
+{
+	uint8_t* CommandData         = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint8_t* ParameterList       = MSInterfaceInfo->Config.DataBuffer;
+	uint16_t ParameterListLength = (((uint16_t)CommandData[7] << 8) | CommandData[8]);
+	uint16_t DescriptorsLength;
+
+	if (!(MS_SCSI_CheckMedium(LUN)))
+	  return false;
+
+	if (LUN->Config.BlockDevice->StartUnmap == NULL)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_INVALID_COMMAND,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	if (LUN->Config.IsReadOnly)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_DATA_PROTECT,
+		                       SCSI_ASENSE_WRITE_PROTECTED,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	if (!(ParameterListLength))
+	  return true;
+
+	/* The parameter list is received whole into the data buffer, so must fit it and be expected from the host */
+	if ((ParameterListLength < 8) || (ParameterListLength > MSInterfaceInfo->Config.DataBufferSize) ||
+	    (MSInterfaceInfo->State.CommandBlock.Flags & MS_COMMAND_DIR_DATA_IN) ||
+	    (ParameterListLength > le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength)))
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+		                       SCSI_ASENSE_PARAMETER_LIST_LENGTH_ERROR,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	/* The data buffer is only received into once any media operation abandoned by an earlier command has released it */
+	if (MS_Device_ReceiveParameterList(MSInterfaceInfo, LUN->Config.BlockDevice, ParameterListLength) != MS_TRANSFER_NoError)
+	{
+		MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_ABORTED_COMMAND,
+		                       SCSI_ASENSE_NO_ADDITIONAL_INFORMATION,
+		                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+		return false;
+	}
+
+	/* Only the whole block descriptors which were sent are processed */
+	DescriptorsLength = MIN((((uint16_t)ParameterList[2] << 8) | ParameterList[3]), (ParameterListLength - 8));
+	DescriptorsLength -= (DescriptorsLength % 16);
+
+	/* All descriptors are checked before any blocks are unmapped, so that an invalid list has no effect */
+	for (uint16_t Offset = 8; Offset < (DescriptorsLength + 8); Offset += 16)
+	{
+		MS_BlockAddress_t BlockAddress;
+		bool              IsAddressValid = MS_SCSI_ReadBlockAddress(&ParameterList[Offset], 8, &BlockAddress);
+
+		if (!(MS_SCSI_CheckBlockRange(LUN, IsAddressValid, BlockAddress, MS_SCSI_ReadBE32(&ParameterList[Offset + 8]))))
+		  return false;
+	}
+
+	for (uint16_t Offset = 8; Offset < (DescriptorsLength + 8); Offset += 16)
+	{
+		MS_BlockAddress_t BlockAddress;
+		uint32_t          TotalBlocks = MS_SCSI_ReadBE32(&ParameterList[Offset + 8]);
+
+		MS_SCSI_ReadBlockAddress(&ParameterList[Offset], 8, &BlockAddress);
+
+		if (TotalBlocks && !(MS_Device_UnmapBlocks(MSInterfaceInfo, LUN->Config.BlockDevice,
+		                                           (LUN->Config.FirstBlock + BlockAddress), TotalBlocks)))
+		{
+			MS_Device_SetSCSISense(LUN, SCSI_SENSE_KEY_MEDIUM_ERROR,
+			                       SCSI_ASENSE_WRITE_ERROR,
+			                       SCSI_ASENSEQ_NO_QUALIFIER);
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool MS_SCSI_Command_ModeSense(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                      MS_SCSI_LUN_t* const LUN,
+                                      const bool IsLongForm)
+{
+	uint8_t* CommandData     = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+	uint8_t  WriteProtectBit = (LUN->Config.IsReadOnly ? (1 << 7) : 0);
+
+	/* Only an empty mode parameter header is returned, with the Write Protect flag status */
+	if (IsLongForm)
+	{
+		uint8_t Header[8] = {0x00, 0x06, 0x00, WriteProtectBit, 0x00, 0x00, 0x00, 0x00};
+
+		return MS_SCSI_SendResponse(MSInterfaceInfo, Header, sizeof(Header), (((uint16_t)CommandData[7] << 8) | CommandData[8]));
+	}
+	else
+	{
+		uint8_t Header[4] = {0x03, 0x00, WriteProtectBit, 0x00};
+
+		return MS_SCSI_SendResponse(MSInterfaceInfo, Header, sizeof(Header), CommandData[4]);
+	}
+}
+
+#endif
@@ -0,0 +1,220 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Device mode SCSI block command target for the library USB Mass Storage Class driver.
+ *
+ *  Device mode SCSI block command target for the library USB Mass Storage Class driver.
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the USB module driver
+ *        dispatch header located in LUFA/Drivers/USB.h.
+ */
+
+/** \ingroup Group_USBClassMS
+ *  \defgroup Group_USBClassMSSCSITarget Mass Storage Class Device Mode SCSI Target
+ *
+ *  \section Sec_USBClassMSSCSITarget_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LUFA/Drivers/USB/Class/Device/MassStorageClassDevice.c <i>(Makefile source module name: LUFA_SRC_USBCLASS)</i>
+ *    - LUFA/Drivers/USB/Class/Device/MassStorageSCSITarget.c <i>(Makefile source module name: LUFA_SRC_USBCLASS)</i>
+ *
+ *  \section Sec_USBClassMSSCSITarget_ModDescription Module Description
+ *  Reusable SCSI Block Command target for the Mass Storage USB Class device mode driver, which decodes the SCSI commands
+ *  received by \ref CALLBACK_MS_Device_SCSICommandReceived() and executes them against a table of logical units, each
+ *  backed by a \ref MS_BlockDevice_t. The logical units may share one block device (at different offsets) or use
+ *  separate ones, and each has its own geometry, write protection and sense data.
+ *
+ *  The following commands are supported:
+ *    - INQUIRY, including the Supported VPD Pages, Block Limits and Logical Block Provisioning VPD pages
+ *    - REQUEST SENSE
+ *    - TEST UNIT READY
+ *    - READ CAPACITY (10) and READ CAPACITY (16)
+ *    - READ and WRITE (10), (12) and (16)
+ *    - VERIFY (10) and (16), reading back the blocks from the media
+ *    - SYNCHRONIZE CACHE (10) and (16)
+ *    - UNMAP, where the block device of the logical unit supports unmapping
+ *    - MODE SENSE (6) and (10), reporting only the write protection state
+ *    - SEND DIAGNOSTIC, with the self-test bit set
+ *    - START STOP UNIT and PREVENT ALLOW MEDIUM REMOVAL
+ *
+ *  Block addresses are limited to the width of \ref MS_BlockAddress_t; larger media requires the
+ *  \c MS_DEVICE_64BIT_BLOCK_ADDRESSES compile time token.
+ *
+ *  @{
+ */
+
+#ifndef _MS_SCSI_TARGET_H_
+#define _MS_SCSI_TARGET_H_
+
+	/* Includes: */
+		#include "../../USB.h"
+		#include "../Common/MassStorageClassCommon.h"
+		#include "MassStorageClassDevice.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_MS_DRIVER)
+			#error Do not include this file directly. Include LUFA/Drivers/USB.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Type Defines: */
+			/** \brief Mass Storage Class Device Mode SCSI Logical Unit.
+			 *
+			 *  Configuration and state of a single logical unit (drive) of a Mass Storage interface. An array of these,
+			 *  one for each of the interface's \c TotalLUNs, is passed to \ref MS_Device_ProcessSCSICommand().
+			 */
+			typedef struct
+			{
+				struct
+				{
+					const MS_BlockDevice_t* BlockDevice; /**< Block device holding the logical unit's media, or \c NULL if no
+					                                      *   medium is currently present.
+					                                      */
+					MS_BlockAddress_t       FirstBlock; /**< Address of the logical unit's first block on the block device. */
+					MS_BlockAddress_t       TotalBlocks; /**< Number of blocks of the block device used by the logical unit. A logical unit
+					                                      *   without any blocks is reported to the host as having no medium present.
+					                                      */
+					bool                    IsReadOnly; /**< Boolean \c true if the host may not write to the logical unit. */
+
+					const SCSI_Inquiry_Response_t* InquiryData; /**< Standard INQUIRY data reported for the logical unit. */
+				} Config; /**< Config data for the logical unit. All elements in this section <b>must</b> be set before the
+				           *   first SCSI command is processed, and may be changed between commands (e.g. on a medium change).
+				           */
+				struct
+				{
+					uint8_t SenseKey; /**< Sense key of the last command, a \c SCSI_SENSE_KEY_* value. */
+					uint8_t AdditionalSenseCode; /**< Additional sense code of the last command, a \c SCSI_ASENSE_* value. */
+					uint8_t AdditionalSenseQualifier; /**< Additional sense qualifier of the last command, a \c SCSI_ASENSEQ_* value. */
+				} State; /**< State data for the logical unit, reported to the host by REQUEST SENSE. All elements in this
+				          *   section should be zero initialized.
+				          */
+			} MS_SCSI_LUN_t;
+
+		/* Function Prototypes: */
+			/** Decodes and executes the SCSI command of the current command block against its addressed logical unit, for
+			 *  use from within \ref CALLBACK_MS_Device_SCSICommandReceived(). The sense data of the logical unit is updated
+			 *  to reflect the outcome of the command. Block data is transferred through \ref MS_Device_TransferBlocks(), and
+			 *  so the interface's \c DataBuffer must be configured.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a Mass Storage Class configuration and state.
+			 *  \param[in,out] LUNs             Array of the interface's logical units, indexed by logical unit number.
+			 *
+			 *  \return Boolean \c true if the SCSI command was successfully processed, \c false otherwise.
+			 */
+			bool MS_Device_ProcessSCSICommand(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+			                                  MS_SCSI_LUN_t* const LUNs) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+		/* Inline Functions: */
+			/** Sets the sense data of a logical unit, which is reported to the host by its next REQUEST SENSE command. This
+			 *  may be used by applications which process additional commands of their own before passing the remaining
+			 *  commands to \ref MS_Device_ProcessSCSICommand().
+			 *
+			 *  \param[in,out] LUN                       Pointer to the logical unit whose sense data is to be set.
+			 *  \param[in]     SenseKey                  Sense key, a \c SCSI_SENSE_KEY_* value.
+			 *  \param[in]     AdditionalSenseCode       Additional sense code, a \c SCSI_ASENSE_* value.
+			 *  \param[in]     AdditionalSenseQualifier  Additional sense qualifier, a \c SCSI_ASENSEQ_* value.
+			 */
+			static inline void MS_Device_SetSCSISense(MS_SCSI_LUN_t* const LUN,
+			                                          const uint8_t SenseKey,
+			                                          const uint8_t AdditionalSenseCode,
+			                                          const uint8_t AdditionalSenseQualifier) ATTR_NON_NULL_PTR_ARG(1) ATTR_ALWAYS_INLINE;
+			static inline void MS_Device_SetSCSISense(MS_SCSI_LUN_t* const LUN,
+			                                          const uint8_t SenseKey,
+			                                          const uint8_t AdditionalSenseCode,
+			                                          const uint8_t AdditionalSenseQualifier)
+			{
+				LUN->State.SenseKey                 = SenseKey;
+				LUN->State.AdditionalSenseCode      = AdditionalSenseCode;
+				LUN->State.AdditionalSenseQualifier = AdditionalSenseQualifier;
+			}
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define SCSI_VPD_PAGE_SUPPORTED_PAGES         0x00
+			#define SCSI_VPD_PAGE_BLOCK_LIMITS            0xB0
+			#define SCSI_VPD_PAGE_LOGICAL_BLOCK_PROVISION 0xB2
+
+		/* Function Prototypes: */
+			#if defined(__INCLUDE_FROM_MASSSTORAGE_SCSITARGET_C)
+				static bool MS_SCSI_ReadBlockAddress(const uint8_t* Data,
+				                                     uint8_t Length,
+				                                     MS_BlockAddress_t* const BlockAddress) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(3);
+				static uint32_t MS_SCSI_ReadBE32(const uint8_t* const Data) ATTR_NON_NULL_PTR_ARG(1);
+				static void MS_SCSI_WriteBE(uint8_t* Data,
+				                            uint8_t Length,
+				                            MS_BlockAddress_t Value) ATTR_NON_NULL_PTR_ARG(1);
+				static bool MS_SCSI_SendResponse(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                 const void* const Data,
+				                                 const uint16_t Length,
+				                                 uint32_t AllocationLength) ATTR_NON_NULL_PTR_ARG(1);
+				static bool MS_SCSI_CheckMedium(MS_SCSI_LUN_t* const LUN) ATTR_NON_NULL_PTR_ARG(1);
+				static bool MS_SCSI_CheckBlockRange(MS_SCSI_LUN_t* const LUN,
+				                                    const bool IsAddressValid,
+				                                    const MS_BlockAddress_t BlockAddress,
+				                                    const uint32_t TotalBlocks) ATTR_NON_NULL_PTR_ARG(1);
+				static bool MS_SCSI_Command_Inquiry(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                    MS_SCSI_LUN_t* const LUN) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_RequestSense(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                         MS_SCSI_LUN_t* const LUN) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_ReadCapacity(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                         MS_SCSI_LUN_t* const LUN,
+				                                         const bool IsLongForm) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_ReadWrite(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                      MS_SCSI_LUN_t* const LUN,
+				                                      const bool IsDataRead,
+				                                      const uint8_t CommandLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_Verify(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                   MS_SCSI_LUN_t* const LUN,
+				                                   const uint8_t CommandLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_SynchronizeCache(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                             MS_SCSI_LUN_t* const LUN) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_Unmap(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                  MS_SCSI_LUN_t* const LUN) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static bool MS_SCSI_Command_ModeSense(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+				                                      MS_SCSI_LUN_t* const LUN,
+				                                      const bool IsLongForm) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+			#endif
+
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
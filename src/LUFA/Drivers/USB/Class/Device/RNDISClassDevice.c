@@ -155,6 +155,18 @@ void RNDIS_Device_USBTask(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo
 
 		RNDISInterfaceInfo->State.ResponseReady = false;
 	}
+
+	if (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized)
+	  return;
+
+	#if !defined(NO_CLASS_DRIVER_AUTOFLUSH)
+	/* Packet messages batched since the last call are sent to the host as one transfer */
+	RNDIS_Device_Flush(RNDISInterfaceInfo);
+	#endif
+
+	/* Keeps the receive pool filling while the application is busy with the frames it holds */
+	if (RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+	  RNDIS_Device_ReceiveIntoPool(RNDISInterfaceInfo);
 }
 
 void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
@@ -174,6 +186,9 @@ void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const
 			RNDIS_Initialize_Complete_t* INITIALIZE_Response =
 			               (RNDIS_Initialize_Complete_t*)&RNDISInterfaceInfo->State.RNDISMessageBuffer;
 
+			/* Must be kept before the response overwrites it, limits how many packet messages are batched to the host */
+			RNDISInterfaceInfo->State.HostMaxTransferSize = le32_to_cpu(INITIALIZE_Message->MaxTransferSize);
+
 			INITIALIZE_Response->MessageType            = CPU_TO_LE32(REMOTE_NDIS_INITIALIZE_CMPLT);
 			INITIALIZE_Response->MessageLength          = CPU_TO_LE32(sizeof(RNDIS_Initialize_Complete_t));
 			INITIALIZE_Response->RequestId              = INITIALIZE_Message->RequestId;
@@ -183,9 +198,21 @@ void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const
 			INITIALIZE_Response->MinorVersion           = CPU_TO_LE32(REMOTE_NDIS_VERSION_MINOR);
 			INITIALIZE_Response->DeviceFlags            = CPU_TO_LE32(REMOTE_NDIS_DF_CONNECTIONLESS);
 			INITIALIZE_Response->Medium                 = CPU_TO_LE32(REMOTE_NDIS_MEDIUM_802_3);
-			INITIALIZE_Response->MaxPacketsPerTransfer  = CPU_TO_LE32(1);
-			INITIALIZE_Response->MaxTransferSize        = CPU_TO_LE32(sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX);
-			INITIALIZE_Response->PacketAlignmentFactor  = CPU_TO_LE32(0);
+
+			/* Several packet messages per transfer can only be split apart once received whole into the receive pool */
+			if (RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+			{
+				INITIALIZE_Response->MaxPacketsPerTransfer  = CPU_TO_LE32(RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER);
+				INITIALIZE_Response->MaxTransferSize        = CPU_TO_LE32(RNDIS_DEVICE_RX_BUFFER_SIZE);
+				INITIALIZE_Response->PacketAlignmentFactor  = CPU_TO_LE32(RNDIS_PACKET_ALIGNMENT_FACTOR);
+			}
+			else
+			{
+				INITIALIZE_Response->MaxPacketsPerTransfer  = CPU_TO_LE32(1);
+				INITIALIZE_Response->MaxTransferSize        = CPU_TO_LE32(sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX);
+				INITIALIZE_Response->PacketAlignmentFactor  = CPU_TO_LE32(0);
+			}
+
 			INITIALIZE_Response->AFListOffset           = CPU_TO_LE32(0);
 			INITIALIZE_Response->AFListSize             = CPU_TO_LE32(0);
 
@@ -426,6 +453,13 @@ bool RNDIS_Device_IsPacketReceived(USB_ClassInfo_RNDIS_Device_t* const RNDISInte
 		return false;
 	}
 
+	if (RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+	{
+		RNDIS_Device_ReceiveIntoPool(RNDISInterfaceInfo);
+
+		return RNDIS_Device_FindNextFrame(RNDISInterfaceInfo, NULL, NULL);
+	}
+
 	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address);
 	return Endpoint_IsOUTReceived();
 }
@@ -440,10 +474,23 @@ uint8_t RNDIS_Device_ReadPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 		return ENDPOINT_RWSTREAM_DeviceDisconnected;
 	}
 
-	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address);
-
 	*PacketLength = 0;
 
+	if (RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+	{
+		uint8_t* Frame;
+
+		if (RNDIS_Device_GetReceivedFrame(RNDISInterfaceInfo, &Frame, PacketLength))
+		{
+			memcpy(Buffer, Frame, *PacketLength);
+			RNDIS_Device_ReleaseFrame(RNDISInterfaceInfo);
+		}
+
+		return ENDPOINT_RWSTREAM_NoError;
+	}
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address);
+
 	if (!(Endpoint_IsOUTReceived()))
 		return ENDPOINT_RWSTREAM_NoError;
 
@@ -465,6 +512,200 @@ uint8_t RNDIS_Device_ReadPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+bool RNDIS_Device_GetReceivedFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                   uint8_t** const Frame,
+                                   uint16_t* const FrameLength)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized) ||
+	    !(RNDISInterfaceInfo->Config.TotalRxFrameBuffers))
+	{
+		return false;
+	}
+
+	RNDIS_Device_ReceiveIntoPool(RNDISInterfaceInfo);
+
+	if (!(RNDIS_Device_FindNextFrame(RNDISInterfaceInfo, Frame, FrameLength)))
+	  return false;
+
+	uint8_t* Buffer = RNDIS_Device_GetPoolBuffer(RNDISInterfaceInfo, RNDISInterfaceInfo->State.RxReadBuffer);
+
+	RNDISInterfaceInfo->State.RxReadOffset = RNDIS_Device_NextMessageOffset(Buffer, RNDISInterfaceInfo->State.RxReadOffset);
+	RNDISInterfaceInfo->State.RxHeldFrames++;
+
+	return true;
+}
+
+void RNDIS_Device_ReleaseFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if (!(RNDISInterfaceInfo->State.RxHeldFrames))
+	  return;
+
+	RNDISInterfaceInfo->State.RxHeldFrames--;
+
+	/* Frames are retrieved in order, so the oldest held frame is always in the oldest received buffer */
+	uint8_t* Buffer = RNDIS_Device_GetPoolBuffer(RNDISInterfaceInfo, 0);
+	uint16_t Offset = RNDIS_Device_NextMessageOffset(Buffer, RNDISInterfaceInfo->State.RxReleaseOffset);
+
+	if ((Offset < RNDIS_DEVICE_RX_BUFFER_SIZE) &&
+	    RNDIS_Device_ParsePacketMessage(&Buffer[Offset], RNDIS_DEVICE_RX_BUFFER_SIZE - Offset, NULL, NULL))
+	{
+		RNDISInterfaceInfo->State.RxReleaseOffset = Offset;
+	}
+	else
+	{
+		/* Last frame of the buffer released, hand the buffer back to the receive pool */
+		RNDISInterfaceInfo->State.RxReleaseOffset = 0;
+
+		if (++RNDISInterfaceInfo->State.RxFirstBuffer == RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+		  RNDISInterfaceInfo->State.RxFirstBuffer = 0;
+
+		RNDISInterfaceInfo->State.RxReceivedBuffers--;
+
+		if (RNDISInterfaceInfo->State.RxReadBuffer)
+		  RNDISInterfaceInfo->State.RxReadBuffer--;
+		else
+		  RNDISInterfaceInfo->State.RxReadOffset = 0;
+	}
+
+	if (USB_DeviceState == DEVICE_STATE_Configured)
+	  RNDIS_Device_ReceiveIntoPool(RNDISInterfaceInfo);
+}
+
+static void RNDIS_Device_ReceiveIntoPool(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if (RNDISInterfaceInfo->State.RxReceivedBuffers == RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+	  return;
+
+	uint8_t* Buffer = RNDIS_Device_GetPoolBuffer(RNDISInterfaceInfo, RNDISInterfaceInfo->State.RxReceivedBuffers);
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address);
+
+#if (ARCH == ARCH_EFM32GG)
+	if (RNDISInterfaceInfo->State.RxTransferActive)
+	{
+		if (Endpoint_IsTransferBusy(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address))
+		  return;
+
+		RNDISInterfaceInfo->State.RxTransferActive = false;
+
+		/* Each transfer from the host, ended by a short packet, carries one or more packet messages */
+		if (RNDIS_Device_CheckPacketMessages(Buffer, Endpoint_GetTransferLength()))
+		{
+			if (++RNDISInterfaceInfo->State.RxReceivedBuffers == RNDISInterfaceInfo->Config.TotalRxFrameBuffers)
+			  return;
+
+			Buffer = RNDIS_Device_GetPoolBuffer(RNDISInterfaceInfo, RNDISInterfaceInfo->State.RxReceivedBuffers);
+		}
+	}
+
+	/* A transfer aborted by a bus reset leaves a stale header behind, which must not be taken for a new message */
+	((RNDIS_Message_Header_t*)Buffer)->MessageType = CPU_TO_LE32(0);
+
+	if (Endpoint_StartTransfer(RNDISInterfaceInfo->Config.DataOUTEndpoint.Address, Buffer,
+	                           RNDIS_DEVICE_RX_BUFFER_SIZE, NULL) == ENDPOINT_XFER_NoError)
+	{
+		RNDISInterfaceInfo->State.RxTransferActive = true;
+	}
+#else
+	if (!(Endpoint_IsOUTReceived()))
+	  return;
+
+	/* Packet messages start on an alignment boundary, so a bank holding the start of another message holds at least its
+	   common header - anything shorter is a zero length packet or padding at the end of the transfer */
+	if (Endpoint_BytesInEndpoint() < sizeof(RNDIS_Message_Header_t))
+	{
+		Endpoint_ClearOUT();
+		return;
+	}
+
+	RNDIS_Message_Header_t* MessageHeader = (RNDIS_Message_Header_t*)Buffer;
+	Endpoint_Read_Stream_LE(MessageHeader, sizeof(RNDIS_Message_Header_t), NULL);
+
+	if (le32_to_cpu(MessageHeader->MessageType) != REMOTE_NDIS_PACKET_MSG)
+	{
+		Endpoint_ClearOUT();
+		return;
+	}
+
+	uint32_t MessageLength = le32_to_cpu(MessageHeader->MessageLength);
+
+	if ((MessageLength < sizeof(RNDIS_Packet_Message_t)) || (MessageLength > RNDIS_DEVICE_RX_BUFFER_SIZE))
+	{
+		Endpoint_StallTransaction();
+		return;
+	}
+
+	Endpoint_Read_Stream_LE(&Buffer[sizeof(RNDIS_Message_Header_t)], MessageLength - sizeof(RNDIS_Message_Header_t), NULL);
+
+	/* Messages batched into the same transfer follow on from the next alignment boundary, and are each read into a buffer
+	   of their own; the padding before the next message is cut short by the end of the transfer */
+	uint16_t PaddingLength = RNDIS_Device_NextMessageOffset(Buffer, 0) - MessageLength;
+	Endpoint_Discard_Stream(MIN(PaddingLength, Endpoint_BytesInEndpoint()), NULL);
+
+	if (!(Endpoint_BytesInEndpoint()))
+	  Endpoint_ClearOUT();
+
+	if (RNDIS_Device_CheckPacketMessages(Buffer, MessageLength))
+	  RNDISInterfaceInfo->State.RxReceivedBuffers++;
+#endif
+}
+
+static uint8_t* RNDIS_Device_GetPoolBuffer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                           const uint8_t Position)
+{
+	uint8_t BufferIndex = (RNDISInterfaceInfo->State.RxFirstBuffer + Position) % RNDISInterfaceInfo->Config.TotalRxFrameBuffers;
+
+	return &((uint8_t*)RNDISInterfaceInfo->Config.RxFrameBuffers)[BufferIndex * RNDIS_DEVICE_RX_BUFFER_SIZE];
+}
+
+static bool RNDIS_Device_FindNextFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                       uint8_t** const Frame,
+                                       uint16_t* const FrameLength)
+{
+	while (RNDISInterfaceInfo->State.RxReadBuffer < RNDISInterfaceInfo->State.RxReceivedBuffers)
+	{
+		uint8_t* Buffer = RNDIS_Device_GetPoolBuffer(RNDISInterfaceInfo, RNDISInterfaceInfo->State.RxReadBuffer);
+		uint16_t Offset = RNDISInterfaceInfo->State.RxReadOffset;
+
+		/* Messages were checked as they were received, so this only locates the frame within the next message */
+		if ((Offset < RNDIS_DEVICE_RX_BUFFER_SIZE) &&
+		    RNDIS_Device_ParsePacketMessage(&Buffer[Offset], RNDIS_DEVICE_RX_BUFFER_SIZE - Offset, Frame, FrameLength))
+		{
+			return true;
+		}
+
+		RNDISInterfaceInfo->State.RxReadBuffer++;
+		RNDISInterfaceInfo->State.RxReadOffset = 0;
+	}
+
+	return false;
+}
+
+static uint16_t RNDIS_Device_CheckPacketMessages(uint8_t* const Buffer,
+                                                 const uint16_t Length)
+{
+	uint16_t Offset = 0;
+
+	while ((Offset < Length) && RNDIS_Device_ParsePacketMessage(&Buffer[Offset], Length - Offset, NULL, NULL))
+	  Offset = RNDIS_Device_NextMessageOffset(Buffer, Offset);
+
+	/* Anything after the last valid message is cut off, so that the buffer can later be walked without its length */
+	if (Offset && ((Offset + sizeof(RNDIS_Packet_Message_t)) <= RNDIS_DEVICE_RX_BUFFER_SIZE))
+	  ((RNDIS_Message_Header_t*)&Buffer[Offset])->MessageType = CPU_TO_LE32(0);
+
+	return Offset;
+}
+
+static uint16_t RNDIS_Device_NextMessageOffset(const uint8_t* const Buffer,
+                                               const uint16_t Offset)
+{
+	const RNDIS_Message_Header_t* MessageHeader = (const RNDIS_Message_Header_t*)&Buffer[Offset];
+	uint16_t AlignmentMask = ((1 << RNDIS_PACKET_ALIGNMENT_FACTOR) - 1);
+
+	return (Offset + (((uint16_t)le32_to_cpu(MessageHeader->MessageLength) + AlignmentMask) & ~AlignmentMask));
+}
+
 uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
                                 void* Buffer,
                                 const uint16_t PacketLength)
@@ -477,26 +718,116 @@ uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 		return ENDPOINT_RWSTREAM_DeviceDisconnected;
 	}
 
+	uint16_t MessageLength = (sizeof(RNDIS_Packet_Message_t) + PacketLength);
+
+	/* Batched messages are padded to the alignment the host is asked to use, with the padding counted in their length */
+	if (RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER > 1)
+	  MessageLength = (MessageLength + ((1 << RNDIS_PACKET_ALIGNMENT_FACTOR) - 1)) & ~((1 << RNDIS_PACKET_ALIGNMENT_FACTOR) - 1);
+
+	if (RNDISInterfaceInfo->State.TxPendingPackets &&
+	    (((uint32_t)RNDISInterfaceInfo->State.TxTransferLength + MessageLength) > RNDISInterfaceInfo->State.HostMaxTransferSize))
+	{
+		if ((ErrorCode = RNDIS_Device_Flush(RNDISInterfaceInfo)) != ENDPOINT_READYWAIT_NoError)
+		  return ErrorCode;
+	}
+
 	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpoint.Address);
 
-	if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
-	  return ErrorCode;
+	/* Messages after the first in a transfer continue in the bank the previous one was written into */
+	if (!(RNDISInterfaceInfo->State.TxPendingPackets))
+	{
+		if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+		  return ErrorCode;
+	}
 
 	RNDIS_Packet_Message_t RNDISPacketHeader;
 
 	memset(&RNDISPacketHeader, 0, sizeof(RNDIS_Packet_Message_t));
 
 	RNDISPacketHeader.MessageType   = CPU_TO_LE32(REMOTE_NDIS_PACKET_MSG);
-	RNDISPacketHeader.MessageLength = cpu_to_le32(sizeof(RNDIS_Packet_Message_t) + PacketLength);
+	RNDISPacketHeader.MessageLength = cpu_to_le32(MessageLength);
 	RNDISPacketHeader.DataOffset    = CPU_TO_LE32(sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
 	RNDISPacketHeader.DataLength    = cpu_to_le32(PacketLength);
 
 	Endpoint_Write_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NULL);
 	Endpoint_Write_Stream_LE(Buffer, PacketLength, NULL);
-	Endpoint_ClearIN();
+	Endpoint_Null_Stream(MessageLength - (sizeof(RNDIS_Packet_Message_t) + PacketLength), NULL);
+
+	RNDISInterfaceInfo->State.TxTransferLength += MessageLength;
+
+	if (++RNDISInterfaceInfo->State.TxPendingPackets == RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER)
+	  return RNDIS_Device_Flush(RNDISInterfaceInfo);
 
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+uint8_t RNDIS_Device_Flush(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	uint8_t ErrorCode;
+
+	if (!(RNDISInterfaceInfo->State.TxPendingPackets))
+	  return ENDPOINT_READYWAIT_NoError;
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpoint.Address);
+
+	RNDISInterfaceInfo->State.TxPendingPackets = 0;
+	RNDISInterfaceInfo->State.TxTransferLength = 0;
+
+	/* A transfer of whole packets is ended with a zero length packet, so that the host does not wait for more */
+	bool BankFull = !(Endpoint_IsReadWriteAllowed());
+
+	Endpoint_ClearIN();
+
+	if (BankFull)
+	{
+		if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+		  return ErrorCode;
+
+		Endpoint_ClearIN();
+	}
+
+	return ENDPOINT_READYWAIT_NoError;
+}
+
+static bool RNDIS_Device_ParsePacketMessage(uint8_t* const Message,
+                                            const uint16_t Length,
+                                            uint8_t** const Frame,
+                                            uint16_t* const FrameLength)
+{
+	RNDIS_Packet_Message_t* MessageHeader = (RNDIS_Packet_Message_t*)Message;
+
+	if ((Length < sizeof(RNDIS_Packet_Message_t)) ||
+	    (le32_to_cpu(MessageHeader->MessageType) != REMOTE_NDIS_PACKET_MSG))
+	{
+		return false;
+	}
+
+	/* The data offset is counted from the start of the message's type specific fields, after the common header */
+	uint32_t MessageLength = le32_to_cpu(MessageHeader->MessageLength);
+	uint32_t DataOffset    = le32_to_cpu(MessageHeader->DataOffset) + sizeof(RNDIS_Message_Header_t);
+	uint32_t DataLength    = le32_to_cpu(MessageHeader->DataLength);
+
+	if ((MessageLength > Length) || (DataLength > ETHERNET_FRAME_SIZE_MAX) ||
+	    (DataOffset < sizeof(RNDIS_Packet_Message_t)) || (DataOffset > MessageLength) ||
+	    (DataLength > (MessageLength - DataOffset)))
+	{
+		return false;
+	}
+
+	if (Frame != NULL)
+	{
+		*Frame       = &Message[DataOffset];
+		*FrameLength = (uint16_t)DataLength;
+	}
+
+	return true;
+}
+
 #endif
 
@@ -68,6 +68,31 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			#if !defined(RNDIS_DEVICE_RX_BUFFER_SIZE) || defined(__DOXYGEN__)
+				/** Size in bytes of each buffer in the receive pool of a RNDIS interface, see \ref RNDIS_Device_GetReceivedFrame().
+				 *  By default this holds a complete RNDIS packet message carrying a maximum size Ethernet frame, rounded up to a whole
+				 *  number of maximum size bulk endpoint packets. This is also the largest transfer the host is told it may send, so
+				 *  larger buffers allow more small frames to be batched into each transfer.
+				 *
+				 *  This value may be overridden in the user project makefile as the value of the \ref RNDIS_DEVICE_RX_BUFFER_SIZE token,
+				 *  and passed to the compiler using the -D switch. It must remain a multiple of 64 bytes, and no smaller than the default.
+				 */
+				#define RNDIS_DEVICE_RX_BUFFER_SIZE       (((sizeof(RNDIS_Packet_Message_t) + ETHERNET_FRAME_SIZE_MAX) + 63) & ~63)
+			#endif
+
+			#if !defined(RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER) || defined(__DOXYGEN__)
+				/** Maximum number of packet messages batched into a single bulk transfer, in each direction. Receiving more than one
+				 *  packet message per transfer is only offered to the host when the interface has a receive pool, see
+				 *  \ref RNDIS_Device_GetReceivedFrame().
+				 *
+				 *  This value may be overridden in the user project makefile as the value of the
+				 *  \ref RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER token, and passed to the compiler using the -D switch. A value of one
+				 *  restores a single packet message per transfer.
+				 */
+				#define RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER  8
+			#endif
+
 		/* Type Defines: */
 			/** \brief RNDIS Class Device Mode Configuration and State Structure.
 			 *
@@ -87,6 +112,12 @@
 
 					char*         AdapterVendorDescription; /**< String description of the adapter vendor. */
 					MAC_Address_t AdapterMACAddress; /**< MAC address of the adapter. */
+
+					void*    RxFrameBuffers; /**< Pool of receive buffers of \ref RNDIS_DEVICE_RX_BUFFER_SIZE bytes each, aligned to a
+					                          *   32-bit word boundary, into which packet messages from the host are received whole for
+					                          *   \ref RNDIS_Device_GetReceivedFrame(). May be \c NULL if the pool is not used.
+					                          */
+					uint8_t  TotalRxFrameBuffers; /**< Number of buffers in the \c RxFrameBuffers pool, or zero if the pool is not used. */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -98,6 +129,30 @@
 					bool     ResponseReady; /**< Internal flag indicating if a RNDIS message is waiting to be returned to the host. */
 					uint8_t  CurrRNDISState; /**< Current RNDIS state of the adapter, a value from the \ref RNDIS_States_t enum. */
 					uint32_t CurrPacketFilter; /**< Current packet filter mode, used internally by the class driver. */
+
+					uint8_t  RxFirstBuffer; /**< Index of the oldest received buffer in the receive pool, used internally by the class driver. */
+					uint8_t  RxReceivedBuffers; /**< Number of buffers in the receive pool holding a received packet message, including those
+					                             *   handed to the application, used internally by the class driver.
+					                             */
+					uint8_t  RxReadBuffer; /**< Position of the buffer holding the next frame to retrieve, counted from the oldest received
+					                        *   buffer, used internally by the class driver.
+					                        */
+					uint16_t RxReadOffset; /**< Offset of the next packet message to retrieve within its buffer, used internally by the class driver. */
+					uint16_t RxReleaseOffset; /**< Offset of the oldest held packet message within the oldest received buffer, used internally
+					                           *   by the class driver.
+					                           */
+					uint8_t  RxHeldFrames; /**< Number of received frames handed to the application and not yet released, used internally by
+					                        *   the class driver.
+					                        */
+					bool     RxTransferActive; /**< Internal flag indicating if the next free buffer of the receive pool is being received into. */
+
+					uint32_t HostMaxTransferSize; /**< Largest transfer the host accepts from the device, used internally by the class driver. */
+					uint16_t TxTransferLength; /**< Length of the packet messages written to the current IN transfer, used internally by the
+					                            *   class driver.
+					                            */
+					uint8_t  TxPendingPackets; /**< Number of packet messages written to the current IN transfer but not yet sent, used
+					                            *   internally by the class driver.
+					                            */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -155,7 +210,45 @@
 											void* Buffer,
 											uint16_t* const PacketLength) ATTR_NON_NULL_PTR_ARG(1);
 
-			/** Sends the given packet to the attached RNDIS device, after adding a RNDIS packet message header.
+			/** Retrieves the next received packet from the receive pool of the given RNDIS interface, without copying it. The packet
+			 *  message header is checked and skipped in place, leaving \c Frame pointing to the Ethernet frame inside the pool buffer
+			 *  it was received into. The frame remains valid until it is released with \ref RNDIS_Device_ReleaseFrame(); several
+			 *  frames may be held at once. When the host batches several packet messages into a single transfer, they share a pool
+			 *  buffer and are returned one at a time.
+			 *
+			 *  On the EFM32GG architecture, packet messages are received from the data OUT endpoint straight into the pool buffers by
+			 *  the endpoint DMA. On other architectures, each message is read out of the endpoint bank directly into a pool buffer.
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \note This requires a receive pool to be set in the \c RxFrameBuffers and \c TotalRxFrameBuffers elements of the
+			 *        interface's configuration. Once a pool is set, \ref RNDIS_Device_ReadPacket() copies frames out of the pool, and
+			 *        must not be used while any frames are held.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 *  \param[out]    Frame               Pointer to where the location of the received frame is to be stored.
+			 *  \param[out]    FrameLength         Pointer to where the length in bytes of the received frame is to be stored.
+			 *
+			 *  \return Boolean \c true if a frame was retrieved, \c false if no further frames have been received.
+			 */
+			bool RNDIS_Device_GetReceivedFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                                   uint8_t** const Frame,
+			                                   uint16_t* const FrameLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+			                                   ATTR_NON_NULL_PTR_ARG(3);
+
+			/** Releases the oldest frame held by the application after a call to \ref RNDIS_Device_GetReceivedFrame(). Frames are
+			 *  released in the order they were retrieved, and each pool buffer returns to the receive pool of the given RNDIS interface
+			 *  once all of the frames received into it have been released.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 */
+			void RNDIS_Device_ReleaseFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Sends the given packet to the attached RNDIS device, after adding a RNDIS packet message header. Packet messages are
+			 *  batched into the current bulk transfer until \ref RNDIS_DEVICE_MAX_PACKETS_PER_TRANSFER messages or the largest transfer
+			 *  the host accepts is reached, or \ref RNDIS_Device_Flush() is called, so that several small frames share one transfer.
+			 *  Pending messages are flushed by \ref RNDIS_Device_USBTask().
 			 *
 			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
 			 *       call will fail.
@@ -170,8 +263,23 @@
 											void* Buffer,
 											const uint16_t PacketLength) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Ends the current bulk IN transfer of the given RNDIS interface, sending any packet messages batched into it by
+			 *  \ref RNDIS_Device_SendPacket() to the host.
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 *
+			 *  \return A value from the \ref Endpoint_WaitUntilReady_ErrorCodes_t enum.
+			 */
+			uint8_t RNDIS_Device_Flush(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define RNDIS_PACKET_ALIGNMENT_FACTOR         3
+
 		/* Function Prototypes: */
 		#if defined(__INCLUDE_FROM_RNDIS_DEVICE_C)
 			static void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
@@ -188,6 +296,20 @@
 			                                        const void* SetData,
                                                     const uint16_t SetSize) ATTR_NON_NULL_PTR_ARG(1)
 			                                        ATTR_NON_NULL_PTR_ARG(3);
+			static void RNDIS_Device_ReceiveIntoPool(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+			static uint8_t* RNDIS_Device_GetPoolBuffer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                                           const uint8_t Position) ATTR_NON_NULL_PTR_ARG(1);
+			static bool RNDIS_Device_FindNextFrame(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                                       uint8_t** const Frame,
+			                                       uint16_t* const FrameLength) ATTR_NON_NULL_PTR_ARG(1);
+			static uint16_t RNDIS_Device_CheckPacketMessages(uint8_t* const Buffer,
+			                                                 const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+			static uint16_t RNDIS_Device_NextMessageOffset(const uint8_t* const Buffer,
+			                                               const uint16_t Offset) ATTR_NON_NULL_PTR_ARG(1);
+			static bool RNDIS_Device_ParsePacketMessage(uint8_t* const Message,
+			                                            const uint16_t Length,
+			                                            uint8_t** const Frame,
+			                                            uint16_t* const FrameLength) ATTR_NON_NULL_PTR_ARG(1);
 		#endif
 
 	#endif
@@ -140,9 +140,8 @@ static uint8_t DCOMP_MS_Host_NextMSInterfaceEndpoint(void* const CurrentDescript
 	return DESCRIPTOR_SEARCH_NotFound;
 }
 
-static uint8_t MS_Host_SendCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
-                                   MS_CommandBlockWrapper_t* const SCSICommandBlock,
-                                   const void* const BufferPtr)
+static uint8_t MS_Host_SendCommandBlock(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                        MS_CommandBlockWrapper_t* const SCSICommandBlock)
 {
 	uint8_t ErrorCode = PIPE_RWSTREAM_NoError;
 
@@ -162,6 +161,22 @@ static uint8_t MS_Host_SendCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInf
 	}
 
 	Pipe_ClearOUT();
+
+	return ErrorCode;
+}
+
+static uint8_t MS_Host_SendCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                   MS_CommandBlockWrapper_t* const SCSICommandBlock,
+                                   const void* const BufferPtr)
+{
+	uint8_t ErrorCode = PIPE_RWSTREAM_NoError;
+
+	if (MSInterfaceInfo->State.RequestCount)
+	  MS_Host_FlushRequests(MSInterfaceInfo);
+
+	if ((ErrorCode = MS_Host_SendCommandBlock(MSInterfaceInfo, SCSICommandBlock)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
 	Pipe_WaitUntilReady();
 
 	Pipe_Freeze();
@@ -575,5 +590,300 @@ uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo
 	return MS_Host_SendCommand(MSInterfaceInfo, &SCSICommandBlock, BlockBuffer);
 }
 
+bool MS_Host_QueueBlockRequest(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                               MS_Host_BlockRequest_t* const Request)
+{
+	if ((USB_HostState != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
+	  return false;
+
+	if (!(Request->Blocks) || (MSInterfaceInfo->State.RequestCount == MS_HOST_REQUEST_QUEUE_SIZE))
+	  return false;
+
+	Request->Status = MS_HOST_REQUEST_PENDING;
+
+	MSInterfaceInfo->State.RequestQueue[(MSInterfaceInfo->State.RequestHead + MSInterfaceInfo->State.RequestCount)
+	                                    % MS_HOST_REQUEST_QUEUE_SIZE] = Request;
+	MSInterfaceInfo->State.RequestCount++;
+
+	return true;
+}
+
+void MS_Host_FlushRequests(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	while (MSInterfaceInfo->State.RequestCount)
+	  MS_Host_USBTask(MSInterfaceInfo);
+}
+
+void MS_Host_USBTask(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	uint8_t ErrorCode = PIPE_RWSTREAM_NoError;
+
+	while (MSInterfaceInfo->State.RequestCount)
+	{
+		if ((USB_HostState != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
+		{
+			MS_Host_CompleteRequests(MSInterfaceInfo, MSInterfaceInfo->State.RequestCount, PIPE_RWSTREAM_DeviceDisconnected);
+			return;
+		}
+
+		switch (MSInterfaceInfo->State.RequestStage)
+		{
+			case MS_REQUEST_STAGE_Idle:
+				ErrorCode = MS_Host_SendQueuedCommand(MSInterfaceInfo);
+				break;
+			case MS_REQUEST_STAGE_Data:
+				ErrorCode = MS_Host_TransferQueuedData(MSInterfaceInfo);
+				break;
+			case MS_REQUEST_STAGE_Status:
+				ErrorCode = MS_Host_GetQueuedStatus(MSInterfaceInfo);
+				break;
+		}
+
+		if (ErrorCode == PIPE_RWSTREAM_IncompleteTransfer)
+		  return;
+
+		if (ErrorCode != PIPE_RWSTREAM_NoError)
+		{
+			Pipe_SelectPipe(MSInterfaceInfo->Config.DataINPipe.Address);
+			Pipe_Freeze();
+
+			Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipe.Address);
+			Pipe_Freeze();
+
+			MS_Host_CompleteRequests(MSInterfaceInfo, MSInterfaceInfo->State.RequestsInCommand, ErrorCode);
+
+			/* The device may still be part way through the failed command, so resynchronize it before the next one */
+			if (ErrorCode != PIPE_RWSTREAM_DeviceDisconnected)
+			  MS_Host_ResetMSInterface(MSInterfaceInfo);
+
+			return;
+		}
+	}
+}
+
+static uint8_t MS_Host_SendQueuedCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	MS_Host_BlockRequest_t* Request = MSInterfaceInfo->State.RequestQueue[MSInterfaceInfo->State.RequestHead];
+
+	uint32_t BlockAddress = (Request->BlockAddress + Request->Blocks);
+	uint16_t Blocks       = Request->Blocks;
+	uint8_t  Requests     = 1;
+
+	/* Merge following requests which continue the same transfer into a single SCSI command */
+	while (Requests < MSInterfaceInfo->State.RequestCount)
+	{
+		MS_Host_BlockRequest_t* NextRequest = MSInterfaceInfo->State.RequestQueue[(MSInterfaceInfo->State.RequestHead + Requests)
+		                                                                          % MS_HOST_REQUEST_QUEUE_SIZE];
+
+		if ((NextRequest->LUNIndex     != Request->LUNIndex)  ||
+		    (NextRequest->IsWrite      != Request->IsWrite)   ||
+		    (NextRequest->BlockSize    != Request->BlockSize) ||
+		    (NextRequest->BlockAddress != BlockAddress)       ||
+		    (((uint32_t)Blocks + NextRequest->Blocks) > 0xFFFF))
+		{
+			break;
+		}
+
+		BlockAddress += NextRequest->Blocks;
+		Blocks       += NextRequest->Blocks;
+		Requests++;
+	}
+
+	MSInterfaceInfo->State.RequestsInCommand = Requests;
+
+	Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipe.Address);
+	Pipe_Unfreeze();
+
+	if (!(Pipe_IsOUTReady()))
+	  return MS_Host_CheckQueuedPipe(MSInterfaceInfo);
+
+	MS_CommandBlockWrapper_t SCSICommandBlock = (MS_CommandBlockWrapper_t)
+		{
+			.DataTransferLength = cpu_to_le32((uint32_t)Blocks * Request->BlockSize),
+			.Flags              = (Request->IsWrite ? MS_COMMAND_DIR_DATA_OUT : MS_COMMAND_DIR_DATA_IN),
+			.LUN                = Request->LUNIndex,
+			.SCSICommandLength  = 10,
+			.SCSICommandData    =
+				{
+					(Request->IsWrite ? SCSI_CMD_WRITE_10 : SCSI_CMD_READ_10),
+					0x00,                                 // Unused (control bits, all off)
+					(Request->BlockAddress >> 24),        // MSB of Block Address
+					(Request->BlockAddress >> 16),
+					(Request->BlockAddress >> 8),
+					(Request->BlockAddress & 0xFF),       // LSB of Block Address
+					0x00,                                 // Reserved
+					(Blocks >> 8),                        // MSB of Total Blocks to Transfer
+					(Blocks & 0xFF),                      // LSB of Total Blocks to Transfer
+					0x00                                  // Unused (control)
+				}
+		};
+
+	uint8_t ErrorCode = MS_Host_SendCommandBlock(MSInterfaceInfo, &SCSICommandBlock);
+
+	if (ErrorCode != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	MSInterfaceInfo->State.RequestIndex          = 0;
+	MSInterfaceInfo->State.RequestOffset         = 0;
+	MSInterfaceInfo->State.RequestBytesProcessed = 0;
+	MSInterfaceInfo->State.RequestTimeoutMSRem   = MS_COMMAND_DATA_TIMEOUT_MS;
+	MSInterfaceInfo->State.RequestFrameNumber    = USB_Host_GetFrameNumber();
+	MSInterfaceInfo->State.RequestStage          = MS_REQUEST_STAGE_Data;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t MS_Host_TransferQueuedData(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	MS_Host_BlockRequest_t* Request = MSInterfaceInfo->State.RequestQueue[(MSInterfaceInfo->State.RequestHead +
+	                                                                       MSInterfaceInfo->State.RequestIndex)
+	                                                                      % MS_HOST_REQUEST_QUEUE_SIZE];
+
+	uint32_t RequestLength = ((uint32_t)Request->Blocks * Request->BlockSize);
+	uint16_t ChunkLength   = MIN(RequestLength - MSInterfaceInfo->State.RequestOffset, MS_HOST_MAX_STREAM_LENGTH);
+	uint8_t* BufferPtr     = ((uint8_t*)Request->BlockBuffer + MSInterfaceInfo->State.RequestOffset);
+	uint8_t  ErrorCode;
+
+	Pipe_SelectPipe(Request->IsWrite ? MSInterfaceInfo->Config.DataOUTPipe.Address : MSInterfaceInfo->Config.DataINPipe.Address);
+	Pipe_Unfreeze();
+
+	if (!(Request->IsWrite ? Pipe_IsOUTReady() : Pipe_IsINReceived()))
+	{
+		ErrorCode = MS_Host_CheckQueuedPipe(MSInterfaceInfo);
+	}
+	else
+	{
+		if (Request->IsWrite)
+		  ErrorCode = Pipe_Write_Stream_LE(BufferPtr, ChunkLength, &MSInterfaceInfo->State.RequestBytesProcessed);
+		else
+		  ErrorCode = Pipe_Read_Stream_LE(BufferPtr, ChunkLength, &MSInterfaceInfo->State.RequestBytesProcessed);
+
+		if (ErrorCode == PIPE_RWSTREAM_IncompleteTransfer)
+		{
+			/* A bank was completed, so the device is still making progress through the transfer */
+			MSInterfaceInfo->State.RequestTimeoutMSRem = MS_COMMAND_DATA_TIMEOUT_MS;
+			return PIPE_RWSTREAM_NoError;
+		}
+		else if (ErrorCode == PIPE_RWSTREAM_PipeStalled)
+		{
+			ErrorCode = MS_Host_CheckQueuedPipe(MSInterfaceInfo);
+		}
+	}
+
+	if (ErrorCode == PIPE_RWSTREAM_PipeStalled)
+	{
+		/* The device has ended the data stage early, the status stage will indicate the failure */
+		MSInterfaceInfo->State.RequestStage = MS_REQUEST_STAGE_Status;
+		return PIPE_RWSTREAM_NoError;
+	}
+	else if (ErrorCode != PIPE_RWSTREAM_NoError)
+	{
+		return ErrorCode;
+	}
+
+	MSInterfaceInfo->State.RequestOffset        += ChunkLength;
+	MSInterfaceInfo->State.RequestBytesProcessed = 0;
+	MSInterfaceInfo->State.RequestTimeoutMSRem   = MS_COMMAND_DATA_TIMEOUT_MS;
+
+	if (MSInterfaceInfo->State.RequestOffset != RequestLength)
+	  return PIPE_RWSTREAM_NoError;
+
+	MSInterfaceInfo->State.RequestOffset = 0;
+
+	if (++MSInterfaceInfo->State.RequestIndex != MSInterfaceInfo->State.RequestsInCommand)
+	  return PIPE_RWSTREAM_NoError;
+
+	if (Request->IsWrite)
+	{
+		Pipe_ClearOUT();
+	}
+	else
+	{
+		Pipe_ClearIN();
+		Pipe_Freeze();
+	}
+
+	MSInterfaceInfo->State.RequestStage = MS_REQUEST_STAGE_Status;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t MS_Host_GetQueuedStatus(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	uint8_t ErrorCode;
+
+	Pipe_SelectPipe(MSInterfaceInfo->Config.DataOUTPipe.Address);
+	Pipe_Unfreeze();
+
+	if (!(Pipe_IsOUTReady()))
+	  return MS_Host_CheckQueuedPipe(MSInterfaceInfo);
+
+	Pipe_Freeze();
+
+	Pipe_SelectPipe(MSInterfaceInfo->Config.DataINPipe.Address);
+	Pipe_Unfreeze();
+
+	if (!(Pipe_IsINReceived()))
+	  return MS_Host_CheckQueuedPipe(MSInterfaceInfo);
+
+	MS_CommandStatusWrapper_t SCSIStatusBlock;
+
+	if ((ErrorCode = Pipe_Read_Stream_LE(&SCSIStatusBlock, sizeof(MS_CommandStatusWrapper_t),
+	                                     NULL)) != PIPE_RWSTREAM_NoError)
+	{
+		return ErrorCode;
+	}
+
+	Pipe_ClearIN();
+	Pipe_Freeze();
+
+	MS_Host_CompleteRequests(MSInterfaceInfo, MSInterfaceInfo->State.RequestsInCommand,
+	                         (SCSIStatusBlock.Status == MS_SCSI_COMMAND_Pass) ? PIPE_RWSTREAM_NoError : MS_ERROR_LOGICAL_CMD_FAILED);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t MS_Host_CheckQueuedPipe(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
+{
+	if (Pipe_IsStalled())
+	{
+		uint8_t EndpointAddress = Pipe_GetBoundEndpointAddress();
+
+		Pipe_ClearStall();
+		Pipe_Freeze();
+
+		USB_Host_ClearEndpointStall(EndpointAddress);
+		return PIPE_RWSTREAM_PipeStalled;
+	}
+
+	uint16_t CurrentFrameNumber = USB_Host_GetFrameNumber();
+
+	if (CurrentFrameNumber != MSInterfaceInfo->State.RequestFrameNumber)
+	{
+		MSInterfaceInfo->State.RequestFrameNumber = CurrentFrameNumber;
+
+		if (!(MSInterfaceInfo->State.RequestTimeoutMSRem--))
+		  return PIPE_RWSTREAM_Timeout;
+	}
+
+	return PIPE_RWSTREAM_IncompleteTransfer;
+}
+
+static void MS_Host_CompleteRequests(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                     const uint8_t Requests,
+                                     const uint8_t Status)
+{
+	for (uint8_t RequestIndex = 0; RequestIndex < Requests; RequestIndex++)
+	{
+		MSInterfaceInfo->State.RequestQueue[MSInterfaceInfo->State.RequestHead]->Status = Status;
+
+		MSInterfaceInfo->State.RequestHead = ((MSInterfaceInfo->State.RequestHead + 1) % MS_HOST_REQUEST_QUEUE_SIZE);
+		MSInterfaceInfo->State.RequestCount--;
+	}
+
+	MSInterfaceInfo->State.RequestsInCommand = 0;
+	MSInterfaceInfo->State.RequestStage      = MS_REQUEST_STAGE_Idle;
+}
+
 #endif
 
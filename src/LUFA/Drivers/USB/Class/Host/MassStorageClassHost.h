@@ -72,7 +72,41 @@
 			/** Error code for some Mass Storage Host functions, indicating a logical (and not hardware) error. */
 			#define MS_ERROR_LOGICAL_CMD_FAILED              0x80
 
+			/** Value of the \c Status element of a \ref MS_Host_BlockRequest_t while the request is waiting in the
+			 *  request queue or is being transferred.
+			 */
+			#define MS_HOST_REQUEST_PENDING                  0xFF
+
+			#if !defined(MS_HOST_REQUEST_QUEUE_SIZE) || defined(__DOXYGEN__)
+				/** Maximum number of block requests which can be waiting in the request queue of each Mass Storage
+				 *  interface at any one time, see \ref MS_Host_QueueBlockRequest().
+				 *
+				 *  This value may be overridden in the user project makefile as the value of the
+				 *  \c MS_HOST_REQUEST_QUEUE_SIZE token, and passed to the compiler using the -D switch.
+				 */
+				#define MS_HOST_REQUEST_QUEUE_SIZE           4
+			#endif
+
 		/* Type Defines: */
+			/** \brief Mass Storage Class Host Mode Block Request Structure.
+			 *
+			 *  Block read or write request, queued on a Mass Storage interface with \ref MS_Host_QueueBlockRequest()
+			 *  and carried out in the background by \ref MS_Host_USBTask(). The structure is owned by the user
+			 *  application, and both it and its buffer must remain valid until the request has completed.
+			 */
+			typedef struct
+			{
+				void*    BlockBuffer; /**< Buffer the blocks are read into or written from. */
+				uint32_t BlockAddress; /**< Starting block address within the device. */
+				uint16_t Blocks; /**< Total number of blocks to transfer. */
+				uint16_t BlockSize; /**< Size in bytes of each block within the device. */
+				uint8_t  LUNIndex; /**< LUN index within the device the request is being issued to. */
+				bool     IsWrite; /**< Boolean \c true if the blocks are to be written to the device, \c false to read them. */
+				volatile uint8_t Status; /**< \ref MS_HOST_REQUEST_PENDING until the request completes, then a value from the
+				                          *   \ref Pipe_Stream_RW_ErrorCodes_t enum or \ref MS_ERROR_LOGICAL_CMD_FAILED.
+				                          */
+			} MS_Host_BlockRequest_t;
+
 			/** \brief Mass Storage Class Host Mode Configuration and State Structure.
 			 *
 			 *  Class state structure. An instance of this structure should be made within the user application,
@@ -97,6 +131,17 @@
 					uint8_t  InterfaceNumber; /**< Interface index of the Mass Storage interface within the attached device. */
 
 					uint32_t TransactionTag; /**< Current transaction tag for data synchronizing of packets. */
+
+					MS_Host_BlockRequest_t* RequestQueue[MS_HOST_REQUEST_QUEUE_SIZE]; /**< Queued block requests, in order of issue. */
+					uint8_t  RequestHead; /**< Index of the oldest request in the request queue. */
+					uint8_t  RequestCount; /**< Number of requests in the request queue, including those in progress. */
+					uint8_t  RequestsInCommand; /**< Number of requests merged into the SCSI command in progress. */
+					uint8_t  RequestIndex; /**< Index of the request whose data is being transferred, within the command. */
+					uint8_t  RequestStage; /**< Stage of the SCSI command in progress. */
+					uint32_t RequestOffset; /**< Bytes of the current request's buffer already transferred. */
+					uint16_t RequestBytesProcessed; /**< Bytes of the current stream chunk already transferred. */
+					uint16_t RequestTimeoutMSRem; /**< Milliseconds left before the command in progress times out. */
+					uint16_t RequestFrameNumber; /**< Frame number at the last check of the request timeout. */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 						  *   <b>may</b> be set to initial values, but may also be ignored to default to sane values when
 						  *   the interface is enumerated.
@@ -286,29 +331,70 @@
 			                                  const uint16_t BlockSize,
 			                                  const void* BlockBuffer) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(6);
 
-		/* Inline Functions: */
+			/** Queues a block read or write request on the given Mass Storage interface, to be carried out in the background
+			 *  by \ref MS_Host_USBTask(). Requests are issued to the device in order, each SCSI command being sent as soon as
+			 *  the status of the previous one has been received. Queued requests to the same LUN, in the same direction and
+			 *  continuing the block range of the request before them are merged into a single SCSI command.
+			 *
+			 *  The \c Status element of the request is set to \ref MS_HOST_REQUEST_PENDING, and is updated once the request
+			 *  has completed.
+			 *
+			 *  \pre This function must only be called when the Host state machine is in the \ref HOST_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a MS Class host configuration and state.
+			 *  \param[in,out] Request          Pointer to the block request to queue.
+			 *
+			 *  \return Boolean \c true if the request was queued, \c false if the queue is full or the device is not ready.
+			 */
+			bool MS_Host_QueueBlockRequest(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+			                               MS_Host_BlockRequest_t* const Request) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Carries out all block requests in the request queue of the given Mass Storage interface, returning once
+			 *  each of them has completed.
+			 *
+			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing a MS Class host configuration and state.
+			 */
+			void MS_Host_FlushRequests(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
 			/** General management task for a given Mass Storage host class interface, required for the correct operation of
 			 *  the interface. This should be called frequently in the main program loop, before the master USB management task
-			 *  \ref USB_USBTask().
+			 *  \ref USB_USBTask(). Queued block requests are advanced as far as the device allows without waiting.
 			 *
 			 *  \param[in,out] MSInterfaceInfo  Pointer to a structure containing an Mass Storage Class host configuration and state.
 			 */
-			static inline void MS_Host_USBTask(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1) ATTR_ALWAYS_INLINE;
-			static inline void MS_Host_USBTask(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo)
-			{
-				(void)MSInterfaceInfo;
-			}
+			void MS_Host_USBTask(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Macros: */
 			#define MS_COMMAND_DATA_TIMEOUT_MS        10000
 
+			#define MS_HOST_MAX_STREAM_LENGTH         0x8000
+
+		/* Enums: */
+			enum MS_Host_RequestStages_t
+			{
+				MS_REQUEST_STAGE_Idle     = 0,
+				MS_REQUEST_STAGE_Data     = 1,
+				MS_REQUEST_STAGE_Status   = 2,
+			};
+
 		/* Function Prototypes: */
 			#if defined(__INCLUDE_FROM_MASSSTORAGE_HOST_C)
+				static uint8_t MS_Host_SendCommandBlock(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+				                                        MS_CommandBlockWrapper_t* const SCSICommandBlock)
+				                                        ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 				static uint8_t MS_Host_SendCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 				                                   MS_CommandBlockWrapper_t* const SCSICommandBlock,
 				                                   const void* const BufferPtr) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				static uint8_t MS_Host_SendQueuedCommand(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+				static uint8_t MS_Host_TransferQueuedData(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+				static uint8_t MS_Host_GetQueuedStatus(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+				static uint8_t MS_Host_CheckQueuedPipe(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+				static void    MS_Host_CompleteRequests(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+				                                        const uint8_t Requests,
+				                                        const uint8_t Status) ATTR_NON_NULL_PTR_ARG(1);
 				static uint8_t MS_Host_WaitForDataReceived(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 				static uint8_t MS_Host_SendReceiveData(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 				                                       MS_CommandBlockWrapper_t* const SCSICommandBlock,
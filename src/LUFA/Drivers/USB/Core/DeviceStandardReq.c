@@ -70,6 +70,7 @@ void USB_Device_ProcessControlRequest(void)
 	if (Endpoint_IsSETUPReceived())
 	{
 		uint8_t bmRequestType = USB_ControlRequest.bmRequestType;
+		bool    RequestHandled = false;
 
 		switch (USB_ControlRequest.bRequest)
 		{
@@ -77,7 +78,7 @@ void USB_Device_ProcessControlRequest(void)
 				if ((bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE)) ||
 					(bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_ENDPOINT)))
 				{
-					USB_Device_GetStatus();
+					RequestHandled = USB_Device_GetStatus();
 				}
 
 				break;
@@ -86,51 +87,49 @@ void USB_Device_ProcessControlRequest(void)
 				if ((bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE)) ||
 					(bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_ENDPOINT)))
 				{
-					USB_Device_ClearSetFeature();
+					RequestHandled = USB_Device_ClearSetFeature();
 				}
 
 				break;
 			case REQ_SetAddress:
 				if (bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE))
-				  USB_Device_SetAddress();
+				  RequestHandled = USB_Device_SetAddress();
 
 				break;
 			case REQ_GetDescriptor:
 				if ((bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE)) ||
 					(bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_INTERFACE)))
 				{
-					USB_Device_GetDescriptor();
+					RequestHandled = USB_Device_GetDescriptor();
 				}
 
 				break;
 			case REQ_GetConfiguration:
 				if (bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE))
-				  USB_Device_GetConfiguration();
+				  RequestHandled = USB_Device_GetConfiguration();
 
 				break;
 			case REQ_SetConfiguration:
 				if (bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE))
-				  USB_Device_SetConfiguration();
+				  RequestHandled = USB_Device_SetConfiguration();
 
 				break;
 
 			default:
-//				printf("Unknow command handled!\n");
-				Endpoint_ClearSETUP();
 				break;
 		}
-	}
 
-#if 0
-	if (Endpoint_IsSETUPReceived())
-	{
-		Endpoint_ClearSETUP();
-		Endpoint_StallTransaction();
+		/* Only stall a request which none of the handlers accepted - once a handler has finished the status
+		 * stage the host may already have sent the next SETUP packet, which must not be stalled */
+		if (!(RequestHandled))
+		{
+			Endpoint_ClearSETUP();
+			Endpoint_StallTransaction();
+		}
 	}
-#endif
 }
 
-static void USB_Device_SetAddress(void)
+static bool USB_Device_SetAddress(void)
 {
 	uint8_t DeviceAddress = (USB_ControlRequest.wValue & 0x7F);
 
@@ -143,13 +142,15 @@ static void USB_Device_SetAddress(void)
 	USB_Device_EnableDeviceAddress(DeviceAddress);
 
 	USB_DeviceState = (DeviceAddress) ? DEVICE_STATE_Addressed : DEVICE_STATE_Default;
+
+	return true;
 }
 
-static void USB_Device_SetConfiguration(void)
+static bool USB_Device_SetConfiguration(void)
 {
 	#if defined(FIXED_NUM_CONFIGURATIONS)
 	if ((uint8_t)USB_ControlRequest.wValue > FIXED_NUM_CONFIGURATIONS)
-	  return;
+	  return false;
 	#else
 	USB_Descriptor_Device_t* DevDescriptorPtr;
 
@@ -172,28 +173,28 @@ static void USB_Device_SetConfiguration(void)
 	#endif
 	                               ) == NO_DESCRIPTOR)
 	{
-		return;
+		return false;
 	}
 
 	#if defined(ARCH_HAS_MULTI_ADDRESS_SPACE)
 	if (MemoryAddressSpace == MEMSPACE_FLASH)
 	{
 		if (((uint8_t)USB_ControlRequest.wValue > pgm_read_byte(&DevDescriptorPtr->NumberOfConfigurations)))
-		  return;
+		  return false;
 	}
 	else if (MemoryAddressSpace == MEMSPACE_EEPROM)
 	{
 		if (((uint8_t)USB_ControlRequest.wValue > eeprom_read_byte(&DevDescriptorPtr->NumberOfConfigurations)))
-		  return;
+		  return false;
 	}
 	else
 	{
 		if ((uint8_t)USB_ControlRequest.wValue > DevDescriptorPtr->NumberOfConfigurations)
-		  return;
+		  return false;
 	}
 	#else
 	if ((uint8_t)USB_ControlRequest.wValue > DevDescriptorPtr->NumberOfConfigurations)
-	  return;
+	  return false;
 	#endif
 	#endif
 
@@ -209,9 +210,11 @@ static void USB_Device_SetConfiguration(void)
 	  USB_DeviceState = (USB_Device_IsAddressSet()) ? DEVICE_STATE_Configured : DEVICE_STATE_Powered;
 
 	EVENT_USB_Device_ConfigurationChanged();
+
+	return true;
 }
 
-static void USB_Device_GetConfiguration(void)
+static bool USB_Device_GetConfiguration(void)
 {
 	Endpoint_ClearSETUP();
 
@@ -219,6 +222,8 @@ static void USB_Device_GetConfiguration(void)
 	Endpoint_ClearIN();
 
 	Endpoint_ClearStatusStage();
+
+	return true;
 }
 
 #if !defined(NO_INTERNAL_SERIAL) && (USE_INTERNAL_SERIAL != NO_DESCRIPTOR)
@@ -242,7 +247,7 @@ static void USB_Device_GetInternalSerialDescriptor(void)
 }
 #endif
 
-static void USB_Device_GetDescriptor(void)
+static bool USB_Device_GetDescriptor(void)
 {
 	const void* DescriptorPointer;
 	uint16_t    DescriptorSize;
@@ -256,7 +261,7 @@ static void USB_Device_GetDescriptor(void)
 	if (USB_ControlRequest.wValue == ((DTYPE_String << 8) | USE_INTERNAL_SERIAL))
 	{
 		USB_Device_GetInternalSerialDescriptor();
-		return;
+		return true;
 	}
 	#endif
 	// printf("wValue = 0x%x\n", USB_ControlRequest.wValue);
@@ -268,7 +273,7 @@ static void USB_Device_GetDescriptor(void)
 	#endif
 													 )) == NO_DESCRIPTOR)
 	{
-		return;
+		return false;
 	}
 
 	Endpoint_ClearSETUP();
@@ -289,9 +294,11 @@ static void USB_Device_GetDescriptor(void)
 	#endif
 
 	Endpoint_ClearOUT();
+
+	return true;
 }
 
-static void USB_Device_GetStatus(void)
+static bool USB_Device_GetStatus(void)
 {
 	uint8_t CurrentStatus = 0;
 
@@ -319,7 +326,7 @@ static void USB_Device_GetStatus(void)
 
 			break;
 		default:
-			return;
+			return false;
 	}
 
 	Endpoint_ClearSETUP();
@@ -328,9 +335,11 @@ static void USB_Device_GetStatus(void)
 	Endpoint_ClearIN();
 
 	Endpoint_ClearStatusStage();
+
+	return true;
 }
 
-static void USB_Device_ClearSetFeature(void)
+static bool USB_Device_ClearSetFeature(void)
 {
 	switch (USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_RECIPIENT)
 	{
@@ -339,7 +348,7 @@ static void USB_Device_ClearSetFeature(void)
 			if ((uint8_t)USB_ControlRequest.wValue == FEATURE_SEL_DeviceRemoteWakeup)
 			  USB_Device_RemoteWakeupEnabled = (USB_ControlRequest.bRequest == REQ_SetFeature);
 			else
-			  return;
+			  return false;
 
 			break;
 		#endif
@@ -350,7 +359,7 @@ static void USB_Device_ClearSetFeature(void)
 				uint8_t EndpointIndex = ((uint8_t)USB_ControlRequest.wIndex & ENDPOINT_EPNUM_MASK);
 
 				if (EndpointIndex == ENDPOINT_CONTROLEP)
-				  return;
+				  return false;
 
 				Endpoint_SelectEndpoint(EndpointIndex);
 
@@ -372,7 +381,7 @@ static void USB_Device_ClearSetFeature(void)
 			break;
 		#endif
 		default:
-			return;
+			return false;
 	}
 
 	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
@@ -380,6 +389,8 @@ static void USB_Device_ClearSetFeature(void)
 	Endpoint_ClearSETUP();
 
 	Endpoint_ClearStatusStage();
+
+	return true;
 }
 
 #endif
@@ -39,6 +39,113 @@
 #include "EndpointStream_EFM32GG.h"
 
 #if !defined(CONTROL_ONLY_DEVICE)
+/* Block copy primitives used by the stream functions below. Rather than moving a single byte per
+ * loop iteration through the Endpoint_Read_8()/Endpoint_Write_8() primitives, an entire packet (or
+ * as much of it as is requested) is moved into or out of the endpoint's RAM bank at once, so that
+ * the endpoint readiness and the bank byte count need only be checked and updated once per packet. */
+
+static void Endpoint_CopyBlock(uint8_t *Dest,
+                               const uint8_t *Source,
+                               uint16_t Length)
+{
+	if (!(((uintptr_t)Dest | (uintptr_t)Source) & 0x03)) {
+		uint32_t       *DestWord   = (uint32_t *)Dest;
+		const uint32_t *SourceWord = (const uint32_t *)Source;
+
+		/* Unrolled so that the compiler may issue LDM/STM bursts for the bulk of the packet */
+		while (Length >= 16) {
+			DestWord[0] = SourceWord[0];
+			DestWord[1] = SourceWord[1];
+			DestWord[2] = SourceWord[2];
+			DestWord[3] = SourceWord[3];
+
+			DestWord   += 4;
+			SourceWord += 4;
+			Length     -= 16;
+		}
+
+		while (Length >= 4) {
+			*(DestWord++) = *(SourceWord++);
+			Length -= 4;
+		}
+
+		Dest   = (uint8_t *)DestWord;
+		Source = (const uint8_t *)SourceWord;
+
+		while (Length--)
+			*(Dest++) = *(Source++);
+	} else {
+		memcpy(Dest, Source, Length);
+	}
+}
+
+static uint16_t Endpoint_BytesFreeInBank(void)
+{
+	return (dev->ep[ep_selected].packetSize - Endpoint_BytesInEndpoint());
+}
+
+static void Endpoint_Write_Block_LE(const uint8_t *Buffer,
+                                    const uint16_t Length)
+{
+	Endpoint_CopyBlock(USB_Endpoint_FIFOPos[ep_selected], Buffer, Length);
+
+	USB_Endpoint_FIFOPos[ep_selected] += Length;
+	dev->ep[ep_selected].remaining    += Length;
+}
+
+static void Endpoint_Write_Block_BE(const uint8_t *Buffer,
+                                    const uint16_t Length)
+{
+	uint8_t *FIFOPos   = USB_Endpoint_FIFOPos[ep_selected];
+	uint16_t BytesLeft = Length;
+
+	while (BytesLeft--)
+		*(FIFOPos++) = *(Buffer--);
+
+	USB_Endpoint_FIFOPos[ep_selected] = FIFOPos;
+	dev->ep[ep_selected].remaining   += Length;
+}
+
+static void Endpoint_Read_Block_LE(uint8_t *Buffer,
+                                   const uint16_t Length)
+{
+	Endpoint_CopyBlock(Buffer, USB_Endpoint_FIFOPos[ep_selected], Length);
+
+	USB_Endpoint_FIFOPos[ep_selected] += Length;
+}
+
+static void Endpoint_Read_Block_BE(uint8_t *Buffer,
+                                   const uint16_t Length)
+{
+	uint8_t *FIFOPos   = USB_Endpoint_FIFOPos[ep_selected];
+	uint16_t BytesLeft = Length;
+
+	while (BytesLeft--)
+		*(Buffer--) = *(FIFOPos++);
+
+	USB_Endpoint_FIFOPos[ep_selected] = FIFOPos;
+}
+
+static uint8_t Endpoint_Write_Packets_LE(const uint8_t *Buffer,
+                                         const uint16_t Length,
+                                         uint16_t *const BytesInPackets)
+{
+	uint16_t PacketSize = dev->ep[ep_selected].packetSize;
+	uint32_t Packets    = MIN((uint32_t)(Length - 1) / PacketSize, ENDPOINT_XFER_MAX_PACKETS);
+
+	/* Whole packets of an aligned buffer are sent in one multi-packet DMA transfer straight from the
+	 * caller's memory, provided nothing is already waiting in the bank. The final packet is always left
+	 * for the bank so that flushing the endpoint afterwards behaves exactly as for a byte-wise write. */
+	if (((uint32_t)Buffer & 0x03) || Endpoint_BytesInEndpoint() || !(Packets))
+		return ENDPOINT_RWSTREAM_NoError;
+
+	if (Endpoint_QueueTransfer(ep_selected, (void *)Buffer, Packets * PacketSize, NULL, false) != ENDPOINT_XFER_NoError)
+		return ENDPOINT_RWSTREAM_NoError;
+
+	*BytesInPackets = Packets * PacketSize;
+	return Endpoint_WaitUntilTransferComplete();
+}
+
 uint8_t Endpoint_Discard_Stream(uint16_t Length,
                                 uint16_t *const BytesProcessed)
 {
@@ -63,10 +170,11 @@ uint8_t Endpoint_Discard_Stream(uint16_t Length,
 			if ((ErrorCode = Endpoint_WaitUntilReady()) != 0)
 				return ErrorCode;
 		} else {
-			Endpoint_Discard_8();
+			uint16_t BytesInPacket = MIN(Length, Endpoint_BytesInEndpoint());
 
-			Length--;
-			BytesInTransfer++;
+			USB_Endpoint_FIFOPos[ep_selected] += BytesInPacket;
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
 		}
 	}
 
@@ -97,10 +205,14 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 			if ((ErrorCode = Endpoint_WaitUntilReady()) != 0)
 				return ErrorCode;
 		} else {
-			Endpoint_Write_8(0);
+			uint16_t BytesInPacket = MIN(Length, Endpoint_BytesFreeInBank());
+
+			memset(USB_Endpoint_FIFOPos[ep_selected], 0x00, BytesInPacket);
+			USB_Endpoint_FIFOPos[ep_selected] += BytesInPacket;
+			dev->ep[ep_selected].remaining    += BytesInPacket;
 
-			Length--;
-			BytesInTransfer++;
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
 		}
 	}
 
@@ -115,7 +227,9 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(*BufferPtr)
+#define  TEMPLATE_BANK_LENGTH()                    Endpoint_BytesFreeInBank()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Endpoint_Write_Block_LE(BufferPtr, Amount)
+#define  TEMPLATE_TRANSFER_PACKETS(BufferPtr, Length, Amount) Endpoint_Write_Packets_LE(BufferPtr, Length, Amount)
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_BE
@@ -123,7 +237,8 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(*BufferPtr)
+#define  TEMPLATE_BANK_LENGTH()                    Endpoint_BytesFreeInBank()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Endpoint_Write_Block_BE(BufferPtr, Amount)
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_LE
@@ -131,7 +246,8 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *BufferPtr = Endpoint_Read_8()
+#define  TEMPLATE_BANK_LENGTH()                    Endpoint_BytesInEndpoint()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Endpoint_Read_Block_LE(BufferPtr, Amount)
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_BE
@@ -139,61 +255,10 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
 #define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *BufferPtr = Endpoint_Read_8()
-#include "Template/Template_Endpoint_RW.c"
-
-#if defined(ARCH_HAS_FLASH_ADDRESS_SPACE)
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_PStream_LE
-#define  TEMPLATE_BUFFER_TYPE                      const void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            0
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(pgm_read_byte(BufferPtr))
-#include "Template/Template_Endpoint_RW.c"
-
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_PStream_BE
-#define  TEMPLATE_BUFFER_TYPE                      const void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(pgm_read_byte(BufferPtr))
-#include "Template/Template_Endpoint_RW.c"
-#endif
-
-#if defined(ARCH_HAS_EEPROM_ADDRESS_SPACE)
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_EStream_LE
-#define  TEMPLATE_BUFFER_TYPE                      const void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            0
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(eeprom_read_byte(BufferPtr))
+#define  TEMPLATE_BANK_LENGTH()                    Endpoint_BytesInEndpoint()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Endpoint_Read_Block_BE(BufferPtr, Amount)
 #include "Template/Template_Endpoint_RW.c"
 
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_EStream_BE
-#define  TEMPLATE_BUFFER_TYPE                      const void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearIN()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(eeprom_read_byte(BufferPtr))
-#include "Template/Template_Endpoint_RW.c"
-
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_LE
-#define  TEMPLATE_BUFFER_TYPE                      void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            0
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_update_byte(BufferPtr, Endpoint_Read_8())
-#include "Template/Template_Endpoint_RW.c"
-
-#define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_BE
-#define  TEMPLATE_BUFFER_TYPE                      void*
-#define  TEMPLATE_CLEAR_ENDPOINT()                 Endpoint_ClearOUT()
-#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
-#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
-#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_update_byte(BufferPtr, Endpoint_Read_8())
-#include "Template/Template_Endpoint_RW.c"
-#endif
-
 #endif
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Control_Stream_LE
@@ -38,17 +38,28 @@
 
 #include "../Endpoint.h"
 
+#include "em_emu.h"
+
 #if !defined(FIXED_CONTROL_ENDPOINT_SIZE)
 uint8_t USB_Device_ControlEndpointSize = ENDPOINT_CONTROLEP_DEFAULT_SIZE;
 #endif
 
 uint32_t ep_selected = ENDPOINT_CONTROLEP;
 uint8_t *USB_Endpoint_FIFOPos[ENDPOINT_TOTAL_ENDPOINTS];
-
-#define BUFFERSIZE 500
-/* Buffer to receive incoming messages. Needs to be
+uint32_t USB_Endpoint_OUTReceived;
+uint32_t USB_Endpoint_AutoZLP;
+uint32_t USB_Endpoint_DoubleBank;
+volatile uint8_t  USB_Endpoint_BusyBanks[ENDPOINT_TOTAL_ENDPOINTS];
+volatile uint16_t USB_Endpoint_PendingLength[ENDPOINT_TOTAL_ENDPOINTS];
+
+/* Written only by the USB interrupt (head) and the main loop (tail) */
+static USB_Endpoint_Event_t USB_Endpoint_Events[USB_ENDPOINT_EVENT_QUEUE_SIZE];
+static volatile uint8_t USB_Endpoint_EventHead;
+static volatile uint8_t USB_Endpoint_EventTail;
+
+/* Pool the endpoint banks are planned into by USB_Init(). Needs to be
  * WORD aligned and an integer number of WORDs large */
-UBUF(receiveBuffer, BUFFERSIZE);
+UBUF(receiveBuffer, USB_ENDPOINT_RAM_SIZE);
 
 bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t *const Table,
                                      const uint8_t Entries)
@@ -72,32 +83,433 @@ bool Endpoint_ConfigureEndpoint(const uint8_t Address,
                                 const uint8_t Banks)
 {
 	uint8_t num = (Address & ENDPOINT_EPNUM_MASK);
+	const USB_Endpoint_LayoutEntry_t *Plan;
 	USBD_Ep_TypeDef *ep;
-	(void)Type;
-	(void)Size;
-	(void)Banks;
 
-	if (num >= ENDPOINT_TOTAL_ENDPOINTS)
+	if (num > NUM_EP_USED)
+		return false;
+
+	/* The endpoint must have been planned by USB_Init() with at least this size and bank count */
+	Plan = &USB_Endpoint_Layout.Endpoints[num];
+
+	if (!(Plan->Size) || (Plan->Type != Type) || (Size > Plan->Size) || (Banks > Plan->Banks))
+		return false;
+
+	if ((Type != EP_TYPE_CONTROL) && ((Address ^ Plan->Address) & ENDPOINT_DIR_IN))
 		return false;
 
 	ep = &dev->ep[num];
+	ep->packetSize = Size;
+	ep->buf        = &receiveBuffer[Plan->BufferOffset];
 	USB_Endpoint_FIFOPos[num] = ep->buf;
+	USB_Endpoint_OUTReceived &= ~(1 << num);
+
+	USB_Endpoint_BusyBanks[num]     = 0;
+	USB_Endpoint_PendingLength[num] = 0;
+
+	if ((Type != EP_TYPE_CONTROL) && (Banks > 1))
+		USB_Endpoint_DoubleBank |= (1 << num);
+	else
+		USB_Endpoint_DoubleBank &= ~(1 << num);
+
+	if (Type == EP_TYPE_BULK)
+		USB_Endpoint_AutoZLP |= (1 << num);
+	else
+		USB_Endpoint_AutoZLP &= ~(1 << num);
 
 	USBDHAL_ActivateEp(ep, false);
 
+	/* Double banked endpoints swap banks from the XFERCOMPL interrupt, single banked ones are polled */
 	if (ep->in) {
-		USB->DAINTMSK &= ~ep->mask;
+		if (USB_Endpoint_DoubleBank & ep->mask)
+			USB->DAINTMSK |= ep->mask;
+		else
+			USB->DAINTMSK &= ~ep->mask;
 	} else {
-		USB->DAINTMSK &= ~(ep->mask << _USB_DAINTMSK_OUTEPMSK0_SHIFT);
+		if (USB_Endpoint_DoubleBank & ep->mask)
+			USB->DAINTMSK |= (ep->mask << _USB_DAINTMSK_OUTEPMSK0_SHIFT);
+		else
+			USB->DAINTMSK &= ~(ep->mask << _USB_DAINTMSK_OUTEPMSK0_SHIFT);
 	}
 	return true;
 }
 
+static uint8_t *Endpoint_OtherBank(const USBD_Ep_TypeDef *const ep)
+{
+	const USB_Endpoint_LayoutEntry_t *Plan = &USB_Endpoint_Layout.Endpoints[ep->num];
+	uint8_t *Bank0 = &receiveBuffer[Plan->BufferOffset];
+
+	return (ep->buf == Bank0) ? (Bank0 + (Plan->BufferSize / Plan->Banks)) : Bank0;
+}
+
+static void Endpoint_ArmBank(USBD_Ep_TypeDef *const ep,
+                             uint8_t *const Bank,
+                             const uint16_t Length)
+{
+	/* A bank always holds a single packet; OUT banks are armed for a full packet */
+	ep->hwXferSize = Length;
+
+	if (ep->in) {
+		USB_DINEPS[ep->num].TSIZ    = (Length << _USB_DIEP_TSIZ_XFERSIZE_SHIFT) |
+		                              (1 << _USB_DIEP_TSIZ_PKTCNT_SHIFT);
+		USB_DINEPS[ep->num].DMAADDR = (uint32_t)Bank;
+		USB_DINEPS[ep->num].CTL     = (USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) |
+		                              USB_DIEP_CTL_CNAK | USB_DIEP_CTL_EPENA;
+	} else {
+		USB_DOUTEPS[ep->num].TSIZ    = (Length << _USB_DOEP_TSIZ_XFERSIZE_SHIFT) |
+		                               (1 << _USB_DOEP_TSIZ_PKTCNT_SHIFT);
+		USB_DOUTEPS[ep->num].DMAADDR = (uint32_t)Bank;
+		USB_DOUTEPS[ep->num].CTL     = (USB_DOUTEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) |
+		                               USB_DOEP_CTL_CNAK | USB_DOEP_CTL_EPENA;
+	}
+}
+
+void Endpoint_ClearBankIN(void)
+{
+	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
+
+	INT_Disable();
+
+	/* Send the filled bank straight away if the other one is idle, otherwise queue it behind the
+	 * bank on the wire; the XFERCOMPL interrupt starts it */
+	if (!(USB_Endpoint_BusyBanks[ep_selected]))
+		Endpoint_ArmBank(ep, ep->buf, ep->remaining);
+	else
+		USB_Endpoint_PendingLength[ep_selected] = ep->remaining;
+
+	USB_Endpoint_BusyBanks[ep_selected]++;
+
+	ep->buf       = Endpoint_OtherBank(ep);
+	ep->remaining = 0;
+	USB_Endpoint_FIFOPos[ep_selected] = ep->buf;
+
+	INT_Enable();
+}
+
+void Endpoint_ClearBankOUT(void)
+{
+	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
+
+	INT_Disable();
+
+	if (!(USB_Endpoint_BusyBanks[ep_selected])) {
+		/* Nothing received yet, make sure the hardware is waiting for the first packet */
+		if (!(USB_DOUTEPS[ep_selected].CTL & USB_DOEP_CTL_EPENA))
+			Endpoint_ArmBank(ep, ep->buf, ep->packetSize);
+	} else {
+		/* The hardware owns the other bank, which either is still receiving or already holds the
+		 * next packet; the bank just read becomes the one the hardware fills next */
+		uint8_t *FreedBank = ep->buf;
+
+		ep->buf       = Endpoint_OtherBank(ep);
+		ep->remaining = 0;
+
+		if (--USB_Endpoint_BusyBanks[ep_selected]) {
+			ep->remaining = USB_Endpoint_PendingLength[ep_selected];
+			Endpoint_ArmBank(ep, FreedBank, ep->packetSize);
+		}
+	}
+
+	USB_Endpoint_FIFOPos[ep_selected] = ep->buf;
+
+	INT_Enable();
+}
+
+void Endpoint_CompleteBank(USBD_Ep_TypeDef *const ep)
+{
+	uint8_t num = ep->num;
+
+	if (ep->in) {
+		USB_DINEPS[num].INT = USB_DIEP_INT_XFERCOMPL;
+
+		if (!(USB_Endpoint_BusyBanks[num]))
+			return;
+
+		Endpoint_QueueEvent(ep, USB_STATUS_OK, ep->hwXferSize);
+
+		/* Start the queued bank, which is the one the application is not filling */
+		if (--USB_Endpoint_BusyBanks[num])
+			Endpoint_ArmBank(ep, Endpoint_OtherBank(ep), USB_Endpoint_PendingLength[num]);
+	} else {
+		uint16_t Received;
+
+		USB_DOUTEPS[num].INT = USB_DOEP_INT_XFERCOMPL;
+
+		Received = ep->hwXferSize - ((USB_DOUTEPS[num].TSIZ & _USB_DOEP_TSIZ_XFERSIZE_MASK) >>
+		                             _USB_DOEP_TSIZ_XFERSIZE_SHIFT);
+
+		Endpoint_QueueEvent(ep, USB_STATUS_OK, Received);
+
+		/* A packet in the application's bank is read from there directly, while the hardware goes on
+		 * to fill the other bank. A second packet waits in the other bank until the first is cleared. */
+		if (!(USB_Endpoint_BusyBanks[num]++)) {
+			ep->remaining = Received;
+			Endpoint_ArmBank(ep, Endpoint_OtherBank(ep), ep->packetSize);
+		} else {
+			USB_Endpoint_PendingLength[num] = Received;
+		}
+	}
+}
+
+
+uint8_t Endpoint_QueueTransfer(const uint8_t Address,
+                               void *const Buffer,
+                               const uint16_t Length,
+                               const USB_XferCompleteCb_TypeDef Callback,
+                               const bool SendZLP)
+{
+	uint8_t num = (Address & ENDPOINT_EPNUM_MASK);
+	uint32_t PacketCount;
+	USBD_Ep_TypeDef *ep;
+
+	if ((num == ENDPOINT_CONTROLEP) || (num > NUM_EP_USED))
+		return ENDPOINT_XFER_InvalidEndpoint;
+
+	if ((uint32_t)Buffer & 0x03)
+		return ENDPOINT_XFER_UnalignedBuffer;
+
+	ep = &dev->ep[num];
+
+	if (ep->state == D_EP_TRANSFERRING)
+		return ENDPOINT_XFER_EndpointBusy;
+
+	/* Double banked endpoints can only be handed over while neither bank is in use */
+	if ((USB_Endpoint_DoubleBank & ep->mask) &&
+	    (USB_Endpoint_BusyBanks[num] || (ep->in ? (USB_DINEPS[num].CTL & USB_DIEP_CTL_EPENA) :
+	                                              (USB_DOUTEPS[num].CTL & USB_DOEP_CTL_EPENA))))
+		return ENDPOINT_XFER_EndpointBusy;
+
+	PacketCount = (Length + ep->packetSize - 1) / ep->packetSize;
+
+	if (ep->in) {
+		/* A zero length IN transfer still needs a single (empty) packet on the bus */
+		if (!(PacketCount))
+			PacketCount = 1;
+	} else if (!(Length) || (Length % ep->packetSize)) {
+		return ENDPOINT_XFER_InvalidLength;
+	}
+
+	if (PacketCount > ENDPOINT_XFER_MAX_PACKETS)
+		return ENDPOINT_XFER_InvalidLength;
+
+	ep->xferCompleteCb = Callback;
+	ep->hwXferSize     = Length;
+	ep->xferred        = 0;
+	ep->zlp            = (ep->in && SendZLP && Length && !(Length % ep->packetSize));
+	ep->state          = D_EP_TRANSFERRING;
+
+	/* All transfers are completed from the endpoint interrupt, with or without a callback */
+	if (ep->in) {
+		USB_DINEPS[num].TSIZ    = (Length << _USB_DIEP_TSIZ_XFERSIZE_SHIFT) |
+		                          (PacketCount << _USB_DIEP_TSIZ_PKTCNT_SHIFT);
+		USB_DINEPS[num].DMAADDR = (uint32_t)Buffer;
+		USB->DAINTMSK          |= ep->mask;
+
+		USB_DINEPS[num].CTL = (USB_DINEPS[num].CTL & ~DEPCTL_WO_BITMASK) |
+		                      USB_DIEP_CTL_CNAK | USB_DIEP_CTL_EPENA;
+	} else {
+		USB_DOUTEPS[num].TSIZ    = (Length << _USB_DOEP_TSIZ_XFERSIZE_SHIFT) |
+		                           (PacketCount << _USB_DOEP_TSIZ_PKTCNT_SHIFT);
+		USB_DOUTEPS[num].DMAADDR = (uint32_t)Buffer;
+		USB->DAINTMSK           |= (ep->mask << _USB_DAINTMSK_OUTEPMSK0_SHIFT);
+
+		USB_DOUTEPS[num].CTL = (USB_DOUTEPS[num].CTL & ~DEPCTL_WO_BITMASK) |
+		                       USB_DOEP_CTL_CNAK | USB_DOEP_CTL_EPENA;
+	}
+
+	return ENDPOINT_XFER_NoError;
+}
+
+uint8_t Endpoint_StartTransfer(const uint8_t Address,
+                               void *const Buffer,
+                               const uint16_t Length,
+                               const USB_XferCompleteCb_TypeDef Callback)
+{
+	uint8_t num = (Address & ENDPOINT_EPNUM_MASK);
+
+	return Endpoint_QueueTransfer(Address, Buffer, Length, Callback,
+	                              (USB_Endpoint_AutoZLP & (1 << num)) ? true : false);
+}
+
+void Endpoint_CompleteTransfer(USBD_Ep_TypeDef *const ep)
+{
+	USB_XferCompleteCb_TypeDef Callback = ep->xferCompleteCb;
+	uint32_t Remaining;
+
+	if (ep->in) {
+		USB_DINEPS[ep->num].INT = USB_DIEP_INT_XFERCOMPL;
+
+		/* Terminate a transfer of whole packets with a ZLP, so the host sees the end of the transfer */
+		if (ep->zlp) {
+			ep->zlp = false;
+
+			USB_DINEPS[ep->num].TSIZ = (1 << _USB_DIEP_TSIZ_PKTCNT_SHIFT);
+			USB_DINEPS[ep->num].CTL  = (USB_DINEPS[ep->num].CTL & ~DEPCTL_WO_BITMASK) |
+			                           USB_DIEP_CTL_CNAK | USB_DIEP_CTL_EPENA;
+			return;
+		}
+
+		if (!(USB_Endpoint_DoubleBank & ep->mask))
+			USB->DAINTMSK &= ~ep->mask;
+
+		Remaining = (USB_DINEPS[ep->num].TSIZ & _USB_DIEP_TSIZ_XFERSIZE_MASK) >> _USB_DIEP_TSIZ_XFERSIZE_SHIFT;
+	} else {
+		USB_DOUTEPS[ep->num].INT = USB_DOEP_INT_XFERCOMPL;
+
+		if (!(USB_Endpoint_DoubleBank & ep->mask))
+			USB->DAINTMSK &= ~(ep->mask << _USB_DAINTMSK_OUTEPMSK0_SHIFT);
+
+		/* Transfer ends early on a short packet, leaving the unused length in XFERSIZE */
+		Remaining = (USB_DOUTEPS[ep->num].TSIZ & _USB_DOEP_TSIZ_XFERSIZE_MASK) >> _USB_DOEP_TSIZ_XFERSIZE_SHIFT;
+	}
+
+	ep->xferred        = ep->hwXferSize - Remaining;
+	ep->xferCompleteCb = NULL;
+	ep->state          = D_EP_IDLE;
+
+	Endpoint_QueueEvent(ep, USB_STATUS_OK, ep->xferred);
+
+	/* Callback is invoked last, so that it may immediately queue the next transfer */
+	if (Callback)
+		Callback(USB_STATUS_OK, ep->xferred, Remaining);
+}
+
+bool Endpoint_IsTransferBusy(const uint8_t Address)
+{
+	return (dev->ep[Address & ENDPOINT_EPNUM_MASK].state == D_EP_TRANSFERRING);
+}
+
+uint8_t Endpoint_WaitUntilTransferComplete(void)
+{
+	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
+	uint16_t TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+
+	uint16_t PreviousFrameNumber = USB_Device_GetFrameNumber();
+	uint32_t PreviousTransferSize = 0;
+
+	while (Endpoint_IsTransferBusy(ep_selected)) {
+		uint8_t USB_DeviceState_LCL = USB_DeviceState;
+		uint8_t ErrorCode = ENDPOINT_READYWAIT_NoError;
+
+		if (USB_DeviceState_LCL == DEVICE_STATE_Unattached)
+			ErrorCode = ENDPOINT_READYWAIT_DeviceDisconnected;
+		else if (USB_DeviceState_LCL == DEVICE_STATE_Suspended)
+			ErrorCode = ENDPOINT_READYWAIT_BusSuspended;
+		else if (Endpoint_IsStalled())
+			ErrorCode = ENDPOINT_READYWAIT_EndpointStalled;
+
+		uint16_t CurrentFrameNumber = USB_Device_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber) {
+			uint32_t CurrentTransferSize = (ep->in) ? USB_DINEPS[ep_selected].TSIZ : USB_DOUTEPS[ep_selected].TSIZ;
+
+			/* Timeout only applies while the host makes no progress through the transfer */
+			if (CurrentTransferSize != PreviousTransferSize)
+				TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+
+			PreviousFrameNumber  = CurrentFrameNumber;
+			PreviousTransferSize = CurrentTransferSize;
+
+			if (!(TimeoutMSRem--))
+				ErrorCode = ENDPOINT_READYWAIT_Timeout;
+		}
+
+		if (ErrorCode != ENDPOINT_READYWAIT_NoError) {
+			if (ep->in)
+				USBDHAL_AbortEpIn(ep);
+			else
+				USBDHAL_AbortEpOut(ep);
+
+			ep->xferCompleteCb = NULL;
+			ep->zlp            = false;
+			ep->state          = D_EP_IDLE;
+			return ErrorCode;
+		}
+
+		/* Completion arrives from the endpoint interrupt. Checking with interrupts masked means one
+		 * arriving just before the sleep still wakes the CPU, and SOF wakes it every frame regardless. */
+		INT_Disable();
+
+		if ((ep->state == D_EP_TRANSFERRING) && !(__get_IPSR()))
+			EMU_EnterEM1();
+
+		INT_Enable();
+	}
+
+	return ENDPOINT_READYWAIT_NoError;
+}
+
+void Endpoint_AbortTransfers(const USB_Status_TypeDef Status)
+{
+	uint8_t EPNum;
+	for (EPNum = 1; EPNum <= NUM_EP_USED; EPNum++) {
+		USBD_Ep_TypeDef *ep = &dev->ep[EPNum];
+		USB_XferCompleteCb_TypeDef Callback = ep->xferCompleteCb;
+
+		USB_Endpoint_BusyBanks[EPNum] = 0;
+
+		if (ep->state != D_EP_TRANSFERRING)
+			continue;
+
+		ep->xferCompleteCb = NULL;
+		ep->state          = D_EP_IDLE;
+
+		Endpoint_QueueEvent(ep, Status, ep->xferred);
+
+		if (Callback)
+			Callback(Status, ep->xferred, ep->hwXferSize - ep->xferred);
+	}
+}
+
+void Endpoint_QueueEvent(const USBD_Ep_TypeDef *const ep,
+                         const USB_Status_TypeDef Status,
+                         const uint16_t Length)
+{
+	uint8_t Head = USB_Endpoint_EventHead;
+
+	if ((uint8_t)(Head - USB_Endpoint_EventTail) >= USB_ENDPOINT_EVENT_QUEUE_SIZE)
+		return;
+
+	USB_Endpoint_Events[Head & (USB_ENDPOINT_EVENT_QUEUE_SIZE - 1)].Address = ep->addr;
+	USB_Endpoint_Events[Head & (USB_ENDPOINT_EVENT_QUEUE_SIZE - 1)].Status  = (int8_t)Status;
+	USB_Endpoint_Events[Head & (USB_ENDPOINT_EVENT_QUEUE_SIZE - 1)].Length  = Length;
+
+	USB_Endpoint_EventHead = (Head + 1);
+}
+
+bool Endpoint_GetEvent(USB_Endpoint_Event_t *const Event)
+{
+	uint8_t Tail = USB_Endpoint_EventTail;
+
+	if (Tail == USB_Endpoint_EventHead)
+		return false;
+
+	*Event = USB_Endpoint_Events[Tail & (USB_ENDPOINT_EVENT_QUEUE_SIZE - 1)];
+	USB_Endpoint_EventTail = (Tail + 1);
+
+	return true;
+}
+
+void Endpoint_WaitForEvent(USB_Endpoint_Event_t *const Event)
+{
+	for (;;) {
+		INT_Disable();
+
+		if (Endpoint_GetEvent(Event)) {
+			INT_Enable();
+			return;
+		}
+
+		/* WFI still wakes on an interrupt pending while masked, which then runs once re-enabled */
+		EMU_EnterEM1();
+		INT_Enable();
+	}
+}
 
 void Endpoint_ClearEndpoints(void)
 {
 	uint8_t EPNum;
-	for ( EPNum = 0; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++) {
+	for ( EPNum = 0; EPNum <= NUM_EP_USED; EPNum++) {
 		Endpoint_SelectEndpoint(EPNum);
 		Endpoint_DisableEndpoint();
 	}
@@ -155,6 +567,19 @@ uint8_t Endpoint_WaitUntilReady(void)
 			if (!(TimeoutMSRem--))
 				return ENDPOINT_READYWAIT_Timeout;
 		}
+
+		/* Double banked endpoints change state from the endpoint interrupt, so they can be waited on
+		 * in EM1; the check is repeated with interrupts masked so a bank completing just before the
+		 * sleep still wakes the CPU */
+		if ((USB_Endpoint_DoubleBank & (1 << ep_selected)) && !(__get_IPSR())) {
+			INT_Disable();
+
+			if ((Endpoint_GetEndpointDirection() == ENDPOINT_DIR_IN) ? !(Endpoint_IsINReady()) :
+			                                                           !(Endpoint_IsOUTReceived()))
+				EMU_EnterEM1();
+
+			INT_Enable();
+		}
 	}
 }
 
@@ -74,6 +74,7 @@
 
 /* Includes: */
 #include "../../../../Common/Common.h"
+#include "../StdRequestType.h"
 #include "../USBTask.h"
 #include "../USBInterrupt.h"
 
@@ -93,13 +94,36 @@ extern "C" {
 #define ENDPOINT_HSB_ADDRESS_SPACE_SIZE            (64 * 1024UL)
 #define INLINENON inline
 #define	ATTR_ALWAYS_INLINE2
+#define ENDPOINT_XFER_MAX_PACKETS                  (_USB_DIEP_TSIZ_PKTCNT_MASK >> _USB_DIEP_TSIZ_PKTCNT_SHIFT)
+
 /* Function Prototypes: */
 void Endpoint_ClearEndpoints(void);
+uint8_t Endpoint_QueueTransfer(const uint8_t Address,
+                               void *const Buffer,
+                               const uint16_t Length,
+                               const USB_XferCompleteCb_TypeDef Callback,
+                               const bool SendZLP);
+void Endpoint_CompleteTransfer(USBD_Ep_TypeDef *const ep);
+uint8_t Endpoint_WaitUntilTransferComplete(void);
+void Endpoint_AbortTransfers(const USB_Status_TypeDef Status);
+void Endpoint_ClearBankIN(void);
+void Endpoint_ClearBankOUT(void);
+void Endpoint_CompleteBank(USBD_Ep_TypeDef *const ep);
+void Endpoint_QueueEvent(const USBD_Ep_TypeDef *const ep,
+                         const USB_Status_TypeDef Status,
+                         const uint16_t Length);
 
 /* External Variables: */
 extern uint32_t ep_selected;
 extern uint8_t *USB_Endpoint_FIFOPos[];
+extern uint32_t USB_Endpoint_OUTReceived;
+extern uint32_t USB_Endpoint_AutoZLP;
+extern uint32_t USB_Endpoint_DoubleBank;
+extern volatile uint8_t  USB_Endpoint_BusyBanks[];
+extern volatile uint16_t USB_Endpoint_PendingLength[];
 extern USBD_Ep_TypeDef *ep;
+extern USBD_Device_TypeDef *dev;
+extern USB_Request_Header_t USB_ControlRequest;
 extern uint8_t receiveBuffer[];
 
 #endif
@@ -123,6 +147,20 @@ extern uint8_t receiveBuffer[];
 #define ENDPOINT_TOTAL_ENDPOINTS            1
 #endif
 
+#if !defined(USB_ENDPOINT_EVENT_QUEUE_SIZE) || defined(__DOXYGEN__)
+/** Number of entries in the endpoint event queue filled by the USB interrupt, see \ref Endpoint_GetEvent().
+ *  Must be a power of two. Events arriving while the queue is full are dropped.
+ *
+ *  This value may be overridden in the user project makefile as the value of the
+ *  \ref USB_ENDPOINT_EVENT_QUEUE_SIZE token, and passed to the compiler using the -D switch.
+ */
+#define USB_ENDPOINT_EVENT_QUEUE_SIZE       8
+#endif
+
+#if (USB_ENDPOINT_EVENT_QUEUE_SIZE & (USB_ENDPOINT_EVENT_QUEUE_SIZE - 1))
+#error USB_ENDPOINT_EVENT_QUEUE_SIZE must be a power of two.
+#endif
+
 /* Enums: */
 /** Enum for the possible error return codes of the \ref Endpoint_WaitUntilReady() function.
  *
@@ -146,6 +184,36 @@ enum Endpoint_WaitUntilReady_ErrorCodes_t {
 				                                                 */
 };
 
+/** Enum for the possible error return codes of the \ref Endpoint_StartTransfer() function.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ */
+enum Endpoint_Transfer_ErrorCodes_t {
+	ENDPOINT_XFER_NoError                      = 0, /**< Transfer was queued to the endpoint's DMA engine. */
+	ENDPOINT_XFER_InvalidEndpoint              = 1, /**< The given address is the control endpoint, or is not a
+				                                                 *   valid endpoint in the device.
+				                                                 */
+	ENDPOINT_XFER_UnalignedBuffer              = 2, /**< The given buffer is not aligned to a 32-bit word boundary. */
+	ENDPOINT_XFER_InvalidLength                = 3, /**< The given length needs more packets than the endpoint can
+				                                                 *   queue at once, or is not a whole number of packets for
+				                                                 *   an OUT endpoint.
+				                                                 */
+	ENDPOINT_XFER_EndpointBusy                 = 4, /**< A previous transfer on the endpoint has not yet completed. */
+};
+
+/* Type Defines: */
+/** Type define for an endpoint event, queued by the USB interrupt each time a transfer started with
+ *  \ref Endpoint_StartTransfer() completes or is aborted, and each time a bank of a double banked
+ *  endpoint is sent or received.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ */
+typedef struct {
+	uint8_t  Address; /**< Address of the endpoint the event occurred on, including the direction bit. */
+	int8_t   Status; /**< Outcome of the transfer, a \c USB_Status_TypeDef value; \c USB_STATUS_OK on success. */
+	uint16_t Length; /**< Number of bytes sent or received. */
+} USB_Endpoint_Event_t;
+
 /* Inline Functions: */
 /** Configures the specified endpoint address with the given endpoint type, bank size and number of hardware
  *  banks. Once configured, the endpoint may be read from or written to, depending on its direction.
@@ -160,7 +228,10 @@ enum Endpoint_WaitUntilReady_ErrorCodes_t {
  *                        the endpoint's data direction). The bank size must indicate the maximum packet size
  *                        that the endpoint can handle.
  *
- *  \param[in] Banks      Number of hardware banks to use for the endpoint being configured.
+ *  \param[in] Banks      Number of hardware banks to use for the endpoint being configured. Two banks may
+ *                        only be used on endpoints planned with two banks by \ref USB_Init(), see
+ *                        \ref USB_BULK_ENDPOINT_BANKS; the application can then fill or read one bank while
+ *                        the other is on the bus.
  *
  *  \attention When the \c ORDERED_EP_CONFIG compile time option is used, Endpoints <b>must</b> be configured in
  *             ascending order, or bank corruption will occur.
@@ -183,7 +254,8 @@ bool Endpoint_ConfigureEndpoint(const uint8_t Address,
                                 const uint16_t Size,
                                 const uint8_t Banks);
 
-/** Indicates the number of bytes currently stored in the current endpoint's selected bank.
+/** Indicates the number of bytes currently stored in the current endpoint's selected bank. For OUT
+ *  endpoints this is the number of received bytes which have not yet been read out of the bank.
  *
  *  \ingroup Group_EndpointRW_EFM32GG
  *
@@ -192,7 +264,10 @@ bool Endpoint_ConfigureEndpoint(const uint8_t Address,
 static INLINENON uint16_t Endpoint_BytesInEndpoint(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE2;
 static INLINENON uint16_t Endpoint_BytesInEndpoint(void)
 {
-	if (ep[ep_selected].remaining < ep[ep_selected].packetSize) {
+	if ((ep_selected != ENDPOINT_CONTROLEP) && !(ep[ep_selected].in)) {
+		return (uint16_t)(ep[ep_selected].remaining -
+		                  (USB_Endpoint_FIFOPos[ep_selected] - ep[ep_selected].buf));
+	} else if (ep[ep_selected].remaining < ep[ep_selected].packetSize) {
 		return (uint16_t)ep[ep_selected].remaining;
 	} else {
 		return (uint16_t)ep[ep_selected].packetSize;
@@ -307,7 +382,13 @@ static INLINENON bool Endpoint_IsEnabled(void)
 static INLINENON uint8_t Endpoint_GetBusyBanks(void) ATTR_ALWAYS_INLINE2 ATTR_WARN_UNUSED_RESULT;
 static INLINENON uint8_t Endpoint_GetBusyBanks(void)
 {
-	return (0);
+	if (USB_Endpoint_DoubleBank & (1 << ep_selected))
+		return USB_Endpoint_BusyBanks[ep_selected];
+
+	if (ep[ep_selected].in)
+		return (USB_DINEPS[ep_selected].CTL & USB_DIEP_CTL_EPENA) ? 1 : 0;
+	else
+		return (USB_Endpoint_OUTReceived & (1 << ep_selected)) ? 1 : 0;
 }
 
 /** Aborts all pending IN transactions on the currently selected endpoint, once the bank
@@ -371,9 +452,13 @@ static INLINENON bool Endpoint_HasEndpointInterrupted(const uint8_t Address)
 static INLINENON bool Endpoint_IsINReady(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE2;
 static INLINENON bool Endpoint_IsINReady(void)
 {
+	/* With two banks, one may be filled while the other is still being sent */
+	if (USB_Endpoint_DoubleBank & (1 << ep_selected))
+		return (USB_Endpoint_BusyBanks[ep_selected] < 2);
+
 	if ((USB_DINEPS[ep_selected].CTL & USB_DIEP_CTL_EPENA) == 0) {
 		if (USB_DINEPS[ep_selected].INT & USB_DIEP_INT_XFERCOMPL) {
-			USB_DINEPS[ep_selected].INT |= USB_DIEP_INT_XFERCOMPL;
+			USB_DINEPS[ep_selected].INT = USB_DIEP_INT_XFERCOMPL;
 		}
 		return true;
 	}
@@ -389,11 +474,22 @@ static INLINENON bool Endpoint_IsINReady(void)
 static INLINENON bool Endpoint_IsOUTReceived(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE2;
 static INLINENON bool Endpoint_IsOUTReceived(void)
 {
+	/* Double banked endpoints latch received packets from the XFERCOMPL interrupt */
+	if (USB_Endpoint_DoubleBank & (1 << ep_selected))
+		return (USB_Endpoint_BusyBanks[ep_selected] != 0);
+
 	if (USB_DOUTEPS[ep_selected].INT & USB_DOEP_INT_XFERCOMPL) {
-		USB_DOUTEPS[ep_selected].INT |= USB_DOEP_INT_XFERCOMPL;
+		USB_DOUTEPS[ep_selected].INT = USB_DOEP_INT_XFERCOMPL;
+
+		if (ep_selected != ENDPOINT_CONTROLEP) {
+			/* Latch the received length so the packet can be read out a block at a time */
+			ep[ep_selected].remaining = ep[ep_selected].hwXferSize -
+			                            (USB_DOUTEPS[ep_selected].TSIZ & _USB_DOEP_TSIZ_XFERSIZE_MASK);
+			USB_Endpoint_OUTReceived |= (1 << ep_selected);
+		}
 		return true;
 	}
-	return false;
+	return (USB_Endpoint_OUTReceived & (1 << ep_selected)) ? true : false;
 }
 
 /** Determines if the currently selected endpoint may be read from (if data is waiting in the endpoint
@@ -415,9 +511,10 @@ static INLINENON bool Endpoint_IsReadWriteAllowed(void)
 		status = true;
 	} else {
 		if (ep[ep_selected].in) {
-			status = Endpoint_IsINReady();
+			status = Endpoint_IsINReady() &&
+			         (Endpoint_BytesInEndpoint() < ep[ep_selected].packetSize);
 		} else {
-			status = Endpoint_IsOUTReceived();
+			status = Endpoint_IsOUTReceived() && Endpoint_BytesInEndpoint();
 		}
 	}
 	return status;
@@ -448,7 +545,9 @@ static INLINENON void Endpoint_ClearSETUP(void)
 	ep->remaining = 0;
 	USB_Endpoint_FIFOPos[ep_selected] = ep->buf;
 
-	USB_DOUTEPS[ENDPOINT_CONTROLEP].INT |= USB_DOEP_INT_SETUP;
+	/* A completion still pending from the previous request's status stage must not be taken for this
+	 * request's OUT data stage */
+	USB_DOUTEPS[ENDPOINT_CONTROLEP].INT = USB_DOEP_INT_SETUP | USB_DOEP_INT_XFERCOMPL;
 	USB->DOEP0TSIZ |= 3 << _USB_DOEP0TSIZ_SUPCNT_SHIFT;
 	USB->DOEP0DMAADDR = (uint32_t)ep->buf;
 	USB->DOEP0CTL = (USB->DOEP0CTL & ~DEPCTL_WO_BITMASK) |
@@ -465,6 +564,11 @@ static INLINENON void Endpoint_ClearIN(void)
 {
 	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
 
+	if (USB_Endpoint_DoubleBank & (1 << ep_selected)) {
+		Endpoint_ClearBankIN();
+		return;
+	}
+
 	USB_Endpoint_FIFOPos[ep_selected] = ep->buf;
 	USBDHAL_StartEpIn(ep);
 	if (ep_selected == ENDPOINT_CONTROLEP)
@@ -482,6 +586,12 @@ static INLINENON void Endpoint_ClearOUT(void)
 {
 	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
 
+	if (USB_Endpoint_DoubleBank & (1 << ep_selected)) {
+		Endpoint_ClearBankOUT();
+		return;
+	}
+
+	USB_Endpoint_OUTReceived &= ~(1 << ep_selected);
 	USB_Endpoint_FIFOPos[ep_selected] = ep->buf;
 	USBDHAL_StartEpOut(ep);
 	if (ep_selected == ENDPOINT_CONTROLEP)
@@ -503,7 +613,25 @@ static INLINENON void Endpoint_ClearOUT(void)
 static INLINENON void Endpoint_StallTransaction(void) ATTR_ALWAYS_INLINE2;
 static INLINENON void Endpoint_StallTransaction(void)
 {
-	USBDHAL_StallEp(&ep[ep_selected]);
+	USBD_Ep_TypeDef *ep = &dev->ep[ep_selected];
+
+	/* A control endpoint is halted in both directions, whichever stage the host runs next. The
+	 * direction of that next stage is halted last, as the host may send the following SETUP packet
+	 * (which clears the halt) as soon as it sees the STALL handshake */
+	if (ep_selected == ENDPOINT_CONTROLEP) {
+		bool in = ep->in;
+		bool OUTNext = !(USB_ControlRequest.bmRequestType & REQDIR_DEVICETOHOST) &&
+		               USB_ControlRequest.wLength;
+
+		ep->in = OUTNext;
+		USBDHAL_StallEp(ep);
+		ep->in = !(OUTNext);
+		USBDHAL_StallEp(ep);
+		ep->in = in;
+		return;
+	}
+
+	USBDHAL_StallEp(ep);
 }
 
 /** Clears the STALL condition on the currently selected endpoint.
@@ -513,7 +641,7 @@ static INLINENON void Endpoint_StallTransaction(void)
 static INLINENON void Endpoint_ClearStall(void) ATTR_ALWAYS_INLINE2;
 static INLINENON void Endpoint_ClearStall(void)
 {
-	USBDHAL_UnStallEp(&ep[ep_selected]);
+	USBDHAL_UnStallEp(&dev->ep[ep_selected]);
 }
 
 /** Determines if the currently selected endpoint is stalled, \c false otherwise.
@@ -525,7 +653,7 @@ static INLINENON void Endpoint_ClearStall(void)
 static INLINENON bool Endpoint_IsStalled(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE2;
 static INLINENON bool Endpoint_IsStalled(void)
 {
-	return USBDHAL_EpIsStalled(&ep[ep_selected]);
+	return USBDHAL_EpIsStalled(&dev->ep[ep_selected]);
 }
 
 /** Resets the data toggle of the currently selected endpoint. */
@@ -774,6 +902,47 @@ extern uint8_t USB_Device_ControlEndpointSize;
 #define USB_Device_ControlEndpointSize FIXED_CONTROL_ENDPOINT_SIZE
 #endif
 
+/** Enables the automatic termination of IN transfers started with \ref Endpoint_StartTransfer() on the
+ *  currently selected endpoint. When enabled, a transfer whose length is an exact multiple of the endpoint's
+ *  packet size is followed by a zero length packet, so that the host can detect the end of the transfer.
+ *  This is enabled by default for BULK type endpoints.
+ *
+ *  \note This should be disabled for protocols such as Mass Storage, where the host knows the exact length of
+ *        each transfer in advance and does not expect a terminating zero length packet.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ */
+static INLINENON void Endpoint_EnableAutoZLP(void) ATTR_ALWAYS_INLINE2;
+static INLINENON void Endpoint_EnableAutoZLP(void)
+{
+	USB_Endpoint_AutoZLP |= (1 << ep_selected);
+}
+
+/** Disables the automatic termination of IN transfers started with \ref Endpoint_StartTransfer() on the
+ *  currently selected endpoint. \see \ref Endpoint_EnableAutoZLP().
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ */
+static INLINENON void Endpoint_DisableAutoZLP(void) ATTR_ALWAYS_INLINE2;
+static INLINENON void Endpoint_DisableAutoZLP(void)
+{
+	USB_Endpoint_AutoZLP &= ~(1 << ep_selected);
+}
+
+/** Retrieves the number of bytes moved by the last completed \ref Endpoint_StartTransfer() transfer on the
+ *  currently selected endpoint. For OUT endpoints, this is the actual number of bytes received, which may be
+ *  less than the requested length if the host ended the transfer with a short packet.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ *
+ *  \return Number of bytes transferred.
+ */
+static INLINENON uint16_t Endpoint_GetTransferLength(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE2;
+static INLINENON uint16_t Endpoint_GetTransferLength(void)
+{
+	return (uint16_t)dev->ep[ep_selected].xferred;
+}
+
 /* Function Prototypes: */
 /** Configures a table of endpoint descriptions, in sequence. This function can be used to configure multiple
  *  endpoints at the same time.
@@ -797,8 +966,9 @@ bool Endpoint_ConfigureEndpointTable(const USB_Endpoint_Table_t *const Table,
  */
 void Endpoint_ClearStatusStage(void);
 
-/** Spin-loops until the currently selected non-control endpoint is ready for the next packet of data
- *  to be read or written to it.
+/** Waits until the currently selected non-control endpoint is ready for the next packet of data
+ *  to be read or written to it. Double banked endpoints are waited on in EM1, since their banks are
+ *  handed over from the USB interrupt; single banked endpoints are spin-loop polled.
  *
  *  \note This routine should not be called on CONTROL type endpoints.
  *
@@ -808,6 +978,75 @@ void Endpoint_ClearStatusStage(void);
  */
 uint8_t Endpoint_WaitUntilReady(void);
 
+/** Starts a zero-copy transfer of the given buffer on the given non-control endpoint. The endpoint's
+ *  DMA engine is pointed directly at the caller's buffer and the whole transfer is queued to the USB
+ *  core as a single multi-packet transfer, so that no data is staged through the endpoint bank and no
+ *  CPU copy takes place.
+ *
+ *  For IN endpoints, \c Length bytes are sent to the host as a series of full packets followed by a
+ *  final short packet if required, or a zero length packet if enabled via \ref Endpoint_EnableAutoZLP()
+ *  and the length is an exact multiple of the packet size. For OUT endpoints, \c Length must be a whole number of packets, and
+ *  the transfer finishes early if the host sends a short packet.
+ *
+ *  Once the transfer completes, the given callback (if not \c NULL) is invoked from the USB interrupt
+ *  with the number of bytes actually transferred. Alternatively, \ref Endpoint_IsTransferBusy() may be
+ *  polled. A USB bus reset aborts any transfer in progress, with a \c USB_STATUS_DEVICE_RESET status.
+ *
+ *  \note The buffer must be aligned to a 32-bit word boundary, and must remain valid and untouched until
+ *        the transfer has completed.
+ *        \n\n
+ *
+ *  \note The endpoint bank of the given endpoint must not be read from or written to while a transfer
+ *        is in progress.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ *
+ *  \param[in]     Address   Address of the endpoint to transfer on.
+ *  \param[in,out] Buffer    Word aligned buffer to send from or receive into.
+ *  \param[in]     Length    Number of bytes to send, or the size of the receive buffer.
+ *  \param[in]     Callback  Function to call once the transfer has completed, or \c NULL if not required.
+ *
+ *  \return A value from the \ref Endpoint_Transfer_ErrorCodes_t enum.
+ */
+uint8_t Endpoint_StartTransfer(const uint8_t Address,
+                               void *const Buffer,
+                               const uint16_t Length,
+                               const USB_XferCompleteCb_TypeDef Callback);
+
+/** Determines if a transfer started with \ref Endpoint_StartTransfer() on the given endpoint is still
+ *  in progress. Transfers are completed from the endpoint's XFERCOMPL interrupt, whether or not they
+ *  were started with a callback.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ *
+ *  \param[in] Address  Address of the endpoint to check.
+ *
+ *  \return Boolean \c true if the endpoint's DMA transfer has not yet completed, \c false otherwise.
+ */
+bool Endpoint_IsTransferBusy(const uint8_t Address) ATTR_WARN_UNUSED_RESULT;
+
+/** Removes the oldest event from the endpoint event queue, if any. The queue lets the main loop learn
+ *  which endpoints need servicing without polling each of them.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ *
+ *  \param[out] Event  Location to store the retrieved event.
+ *
+ *  \return Boolean \c true if an event was retrieved, \c false if the queue was empty.
+ */
+bool Endpoint_GetEvent(USB_Endpoint_Event_t *const Event);
+
+/** Sleeps in EM1 until the endpoint event queue holds at least one event, then removes and returns the
+ *  oldest one. Any other interrupt also wakes the CPU, but only an endpoint event ends the wait.
+ *
+ *  \note This routine must not be called from an interrupt, including from control request handlers.
+ *
+ *  \ingroup Group_EndpointRW_EFM32GG
+ *
+ *  \param[out] Event  Location to store the retrieved event.
+ */
+void Endpoint_WaitForEvent(USB_Endpoint_Event_t *const Event);
+
 /* Disable C linkage for C++ Compilers: */
 #if defined(__cplusplus)
 }
@@ -0,0 +1,299 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#include "../../../../Common/Common.h"
+#if (ARCH == ARCH_EFM32GG)
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../USBMode.h"
+
+#if defined(USB_CAN_BE_HOST)
+
+#include "PipeStream_EFM32GG.h"
+
+/* Block copy primitives used by the stream functions below, the pipe counterparts of the endpoint
+ * stream block copies. A packet is moved into or out of the pipe's RAM bank at once, so that the
+ * pipe readiness and the bank byte count need only be checked and updated once per packet. */
+
+static void Pipe_CopyBlock(uint8_t *Dest,
+                           const uint8_t *Source,
+                           uint16_t Length)
+{
+	if (!(((uintptr_t)Dest | (uintptr_t)Source) & 0x03)) {
+		uint32_t       *DestWord   = (uint32_t *)Dest;
+		const uint32_t *SourceWord = (const uint32_t *)Source;
+
+		while (Length >= 16) {
+			DestWord[0] = SourceWord[0];
+			DestWord[1] = SourceWord[1];
+			DestWord[2] = SourceWord[2];
+			DestWord[3] = SourceWord[3];
+
+			DestWord   += 4;
+			SourceWord += 4;
+			Length     -= 16;
+		}
+
+		while (Length >= 4) {
+			*(DestWord++) = *(SourceWord++);
+			Length -= 4;
+		}
+
+		Dest   = (uint8_t *)DestWord;
+		Source = (const uint8_t *)SourceWord;
+
+		while (Length--)
+			*(Dest++) = *(Source++);
+	} else {
+		memcpy(Dest, Source, Length);
+	}
+}
+
+static uint16_t Pipe_BytesFreeInBank(void)
+{
+	return (USB_Pipes[USB_Pipe_SelectedPipe].Size - Pipe_BytesInPipe());
+}
+
+static void Pipe_Write_Block_LE(const uint8_t *Buffer,
+                                const uint16_t Length)
+{
+	Pipe_CopyBlock(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos, Buffer, Length);
+
+	USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos += Length;
+}
+
+static void Pipe_Write_Block_BE(const uint8_t *Buffer,
+                                const uint16_t Length)
+{
+	uint8_t *FIFOPos   = USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos;
+	uint16_t BytesLeft = Length;
+
+	while (BytesLeft--)
+		*(FIFOPos++) = *(Buffer--);
+
+	USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos = FIFOPos;
+}
+
+static void Pipe_Read_Block_LE(uint8_t *Buffer,
+                               const uint16_t Length)
+{
+	Pipe_CopyBlock(Buffer, USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos, Length);
+
+	USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos += Length;
+}
+
+static void Pipe_Read_Block_BE(uint8_t *Buffer,
+                               const uint16_t Length)
+{
+	uint8_t *FIFOPos   = USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos;
+	uint16_t BytesLeft = Length;
+
+	while (BytesLeft--)
+		*(Buffer--) = *(FIFOPos++);
+
+	USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos = FIFOPos;
+}
+
+static uint8_t Pipe_Write_Packets_LE(const uint8_t *Buffer,
+                                     const uint16_t Length,
+                                     uint16_t *const BytesInPackets)
+{
+	uint16_t PacketSize = USB_Pipes[USB_Pipe_SelectedPipe].Size;
+	uint32_t Packets    = MIN((uint32_t)(Length - 1) / PacketSize, PIPE_XFER_MAX_PACKETS);
+	uint8_t  ErrorCode;
+
+	if (((uint32_t)Buffer & 0x03) || !(Packets))
+		return PIPE_RWSTREAM_NoError;
+
+	/* The packet just cleared from the bank has to go out first to keep the data in order */
+	if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+		return ErrorCode;
+
+	/* The final packet is always left for the bank, so that clearing the pipe afterwards behaves
+	 * exactly as for a byte-wise write */
+	if (Pipe_StartTransfer(USB_Pipe_SelectedPipe, (void *)Buffer, Packets * PacketSize, NULL) != PIPE_XFER_NoError)
+		return PIPE_RWSTREAM_NoError;
+
+	if ((ErrorCode = Pipe_WaitUntilTransferComplete()) != 0)
+		return ErrorCode;
+
+	*BytesInPackets = Pipe_GetTransferLength();
+	return PIPE_RWSTREAM_NoError;
+}
+
+static uint8_t Pipe_Read_Packets_LE(uint8_t *Buffer,
+                                    const uint16_t Length,
+                                    uint16_t *const BytesInPackets)
+{
+	uint16_t PacketSize = USB_Pipes[USB_Pipe_SelectedPipe].Size;
+	uint32_t Packets    = MIN((uint32_t)Length / PacketSize, PIPE_XFER_MAX_PACKETS);
+	uint8_t  ErrorCode;
+
+	/* Whole packets are received by DMA straight into the caller's memory; if the next packet is
+	 * already in the bank the transfer is refused, and the stream carries on through the bank */
+	if (((uint32_t)Buffer & 0x03) || !(Packets))
+		return PIPE_RWSTREAM_NoError;
+
+	if (Pipe_StartTransfer(USB_Pipe_SelectedPipe, Buffer, Packets * PacketSize, NULL) != PIPE_XFER_NoError)
+		return PIPE_RWSTREAM_NoError;
+
+	if ((ErrorCode = Pipe_WaitUntilTransferComplete()) != 0)
+		return ErrorCode;
+
+	*BytesInPackets = Pipe_GetTransferLength();
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t Pipe_Discard_Stream(uint16_t Length,
+                            uint16_t *const BytesProcessed)
+{
+	uint8_t  ErrorCode;
+	uint16_t BytesInTransfer = 0;
+
+	Pipe_SetPipeToken(PIPE_TOKEN_IN);
+
+	if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+		return ErrorCode;
+
+	if (BytesProcessed != NULL)
+		Length -= *BytesProcessed;
+
+	while (Length) {
+		if (!(Pipe_IsReadWriteAllowed())) {
+			Pipe_ClearIN();
+
+			if (BytesProcessed != NULL) {
+				*BytesProcessed += BytesInTransfer;
+				return PIPE_RWSTREAM_IncompleteTransfer;
+			}
+
+			if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+				return ErrorCode;
+		} else {
+			uint16_t BytesInPacket = MIN(Length, Pipe_BytesInPipe());
+
+			USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos += BytesInPacket;
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
+		}
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t Pipe_Null_Stream(uint16_t Length,
+                         uint16_t *const BytesProcessed)
+{
+	uint8_t  ErrorCode;
+	uint16_t BytesInTransfer = 0;
+
+	Pipe_SetPipeToken(PIPE_TOKEN_OUT);
+
+	if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+		return ErrorCode;
+
+	if (BytesProcessed != NULL)
+		Length -= *BytesProcessed;
+
+	while (Length) {
+		if (!(Pipe_IsReadWriteAllowed())) {
+			Pipe_ClearOUT();
+
+			if (BytesProcessed != NULL) {
+				*BytesProcessed += BytesInTransfer;
+				return PIPE_RWSTREAM_IncompleteTransfer;
+			}
+
+			USB_USBTask();
+
+			if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+				return ErrorCode;
+		} else {
+			uint16_t BytesInPacket = MIN(Length, Pipe_BytesFreeInBank());
+
+			memset(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos, 0x00, BytesInPacket);
+			USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos += BytesInPacket;
+
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
+		}
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+/* The following abuses the C preprocessor in order to copy-paste common code with slight alterations,
+ * so that the code needs to be written once. It is a crude form of templating to reduce code maintenance. */
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Write_Stream_LE
+#define  TEMPLATE_BUFFER_TYPE                      const void*
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_OUT
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearOUT()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
+#define  TEMPLATE_BANK_LENGTH()                    Pipe_BytesFreeInBank()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Pipe_Write_Block_LE(BufferPtr, Amount)
+#define  TEMPLATE_TRANSFER_PACKETS(BufferPtr, Length, Amount) Pipe_Write_Packets_LE(BufferPtr, Length, Amount)
+#include "Template/Template_Pipe_RW.c"
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Write_Stream_BE
+#define  TEMPLATE_BUFFER_TYPE                      const void*
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_OUT
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearOUT()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
+#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
+#define  TEMPLATE_BANK_LENGTH()                    Pipe_BytesFreeInBank()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Pipe_Write_Block_BE(BufferPtr, Amount)
+#include "Template/Template_Pipe_RW.c"
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Read_Stream_LE
+#define  TEMPLATE_BUFFER_TYPE                      void*
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_IN
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearIN()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            0
+#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
+#define  TEMPLATE_BANK_LENGTH()                    Pipe_BytesInPipe()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Pipe_Read_Block_LE(BufferPtr, Amount)
+#define  TEMPLATE_TRANSFER_PACKETS(BufferPtr, Length, Amount) Pipe_Read_Packets_LE(BufferPtr, Length, Amount)
+#include "Template/Template_Pipe_RW.c"
+
+#define  TEMPLATE_FUNC_NAME                        Pipe_Read_Stream_BE
+#define  TEMPLATE_BUFFER_TYPE                      void*
+#define  TEMPLATE_TOKEN                            PIPE_TOKEN_IN
+#define  TEMPLATE_CLEAR_PIPE()                     Pipe_ClearIN()
+#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
+#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
+#define  TEMPLATE_BANK_LENGTH()                    Pipe_BytesInPipe()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Amount) Pipe_Read_Block_BE(BufferPtr, Amount)
+#include "Template/Template_Pipe_RW.c"
+
+#endif
+
+#endif
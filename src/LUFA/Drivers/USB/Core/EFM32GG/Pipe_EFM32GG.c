@@ -0,0 +1,748 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#include "../../../../Common/Common.h"
+#if (ARCH == ARCH_EFM32GG)
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../USBMode.h"
+
+#if defined(USB_CAN_BE_HOST)
+
+#include "../Pipe.h"
+
+#include "em_emu.h"
+
+uint8_t USB_Host_ControlPipeSize = PIPE_CONTROLPIPE_DEFAULT_SIZE;
+
+uint32_t USB_Pipe_SelectedPipe = PIPE_CONTROLPIPE;
+uint8_t USB_Pipe_DeviceAddress;
+USB_Pipe_State_t USB_Pipes[PIPE_TOTAL_PIPES];
+
+/* Pool the pipe banks are allocated from by Pipe_ConfigurePipe(). Needs to be
+ * WORD aligned, as the host channels DMA straight into and out of it */
+STATIC_UBUF(USB_Pipe_RAM, USB_PIPE_RAM_SIZE);
+static uint16_t USB_Pipe_RAMUsed;
+
+static inline bool Pipe_IsPeriodic(const USB_Pipe_State_t *const Pipe)
+{
+	return ((Pipe->Type == EP_TYPE_INTERRUPT) || (Pipe->Type == EP_TYPE_ISOCHRONOUS));
+}
+
+static inline uint16_t Pipe_GetFrameNumber(void)
+{
+	return (USB->HFNUM & PIPE_FRAME_NUMBER_MASK);
+}
+
+/* Determines if the pipe has a packet or transfer waiting for its host channel */
+static bool Pipe_IsChannelNeeded(const USB_Pipe_State_t *const Pipe)
+{
+	if (!(Pipe->Flags & PIPE_FLAG_ENABLED) || (Pipe->Flags & (PIPE_FLAG_ACTIVE | PIPE_FLAG_HALTING | PIPE_FLAG_STALLED)) ||
+	    Pipe->ErrorFlags)
+		return false;
+
+	if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+		return true;
+
+	if (Pipe->Flags & PIPE_FLAG_FROZEN)
+		return false;
+
+	if (Pipe->Token == PIPE_TOKEN_IN)
+		return !(Pipe->Flags & PIPE_FLAG_IN_RECEIVED);
+	else
+		return ((Pipe->Flags & PIPE_FLAG_BANK_BUSY) ? true : false);
+}
+
+static void Pipe_StartChannel(const uint8_t PNum)
+{
+	USB_Pipe_State_t *Pipe    = &USB_Pipes[PNum];
+	USB_HC_TypeDef   *Channel = &USB->HC[PNum];
+	uint8_t  *Buffer = Pipe->Bank;
+	uint32_t Length;
+	uint32_t PacketCount;
+	uint32_t PID = (Pipe->Token == PIPE_TOKEN_SETUP) ? _USB_HC_TSIZ_PID_MDATA : Pipe->DataPID;
+	uint32_t Characteristics;
+
+	if (Pipe->Flags & PIPE_FLAG_TRANSFER) {
+		Buffer = Pipe->XferBuffer + Pipe->XferDone;
+		Length = Pipe->XferLength - Pipe->XferDone;
+	} else if (Pipe->Token == PIPE_TOKEN_IN) {
+		Length = Pipe->Size;
+	} else {
+		Length = Pipe->BankLength;
+	}
+
+	PacketCount = (Length + Pipe->Size - 1) / Pipe->Size;
+	if (!(PacketCount))
+		PacketCount = 1;
+
+	Characteristics = Pipe->Size |
+	                  ((uint32_t)(Pipe->EndpointAddress & PIPE_EPNUM_MASK) << _USB_HC_CHAR_EPNUM_SHIFT) |
+	                  ((uint32_t)Pipe->Type << _USB_HC_CHAR_EPTYPE_SHIFT) |
+	                  (1UL << _USB_HC_CHAR_MC_SHIFT) |
+	                  ((uint32_t)USB_Pipe_DeviceAddress << _USB_HC_CHAR_DEVADDR_SHIFT);
+
+	if (Pipe->Token == PIPE_TOKEN_IN)
+		Characteristics |= USB_HC_CHAR_EPDIR;
+
+	if (((USB->HPRT & _USB_HPRT_PRTSPD_MASK) >> _USB_HPRT_PRTSPD_SHIFT) == _USB_HPRT_PRTSPD_LS)
+		Characteristics |= USB_HC_CHAR_LSPDDEV;
+
+	/* Periodic transactions go out in the frame after the one currently on the bus */
+	if (Pipe_IsPeriodic(Pipe) && !(Pipe_GetFrameNumber() & 1))
+		Characteristics |= USB_HC_CHAR_ODDFRM;
+
+	Pipe->ChannelLength = Length;
+	Pipe->Flags        |= PIPE_FLAG_ACTIVE;
+
+	Channel->INT     = 0xFFFFFFFF;
+	Channel->TSIZ    = (Length << _USB_HC_TSIZ_XFERSIZE_SHIFT) |
+	                   (PacketCount << _USB_HC_TSIZ_PKTCNT_SHIFT) |
+	                   (PID << _USB_HC_TSIZ_PID_SHIFT);
+	Channel->DMAADDR = (uint32_t)Buffer;
+	Channel->CHAR    = Characteristics | USB_HC_CHAR_CHENA;
+}
+
+/* Hands the pipe to its host channel if it has work pending. Periodic pipes, and
+ * pipes retrying a failed transaction, are left to the SOF scheduler instead */
+static void Pipe_Kick(const uint8_t PNum)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[PNum];
+
+	if (!(Pipe_IsChannelNeeded(Pipe)))
+		return;
+
+	if (Pipe_IsPeriodic(Pipe) || Pipe->Retries)
+		Pipe->Flags |= PIPE_FLAG_SCHEDULED;
+	else
+		Pipe_StartChannel(PNum);
+}
+
+static void Pipe_CompleteTransfer(const uint8_t PNum,
+                                  const USB_Status_TypeDef Status)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[PNum];
+	USB_XferCompleteCb_TypeDef Callback = Pipe->XferCallback;
+
+	Pipe->Flags       &= ~PIPE_FLAG_TRANSFER;
+	Pipe->XferCallback = NULL;
+
+	/* Callback is invoked last, so that it may immediately start the next transfer */
+	if (Callback)
+		Callback(Status, Pipe->XferDone, Pipe->XferLength - Pipe->XferDone);
+}
+
+static void Pipe_ChannelHalted(const uint8_t PNum,
+                               const uint32_t Status)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[PNum];
+	uint32_t Size = USB->HC[PNum].TSIZ;
+	uint16_t Transferred;
+
+	if (!(Pipe->Flags & PIPE_FLAG_ACTIVE))
+		return;
+
+	Pipe->Flags &= ~PIPE_FLAG_ACTIVE;
+
+	/* IN progress is counted in received bytes, OUT progress only in acknowledged packets */
+	if (Pipe->Token == PIPE_TOKEN_IN) {
+		Transferred = Pipe->ChannelLength - ((Size & _USB_HC_TSIZ_XFERSIZE_MASK) >> _USB_HC_TSIZ_XFERSIZE_SHIFT);
+	} else if (Status & USB_HC_INT_XFERCOMPL) {
+		Transferred = Pipe->ChannelLength;
+	} else {
+		uint32_t PacketCount = (Pipe->ChannelLength + Pipe->Size - 1) / Pipe->Size;
+		uint32_t PacketsLeft = (Size & _USB_HC_TSIZ_PKTCNT_MASK) >> _USB_HC_TSIZ_PKTCNT_SHIFT;
+
+		Transferred = (PacketCount > PacketsLeft) ? MIN((PacketCount - PacketsLeft) * Pipe->Size, Pipe->ChannelLength) : 0;
+	}
+
+	if (Pipe->Token != PIPE_TOKEN_SETUP)
+		Pipe->DataPID = (Size & _USB_HC_TSIZ_PID_MASK) >> _USB_HC_TSIZ_PID_SHIFT;
+
+	if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+		Pipe->XferDone += Transferred;
+
+	if (Status & USB_HC_INT_XFERCOMPL) {
+		Pipe->Retries = 0;
+
+		if (Pipe->Flags & PIPE_FLAG_TRANSFER) {
+			Pipe_CompleteTransfer(PNum, USB_STATUS_OK);
+		} else if (Pipe->Token == PIPE_TOKEN_SETUP) {
+			Pipe->Flags   = (Pipe->Flags & ~PIPE_FLAG_BANK_BUSY) | PIPE_FLAG_SETUP_SENT;
+			Pipe->DataPID = _USB_HC_TSIZ_PID_DATA1;
+		} else if (Pipe->Token == PIPE_TOKEN_IN) {
+			Pipe->BankLength = Transferred;
+			Pipe->FIFOPos    = Pipe->Bank;
+			Pipe->Flags     |= PIPE_FLAG_IN_RECEIVED;
+		} else {
+			Pipe->Flags     &= ~PIPE_FLAG_BANK_BUSY;
+		}
+	} else if (Status & USB_HC_INT_STALL) {
+		Pipe->Flags   = (Pipe->Flags & ~PIPE_FLAG_BANK_BUSY) | PIPE_FLAG_STALLED;
+		Pipe->DataPID = _USB_HC_TSIZ_PID_DATA0;
+
+		if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+			Pipe_CompleteTransfer(PNum, USB_STATUS_EP_STALLED);
+	} else if (Status & (USB_HC_INT_XACTERR | USB_HC_INT_FRMOVRUN)) {
+		/* Failed transactions are retried from the next frames' SOF, like a NAK from the device */
+		if (++Pipe->Retries < PIPE_TRANSACTION_RETRIES) {
+			Pipe->NextFrame = (Pipe_GetFrameNumber() + 1) & PIPE_FRAME_NUMBER_MASK;
+		} else {
+			Pipe->ErrorFlags |= PIPE_ERRORFLAG_TIMEOUT;
+
+			if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+				Pipe_CompleteTransfer(PNum, USB_STATUS_TIMEOUT);
+		}
+	} else if (Status & (USB_HC_INT_BBLERR | USB_HC_INT_DATATGLERR | USB_HC_INT_AHBERR)) {
+		if (Status & USB_HC_INT_BBLERR)
+			Pipe->ErrorFlags |= PIPE_ERRORFLAG_OVERFLOW;
+		if (Status & USB_HC_INT_DATATGLERR)
+			Pipe->ErrorFlags |= PIPE_ERRORFLAG_DATATGL;
+		if (Status & USB_HC_INT_AHBERR)
+			Pipe->ErrorFlags |= PIPE_ERRORFLAG_DMA;
+
+		if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+			Pipe_CompleteTransfer(PNum, USB_STATUS_EP_ERROR);
+	} else if (Status & USB_HC_INT_NAK) {
+		Pipe->Flags |= PIPE_FLAG_NAK_RECEIVED;
+	}
+
+	Pipe_Kick(PNum);
+}
+
+/* Halts the pipe's host channel and waits for the halt to take effect, as the core
+ * may still be finishing the transaction currently on the bus. Returns false if the
+ * channel had to be forced off instead, leaving the pipe with a timeout error */
+static bool Pipe_HaltChannel(const uint8_t PNum)
+{
+	USB_Pipe_State_t *Pipe    = &USB_Pipes[PNum];
+	USB_HC_TypeDef   *Channel = &USB->HC[PNum];
+	uint8_t  FramesRem = PIPE_HALT_TIMEOUT_FRAMES;
+	uint16_t PreviousFrameNumber = Pipe_GetFrameNumber();
+	uint32_t Status;
+
+	if (!(Pipe->Flags & PIPE_FLAG_ACTIVE))
+		return true;
+
+	/* The channel may already have halted by itself, with its interrupt still pending */
+	if (Channel->CHAR & USB_HC_CHAR_CHENA)
+		Channel->CHAR |= (USB_HC_CHAR_CHDIS | USB_HC_CHAR_CHENA);
+
+	/* A halt takes effect within the frame, unless the port has gone or the core is stuck */
+	while (!(Channel->INT & USB_HC_INT_CHHLTD)) {
+		uint16_t CurrentFrameNumber = Pipe_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber) {
+			PreviousFrameNumber = CurrentFrameNumber;
+
+			if (!(FramesRem--))
+				break;
+		}
+
+		if (!(USB->HPRT & USB_HPRT_PRTENA))
+			break;
+	}
+
+	Status       = Channel->INT;
+	Channel->INT = Status;
+
+	if (!(Status & USB_HC_INT_CHHLTD)) {
+		/* Take the pipe off the channel regardless, a late halt is then ignored */
+		Pipe->Flags      &= ~(PIPE_FLAG_ACTIVE | PIPE_FLAG_SCHEDULED);
+		Pipe->ErrorFlags |= PIPE_ERRORFLAG_TIMEOUT;
+
+		if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+			Pipe_CompleteTransfer(PNum, USB_STATUS_TIMEOUT);
+
+		return false;
+	}
+
+	/* The halted pipe must not be handed straight back to its channel */
+	Pipe->Flags |= PIPE_FLAG_HALTING;
+	Pipe_ChannelHalted(PNum, Status);
+	Pipe->Flags &= ~PIPE_FLAG_HALTING;
+
+	return true;
+}
+
+bool Pipe_ConfigurePipeTable(const USB_Pipe_Table_t* const Table,
+                             const uint8_t Entries)
+{
+	int i;
+	for (i = 0; i < Entries; i++) {
+		if (!(Table[i].Address))
+			continue;
+
+		if (!(Pipe_ConfigurePipe(Table[i].Address, Table[i].Type, Table[i].EndpointAddress, Table[i].Size, Table[i].Banks)))
+			return false;
+	}
+
+	return true;
+}
+
+bool Pipe_ConfigurePipe(const uint8_t Address,
+                        const uint8_t Type,
+                        const uint8_t EndpointAddress,
+                        const uint16_t Size,
+                        const uint8_t Banks)
+{
+	uint8_t Number = (Address & PIPE_EPNUM_MASK);
+	USB_Pipe_State_t *Pipe = &USB_Pipes[Number];
+	uint16_t BankSize = ((Size + 3) & ~3);
+
+	(void)Banks;
+
+	if (Number >= PIPE_TOTAL_PIPES)
+		return false;
+
+	Pipe_SelectPipe(Number);
+
+	if (!(Size) || (Size > ((Type == EP_TYPE_ISOCHRONOUS) ? PIPE_MAX_SIZE : 64)))
+		return false;
+
+	INT_Disable();
+
+	if (!(Pipe_HaltChannel(Number))) {
+		INT_Enable();
+		return false;
+	}
+
+	/* A reconfigured pipe keeps its bank if the new size still fits into it */
+	if (!(Pipe->Bank) || (Pipe->BankSize < BankSize)) {
+		if ((USB_Pipe_RAMUsed + BankSize) > USB_PIPE_RAM_SIZE) {
+			Pipe->Flags = 0;
+			INT_Enable();
+			return false;
+		}
+
+		Pipe->Bank       = &USB_Pipe_RAM[USB_Pipe_RAMUsed];
+		Pipe->BankSize   = BankSize;
+		USB_Pipe_RAMUsed += BankSize;
+	}
+
+	Pipe->FIFOPos         = Pipe->Bank;
+	Pipe->BankLength      = 0;
+	Pipe->Size            = Size;
+	Pipe->Type            = Type;
+	Pipe->EndpointAddress = EndpointAddress;
+	Pipe->Interval        = 1;
+	Pipe->NextFrame       = Pipe_GetFrameNumber();
+	Pipe->DataPID         = _USB_HC_TSIZ_PID_DATA0;
+	Pipe->Retries         = 0;
+	Pipe->ErrorFlags      = 0;
+	Pipe->XferCallback    = NULL;
+	Pipe->Flags           = (PIPE_FLAG_CONFIGURED | PIPE_FLAG_ENABLED | PIPE_FLAG_FROZEN);
+
+	if (Type == EP_TYPE_CONTROL)
+		Pipe->Token = PIPE_TOKEN_SETUP;
+	else
+		Pipe->Token = (Address & PIPE_DIR_IN) ? PIPE_TOKEN_IN : PIPE_TOKEN_OUT;
+
+	USB->HC[Number].INT    = 0xFFFFFFFF;
+	USB->HC[Number].INTMSK = USB_HC_INTMSK_CHHLTDMSK;
+	USB->HAINTMSK         |= (1 << Number);
+	INT_Enable();
+
+	return true;
+}
+
+void Pipe_ClearPipes(void)
+{
+	uint8_t PNum;
+
+	INT_Disable();
+
+	/* Channels are stopped without waiting, as the device may already be gone */
+	for (PNum = 0; PNum < PIPE_TOTAL_PIPES; PNum++) {
+		USB_Pipe_State_t *Pipe = &USB_Pipes[PNum];
+
+		if (USB->HC[PNum].CHAR & USB_HC_CHAR_CHENA)
+			USB->HC[PNum].CHAR |= (USB_HC_CHAR_CHDIS | USB_HC_CHAR_CHENA);
+
+		USB->HC[PNum].INTMSK = 0;
+		USB->HC[PNum].INT    = 0xFFFFFFFF;
+
+		if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+			Pipe_CompleteTransfer(PNum, USB_STATUS_DEVICE_REMOVED);
+
+		memset(Pipe, 0, sizeof(USB_Pipe_State_t));
+	}
+
+	USB->HAINTMSK          = 0;
+	USB_Pipe_RAMUsed       = 0;
+	USB_Pipe_DeviceAddress = 0;
+	USB_Pipe_SelectedPipe  = PIPE_CONTROLPIPE;
+
+	INT_Enable();
+}
+
+void Pipe_ResetPipe(const uint8_t Address)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[Address & PIPE_EPNUM_MASK];
+
+	INT_Disable();
+	Pipe_HaltChannel(Address & PIPE_EPNUM_MASK);
+
+	Pipe->Flags     &= ~(PIPE_FLAG_SCHEDULED | PIPE_FLAG_BANK_BUSY | PIPE_FLAG_IN_RECEIVED |
+	                     PIPE_FLAG_SETUP_SENT | PIPE_FLAG_NAK_RECEIVED);
+	Pipe->FIFOPos    = Pipe->Bank;
+	Pipe->BankLength = 0;
+	Pipe->DataPID    = _USB_HC_TSIZ_PID_DATA0;
+	Pipe->Retries    = 0;
+	INT_Enable();
+}
+
+void Pipe_DisablePipe(void)
+{
+	INT_Disable();
+	Pipe_HaltChannel(USB_Pipe_SelectedPipe);
+	USB_Pipes[USB_Pipe_SelectedPipe].Flags &= ~(PIPE_FLAG_ENABLED | PIPE_FLAG_SCHEDULED);
+	INT_Enable();
+}
+
+void Pipe_SetPipeToken(const uint8_t Token)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	/* Data already in the bank is kept while the direction does not change */
+	if (Pipe->Token == Token)
+		return;
+
+	INT_Disable();
+
+	/* Each stage of a control transfer starts on DATA1 */
+	if (Pipe->Type == EP_TYPE_CONTROL)
+		Pipe->DataPID = _USB_HC_TSIZ_PID_DATA1;
+
+	Pipe->Token      = Token;
+	Pipe->FIFOPos    = Pipe->Bank;
+	Pipe->BankLength = 0;
+	Pipe->Flags     &= ~(PIPE_FLAG_BANK_BUSY | PIPE_FLAG_IN_RECEIVED);
+	INT_Enable();
+}
+
+void Pipe_Unfreeze(void)
+{
+	INT_Disable();
+	USB_Pipes[USB_Pipe_SelectedPipe].Flags &= ~PIPE_FLAG_FROZEN;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+void Pipe_Freeze(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	INT_Disable();
+	Pipe->Flags = (Pipe->Flags & ~PIPE_FLAG_SCHEDULED) | PIPE_FLAG_FROZEN;
+
+	/* A multi-packet transfer runs to completion regardless of the pipe's frozen state */
+	if (!(Pipe->Flags & PIPE_FLAG_TRANSFER))
+		Pipe_HaltChannel(USB_Pipe_SelectedPipe);
+
+	INT_Enable();
+}
+
+void Pipe_ClearError(void)
+{
+	INT_Disable();
+	USB_Pipes[USB_Pipe_SelectedPipe].ErrorFlags = 0;
+	USB_Pipes[USB_Pipe_SelectedPipe].Retries    = 0;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+void Pipe_ClearSETUP(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	INT_Disable();
+	Pipe->BankLength = (Pipe->FIFOPos - Pipe->Bank);
+	Pipe->FIFOPos    = Pipe->Bank;
+	Pipe->Flags      = (Pipe->Flags & ~PIPE_FLAG_SETUP_SENT) | PIPE_FLAG_BANK_BUSY;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+void Pipe_ClearIN(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	INT_Disable();
+	Pipe->BankLength = 0;
+	Pipe->FIFOPos    = Pipe->Bank;
+	Pipe->Flags     &= ~PIPE_FLAG_IN_RECEIVED;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+void Pipe_ClearOUT(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	INT_Disable();
+	Pipe->BankLength = (Pipe->FIFOPos - Pipe->Bank);
+	Pipe->FIFOPos    = Pipe->Bank;
+	Pipe->Flags     |= PIPE_FLAG_BANK_BUSY;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+void Pipe_ClearStall(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	INT_Disable();
+	Pipe->Flags  &= ~PIPE_FLAG_STALLED;
+	Pipe->FIFOPos = Pipe->Bank;
+	Pipe->DataPID = _USB_HC_TSIZ_PID_DATA0;
+	Pipe->Retries = 0;
+	Pipe_Kick(USB_Pipe_SelectedPipe);
+	INT_Enable();
+}
+
+bool Pipe_IsEndpointBound(const uint8_t EndpointAddress)
+{
+	uint8_t PrevPipeNumber = Pipe_GetCurrentPipe();
+	uint8_t PNum;
+
+	for (PNum = 0; PNum < PIPE_TOTAL_PIPES; PNum++) {
+		Pipe_SelectPipe(PNum);
+
+		if (!(Pipe_IsConfigured()))
+			continue;
+
+		if (Pipe_GetBoundEndpointAddress() == EndpointAddress)
+			return true;
+	}
+
+	Pipe_SelectPipe(PrevPipeNumber);
+	return false;
+}
+
+uint8_t Pipe_WaitUntilReady(void)
+{
+	uint16_t TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+
+	uint16_t PreviousFrameNumber = Pipe_GetFrameNumber();
+
+	for (;;) {
+		if (Pipe_GetPipeToken() == PIPE_TOKEN_IN) {
+			if (Pipe_IsINReceived())
+				return PIPE_READYWAIT_NoError;
+		} else {
+			if (Pipe_IsOUTReady())
+				return PIPE_READYWAIT_NoError;
+		}
+
+		if (Pipe_IsStalled())
+			return PIPE_READYWAIT_PipeStalled;
+		else if (USB_HostState == HOST_STATE_Unattached)
+			return PIPE_READYWAIT_DeviceDisconnected;
+
+		uint16_t CurrentFrameNumber = Pipe_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber) {
+			PreviousFrameNumber = CurrentFrameNumber;
+
+			if (!(TimeoutMSRem--))
+				return PIPE_READYWAIT_Timeout;
+		}
+
+		/* The channel completes from the USB interrupt, and SOF wakes the CPU every frame */
+		INT_Disable();
+
+		if ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & (PIPE_FLAG_ACTIVE | PIPE_FLAG_SCHEDULED)) && !(__get_IPSR()))
+			EMU_EnterEM1();
+
+		INT_Enable();
+	}
+}
+
+uint8_t Pipe_StartTransfer(const uint8_t Address,
+                           void *const Buffer,
+                           const uint16_t Length,
+                           const USB_XferCompleteCb_TypeDef Callback)
+{
+	uint8_t Number = (Address & PIPE_EPNUM_MASK);
+	USB_Pipe_State_t *Pipe = &USB_Pipes[Number];
+
+	if ((Number >= PIPE_TOTAL_PIPES) || !(Pipe->Flags & PIPE_FLAG_CONFIGURED) || (Pipe->Type != EP_TYPE_BULK))
+		return PIPE_XFER_InvalidPipe;
+
+	if ((uint32_t)Buffer & 3)
+		return PIPE_XFER_UnalignedBuffer;
+
+	if ((((uint32_t)Length + Pipe->Size - 1) / Pipe->Size) > PIPE_XFER_MAX_PACKETS)
+		return PIPE_XFER_InvalidLength;
+
+	/* Only whole packets can be requested, or a long packet would overrun the buffer */
+	if ((Pipe->Token == PIPE_TOKEN_IN) && (!(Length) || (Length % Pipe->Size)))
+		return PIPE_XFER_InvalidLength;
+
+	INT_Disable();
+
+	/* A single packet request already on the bus for the bank is withdrawn first */
+	if (!(Pipe->Flags & PIPE_FLAG_TRANSFER) && !(Pipe_HaltChannel(Number))) {
+		INT_Enable();
+		return PIPE_XFER_ChannelStuck;
+	}
+
+	if (Pipe->Flags & (PIPE_FLAG_TRANSFER | PIPE_FLAG_BANK_BUSY | PIPE_FLAG_IN_RECEIVED)) {
+		Pipe_Kick(Number);
+		INT_Enable();
+		return PIPE_XFER_PipeBusy;
+	}
+
+	Pipe->Flags       &= ~PIPE_FLAG_SCHEDULED;
+	Pipe->XferBuffer   = (uint8_t*)Buffer;
+	Pipe->XferLength   = Length;
+	Pipe->XferDone     = 0;
+	Pipe->XferCallback = Callback;
+	Pipe->Flags       |= PIPE_FLAG_TRANSFER;
+	Pipe_Kick(Number);
+	INT_Enable();
+
+	return PIPE_XFER_NoError;
+}
+
+bool Pipe_IsTransferBusy(const uint8_t Address)
+{
+	return ((USB_Pipes[Address & PIPE_EPNUM_MASK].Flags & PIPE_FLAG_TRANSFER) ? true : false);
+}
+
+uint8_t Pipe_WaitUntilTransferComplete(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+	uint16_t TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+
+	uint16_t PreviousFrameNumber = Pipe_GetFrameNumber();
+	uint32_t PreviousTransferSize = 0;
+
+	while (Pipe->Flags & PIPE_FLAG_TRANSFER) {
+		uint8_t ErrorCode = PIPE_READYWAIT_NoError;
+
+		if (USB_HostState == HOST_STATE_Unattached)
+			return PIPE_READYWAIT_DeviceDisconnected;
+
+		uint16_t CurrentFrameNumber = Pipe_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber) {
+			uint32_t CurrentTransferSize = USB->HC[USB_Pipe_SelectedPipe].TSIZ;
+
+			/* Timeout only applies while the device makes no progress through the transfer */
+			if (CurrentTransferSize != PreviousTransferSize)
+				TimeoutMSRem = USB_STREAM_TIMEOUT_MS;
+
+			PreviousFrameNumber  = CurrentFrameNumber;
+			PreviousTransferSize = CurrentTransferSize;
+
+			if (!(TimeoutMSRem--))
+				ErrorCode = PIPE_READYWAIT_Timeout;
+		}
+
+		if (ErrorCode != PIPE_READYWAIT_NoError) {
+			INT_Disable();
+			Pipe->Flags |= PIPE_FLAG_FROZEN;
+			Pipe->Flags &= ~PIPE_FLAG_SCHEDULED;
+			Pipe_HaltChannel(USB_Pipe_SelectedPipe);
+
+			if (Pipe->Flags & PIPE_FLAG_TRANSFER)
+				Pipe_CompleteTransfer(USB_Pipe_SelectedPipe, USB_STATUS_TIMEOUT);
+
+			INT_Enable();
+			return ErrorCode;
+		}
+
+		INT_Disable();
+
+		if ((Pipe->Flags & PIPE_FLAG_TRANSFER) && !(__get_IPSR()))
+			EMU_EnterEM1();
+
+		INT_Enable();
+	}
+
+	if (Pipe->Flags & PIPE_FLAG_STALLED)
+		return PIPE_READYWAIT_PipeStalled;
+	else if (Pipe->ErrorFlags)
+		return PIPE_READYWAIT_Timeout;
+
+	return PIPE_READYWAIT_NoError;
+}
+
+void Pipe_HandleChannelInterrupts(void)
+{
+	uint32_t Channels = USB->HAINT & USB->HAINTMSK;
+	uint8_t  PNum;
+
+	for (PNum = 0; Channels; PNum++, Channels >>= 1) {
+		uint32_t Status;
+
+		if (!(Channels & 1))
+			continue;
+
+		Status = USB->HC[PNum].INT;
+		USB->HC[PNum].INT = Status;
+
+		if (Status & USB_HC_INT_CHHLTD)
+			Pipe_ChannelHalted(PNum, Status);
+	}
+}
+
+void Pipe_ScheduleChannels(void)
+{
+	uint16_t Frame = Pipe_GetFrameNumber();
+	uint8_t  PNum;
+
+	for (PNum = 0; PNum < PIPE_TOTAL_PIPES; PNum++) {
+		USB_Pipe_State_t *Pipe = &USB_Pipes[PNum];
+
+		if (!(Pipe->Flags & PIPE_FLAG_SCHEDULED))
+			continue;
+
+		/* Frame numbers wrap, so a pipe is due when it is less than half the frame range behind */
+		if (((Frame - Pipe->NextFrame) & PIPE_FRAME_NUMBER_MASK) > (PIPE_FRAME_NUMBER_MASK >> 1))
+			continue;
+
+		Pipe->Flags &= ~PIPE_FLAG_SCHEDULED;
+
+		if (!(Pipe_IsChannelNeeded(Pipe)))
+			continue;
+
+		if (Pipe_IsPeriodic(Pipe))
+			Pipe->NextFrame = (Frame + Pipe->Interval) & PIPE_FRAME_NUMBER_MASK;
+
+		Pipe_StartChannel(PNum);
+	}
+}
+
+#endif
+
+#endif
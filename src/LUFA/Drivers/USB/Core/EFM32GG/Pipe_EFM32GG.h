@@ -0,0 +1,933 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief USB Pipe definitions for the EFM32 Giant Gecko microcontrollers.
+ *  \copydetails Group_PipeManagement_EFM32GG
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the USB driver
+ *        dispatch header located in LUFA/Drivers/USB/USB.h.
+ */
+
+/** \ingroup Group_PipeRW
+ *  \defgroup Group_PipeRW_EFM32GG Pipe Data Reading and Writing (EFM32GG)
+ *  \brief Pipe data read/write definitions for the Silabs EFM32 Giant Gecko architecture.
+ *
+ *  Functions, macros, variables, enums and types related to data reading and writing from and to pipes.
+ */
+
+/** \ingroup Group_PipePrimitiveRW
+ *  \defgroup Group_PipePrimitiveRW_EFM32GG Read/Write of Primitive Data Types (EFM32GG)
+ *  \brief Pipe primitive data read/write definitions for the Silabs EFM32 Giant Gecko architecture.
+ *
+ *  Functions, macros, variables, enums and types related to data reading and writing of primitive data types
+ *  from and to pipes.
+ */
+
+/** \ingroup Group_PipePacketManagement
+ *  \defgroup Group_PipePacketManagement_EFM32GG Pipe Packet Management (EFM32GG)
+ *  \brief Pipe packet management definitions for the Silabs EFM32 Giant Gecko architecture.
+ *
+ *  Functions, macros, variables, enums and types related to packet management of pipes.
+ */
+
+/** \ingroup Group_PipeControlReq
+ *  \defgroup Group_PipeControlReq_EFM32GG Pipe Control Request Management (EFM32GG)
+ *  \brief Pipe control request management definitions for the Silabs EFM32 Giant Gecko architecture.
+ *
+ *  Module for host mode request processing. This module allows for the transmission of standard, class and
+ *  vendor control requests to the default control endpoint of an attached device while in host mode.
+ *
+ *  \see Chapter 9 of the USB 2.0 specification.
+ */
+
+/** \ingroup Group_PipeManagement
+ *  \defgroup Group_PipeManagement_EFM32GG Pipe Management (EFM32GG)
+ *  \brief Pipe management definitions for the Silabs EFM32 Giant Gecko architecture.
+ *
+ *  This module contains functions, macros and enums related to pipe management when in USB Host mode. This
+ *  module contains the pipe management macros, as well as pipe interrupt and data send/receive functions
+ *  for various data types.
+ *
+ *  Each pipe is mapped onto the USB core host channel of the same index. Pipe banks are kept in RAM
+ *  and moved to and from the bus by the core's DMA engine, so that a whole packet, or a whole
+ *  multi-packet transfer, is handed to the hardware at once.
+ *
+ *  @{
+ */
+
+#ifndef __PIPE_EFM32GG_H__
+#define __PIPE_EFM32GG_H__
+
+/* Includes: */
+#include "../../../../Common/Common.h"
+#include "../USBTask.h"
+
+/* Enable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Preprocessor Checks: */
+#if !defined(__INCLUDE_FROM_USB_DRIVER)
+#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
+#endif
+
+/* Private Interface - For use in library only: */
+#if !defined(__DOXYGEN__)
+/* Macros: */
+#define PIPE_FLAG_CONFIGURED            (1 << 0)
+#define PIPE_FLAG_ENABLED               (1 << 1)
+#define PIPE_FLAG_FROZEN                (1 << 2)
+#define PIPE_FLAG_ACTIVE                (1 << 3)
+#define PIPE_FLAG_SCHEDULED             (1 << 4)
+#define PIPE_FLAG_BANK_BUSY             (1 << 5)
+#define PIPE_FLAG_IN_RECEIVED           (1 << 6)
+#define PIPE_FLAG_SETUP_SENT            (1 << 7)
+#define PIPE_FLAG_STALLED               (1 << 8)
+#define PIPE_FLAG_NAK_RECEIVED          (1 << 9)
+#define PIPE_FLAG_TRANSFER              (1 << 10)
+#define PIPE_FLAG_HALTING               (1 << 11)
+
+#define PIPE_FRAME_NUMBER_MASK          0x3FFF
+#define PIPE_TRANSACTION_RETRIES        3
+#define PIPE_HALT_TIMEOUT_FRAMES        3
+#define PIPE_XFER_MAX_PACKETS           (_USB_HC_TSIZ_PKTCNT_MASK >> _USB_HC_TSIZ_PKTCNT_SHIFT)
+
+/* Type Defines: */
+typedef struct {
+	uint8_t* Bank;
+	uint8_t* FIFOPos;
+	uint8_t* XferBuffer;
+	USB_XferCompleteCb_TypeDef XferCallback;
+	uint16_t XferLength;
+	volatile uint16_t XferDone;
+	uint16_t ChannelLength;
+	uint16_t Size;
+	uint16_t BankSize;
+	volatile uint16_t BankLength;
+	volatile uint16_t Flags;
+	uint16_t NextFrame;
+	uint8_t  EndpointAddress;
+	uint8_t  Type;
+	uint8_t  Token;
+	uint8_t  Interval;
+	uint8_t  DataPID;
+	uint8_t  Retries;
+	volatile uint8_t ErrorFlags;
+} USB_Pipe_State_t;
+#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+/** \name Pipe Error Flag Masks */
+//@{
+/** Mask for \ref Pipe_GetErrorFlags(), indicating that an overflow error occurred in the pipe on the received data. */
+#define PIPE_ERRORFLAG_OVERFLOW         (1 << 0)
+
+/** Mask for \ref Pipe_GetErrorFlags(), indicating that the device failed to respond, or that a CRC, bit stuffing or
+ *  PID error occurred, on several consecutive attempts of the same transaction.
+ */
+#define PIPE_ERRORFLAG_TIMEOUT          (1 << 1)
+
+/** Mask for \ref Pipe_GetErrorFlags(), indicating that a hardware data toggle error occurred in the pipe. */
+#define PIPE_ERRORFLAG_DATATGL          (1 << 2)
+
+/** Mask for \ref Pipe_GetErrorFlags(), indicating that the host channel's DMA engine could not access the pipe bank
+ *  or transfer buffer.
+ */
+#define PIPE_ERRORFLAG_DMA              (1 << 3)
+//@}
+
+/** \name Pipe Token Masks */
+//@{
+/** Token mask for \ref Pipe_SetPipeToken() and \ref Pipe_GetPipeToken(). This sets the pipe as a SETUP token (for CONTROL type pipes),
+ *  which will trigger a control request on the attached device when data is written to the pipe.
+ */
+#define PIPE_TOKEN_SETUP                0
+
+/** Token mask for \ref Pipe_SetPipeToken() and \ref Pipe_GetPipeToken(). This sets the pipe as a IN token (for non-CONTROL type pipes),
+ *  indicating that the pipe data will flow from device to host.
+ */
+#define PIPE_TOKEN_IN                   1
+
+/** Token mask for \ref Pipe_SetPipeToken() and \ref Pipe_GetPipeToken(). This sets the pipe as a OUT token (for non-CONTROL type pipes),
+ *  indicating that the pipe data will flow from host to device.
+ */
+#define PIPE_TOKEN_OUT                  2
+//@}
+
+/** Default size of the default control pipe's bank, until altered by the Endpoint0Size value
+ *  in the device descriptor of the attached device.
+ */
+#define PIPE_CONTROLPIPE_DEFAULT_SIZE   64
+
+/** Total number of pipes (including the default control pipe at address 0) which may be used in
+ *  the device. Each pipe uses the USB core host channel of the same index.
+ */
+#define PIPE_TOTAL_PIPES                14
+
+/** Size in bytes of the largest pipe bank size possible in the device. Only isochronous pipes may use
+ *  banks larger than 64 bytes at full speed.
+ */
+#define PIPE_MAX_SIZE                   1023
+
+/* Enums: */
+/** Enum for the possible error return codes of the \ref Pipe_WaitUntilReady() function.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ */
+enum Pipe_WaitUntilReady_ErrorCodes_t {
+	PIPE_READYWAIT_NoError                     = 0, /**< Pipe ready for next packet, no error. */
+	PIPE_READYWAIT_PipeStalled                 = 1, /**< The device stalled the pipe while waiting. */
+	PIPE_READYWAIT_DeviceDisconnected          = 2, /**< Device was disconnected from the host while waiting. */
+	PIPE_READYWAIT_Timeout                     = 3, /**< The device failed to accept or send the next packet
+				                                                 *   within the software timeout period set by the
+				                                                 *   \ref USB_STREAM_TIMEOUT_MS macro.
+				                                                 */
+};
+
+/** Enum for the possible error return codes of the \ref Pipe_StartTransfer() function.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ */
+enum Pipe_Transfer_ErrorCodes_t {
+	PIPE_XFER_NoError                          = 0, /**< Transfer was queued to the pipe's host channel. */
+	PIPE_XFER_InvalidPipe                      = 1, /**< The given address is not a configured bulk pipe. */
+	PIPE_XFER_UnalignedBuffer                  = 2, /**< The given buffer is not aligned to a 32-bit word boundary. */
+	PIPE_XFER_InvalidLength                    = 3, /**< The given length needs more packets than the host channel can
+				                                                 *   queue at once, or is not a whole number of packets for
+				                                                 *   an IN pipe.
+				                                                 */
+	PIPE_XFER_PipeBusy                         = 4, /**< A previous transfer on the pipe has not yet completed, or the
+				                                                 *   pipe bank still holds data.
+				                                                 */
+	PIPE_XFER_ChannelStuck                     = 5, /**< The pipe's host channel failed to halt, the pipe is flagged
+				                                                 *   with a timeout error until \ref Pipe_ClearError() is called.
+				                                                 */
+};
+
+/* Private Interface - For use in library only: */
+#if !defined(__DOXYGEN__)
+/* Function Prototypes: */
+void Pipe_ClearPipes(void);
+void Pipe_HandleChannelInterrupts(void);
+void Pipe_ScheduleChannels(void);
+uint8_t Pipe_WaitUntilTransferComplete(void);
+
+/* External Variables: */
+extern uint32_t USB_Pipe_SelectedPipe;
+extern uint8_t USB_Pipe_DeviceAddress;
+extern USB_Pipe_State_t USB_Pipes[];
+#endif
+
+/* Inline Functions: */
+/** Indicates the number of bytes currently stored in the current pipes's selected bank. For IN pipes
+ *  this is the number of received bytes which have not yet been read out of the bank.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ *
+ *  \return Total number of bytes in the currently selected pipe's FIFO buffer.
+ */
+static inline uint16_t Pipe_BytesInPipe(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint16_t Pipe_BytesInPipe(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	if (Pipe->Token == PIPE_TOKEN_IN)
+		return (Pipe->BankLength - (Pipe->FIFOPos - Pipe->Bank));
+	else
+		return (Pipe->FIFOPos - Pipe->Bank);
+}
+
+/** Determines the currently selected pipe's direction.
+ *
+ *  \return The currently selected pipe's direction, as a \c PIPE_DIR_* mask.
+ */
+static inline uint8_t Pipe_GetPipeDirection(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetPipeDirection(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Token == PIPE_TOKEN_OUT) ? PIPE_DIR_OUT : PIPE_DIR_IN);
+}
+
+/** Returns the pipe address of the currently selected pipe. This is typically used to save the
+ *  currently selected pipe number so that it can be restored after another pipe has been manipulated.
+ *
+ *  \return Index of the currently selected pipe.
+ */
+static inline uint8_t Pipe_GetCurrentPipe(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetCurrentPipe(void)
+{
+	return (USB_Pipe_SelectedPipe | Pipe_GetPipeDirection());
+}
+
+/** Selects the given pipe address. Any pipe operations which do not require the pipe address to be
+ *  indicated will operate on the currently selected pipe.
+ *
+ *  \param[in] Address  Address of the pipe to select.
+ */
+static inline void Pipe_SelectPipe(const uint8_t Address) ATTR_ALWAYS_INLINE;
+static inline void Pipe_SelectPipe(const uint8_t Address)
+{
+	USB_Pipe_SelectedPipe = (Address & PIPE_EPNUM_MASK);
+}
+
+/** Enables the currently selected pipe so that data can be sent and received through it to and from
+ *  an attached device.
+ *
+ *  \pre The currently selected pipe must first be configured properly via \ref Pipe_ConfigurePipe().
+ */
+static inline void Pipe_EnablePipe(void) ATTR_ALWAYS_INLINE;
+static inline void Pipe_EnablePipe(void)
+{
+	USB_Pipes[USB_Pipe_SelectedPipe].Flags |= PIPE_FLAG_ENABLED;
+}
+
+/** Determines if the currently selected pipe is enabled, but not necessarily configured.
+ *
+ * \return Boolean \c true if the currently selected pipe is enabled, \c false otherwise.
+ */
+static inline bool Pipe_IsEnabled(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsEnabled(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_ENABLED) ? true : false);
+}
+
+/** Gets the current pipe token, indicating the pipe's data direction and type.
+ *
+ *  \return The current pipe token, as a \c PIPE_TOKEN_* mask.
+ */
+static inline uint8_t Pipe_GetPipeToken(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetPipeToken(void)
+{
+	return USB_Pipes[USB_Pipe_SelectedPipe].Token;
+}
+
+/** Determines if the currently selected pipe is configured.
+ *
+ *  \return Boolean \c true if the selected pipe is configured, \c false otherwise.
+ */
+static inline bool Pipe_IsConfigured(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsConfigured(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_CONFIGURED) ? true : false);
+}
+
+/** Retrieves the endpoint address of the endpoint within the attached device that the currently selected
+ *  pipe is bound to.
+ *
+ *  \return Endpoint address the currently selected pipe is bound to.
+ */
+static inline uint8_t Pipe_GetBoundEndpointAddress(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetBoundEndpointAddress(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].EndpointAddress & PIPE_EPNUM_MASK) |
+	        ((Pipe_GetPipeToken() == PIPE_TOKEN_IN) ? PIPE_DIR_IN : PIPE_DIR_OUT));
+}
+
+/** Sets the period between interrupts for an INTERRUPT type pipe to a specified number of milliseconds.
+ *  Interrupt pipes are polled by the host channel scheduler on every frame until this is called.
+ *
+ *  \param[in] Milliseconds  Number of milliseconds between each pipe poll.
+ */
+static inline void Pipe_SetInterruptPeriod(const uint8_t Milliseconds) ATTR_ALWAYS_INLINE;
+static inline void Pipe_SetInterruptPeriod(const uint8_t Milliseconds)
+{
+	USB_Pipes[USB_Pipe_SelectedPipe].Interval = (Milliseconds ? Milliseconds : 1);
+}
+
+/** Determines if the currently selected pipe is frozen, and not able to accept data.
+ *
+ *  \return Boolean \c true if the currently selected pipe is frozen, \c false otherwise.
+ */
+static inline bool Pipe_IsFrozen(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsFrozen(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_FROZEN) ? true : false);
+}
+
+/** Determines if the master pipe error flag is set for the currently selected pipe, indicating that
+ *  some sort of hardware error has occurred on the pipe.
+ *
+ *  \see \ref Pipe_GetErrorFlags() macro for information on retrieving the exact error flag.
+ *
+ *  \return Boolean \c true if an error has occurred on the selected pipe, \c false otherwise.
+ */
+static inline bool Pipe_IsError(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsError(void)
+{
+	return (USB_Pipes[USB_Pipe_SelectedPipe].ErrorFlags ? true : false);
+}
+
+/** Gets a mask of the hardware error flags which have occurred on the currently selected pipe. This
+ *  value can then be masked against the \c PIPE_ERRORFLAG_* masks to determine what error has occurred.
+ *
+ *  \return  Mask comprising of \c PIPE_ERRORFLAG_* bits indicating what error has occurred on the selected pipe.
+ */
+static inline uint8_t Pipe_GetErrorFlags(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetErrorFlags(void)
+{
+	return USB_Pipes[USB_Pipe_SelectedPipe].ErrorFlags;
+}
+
+/** Retrieves the number of busy banks in the currently selected pipe, which have been queued for
+ *  transmission via the \ref Pipe_ClearOUT() command, or are awaiting acknowledgement via the
+ *  \ref Pipe_ClearIN() command.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Total number of busy banks in the selected pipe.
+ */
+static inline uint8_t Pipe_GetBusyBanks(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_GetBusyBanks(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & (PIPE_FLAG_BANK_BUSY | PIPE_FLAG_IN_RECEIVED)) ? 1 : 0);
+}
+
+/** Determines if the currently selected pipe may be read from (if data is waiting in the pipe
+ *  bank and the pipe is an IN direction, or if the bank is not yet full if the pipe is an OUT
+ *  direction). This function will return false if the pipe is an IN direction and no packet (or an
+ *  empty packet) has been received, or if the pipe is an OUT direction and the pipe bank is full or
+ *  still being sent.
+ *
+ *  \note This function is not valid on CONTROL type pipes.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if the currently selected pipe may be read from or written to, depending
+ *          on its direction.
+ */
+static inline bool Pipe_IsReadWriteAllowed(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsReadWriteAllowed(void)
+{
+	USB_Pipe_State_t *Pipe = &USB_Pipes[USB_Pipe_SelectedPipe];
+
+	if (Pipe->Token == PIPE_TOKEN_IN)
+		return ((Pipe->Flags & PIPE_FLAG_IN_RECEIVED) && Pipe_BytesInPipe());
+	else
+		return (!(Pipe->Flags & PIPE_FLAG_BANK_BUSY) && (Pipe_BytesInPipe() < Pipe->Size));
+}
+
+/** Determines if a packet has been received on the currently selected IN pipe from the attached device.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if the current pipe has received an IN packet, \c false otherwise.
+ */
+static inline bool Pipe_IsINReceived(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsINReceived(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_IN_RECEIVED) ? true : false);
+}
+
+/** Determines if the currently selected OUT pipe is ready to send an OUT packet to the attached device.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if the current pipe is ready for an OUT packet, \c false otherwise.
+ */
+static inline bool Pipe_IsOUTReady(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsOUTReady(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_BANK_BUSY) ? false : true);
+}
+
+/** Determines if no SETUP request is currently being sent to the attached device on the selected
+ *  CONTROL type pipe.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if the current pipe is ready for a SETUP packet, \c false otherwise.
+ */
+static inline bool Pipe_IsSETUPSent(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsSETUPSent(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_SETUP_SENT) ? true : false);
+}
+
+/** Determines if the device sent a NAK (Negative Acknowledge) in response to the last sent packet on
+ *  the currently selected pipe. This occurs when the host sends a packet to the device, but the device
+ *  is not currently ready to handle the packet (i.e. its endpoint banks are full).
+ *
+ *  \note Bulk and control pipes are retried by the USB core until the device responds, so only NAKs on
+ *        interrupt and isochronous pipes are reported.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if an NAK has been received on the current pipe, \c false otherwise.
+ */
+static inline bool Pipe_IsNAKReceived(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsNAKReceived(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_NAK_RECEIVED) ? true : false);
+}
+
+/** Clears the NAK condition on the currently selected pipe.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \see \ref Pipe_IsNAKReceived() for more details.
+ */
+static inline void Pipe_ClearNAKReceived(void) ATTR_ALWAYS_INLINE;
+static inline void Pipe_ClearNAKReceived(void)
+{
+	INT_Disable();
+	USB_Pipes[USB_Pipe_SelectedPipe].Flags &= ~PIPE_FLAG_NAK_RECEIVED;
+	INT_Enable();
+}
+
+/** Determines if the currently selected pipe has had the STALL condition set by the attached device.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ *
+ *  \return Boolean \c true if the current pipe has been stalled by the attached device, \c false otherwise.
+ */
+static inline bool Pipe_IsStalled(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline bool Pipe_IsStalled(void)
+{
+	return ((USB_Pipes[USB_Pipe_SelectedPipe].Flags & PIPE_FLAG_STALLED) ? true : false);
+}
+
+/** Reads one byte from the currently selected pipe's bank, for OUT direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \return Next byte in the currently selected pipe's FIFO buffer.
+ */
+static inline uint8_t Pipe_Read_8(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint8_t Pipe_Read_8(void)
+{
+	return *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+}
+
+/** Writes one byte to the currently selected pipe's bank, for IN direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \param[in] Data  Data to write into the the currently selected pipe's FIFO buffer.
+ */
+static inline void Pipe_Write_8(const uint8_t Data) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Write_8(const uint8_t Data)
+{
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = Data;
+}
+
+/** Discards one byte from the currently selected pipe's bank, for OUT direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ */
+static inline void Pipe_Discard_8(void) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Discard_8(void)
+{
+	uint8_t Dummy;
+
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	(void)Dummy;
+}
+
+/** Reads two bytes from the currently selected pipe's bank in little endian format, for OUT
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \return Next two bytes in the currently selected pipe's FIFO buffer.
+ */
+static inline uint16_t Pipe_Read_16_LE(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint16_t Pipe_Read_16_LE(void)
+{
+	uint16_t Byte0 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint16_t Byte1 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	return ((Byte1 << 8) | Byte0);
+}
+
+/** Reads two bytes from the currently selected pipe's bank in big endian format, for OUT
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \return Next two bytes in the currently selected pipe's FIFO buffer.
+ */
+static inline uint16_t Pipe_Read_16_BE(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint16_t Pipe_Read_16_BE(void)
+{
+	uint16_t Byte0 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint16_t Byte1 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	return ((Byte0 << 8) | Byte1);
+}
+
+/** Writes two bytes to the currently selected pipe's bank in little endian format, for IN
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \param[in] Data  Data to write to the currently selected pipe's FIFO buffer.
+ */
+static inline void Pipe_Write_16_LE(const uint16_t Data) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Write_16_LE(const uint16_t Data)
+{
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data & 0xFF);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 8);
+}
+
+/** Writes two bytes to the currently selected pipe's bank in big endian format, for IN
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \param[in] Data  Data to write to the currently selected pipe's FIFO buffer.
+ */
+static inline void Pipe_Write_16_BE(const uint16_t Data) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Write_16_BE(const uint16_t Data)
+{
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 8);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data & 0xFF);
+}
+
+/** Discards two bytes from the currently selected pipe's bank, for OUT direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ */
+static inline void Pipe_Discard_16(void) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Discard_16(void)
+{
+	uint8_t Dummy;
+
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	(void)Dummy;
+}
+
+/** Reads four bytes from the currently selected pipe's bank in little endian format, for OUT
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \return Next four bytes in the currently selected pipe's FIFO buffer.
+ */
+static inline uint32_t Pipe_Read_32_LE(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint32_t Pipe_Read_32_LE(void)
+{
+	uint32_t Byte0 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte1 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte2 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte3 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	return ((Byte3 << 24) | (Byte2 << 16) | (Byte1 << 8) | Byte0);
+}
+
+/** Reads four bytes from the currently selected pipe's bank in big endian format, for OUT
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \return Next four bytes in the currently selected pipe's FIFO buffer.
+ */
+static inline uint32_t Pipe_Read_32_BE(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint32_t Pipe_Read_32_BE(void)
+{
+	uint32_t Byte0 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte1 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte2 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	uint32_t Byte3 = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	return ((Byte0 << 24) | (Byte1 << 16) | (Byte2 << 8) | Byte3);
+}
+
+/** Writes four bytes to the currently selected pipe's bank in little endian format, for IN
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \param[in] Data  Data to write to the currently selected pipe's FIFO buffer.
+ */
+static inline void Pipe_Write_32_LE(const uint32_t Data) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Write_32_LE(const uint32_t Data)
+{
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data &  0xFF);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 8);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 16);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 24);
+}
+
+/** Writes four bytes to the currently selected pipe's bank in big endian format, for IN
+ *  direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ *
+ *  \param[in] Data  Data to write to the currently selected pipe's FIFO buffer.
+ */
+static inline void Pipe_Write_32_BE(const uint32_t Data) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Write_32_BE(const uint32_t Data)
+{
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 24);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 16);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data >> 8);
+	*(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++) = (Data &  0xFF);
+}
+
+/** Discards four bytes from the currently selected pipe's bank, for OUT direction pipes.
+ *
+ *  \ingroup Group_PipePrimitiveRW_EFM32GG
+ */
+static inline void Pipe_Discard_32(void) ATTR_ALWAYS_INLINE;
+static inline void Pipe_Discard_32(void)
+{
+	uint8_t Dummy;
+
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+	Dummy = *(USB_Pipes[USB_Pipe_SelectedPipe].FIFOPos++);
+
+	(void)Dummy;
+}
+
+/** Retrieves the number of bytes moved by the last transfer started with \ref Pipe_StartTransfer() on the
+ *  currently selected pipe.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ *
+ *  \return Number of bytes sent or received by the pipe's last transfer.
+ */
+static inline uint16_t Pipe_GetTransferLength(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+static inline uint16_t Pipe_GetTransferLength(void)
+{
+	return USB_Pipes[USB_Pipe_SelectedPipe].XferDone;
+}
+
+/* External Variables: */
+/** Global indicating the maximum packet size of the default control pipe located at address
+ *  0 in the device. This value is set to the value indicated in the attached device's device
+ *  descriptor once the USB interface is initialized into host mode and a device is attached
+ *  to the USB bus.
+ *
+ *  \attention This variable should be treated as read-only in the user application, and never manually
+ *             changed in value.
+ */
+extern uint8_t USB_Host_ControlPipeSize;
+
+/* Function Prototypes: */
+/** Configures a table of pipe descriptions, in sequence. This function can be used to configure multiple
+ *  pipes at the same time.
+ *
+ *  \note Pipe with a zero address will be ignored, thus this function cannot be used to configure the
+ *        control pipe.
+ *
+ *  \param[in] Table    Pointer to a table of pipe descriptions.
+ *  \param[in] Entries  Number of entries in the pipe table to configure.
+ *
+ *  \return Boolean \c true if all pipes configured successfully, \c false otherwise.
+ */
+bool Pipe_ConfigurePipeTable(const USB_Pipe_Table_t* const Table,
+                             const uint8_t Entries);
+
+/** Configures the specified pipe address with the given pipe type, endpoint address within the attached device,
+ *  bank size and number of hardware banks.
+ *
+ *  A newly configured pipe is frozen by default, and must be unfrozen before use via the \ref Pipe_Unfreeze()
+ *  before being used. Pipes should be kept frozen unless waiting for data from a device while in IN mode, or
+ *  sending data to the device in OUT mode. Unfrozen IN type pipes keep requesting packets from the device
+ *  until a packet is received, and again each time the bank is released via \ref Pipe_ClearIN().
+ *
+ *  \param[in] Address          Pipe address to configure.
+ *
+ *  \param[in] Type             Type of pipe to configure, an \c EP_TYPE_* mask. Not all pipe types are available on Low
+ *                              Speed USB devices - refer to the USB 2.0 specification.
+ *
+ *  \param[in] EndpointAddress  Endpoint address within the attached device that the pipe should interface to.
+ *
+ *  \param[in] Size             Size of the pipe's bank, where packets are stored before they are transmitted to
+ *                              the USB device, or after they have been received from the USB device (depending on
+ *                              the pipe's data direction). The bank size must indicate the maximum packet size that
+ *                              the pipe can handle.
+ *
+ *  \param[in] Banks            Number of banks to use for the pipe being configured. Each pipe has a single RAM bank
+ *                              allocated from the \ref USB_PIPE_RAM_SIZE pool; higher throughput is obtained through
+ *                              \ref Pipe_StartTransfer() instead.
+ *
+ *  \note The default control pipe should not be manually configured by the user application, as it is
+ *        automatically configured by the library internally.
+ *        \n\n
+ *
+ *  \note This routine will automatically select the specified pipe upon success. Upon failure, the pipe which
+ *        failed to reconfigure correctly will be selected.
+ *
+ *  \return Boolean \c true if the configuration succeeded, \c false otherwise.
+ */
+bool Pipe_ConfigurePipe(const uint8_t Address,
+                        const uint8_t Type,
+                        const uint8_t EndpointAddress,
+                        const uint16_t Size,
+                        const uint8_t Banks);
+
+/** Resets the desired pipe, including the pipe banks and flags. Any packet in progress on the pipe's host
+ *  channel is abandoned, and the pipe's data toggle is reset to DATA0.
+ *
+ *  \param[in] Address  Index of the pipe to reset.
+ */
+void Pipe_ResetPipe(const uint8_t Address);
+
+/** Disables the currently selected pipe so that data cannot be sent and received through it to and
+ *  from an attached device.
+ */
+void Pipe_DisablePipe(void);
+
+/** Sets the token for the currently selected pipe to one of the tokens specified by the \c PIPE_TOKEN_*
+ *  masks. This can be used on CONTROL type pipes, to allow for bidirectional transfer of data during
+ *  control requests, or on regular pipes to allow for half-duplex bidirectional data transfer to devices
+ *  which have two endpoints of opposite direction sharing the same endpoint address within the device.
+ *
+ *  \param[in] Token  New pipe token to set the selected pipe to, as a \c PIPE_TOKEN_* mask.
+ */
+void Pipe_SetPipeToken(const uint8_t Token);
+
+/** Unfreezes the selected pipe, allowing it to communicate with an attached device. */
+void Pipe_Unfreeze(void);
+
+/** Freezes the selected pipe, preventing it from communicating with an attached device. A packet which
+ *  is already on the bus is allowed to finish; an OUT packet which could not be sent is kept in the bank,
+ *  and sent once the pipe is unfrozen again.
+ */
+void Pipe_Freeze(void);
+
+/** Clears the error flags for the currently selected pipe. */
+void Pipe_ClearError(void);
+
+/** Sends the currently selected CONTROL type pipe's contents to the device as a SETUP packet.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ */
+void Pipe_ClearSETUP(void);
+
+/** Acknowledges the reception of a setup IN request from the attached device on the currently selected
+ *  pipe, freeing the bank ready for the next packet.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ */
+void Pipe_ClearIN(void);
+
+/** Sends the currently selected pipe's contents to the device as an OUT packet on the selected pipe, freeing
+ *  the bank ready for the next packet.
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ */
+void Pipe_ClearOUT(void);
+
+/** Clears the STALL condition detection flag on the currently selected pipe, but does not clear the
+ *  STALL condition itself (this must be done via a ClearFeature control request to the device).
+ *
+ *  \ingroup Group_PipePacketManagement_EFM32GG
+ */
+void Pipe_ClearStall(void);
+
+/** Waits until the currently selected non-control pipe is ready for the next packet of data to be read
+ *  or written to it, aborting in the case of an error condition (such as a timeout or device disconnect).
+ *  The CPU sleeps in EM1 between checks, as the pipe's host channel completes from the USB interrupt.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ *
+ *  \return A value from the \ref Pipe_WaitUntilReady_ErrorCodes_t enum.
+ */
+uint8_t Pipe_WaitUntilReady(void);
+
+/** Determines if a pipe has been bound to the given device endpoint address. If a pipe which is bound to the given
+ *  endpoint is found, it is automatically selected.
+ *
+ *  \param[in] EndpointAddress Address and direction mask of the endpoint within the attached device to check.
+ *
+ *  \return Boolean \c true if a pipe bound to the given endpoint address of the specified direction is found,
+ *          \c false otherwise.
+ */
+bool Pipe_IsEndpointBound(const uint8_t EndpointAddress) ATTR_WARN_UNUSED_RESULT;
+
+/** Starts a zero-copy transfer of the given buffer on the given bulk pipe. The pipe's host channel is
+ *  pointed directly at the caller's buffer and the whole transfer is handed to the USB core as a single
+ *  multi-packet transfer, so that no data is staged through the pipe bank and no CPU copy takes place.
+ *  NAKs from the device are retried by the core without software involvement.
+ *
+ *  For OUT pipes, \c Length bytes are sent to the device as a series of full packets followed by a final
+ *  short packet if required. For IN pipes, \c Length must be a whole number of packets, and the transfer
+ *  finishes early if the device sends a short packet.
+ *
+ *  Once the transfer completes, the given callback (if not \c NULL) is invoked from the USB interrupt
+ *  with the number of bytes actually transferred. Alternatively, \ref Pipe_IsTransferBusy() may be
+ *  polled. A transfer runs regardless of the pipe's frozen state; a device disconnection aborts it with
+ *  a \c USB_STATUS_DEVICE_REMOVED status.
+ *
+ *  \note The buffer must be aligned to a 32-bit word boundary, and must remain valid and untouched until
+ *        the transfer has completed.
+ *        \n\n
+ *
+ *  \note The pipe bank of the given pipe must not be read from or written to while a transfer is in progress.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ *
+ *  \param[in]     Address   Address of the pipe to transfer on.
+ *  \param[in,out] Buffer    Word aligned buffer to send from or receive into.
+ *  \param[in]     Length    Number of bytes to send, or the size of the receive buffer.
+ *  \param[in]     Callback  Function to call once the transfer has completed, or \c NULL if not required.
+ *
+ *  \return A value from the \ref Pipe_Transfer_ErrorCodes_t enum.
+ */
+uint8_t Pipe_StartTransfer(const uint8_t Address,
+                           void *const Buffer,
+                           const uint16_t Length,
+                           const USB_XferCompleteCb_TypeDef Callback);
+
+/** Determines if a transfer started with \ref Pipe_StartTransfer() on the given pipe is still in progress.
+ *
+ *  \ingroup Group_PipeRW_EFM32GG
+ *
+ *  \param[in] Address  Address of the pipe to check.
+ *
+ *  \return Boolean \c true if the pipe's transfer has not yet completed, \c false otherwise.
+ */
+bool Pipe_IsTransferBusy(const uint8_t Address) ATTR_WARN_UNUSED_RESULT;
+
+/* Private Interface - For use in library only: */
+#if !defined(__DOXYGEN__)
+/* Macros: */
+#if !defined(ENDPOINT_CONTROLEP)
+#define ENDPOINT_CONTROLEP          0
+#endif
+#endif
+
+/* Disable C linkage for C++ Compilers: */
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
+/** @} */
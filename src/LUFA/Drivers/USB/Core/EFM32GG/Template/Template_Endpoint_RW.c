@@ -62,10 +62,28 @@ uint8_t TEMPLATE_FUNC_NAME(TEMPLATE_BUFFER_TYPE const Buffer,
 			if ((ErrorCode = Endpoint_WaitUntilReady()) != 0)
 				return ErrorCode;
 		} else {
-			TEMPLATE_TRANSFER_BYTE(DataStream);
-			TEMPLATE_BUFFER_MOVE(DataStream, 1);
-			Length--;
-			BytesInTransfer++;
+			uint16_t BytesInPacket = MIN(Length, TEMPLATE_BANK_LENGTH());
+
+#if defined(TEMPLATE_TRANSFER_PACKETS)
+			if (BytesInPacket < Length) {
+				uint16_t BytesInPackets = 0;
+
+				if ((ErrorCode = TEMPLATE_TRANSFER_PACKETS(DataStream, Length, &BytesInPackets)) != 0)
+					return ErrorCode;
+
+				if (BytesInPackets) {
+					TEMPLATE_BUFFER_MOVE(DataStream, BytesInPackets);
+					Length          -= BytesInPackets;
+					BytesInTransfer += BytesInPackets;
+					continue;
+				}
+			}
+#endif
+
+			TEMPLATE_TRANSFER_BLOCK(DataStream, BytesInPacket);
+			TEMPLATE_BUFFER_MOVE(DataStream, BytesInPacket);
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
 		}
 	}
 
@@ -74,7 +92,9 @@ uint8_t TEMPLATE_FUNC_NAME(TEMPLATE_BUFFER_TYPE const Buffer,
 
 #undef TEMPLATE_FUNC_NAME
 #undef TEMPLATE_BUFFER_TYPE
-#undef TEMPLATE_TRANSFER_BYTE
+#undef TEMPLATE_TRANSFER_BLOCK
+#undef TEMPLATE_BANK_LENGTH
+#undef TEMPLATE_TRANSFER_PACKETS
 #undef TEMPLATE_CLEAR_ENDPOINT
 #undef TEMPLATE_BUFFER_OFFSET
 #undef TEMPLATE_BUFFER_MOVE
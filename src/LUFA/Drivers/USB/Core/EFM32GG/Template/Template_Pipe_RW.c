@@ -0,0 +1,99 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#if defined(TEMPLATE_FUNC_NAME)
+
+uint8_t TEMPLATE_FUNC_NAME(TEMPLATE_BUFFER_TYPE const Buffer,
+                           uint16_t Length,
+                           uint16_t *const BytesProcessed)
+{
+	uint8_t *DataStream      = ((uint8_t *)Buffer + TEMPLATE_BUFFER_OFFSET(Length));
+	uint16_t BytesInTransfer = 0;
+	uint8_t  ErrorCode;
+
+	Pipe_SetPipeToken(TEMPLATE_TOKEN);
+
+	if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+		return ErrorCode;
+
+	if (BytesProcessed != NULL) {
+		Length -= *BytesProcessed;
+		TEMPLATE_BUFFER_MOVE(DataStream, *BytesProcessed);
+	}
+
+	while (Length) {
+		if (!(Pipe_IsReadWriteAllowed())) {
+			TEMPLATE_CLEAR_PIPE();
+
+			if (BytesProcessed != NULL) {
+				*BytesProcessed += BytesInTransfer;
+				return PIPE_RWSTREAM_IncompleteTransfer;
+			}
+
+#if defined(TEMPLATE_TRANSFER_PACKETS)
+			uint16_t BytesInPackets = 0;
+
+			if ((ErrorCode = TEMPLATE_TRANSFER_PACKETS(DataStream, Length, &BytesInPackets)) != 0)
+				return ErrorCode;
+
+			if (BytesInPackets) {
+				TEMPLATE_BUFFER_MOVE(DataStream, BytesInPackets);
+				Length          -= BytesInPackets;
+				BytesInTransfer += BytesInPackets;
+				continue;
+			}
+#endif
+
+			if ((ErrorCode = Pipe_WaitUntilReady()) != 0)
+				return ErrorCode;
+		} else {
+			uint16_t BytesInPacket = MIN(Length, TEMPLATE_BANK_LENGTH());
+
+			TEMPLATE_TRANSFER_BLOCK(DataStream, BytesInPacket);
+			TEMPLATE_BUFFER_MOVE(DataStream, BytesInPacket);
+			Length          -= BytesInPacket;
+			BytesInTransfer += BytesInPacket;
+		}
+	}
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+#undef TEMPLATE_FUNC_NAME
+#undef TEMPLATE_BUFFER_TYPE
+#undef TEMPLATE_TOKEN
+#undef TEMPLATE_TRANSFER_BLOCK
+#undef TEMPLATE_BANK_LENGTH
+#undef TEMPLATE_TRANSFER_PACKETS
+#undef TEMPLATE_CLEAR_PIPE
+#undef TEMPLATE_BUFFER_OFFSET
+#undef TEMPLATE_BUFFER_MOVE
+
+#endif
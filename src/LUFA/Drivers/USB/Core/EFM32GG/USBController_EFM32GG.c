@@ -35,12 +35,16 @@
 #define  __INCLUDE_FROM_USB_CONTROLLER_C
 #include "../USBController.h"
 
-#define MAX_FIFO_SIZE 512U
+#include "em_assert.h"
+
+#if defined(USB_CAN_BE_DEVICE)
 static USBD_Device_TypeDef device;
 USBD_Device_TypeDef *dev = &device;
 
 USBD_Ep_TypeDef *ep;
 
+USB_Endpoint_Layout_t USB_Endpoint_Layout;
+
 /* Define callbacks that are called by the USB stack on different events. */
 static const USBD_Callbacks_TypeDef callbacks = {
 	.usbReset        = NULL,              /* Called whenever USB reset signalling is detected on the USB port. */
@@ -51,114 +55,186 @@ static const USBD_Callbacks_TypeDef callbacks = {
 };
 
 
-static void USB_Fifo_Init(uint8_t *endpoint_desc)
+static uint16_t USB_Endpoint_MaxSize(const uint8_t Type)
 {
-	USB_StdDescriptor_Endpoint_t *epd;
-	uint8_t *config;
-	uint8_t *buf = receiveBuffer;
-	uint8_t txFifoNum = 0, Multiplier = 1;
-	uint16_t start = 0, depth = 0;
-	uint32_t totalRxFifoSize = 0, totalTxFifoSize = 0;
-	uint32_t numEps = 0, numInEps = 0, numOutEps = 0;
-	int i, j;
-	USBD_Ep_TypeDef *ep;
-
-	config = &endpoint_desc[1];
-	epd = (USB_StdDescriptor_Endpoint_t *)config;
-	do {
-
-		ep                 = &dev->ep[numEps++];
-		ep->in             = (epd->bEndpointAddress & USB_SETUP_DIR_MASK) != 0;
-		ep->buf            = buf;
-		ep->addr           = epd->bEndpointAddress;
-		ep->num            = ep->addr & USB_EPNUM_MASK;
-		ep->mask           = 1 << ep->num;
-		ep->type           = epd->bmAttributes & CONFIG_DESC_BM_TRANSFERTYPE;
-		ep->packetSize     = epd->wMaxPacketSize;
-		ep->remaining      = 0;
-		ep->xferred        = 0;
-		ep->state          = D_EP_IDLE;
-		ep->xferCompleteCb = NULL;
+	/* Full speed maximum packet sizes */
+	return (Type == EP_TYPE_ISOCHRONOUS) ? 1023 : 64;
+}
 
-		buf += ep->packetSize;
+static bool USB_Fifo_Init(uint8_t *endpoint_desc)
+{
+	USB_StdDescriptor_Endpoint_t *epd = (USB_StdDescriptor_Endpoint_t *)&endpoint_desc[1];
+	USB_Endpoint_LayoutEntry_t   *Entry;
+	USBD_Ep_TypeDef *ep;
+	uint16_t RAMUsed  = 0;
+	uint16_t FIFOUsed;
+	uint16_t Words;
+	uint8_t  TxFIFONum = 0;
+	uint8_t  Error     = USB_LAYOUT_NoError;
+	uint8_t  i;
 
-		if (ep->type == EP_TYPE_BULK)
-			Multiplier = 2;
-		else
-			Multiplier = 1;
+	memset(&USB_Endpoint_Layout, 0, sizeof(USB_Endpoint_Layout));
+	USB_Endpoint_Layout.RAMSize  = USB_ENDPOINT_RAM_SIZE;
+	USB_Endpoint_Layout.FIFOSize = USB_FIFO_TOTAL_WORDS;
 
-		if (ep->in) {
-			numInEps++;
-			ep->txFifoNum = txFifoNum++;
-			ep->fifoSize = (ep->packetSize / 4) * Multiplier;
-			dev->inEpAddr2EpIndex[ep->num] = numEps;
-			totalTxFifoSize += ep->fifoSize;
-		} else {
-			if (ep->type == EP_TYPE_CONTROL) {
-				ep->fifoSize = ep->packetSize / 4;
-			} else {
-				numOutEps++;
-				ep->fifoSize = (ep->packetSize / 4 + 1) * Multiplier;
-				dev->outEpAddr2EpIndex[ep->num] = numEps;
-			}
-			totalRxFifoSize += ep->fifoSize;
-		}
-		epd++;
-	} while (numEps < endpoint_desc[0]);
 	/* Rx-FIFO size: SETUP packets : 4*n + 6    n=#CTRL EP's
 	 *               GOTNAK        : 1
 	 *               Status info   : 2*n        n=#OUT EP's (EP0 included) in HW
 	 */
-	totalRxFifoSize += 10 + 1 + (2 * (MAX_NUM_OUT_EPS + 1));
+	USB_Endpoint_Layout.RxFIFODepth = 10 + 1 + (2 * (MAX_NUM_OUT_EPS + 1));
 
-	/* Set Rx FIFO size */
-	USB->GRXFSIZ = (totalRxFifoSize << _USB_GRXFSIZ_RXFDEP_SHIFT) &
-	               _USB_GRXFSIZ_RXFDEP_MASK;
+	/* Plan RAM banks and FIFO space per endpoint number, nothing is written to the core yet */
+	for (i = 0; (i < endpoint_desc[0]) && (Error == USB_LAYOUT_NoError); i++, epd++) {
+		uint8_t  Num  = (epd->bEndpointAddress & USB_EPNUM_MASK);
+		uint8_t  Type = (epd->bmAttributes & CONFIG_DESC_BM_TRANSFERTYPE);
+		uint16_t Size = (le16_to_cpu(epd->wMaxPacketSize) & 0x07FF);
+
+		if (Num > NUM_EP_USED) {
+			Error = USB_LAYOUT_InvalidEndpoint;
+			break;
+		}
+
+		Entry = &USB_Endpoint_Layout.Endpoints[Num];
+
+		if (Entry->Size) {
+			Error = USB_LAYOUT_DuplicateEndpoint;
+			break;
+		}
+
+		if (!(Size) || (Size > USB_Endpoint_MaxSize(Type))) {
+			Error = USB_LAYOUT_InvalidSize;
+			break;
+		}
+
+		Words = ((Size + 3) / 4);
+
+		Entry->Address      = epd->bEndpointAddress;
+		Entry->Type         = Type;
+		Entry->Size         = Size;
+		Entry->Banks        = (Type == EP_TYPE_BULK) ? USB_BULK_ENDPOINT_BANKS : 1;
+		Entry->BufferOffset = RAMUsed;
+		Entry->BufferSize   = (Words * 4 * Entry->Banks);
+
+		if ((uint32_t)RAMUsed + Entry->BufferSize > USB_ENDPOINT_RAM_SIZE) {
+			Error = USB_LAYOUT_OutOfRAM;
+			break;
+		}
+
+		RAMUsed += Entry->BufferSize;
+
+		if (Type == EP_TYPE_CONTROL) {
+			/* SETUP and OUT data share the RX FIFO, IN data goes through the non-periodic TX FIFO 0 */
+			Entry->Address   = ENDPOINT_CONTROLEP;
+			Entry->FIFODepth = Words;
+			USB_Endpoint_Layout.RxFIFODepth += Words;
+		} else if (Entry->Address & USB_SETUP_DIR_MASK) {
+			Entry->FIFODepth = (Words * Entry->Banks);
+		} else {
+			/* Each OUT packet is preceded by a status word in the RX FIFO */
+			Entry->FIFODepth = ((Words + 1) * Entry->Banks);
+			USB_Endpoint_Layout.RxFIFODepth += Entry->FIFODepth;
+		}
+	}
+
+	if ((Error == USB_LAYOUT_NoError) && !(USB_Endpoint_Layout.Endpoints[0].Size))
+	  Error = USB_LAYOUT_InvalidEndpoint;
+
+	/* Stack the TX FIFOs behind the RX FIFO in endpoint number order */
+	FIFOUsed = USB_Endpoint_Layout.RxFIFODepth;
+
+	for (i = 0; (i <= NUM_EP_USED) && (Error == USB_LAYOUT_NoError); i++) {
+		Entry = &USB_Endpoint_Layout.Endpoints[i];
+
+		if (i && !(Entry->Address & USB_SETUP_DIR_MASK))
+		  continue;
+
+		if (i && (++TxFIFONum > MAX_NUM_TX_FIFOS)) {
+			Error = USB_LAYOUT_OutOfFIFO;
+			break;
+		}
+
+		Entry->FIFONumber = TxFIFONum;
+		Entry->FIFOStart  = FIFOUsed;
+		FIFOUsed         += Entry->FIFODepth;
+	}
+
+	if ((Error == USB_LAYOUT_NoError) && (FIFOUsed > USB_FIFO_TOTAL_WORDS))
+	  Error = USB_LAYOUT_OutOfFIFO;
+
+	USB_Endpoint_Layout.RAMUsed  = RAMUsed;
+	USB_Endpoint_Layout.FIFOUsed = FIFOUsed;
+	USB_Endpoint_Layout.Error    = Error;
+
+	if (Error != USB_LAYOUT_NoError)
+	  return false;
+
+	/* The plan fits, hand each endpoint its buffer and program the FIFO sizes */
+	for (i = 0; i <= NUM_EP_USED; i++) {
+		Entry = &USB_Endpoint_Layout.Endpoints[i];
+
+		if (!(Entry->Size))
+		  continue;
+
+		ep                 = &dev->ep[i];
+		ep->in             = (Entry->Address & USB_SETUP_DIR_MASK) != 0;
+		ep->buf            = &receiveBuffer[Entry->BufferOffset];
+		ep->addr           = Entry->Address;
+		ep->num            = i;
+		ep->mask           = 1 << i;
+		ep->type           = Entry->Type;
+		ep->packetSize     = Entry->Size;
+		ep->fifoSize       = Entry->FIFODepth;
+		ep->txFifoNum      = Entry->FIFONumber;
+		ep->remaining      = 0;
+		ep->xferred        = 0;
+		ep->state          = D_EP_IDLE;
+		ep->xferCompleteCb = NULL;
 
-	start = totalRxFifoSize;                /* Set Tx EP0 FIFO size */
-	depth = dev->ep[0].fifoSize;
-	USB->GNPTXFSIZ = ((depth << _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_SHIFT) &
-	                  _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_MASK) |
-	                 ((start << _USB_GNPTXFSIZ_NPTXFSTADDR_SHIFT) &
-	                  _USB_GNPTXFSIZ_NPTXFSTADDR_MASK);
-
-
-	/* Set Tx EP FIFO sizes for all IN ep's */
-	for (j = 1; j <= MAX_NUM_TX_FIFOS; j++) {
-		for (i = 1; i <= MAX_NUM_IN_EPS; i++) {
-			ep = USBD_GetEpFromAddr(USB_SETUP_DIR_MASK | i);
-			if (ep) {                             /* Is EP in use ? */
-				if (ep->txFifoNum == j) {           /* Is it correct FIFO number ? */
-					start += depth;
-					depth = ep->fifoSize;
-					USB_DIEPTXFS[ep->txFifoNum - 1] =
-					    (depth << _USB_DIEPTXF1_INEPNTXFDEP_SHIFT) |
-					    (start &  _USB_DIEPTXF1_INEPNTXFSTADDR_MASK);
-				}
-			}
+		if (!(i)) {
+			USB->GNPTXFSIZ = ((Entry->FIFODepth << _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_SHIFT) &
+			                  _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_MASK) |
+			                 ((Entry->FIFOStart << _USB_GNPTXFSIZ_NPTXFSTADDR_SHIFT) &
+			                  _USB_GNPTXFSIZ_NPTXFSTADDR_MASK);
+		} else if (ep->in) {
+			dev->inEpAddr2EpIndex[i] = i;
+			USB_DIEPTXFS[ep->txFifoNum - 1] =
+			    (Entry->FIFODepth << _USB_DIEPTXF1_INEPNTXFDEP_SHIFT) |
+			    (Entry->FIFOStart &  _USB_DIEPTXF1_INEPNTXFSTADDR_MASK);
+		} else {
+			dev->outEpAddr2EpIndex[i] = i;
 		}
 	}
 
-	if (totalRxFifoSize + totalTxFifoSize > MAX_FIFO_SIZE)
-		return;
+	/* Set Rx FIFO size */
+	USB->GRXFSIZ = (USB_Endpoint_Layout.RxFIFODepth << _USB_GRXFSIZ_RXFDEP_SHIFT) &
+	               _USB_GRXFSIZ_RXFDEP_MASK;
 
 	/* Flush the FIFO's */
 	USBHAL_FlushTxFifo(0x10);        /* All Tx FIFO's */
 	USBHAL_FlushRxFifo();            /* The Rx FIFO   */
+
+	return true;
 }
+#endif
 
-void USB_Init(uint8_t *endpoint_desc)
+#if defined(USB_CAN_BE_DEVICE)
+bool USB_Init(uint8_t *endpoint_desc)
+#else
+bool USB_Init(void)
+#endif
 {
 	USB_Disable();
 
 	USB_IsInitialized = true;
 
+#if defined(USB_CAN_BE_DEVICE)
 	memset(dev, 0, sizeof(USBD_Device_TypeDef));
 	dev->callbacks = &callbacks;
 	dev->setup = dev->setupPkt;
 
 	/* Initialize EP0 */
 	ep = &dev->ep[0];
+#endif
 
 	CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);
 
@@ -169,13 +245,24 @@ void USB_Init(uint8_t *endpoint_desc)
 	USBHAL_DisableGlobalInt();
 
 	USB_ResetInterface();
-	USB_Fifo_Init(endpoint_desc);
+
+#if defined(USB_CAN_BE_DEVICE)
+	if (!(USB_Fifo_Init(endpoint_desc))) {
+		/* The endpoint table does not fit the RAM pool or FIFOs, never attach with overlapping buffers */
+		EFM_ASSERT(false);
+		USB_Disable();
+		return false;
+	}
+
 	USB_Init_Device();
+#endif
 
 	USBHAL_EnableGlobalInt();
 	NVIC_ClearPendingIRQ(USB_IRQn);
 	NVIC_EnableIRQ(USB_IRQn);
 	INT_Enable();
+
+	return true;
 }
 
 void USB_Disable(void)
@@ -183,6 +270,10 @@ void USB_Disable(void)
 	USB_INT_DisableAllInterrupts();
 	USB_INT_ClearAllInterrupts();
 
+#if defined(USB_CAN_BE_HOST)
+	USB_Host_VBUS_Auto_Off();
+#endif
+
 	USB_Detach();
 	USB_Controller_Disable();
 
@@ -197,9 +288,15 @@ void USB_ResetInterface(void)
 
 	USB_Controller_Enable();  /* Init PHY          */
 	USB_Controller_Reset();
+
+#if defined(USB_CAN_BE_HOST)
+	/* Device mode needs the endpoint table first, so it is brought up by USB_Init() instead */
+	USB_Init_Host();
+#endif
 }
 
 
+#if defined(USB_CAN_BE_DEVICE)
 static void USB_Init_Device(void)
 {
 	USB_DeviceState                 = DEVICE_STATE_Unattached;
@@ -250,5 +347,60 @@ static void USB_Init_Device(void)
 	USB_INT_Enable(USB_GINT_SOF);
 	USB_Attach();
 }
+#endif
+
+#if defined(USB_CAN_BE_HOST)
+static void USB_Init_Host(void)
+{
+	USB_HostState                = HOST_STATE_Unattached;
+	USB_Host_ConfigurationNumber = 0;
+	USB_Host_ControlPipeSize     = PIPE_CONTROLPIPE_DEFAULT_SIZE;
+
+	CMU_ClockEnable(cmuClock_GPIO, true);
+	GPIO_PinModeSet(gpioPortF, 5, gpioModePushPull, 0);    // Enable VBUSEN pin
+
+#if defined(INVERTED_VBUS_ENABLE_LINE)
+	USB->CTRL &= ~USB_CTRL_VBUSENAP;
+#else
+	USB->CTRL |= USB_CTRL_VBUSENAP;
+#endif
+
+	/* Force Host Mode */
+	USB->GUSBCFG = (USB->GUSBCFG                                    &
+	                ~(GUSBCFG_WO_BITMASK | USB_GUSBCFG_FORCEDEVMODE)) |
+	               USB_GUSBCFG_FORCEHSTMODE;
+	INT_Enable();
+	Delay_MS(50);
+	INT_Disable();
+
+	/* Start with the full speed PHY clock, USB_Host_ResetDevice() switches it for low speed devices */
+	USB->HCFG = (USB->HCFG & ~_USB_HCFG_FSLSPCLKSEL_MASK) | _USB_HCFG_FSLSPCLKSEL_DIV1;
+	USB->HFIR = 48000;
+
+	/* Set DMA enabled and incrementing burst of unspecified length*/
+	USB->GAHBCFG = (USB->GAHBCFG & ~_USB_GAHBCFG_HBSTLEN_MASK) |
+	               USB_GAHBCFG_DMAEN | USB_GAHBCFG_HBSTLEN_INCR;
+
+	/* Fixed FIFO split, the host channels share one RX and two TX FIFOs */
+	USB->GRXFSIZ   = (USB_HOST_RX_FIFO_WORDS << _USB_GRXFSIZ_RXFDEP_SHIFT) &
+	                 _USB_GRXFSIZ_RXFDEP_MASK;
+	USB->GNPTXFSIZ = (USB_HOST_NPTX_FIFO_WORDS << _USB_GNPTXFSIZ_NPTXFINEPTXF0DEP_SHIFT) |
+	                 (USB_HOST_RX_FIFO_WORDS   << _USB_GNPTXFSIZ_NPTXFSTADDR_SHIFT);
+	USB->HPTXFSIZ  = (USB_HOST_PTX_FIFO_WORDS << _USB_HPTXFSIZ_PTXFSIZE_SHIFT) |
+	                 (USB_HOST_RX_FIFO_WORDS + USB_HOST_NPTX_FIFO_WORDS);
+
+	USBHAL_FlushTxFifo(0x10);        /* All Tx FIFO's */
+	USBHAL_FlushRxFifo();            /* The Rx FIFO   */
+
+	Pipe_ClearPipes();
+
+	USB_INT_Enable(USB_GINT_PRTINT);
+	USB_INT_Enable(USB_GINT_HCHINT);
+	USB_INT_Enable(USB_GINT_DISCONNINT);
+	USB_INT_Enable(USB_GINT_SOF);
+
+	USB_Host_VBUS_Auto_On();
+}
+#endif
 
 #endif
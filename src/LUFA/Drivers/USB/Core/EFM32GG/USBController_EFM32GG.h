@@ -121,6 +121,99 @@ extern "C" {
 #define USB_STREAM_TIMEOUT_MS       100
 #endif
 
+#if !defined(USB_ENDPOINT_RAM_SIZE) || defined(__DOXYGEN__)
+/** Size in bytes of the word aligned RAM pool from which \ref USB_Init() allocates the endpoint
+ *  bank buffers. Every endpoint in the table passed to \ref USB_Init() takes one word padded buffer
+ *  per bank from this pool; if the table does not fit, initialization fails.
+ *
+ *  This value may be overridden in the user project makefile as the value of the
+ *  \ref USB_ENDPOINT_RAM_SIZE token, and passed to the compiler using the -D switch.
+ */
+#define USB_ENDPOINT_RAM_SIZE       500
+#endif
+
+#if (USB_ENDPOINT_RAM_SIZE % 4)
+#error USB_ENDPOINT_RAM_SIZE must be a whole number of 32-bit words.
+#endif
+
+#if !defined(USB_PIPE_RAM_SIZE) || defined(__DOXYGEN__)
+/** Size in bytes of the word aligned RAM pool from which \ref Pipe_ConfigurePipe() allocates the pipe
+ *  bank buffers when in host mode. Each configured pipe takes one word padded bank from this pool, which
+ *  is returned when the attached device is removed.
+ *
+ *  This value may be overridden in the user project makefile as the value of the
+ *  \ref USB_PIPE_RAM_SIZE token, and passed to the compiler using the -D switch.
+ */
+#define USB_PIPE_RAM_SIZE           512
+#endif
+
+#if (USB_PIPE_RAM_SIZE % 4)
+#error USB_PIPE_RAM_SIZE must be a whole number of 32-bit words.
+#endif
+
+#if !defined(USB_BULK_ENDPOINT_BANKS) || defined(__DOXYGEN__)
+/** Number of banks reserved for each bulk endpoint, both in RAM and in the hardware FIFOs. Control,
+ *  interrupt and isochronous endpoints are always single banked.
+ *
+ *  This value may be overridden in the user project makefile as the value of the
+ *  \ref USB_BULK_ENDPOINT_BANKS token, and passed to the compiler using the -D switch.
+ */
+#define USB_BULK_ENDPOINT_BANKS     2
+#endif
+
+/** Total size in 32-bit words of the USB core's shared RX/TX FIFO RAM. */
+#define USB_FIFO_TOTAL_WORDS        512
+
+#if defined(USB_CAN_BE_DEVICE) || defined(__DOXYGEN__)
+/* Enums: */
+/** Enum for the possible error return codes of the endpoint memory planner run by \ref USB_Init(),
+ *  as stored in the \c Error element of \ref USB_Endpoint_Layout.
+ */
+enum USB_Endpoint_Layout_ErrorCodes_t {
+	USB_LAYOUT_NoError                         = 0, /**< All endpoints fit into the RAM pool and FIFOs. */
+	USB_LAYOUT_InvalidEndpoint                 = 1, /**< An endpoint number is larger than \c NUM_EP_USED, or the
+				                                                 *   table has no control endpoint.
+				                                                 */
+	USB_LAYOUT_DuplicateEndpoint               = 2, /**< Two entries in the table use the same endpoint number. */
+	USB_LAYOUT_InvalidSize                     = 3, /**< An endpoint size is zero or larger than its transfer type
+				                                                 *   allows at full speed.
+				                                                 */
+	USB_LAYOUT_OutOfRAM                        = 4, /**< The endpoint banks need more than \ref USB_ENDPOINT_RAM_SIZE
+				                                                 *   bytes of RAM.
+				                                                 */
+	USB_LAYOUT_OutOfFIFO                       = 5, /**< The RX and TX FIFOs need more than \ref USB_FIFO_TOTAL_WORDS
+				                                                 *   words, or more IN endpoints than there are TX FIFOs.
+				                                                 */
+};
+
+/* Type Defines: */
+/** Type define for the allocation of a single endpoint, as planned by \ref USB_Init(). */
+typedef struct {
+	uint8_t  Address; /**< Address of the endpoint, including the direction bit. */
+	uint8_t  Type; /**< Type of the endpoint, a \c EP_TYPE_* mask. */
+	uint8_t  Banks; /**< Number of banks allocated to the endpoint. */
+	uint8_t  FIFONumber; /**< Dedicated TX FIFO number of an IN endpoint, zero for the control and OUT endpoints. */
+	uint16_t Size; /**< Maximum packet size of the endpoint, in bytes; zero if the endpoint is unused. */
+	uint16_t BufferOffset; /**< Offset in bytes of the endpoint's first bank within the endpoint RAM pool. */
+	uint16_t BufferSize; /**< Bytes of the endpoint RAM pool allocated to all banks of the endpoint. */
+	uint16_t FIFOStart; /**< Start of the endpoint's TX FIFO, in words; zero for OUT endpoints, which share the RX FIFO. */
+	uint16_t FIFODepth; /**< Words of TX FIFO, or the share of the RX FIFO for OUT endpoints, used by the endpoint. */
+} USB_Endpoint_LayoutEntry_t;
+
+/** Type define for the complete endpoint memory plan computed by \ref USB_Init() from the endpoint
+ *  table, indexed by endpoint number.
+ */
+typedef struct {
+	USB_Endpoint_LayoutEntry_t Endpoints[NUM_EP_USED + 1]; /**< Allocation of each endpoint, up to \c NUM_EP_USED. */
+	uint16_t RAMUsed; /**< Bytes of the endpoint RAM pool allocated to endpoint banks. */
+	uint16_t RAMSize; /**< Total size of the endpoint RAM pool, \ref USB_ENDPOINT_RAM_SIZE. */
+	uint16_t RxFIFODepth; /**< Depth of the shared RX FIFO, in words. */
+	uint16_t FIFOUsed; /**< Words of FIFO RAM used by the RX FIFO and all TX FIFOs. */
+	uint16_t FIFOSize; /**< Total words of FIFO RAM, \ref USB_FIFO_TOTAL_WORDS. */
+	uint8_t  Error; /**< Result of the plan, a value from the \ref USB_Endpoint_Layout_ErrorCodes_t enum. */
+} USB_Endpoint_Layout_t;
+#endif
+
 /* Inline Functions: */
 /** Determines if the VBUS line is currently high (i.e. the USB host is supplying power).
  *
@@ -157,6 +250,7 @@ static inline void USB_Attach(void)
 }
 
 /* Function Prototypes: */
+#if defined(USB_CAN_BE_DEVICE) || defined(__DOXYGEN__)
 /** Main function to initialize and start the USB interface. Once active, the USB interface will
  *  allow for device connection to a host when in device mode, or for device enumeration while in
  *  host mode.
@@ -171,10 +265,24 @@ static inline void USB_Attach(void)
  *  Calling this function when the USB interface is already initialized will cause a complete USB
  *  interface reset and re-enumeration.
  *
- *  \param[in] endpoint_desc    endpoint descriptor
+ *  The endpoint buffers and FIFOs are planned from the given endpoint table before the controller is
+ *  touched; the result is stored in \ref USB_Endpoint_Layout. If the plan does not fit, the device is
+ *  left detached, an assertion is raised in debug builds and \c false is returned.
+ *
+ *  \param[in] endpoint_desc    Endpoint table, an endpoint count followed by that many endpoint descriptors.
  *
+ *  \return Boolean \c true if the endpoint plan fit and the interface was started, \c false otherwise.
  */
-void USB_Init(uint8_t *endpoint_desc);
+bool USB_Init(uint8_t *endpoint_desc);
+#else
+/** Main function to initialize and start the USB interface in host mode, selected at compile time with the
+ *  \c USB_HOST_ONLY token. The core is forced into host mode, VBUS is switched on and the host state machine
+ *  will begin enumerating any device attached to the port.
+ *
+ *  \return Boolean \c true once the interface has been started.
+ */
+bool USB_Init(void);
+#endif
 
 /** Shuts down the USB interface. This turns off the USB interface after deallocating all USB FIFO
  *  memory, endpoints and pipes. When turned off, no USB functionality can be used until the interface
@@ -188,7 +296,17 @@ void USB_Disable(void);
 void USB_ResetInterface(void);
 
 /* Global Variables: */
+#if defined(USB_CAN_BE_DEVICE) || defined(__DOXYGEN__)
 extern USBD_Device_TypeDef *dev;
+
+/** Endpoint RAM and FIFO allocation planned by the last call to \ref USB_Init().
+ *
+ *  \attention This variable should be treated as read-only in the user application, and never manually
+ *             changed in value.
+ */
+extern USB_Endpoint_Layout_t USB_Endpoint_Layout;
+#endif
+
 #if defined(USB_CAN_BE_BOTH) || defined(__DOXYGEN__)
 /** Indicates the mode that the USB interface is currently initialized to, a value from the
  *  \ref USB_Modes_t enum.
@@ -227,6 +345,11 @@ extern volatile uint8_t USB_Options;
 /* Macros: */
 #define USB_CLOCK_REQUIRED_FREQ  48000000UL
 
+/* Host mode FIFO split in 32-bit words, the three FIFOs fill the whole FIFO RAM */
+#define USB_HOST_RX_FIFO_WORDS     256
+#define USB_HOST_NPTX_FIFO_WORDS   128
+#define USB_HOST_PTX_FIFO_WORDS    128
+
 /* Function Prototypes: */
 #if defined(__INCLUDE_FROM_USB_CONTROLLER_C)
 #if defined(USB_CAN_BE_DEVICE)
@@ -293,7 +416,7 @@ static inline void USB_Controller_Reset(void)
 static inline uint8_t USB_GetUSBModeFromUID(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
 static inline uint8_t USB_GetUSBModeFromUID(void)
 {
-	return USB_MODE_Device;
+	return (USB->GOTGCTL & USB_GOTGCTL_CONIDSTS) ? USB_MODE_Device : USB_MODE_Host;
 }
 #endif
 
@@ -36,6 +36,7 @@
 
 #define HANDLE_INT( x ) if ( status & x ) { Handle_##x(); status &= ~x; }
 
+#if defined(USB_CAN_BE_DEVICE)
 static void Handle_USB_GINTSTS_ENUMDONE(void);
 static void Handle_USB_GINTSTS_IEPINT(void);
 static void Handle_USB_GINTSTS_OEPINT(void);
@@ -44,24 +45,45 @@ static void Handle_USB_GINTSTS_SOF(void);
 static void Handle_USB_GINTSTS_USBRST(void);
 static void Handle_USB_GINTSTS_USBSUSP(void);
 static void Handle_USB_GINTSTS_WKUPINT(void);
+static void Rearm_EP0(void);
+#endif
+
+#if defined(USB_CAN_BE_HOST)
+static void Handle_USB_GINTSTS_PRTINT(void);
+static void Handle_USB_GINTSTS_HCHINT(void);
+static void Handle_USB_GINTSTS_DISCONNINT(void);
+static void Handle_USB_GINTSTS_SOF(void);
+#endif
 
 void USB_INT_DisableAllInterrupts(void)
 {
+#if defined(USB_CAN_BE_DEVICE)
 	/* Disable all device interrupts */
 	USB->DIEPMSK  = 0;
 	USB->DOEPMSK  = 0;
 	USB->DAINTMSK = 0;
 	USB->DIEPEMPMSK = 0;
+#endif
+#if defined(USB_CAN_BE_HOST)
+	/* Disable all host channel interrupts */
+	USB->HAINTMSK = 0;
+#endif
 	USB->GINTMSK = 0;
 }
 
 void USB_INT_ClearAllInterrupts(void)
 {
 	uint8_t i;
+#if defined(USB_CAN_BE_DEVICE)
 	for (i = 0; i <= MAX_NUM_IN_EPS; i++) {
 		USB_DINEPS[i].INT  = 0xFFFFFFFF;
 		USB_DOUTEPS[i].INT  = 0xFFFFFFFF;
 	}
+#endif
+#if defined(USB_CAN_BE_HOST)
+	for (i = 0; i < PIPE_TOTAL_PIPES; i++)
+		USB->HC[i].INT = 0xFFFFFFFF;
+#endif
 	USB->GINTSTS = 0xFFFFFFFF;
 }
 
@@ -74,12 +96,14 @@ void USB_IRQHandler(void)
 
 	INT_Disable();
 
+#if defined(USB_CAN_BE_DEVICE)
 	if (USB->IF && (USB->CTRL & USB_CTRL_VREGOSEN)) {
 		if (USB->IF & USB_IF_VREGOSH) {
 			USB->IFC = USB_IFC_VREGOSH;
 			if (USB->STATUS & USB_STATUS_VREGOS) {
 				USBDHAL_EnableUsbResetAndSuspendInt();
 				USB_DeviceState = DEVICE_STATE_Powered;
+				EVENT_USB_Device_Connect();
 			}
 		}
 		if (USB->IF & USB_IF_VREGOSL) {
@@ -88,15 +112,23 @@ void USB_IRQHandler(void)
 				USB->GINTMSK = 0;
 				USB->GINTSTS = 0xFFFFFFFF;
 				USB_DeviceState = DEVICE_STATE_Unattached;
+				EVENT_USB_Device_Disconnect();
 			}
 		}
 	}
+#endif
 
 	status = USBHAL_GetCoreInts();
 	// printf("\nGINTSTS = 0x%x\n", status);
 
+#if defined(USB_CAN_BE_HOST)
+	HANDLE_INT(USB_GINTSTS_DISCONNINT)
+	HANDLE_INT(USB_GINTSTS_PRTINT)
+	HANDLE_INT(USB_GINTSTS_HCHINT)
+	HANDLE_INT(USB_GINTSTS_SOF)
+#else
 	if (status == 0) {
-		USBDHAL_Ep0Activate(0);
+		Rearm_EP0();
 		INT_Enable();
 		return;
 	}
@@ -110,10 +142,25 @@ void USB_IRQHandler(void)
 	HANDLE_INT(USB_GINTSTS_IEPINT)
 	HANDLE_INT(USB_GINTSTS_OEPINT)
 
-	USBDHAL_Ep0Activate(0);
+	Rearm_EP0();
+#endif
 	INT_Enable();
 }
 
+#if defined(USB_CAN_BE_DEVICE)
+
+/*
+ * Re-arm EP0 for the next SETUP packet once a transfer has disabled it, unless a
+ * SETUP packet is still waiting to be processed - the endpoint would then accept
+ * the request's OUT data stage before the request has been read and cleared. No
+ * SETUP packet can arrive on the disabled endpoint between the two checks.
+ */
+static void Rearm_EP0(void)
+{
+	if (!(USB->DOEP0CTL & USB_DOEP_CTL_EPENA) && !(USB->DOEP0INT & USB_DOEP_INT_SETUP))
+		USBDHAL_Ep0Activate(0);
+}
+
 /*
  * Handle port enumeration interrupt. This has nothing to do with normal
  * device enumeration.
@@ -141,7 +188,12 @@ static void Handle_USB_GINTSTS_IEPINT(void)
 	for (epnum = 0, epmask = 1; epnum <= NUM_EP_USED; epnum++, epmask <<= 1) {
 		if (epint & epmask) {
 			ep = &dev->ep[epnum];
-			USBDHAL_GetInEpInts(ep);
+			if (USBDHAL_GetInEpInts(ep) & USB_DIEP_INT_XFERCOMPL) {
+				if (ep->state == D_EP_TRANSFERRING)
+					Endpoint_CompleteTransfer(ep);
+				else if (USB_Endpoint_DoubleBank & epmask)
+					Endpoint_CompleteBank(ep);
+			}
 		}
 	}
 }
@@ -169,6 +221,13 @@ static void Handle_USB_GINTSTS_OEPINT(void)
 				USB_Device_ProcessControlRequest();
 				Endpoint_SelectEndpoint(PrevSelectedEndpoint);
 			}
+
+			if (status & USB_DOEP_INT_XFERCOMPL) {
+				if (ep->state == D_EP_TRANSFERRING)
+					Endpoint_CompleteTransfer(ep);
+				else if (USB_Endpoint_DoubleBank & epmask)
+					Endpoint_CompleteBank(ep);
+			}
 		}
 	}
 }
@@ -189,6 +248,10 @@ static void Handle_USB_GINTSTS_SOF(void)
 {
 	USB->GINTSTS = USB_GINTSTS_SOF;
 
+#if !defined(NO_SOF_EVENTS)
+	EVENT_USB_Device_StartOfFrame();
+#endif
+
 	if (dev->callbacks->sofInt) {
 		dev->callbacks->sofInt(
 		    (USB->DSTS & _USB_DSTS_SOFFN_MASK) >> _USB_DSTS_SOFFN_SHIFT);
@@ -235,7 +298,7 @@ static void Handle_USB_GINTSTS_USBRST(void)
 	}
 
 	USB_DeviceState = DEVICE_STATE_Default;
-	// USBDHAL_AbortAllTransfers(USB_STATUS_DEVICE_RESET);
+	Endpoint_AbortTransfers(USB_STATUS_DEVICE_RESET);
 }
 
 /*
@@ -260,6 +323,79 @@ static void Handle_USB_GINTSTS_WKUPINT(void)
 		USB_DeviceState = (USB_Device_IsAddressSet()) ? DEVICE_STATE_Addressed :
 		                  DEVICE_STATE_Powered;
 }
+#endif
+
+#if defined(USB_CAN_BE_HOST)
+/*
+ * Handle host port interrupt. The port change flags are write-one-to-clear, and
+ * so is the port enable bit, which must never be written back as a one.
+ */
+static void Handle_USB_GINTSTS_PRTINT(void)
+{
+	uint32_t hprt = USB->HPRT;
+
+	USB->HPRT = (hprt & ~(USB_HOST_HPRT_WC_BITMASK)) |
+	            (hprt & (USB_HPRT_PRTCONNDET | USB_HPRT_PRTENCHNG | USB_HPRT_PRTOVRCURRCHNG));
+
+	if ((hprt & USB_HPRT_PRTOVRCURRCHNG) && (hprt & USB_HPRT_PRTOVRCURRACT)) {
+		USB_Host_VBUS_Auto_Off();
+
+		EVENT_USB_Host_HostError(HOST_ERROR_VBusVoltageDip);
+
+		if (USB_HostState != HOST_STATE_Unattached) {
+			Pipe_ClearPipes();
+			USB_HostState = HOST_STATE_Unattached;
+			EVENT_USB_Host_DeviceUnattached();
+		}
+
+		return;
+	}
+
+	if ((hprt & USB_HPRT_PRTCONNDET) && (USB_HostState == HOST_STATE_Unattached)) {
+		USB_HostState = HOST_STATE_Powered;
+		EVENT_USB_Host_DeviceAttached();
+	}
+}
+
+/*
+ * Handle host channel interrupt.
+ */
+static void Handle_USB_GINTSTS_HCHINT(void)
+{
+	Pipe_HandleChannelInterrupts();
+}
+
+/*
+ * Handle device disconnect interrupt. The channels are torn down straight away
+ * so that any transfer in progress is completed with an error.
+ */
+static void Handle_USB_GINTSTS_DISCONNINT(void)
+{
+	USB->GINTSTS = USB_GINTSTS_DISCONNINT;
+
+	Pipe_ClearPipes();
+
+	if (USB_HostState != HOST_STATE_Unattached) {
+		USB_HostState = HOST_STATE_Unattached;
+		EVENT_USB_Host_DeviceUnattached();
+	}
+}
+
+/*
+ * Handle Start Of Frame (SOF) interrupt, which also paces the periodic pipes.
+ */
+static void Handle_USB_GINTSTS_SOF(void)
+{
+	USB->GINTSTS = USB_GINTSTS_SOF;
+
+	Pipe_ScheduleChannels();
+
+#if !defined(NO_SOF_EVENTS)
+	if (USB_Host_SOFEvents)
+		EVENT_USB_Host_StartOfFrame();
+#endif
+}
+#endif
 
 #if defined(INTERRUPT_CONTROL_ENDPOINT) && defined(USB_CAN_BE_DEVICE)
 ISR(USB_COM_vect)
@@ -66,6 +66,9 @@ enum USB_Interrupts_t {
 	USB_GINT_IEPINT,	/* bit 18 */
 	USB_GINT_ENUMDONE,	/* bit 13*/
 	USB_GINT_USBRST,	/* bit 12 */
+	USB_GINT_DISCONNINT,	/* bit 29 */
+	USB_GINT_HCHINT,	/* bit 25 */
+	USB_GINT_PRTINT,	/* bit 24 */
 	USB_GINT_USBSUSP,	/* bit 11 */
 	USB_GINT_SOF,		/* bit 3 */
 	USB_INT_VREGOSH,	/* IF register */
@@ -95,6 +98,15 @@ static inline void USB_INT_Enable(const uint8_t Interrupt)
 	case USB_GINT_USBRST:
 		USB->GINTMSK |= USB_GINTMSK_USBRSTMSK;
 		break;
+	case USB_GINT_DISCONNINT:
+		USB->GINTMSK |= USB_GINTMSK_DISCONNINTMSK;
+		break;
+	case USB_GINT_HCHINT:
+		USB->GINTMSK |= USB_GINTMSK_HCHINTMSK;
+		break;
+	case USB_GINT_PRTINT:
+		USB->GINTMSK |= USB_GINTMSK_PRTINTMSK;
+		break;
 	case USB_GINT_USBSUSP:
 		USB->GINTMSK |= USB_GINTMSK_USBSUSPMSK;
 		break;
@@ -136,6 +148,15 @@ static inline void USB_INT_Disable(const uint8_t Interrupt)
 	case USB_GINT_USBRST:
 		USB->GINTMSK &= ~USB_GINTMSK_USBRSTMSK;
 		break;
+	case USB_GINT_DISCONNINT:
+		USB->GINTMSK &= ~USB_GINTMSK_DISCONNINTMSK;
+		break;
+	case USB_GINT_HCHINT:
+		USB->GINTMSK &= ~USB_GINTMSK_HCHINTMSK;
+		break;
+	case USB_GINT_PRTINT:
+		USB->GINTMSK &= ~USB_GINTMSK_PRTINTMSK;
+		break;
 	case USB_GINT_USBSUSP:
 		USB->GINTMSK &= ~USB_GINTMSK_USBSUSPMSK;
 		break;
@@ -158,28 +179,31 @@ static inline void USB_INT_Clear(const uint8_t Interrupt)
 {
 	switch (Interrupt) {
 	case USB_GINT_WKUPINT:
-		USB->GINTSTS |= USB_GINTSTS_WKUPINT;
+		USB->GINTSTS = USB_GINTSTS_WKUPINT;
 		break;
 	case USB_GINT_RESETDET:
-		USB->GINTSTS |= USB_GINTSTS_RESETDET;
+		USB->GINTSTS = USB_GINTSTS_RESETDET;
 		break;
 	case USB_GINT_OEPINT:
-		USB->GINTSTS |= USB_GINTSTS_OEPINT;
+		USB->GINTSTS = USB_GINTSTS_OEPINT;
 		break;
 	case USB_GINT_IEPINT:
-		USB->GINTSTS |= USB_GINTSTS_IEPINT;
+		USB->GINTSTS = USB_GINTSTS_IEPINT;
 		break;
 	case USB_GINT_ENUMDONE:
-		USB->GINTSTS |= USB_GINTSTS_ENUMDONE;
+		USB->GINTSTS = USB_GINTSTS_ENUMDONE;
 		break;
 	case USB_GINT_USBRST:
-		USB->GINTSTS |= USB_GINTSTS_USBRST;
+		USB->GINTSTS = USB_GINTSTS_USBRST;
+		break;
+	case USB_GINT_DISCONNINT:
+		USB->GINTSTS = USB_GINTSTS_DISCONNINT;
 		break;
 	case USB_GINT_USBSUSP:
-		USB->GINTSTS |= USB_GINTSTS_USBSUSP;
+		USB->GINTSTS = USB_GINTSTS_USBSUSP;
 		break;
 	case USB_GINT_SOF:
-		USB->GINTSTS |= USB_GINTSTS_SOF;
+		USB->GINTSTS = USB_GINTSTS_SOF;
 		break;
 	case USB_INT_VREGOSH:
 		USB->IFC = USB_IFC_VREGOSH;
@@ -215,6 +239,15 @@ static inline bool USB_INT_IsEnabled(const uint8_t Interrupt)
 	case USB_GINT_USBRST:
 		tmp = USB->GINTMSK & USB_GINTMSK_USBRSTMSK;
 		break;
+	case USB_GINT_DISCONNINT:
+		tmp = USB->GINTMSK & USB_GINTMSK_DISCONNINTMSK;
+		break;
+	case USB_GINT_HCHINT:
+		tmp = USB->GINTMSK & USB_GINTMSK_HCHINTMSK;
+		break;
+	case USB_GINT_PRTINT:
+		tmp = USB->GINTMSK & USB_GINTMSK_PRTINTMSK;
+		break;
 	case USB_GINT_USBSUSP:
 		tmp = USB->GINTMSK & USB_GINTMSK_USBSUSPMSK;
 		break;
@@ -256,6 +289,15 @@ static inline bool USB_INT_HasOccurred(const uint8_t Interrupt)
 	case USB_GINT_USBRST:
 		tmp = USB->GINTSTS & USB_GINTSTS_USBRST;
 		break;
+	case USB_GINT_DISCONNINT:
+		tmp = USB->GINTSTS & USB_GINTSTS_DISCONNINT;
+		break;
+	case USB_GINT_HCHINT:
+		tmp = USB->GINTSTS & USB_GINTSTS_HCHINT;
+		break;
+	case USB_GINT_PRTINT:
+		tmp = USB->GINTSTS & USB_GINTSTS_PRTINT;
+		break;
 	case USB_GINT_USBSUSP:
 		tmp = USB->GINTSTS & USB_GINTSTS_USBSUSP;
 		break;
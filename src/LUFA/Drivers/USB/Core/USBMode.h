@@ -69,7 +69,11 @@
 		#include "../../../Common/Common.h"
 
 	#define __EFM32GG__
-	#define USB_DEVICE_ONLY
+
+	/* The EFM32GG port has no dual role support, it is fixed to device mode unless USB_HOST_ONLY is given */
+	#if !defined(USB_HOST_ONLY) && !defined(USB_DEVICE_ONLY)
+		#define USB_DEVICE_ONLY
+	#endif
 
 	/* Public Interface - May be used in end-application: */
 	#if defined(__DOXYGEN__)
@@ -250,6 +254,7 @@
 				#define USB_CAN_BE_DEVICE
 			#elif (defined(__EFM32GG__))
 				#define USB_CAN_BE_DEVICE
+				#define USB_CAN_BE_HOST
 			#endif
 
 			#if (defined(USB_HOST_ONLY) && defined(USB_DEVICE_ONLY))
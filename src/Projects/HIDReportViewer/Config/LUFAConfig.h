@@ -54,6 +54,7 @@
 //		#define HID_MAX_COLLECTIONS              {Insert Value Here}
 //		#define HID_MAX_REPORTITEMS              {Insert Value Here}
 //		#define HID_MAX_REPORT_IDS               {Insert Value Here}
+		#define HID_USE_PARSER_ARENA
 //		#define NO_CLASS_DRIVER_AUTOFLUSH
 
 		/* General USB Driver Related Tokens: */
@@ -36,8 +36,15 @@
 
 #include "HIDReportViewer.h"
 
+/** Arena holding the processed HID report items, sized for the application rather than by the parser's fixed item limits */
+static uint8_t HIDParserArena[HID_PARSER_ARENA_SIZE];
+
 /** Processed HID report descriptor items structure, containing information on each HID report element */
-static HID_ReportInfo_t HIDReportInfo;
+static HID_ReportInfo_t HIDReportInfo =
+	{
+		.Arena     = HIDParserArena,
+		.ArenaSize = sizeof(HIDParserArena),
+	};
 
 /** LUFA HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
@@ -67,6 +67,9 @@
 		/** LED mask for the library LED driver, to indicate that the USB interface is busy. */
 		#define LEDMASK_USB_BUSY         (LEDS_LED1 | LEDS_LED3 | LEDS_LED4)
 
+		/** Size in bytes of the HID parser's arena, holding the parsed report items and the collections they reference. */
+		#define HID_PARSER_ARENA_SIZE    2048
+
 	/* Function Prototypes: */
 		void SetupHardware(void);
 		void RetrieveDeviceData(void);
@@ -97,9 +97,15 @@ int main(void)
 
 	for (;;)
 	{
-		MIDI_EventPacket_t ReceivedMIDIEvent;
-		if (MIDI_Device_ReceiveEventPacket(&Keyboard_MIDI_Interface, &ReceivedMIDIEvent))
+		/* Fetch every event of a received packet at once, so that chords and runs of notes are not spread over several loops */
+		MIDI_EventPacket_t ReceivedMIDIEvents[MIDI_STREAM_EPSIZE / sizeof(MIDI_EventPacket_t)];
+		uint8_t            TotalEvents = MIDI_Device_ReceiveEvents(&Keyboard_MIDI_Interface, ReceivedMIDIEvents,
+		                                                           (sizeof(ReceivedMIDIEvents) / sizeof(ReceivedMIDIEvents[0])));
+
+		for (uint8_t CurrEvent = 0; CurrEvent < TotalEvents; CurrEvent++)
 		{
+			MIDI_EventPacket_t ReceivedMIDIEvent = ReceivedMIDIEvents[CurrEvent];
+
 			if ((ReceivedMIDIEvent.Event == MIDI_EVENT(0, MIDI_COMMAND_NOTE_ON)) && ((ReceivedMIDIEvent.Data1 & 0x0F) == 0))
 			{
 				DDSNoteData* LRUNoteStruct = &NoteData[0];
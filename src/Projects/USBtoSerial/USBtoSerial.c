@@ -37,13 +37,15 @@
 #include "USBtoSerial.h"
 
 /** Circular buffer to hold data from the host before it is sent to the device via the serial port. */
-static RingBuffer_t USBtoUSART_Buffer;
+static RingBufferSPSC_t USBtoUSART_Buffer;
 
 /** Underlying data buffer for \ref USBtoUSART_Buffer, where the stored bytes are located. */
 static uint8_t      USBtoUSART_Buffer_Data[128];
 
-/** Circular buffer to hold data from the serial port before it is sent to the host. */
-static RingBuffer_t USARTtoUSB_Buffer;
+/** Circular buffer to hold data from the serial port before it is sent to the host. The USART receive
+ *  ISR is the only producer and the main loop the only consumer, so neither side masks interrupts.
+ */
+static RingBufferSPSC_t USARTtoUSB_Buffer;
 
 /** Underlying data buffer for \ref USARTtoUSB_Buffer, where the stored bytes are located. */
 static uint8_t      USARTtoUSB_Buffer_Data[128];
@@ -86,8 +88,8 @@ int main(void)
 {
 	SetupHardware();
 
-	RingBuffer_InitBuffer(&USBtoUSART_Buffer, USBtoUSART_Buffer_Data, sizeof(USBtoUSART_Buffer_Data));
-	RingBuffer_InitBuffer(&USARTtoUSB_Buffer, USARTtoUSB_Buffer_Data, sizeof(USARTtoUSB_Buffer_Data));
+	RingBufferSPSC_InitBuffer(&USBtoUSART_Buffer, USBtoUSART_Buffer_Data, sizeof(USBtoUSART_Buffer_Data));
+	RingBufferSPSC_InitBuffer(&USARTtoUSB_Buffer, USARTtoUSB_Buffer_Data, sizeof(USARTtoUSB_Buffer_Data));
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 	GlobalInterruptEnable();
@@ -95,16 +97,17 @@ int main(void)
 	for (;;)
 	{
 		/* Only try to read in bytes from the CDC interface if the transmit buffer is not full */
-		if (!(RingBuffer_IsFull(&USBtoUSART_Buffer)))
+		if (!(RingBufferSPSC_IsFull(&USBtoUSART_Buffer)))
 		{
 			int16_t ReceivedByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
 
 			/* Store received byte into the USART transmit buffer */
 			if (!(ReceivedByte < 0))
-			  RingBuffer_Insert(&USBtoUSART_Buffer, ReceivedByte);
+			  RingBufferSPSC_Insert(&USBtoUSART_Buffer, ReceivedByte);
 		}
 
-		uint16_t BufferCount = RingBuffer_GetCount(&USARTtoUSB_Buffer);
+		const uint8_t* BufferSpan;
+		uint16_t       BufferCount = RingBufferSPSC_GetRemoveSpan(&USARTtoUSB_Buffer, &BufferSpan);
 		if (BufferCount)
 		{
 			Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
@@ -117,25 +120,16 @@ int main(void)
 				 * while a Zero Length Packet (ZLP) to terminate the transfer is sent if the host isn't listening */
 				uint8_t BytesToSend = MIN(BufferCount, (CDC_TXRX_EPSIZE - 1));
 
-				/* Read bytes from the USART receive buffer into the USB IN endpoint */
-				while (BytesToSend--)
-				{
-					/* Try to send the next byte of data to the host, abort if there is an error without dequeuing */
-					if (CDC_Device_SendByte(&VirtualSerial_CDC_Interface,
-											RingBuffer_Peek(&USARTtoUSB_Buffer)) != ENDPOINT_READYWAIT_NoError)
-					{
-						break;
-					}
-
-					/* Dequeue the already sent byte from the buffer now we have confirmed that no transmission error occurred */
-					RingBuffer_Remove(&USARTtoUSB_Buffer);
-				}
+				/* Write the contiguous span of the USART receive buffer into the USB IN endpoint, and only dequeue
+				 * the sent bytes from the buffer once we have confirmed that no transmission error occurred */
+				if (CDC_Device_SendData(&VirtualSerial_CDC_Interface, BufferSpan, BytesToSend) == ENDPOINT_RWSTREAM_NoError)
+				  RingBufferSPSC_CommitRemove(&USARTtoUSB_Buffer, BytesToSend);
 			}
 		}
 
 		/* Load the next byte from the USART transmit buffer into the USART */
-		if (!(RingBuffer_IsEmpty(&USBtoUSART_Buffer)))
-		  Serial_SendByte(RingBuffer_Remove(&USBtoUSART_Buffer));
+		if (!(RingBufferSPSC_IsEmpty(&USBtoUSART_Buffer)))
+		  Serial_SendByte(RingBufferSPSC_Remove(&USBtoUSART_Buffer));
 
 		CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
 		USB_USBTask();
@@ -194,8 +188,8 @@ ISR(USART1_RX_vect, ISR_BLOCK)
 {
 	uint8_t ReceivedByte = UDR1;
 
-	if (USB_DeviceState == DEVICE_STATE_Configured)
-	  RingBuffer_Insert(&USARTtoUSB_Buffer, ReceivedByte);
+	if ((USB_DeviceState == DEVICE_STATE_Configured) && !(RingBufferSPSC_IsFull(&USARTtoUSB_Buffer)))
+	  RingBufferSPSC_Insert(&USARTtoUSB_Buffer, ReceivedByte);
 }
 
 /** Event handler for the CDC Class driver Line Encoding Changed event.
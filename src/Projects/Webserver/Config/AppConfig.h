@@ -47,6 +47,9 @@
 	#define ENABLE_DHCP_SERVER
 	#define ENABLE_TELNET_SERVER
 	#define MAX_URI_LENGTH                50
+	#define HTTP_SERVER_READAHEAD_BUFFERS 1
+	#define HTTP_SERVER_READAHEAD_SIZE    1536
+	#define HTTP_SERVER_LINKMAP_SIZE      8
 
 	#define DEVICE_IP_ADDRESS             (uint8_t[]){ 10,   0,   0,   2}
 	#define DEVICE_NETMASK                (uint8_t[]){255, 255, 255,   0}
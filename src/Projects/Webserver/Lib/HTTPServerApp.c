@@ -43,8 +43,14 @@
 const char PROGMEM HTTP200Header[] = "HTTP/1.1 200 OK\r\n"
                                      "Server: LUFA " LUFA_VERSION_STRING "\r\n"
                                      "Connection: close\r\n"
-                                     "MIME-version: 1.0\r\n"
-                                     "Content-Type: ";
+                                     "MIME-version: 1.0\r\n";
+
+/** HTTP server response header, for transmission when the client's cached copy of the requested file is current. This
+ *  indicates to the host that the copy can be used, and is followed by the file's entity tag.
+ */
+const char PROGMEM HTTP304Header[] = "HTTP/1.1 304 Not Modified\r\n"
+                                     "Server: LUFA " LUFA_VERSION_STRING "\r\n"
+                                     "Connection: close\r\n";
 
 /** HTTP server response header, for transmission before a resource not found error. This indicates to the host that the given
  *  URL is invalid, and gives extra error information.
@@ -56,6 +62,17 @@ const char PROGMEM HTTP404Header[] = "HTTP/1.1 404 Not Found\r\n"
                                      "Content-Type: text/plain\r\n\r\n"
                                      "Error 404: File Not Found: /";
 
+/** HTTP server response header, for transmission when the requested file is only stored compressed and the client does not
+ *  accept compressed files. This indicates to the host that the file cannot be sent in an encoding it accepts.
+ */
+const char PROGMEM HTTP406Header[] = "HTTP/1.1 406 Not Acceptable\r\n"
+                                     "Server: LUFA " LUFA_VERSION_STRING "\r\n"
+                                     "Connection: close\r\n"
+                                     "Vary: Accept-Encoding\r\n"
+                                     "MIME-version: 1.0\r\n"
+                                     "Content-Type: text/plain\r\n\r\n"
+                                     "Error 406: Compressed File Not Accepted: /";
+
 /** Default filename to fetch when a directory is requested */
 const char PROGMEM DefaultDirFileName[] = "index.htm";
 
@@ -80,6 +97,13 @@ const MIME_Type_t MIMETypes[] =
 /** FATFs structure to hold the internal state of the FAT driver for the Dataflash contents. */
 FATFS DiskFATState;
 
+#if (HTTP_SERVER_READAHEAD_BUFFERS > 0)
+/** Pool of read-ahead buffers, each allocated to a HTTP connection while it is sending a file so that the file data
+ *  in flight can be retransmitted without being read from the Dataflash again.
+ */
+static HTTPServer_ReadAhead_t ReadAheadBuffers[HTTP_SERVER_READAHEAD_BUFFERS];
+#endif
+
 
 /** Initialization function for the simple HTTP webserver. */
 void HTTPServerApp_Init(void)
@@ -100,6 +124,9 @@ void HTTPServerApp_Callback(void)
 
 	if (uip_aborted() || uip_timedout() || uip_closed())
 	{
+		/* No further events will occur on the connection, so release its file and read-ahead buffer now */
+		HTTPServerApp_CloseRequestedFile();
+
 		/* Lock to the closed state so that no further processing will occur on the connection */
 		AppState->HTTPServer.CurrentState  = WEBSERVER_STATE_Closing;
 		AppState->HTTPServer.NextState     = WEBSERVER_STATE_Closing;
@@ -111,22 +138,38 @@ void HTTPServerApp_Callback(void)
 		AppState->HTTPServer.CurrentState  = WEBSERVER_STATE_OpenRequestedFile;
 		AppState->HTTPServer.NextState     = WEBSERVER_STATE_OpenRequestedFile;
 		AppState->HTTPServer.FileOpen      = false;
+		AppState->HTTPServer.AssetFound    = false;
 		AppState->HTTPServer.ACKedFilePos  = 0;
 		AppState->HTTPServer.SentChunkSize = 0;
+		AppState->HTTPServer.ReadAhead     = NULL;
 	}
 
 	if (uip_acked())
 	{
+		HTTPServer_ReadAhead_t* const ReadAhead = AppState->HTTPServer.ReadAhead;
+
 		/* Add the amount of ACKed file data to the total sent file bytes counter */
 		AppState->HTTPServer.ACKedFilePos += AppState->HTTPServer.SentChunkSize;
 
+		/* Discard the ACKed data from the front of the read-ahead ring, keeping any data read beyond it */
+		if (ReadAhead != NULL)
+		{
+			ReadAhead->Start  += AppState->HTTPServer.SentChunkSize;
+			ReadAhead->Length -= AppState->HTTPServer.SentChunkSize;
+
+			if (ReadAhead->Start >= HTTP_SERVER_READAHEAD_SIZE)
+			  ReadAhead->Start -= HTTP_SERVER_READAHEAD_SIZE;
+
+			AppState->HTTPServer.SentChunkSize = 0;
+		}
+
 		/* Progress to the next state once the current state's data has been ACKed */
 		AppState->HTTPServer.CurrentState = AppState->HTTPServer.NextState;
 	}
 
-	if (uip_rexmit())
+	if (uip_rexmit() && AppState->HTTPServer.FileOpen && (AppState->HTTPServer.ReadAhead == NULL))
 	{
-		/* Return file pointer to the last ACKed position */
+		/* Return file pointer to the last ACKed position, as the unACKed data is not held in a read-ahead window */
 		f_lseek(&AppState->HTTPServer.FileHandle, AppState->HTTPServer.ACKedFilePos);
 	}
 
@@ -145,8 +188,7 @@ void HTTPServerApp_Callback(void)
 				break;
 			case WEBSERVER_STATE_Closing:
 				/* Connection is being terminated for some reason - close file handle */
-				f_close(&AppState->HTTPServer.FileHandle);
-				AppState->HTTPServer.FileOpen = false;
+				HTTPServerApp_CloseRequestedFile();
 
 				/* If connection is not already closed, close it */
 				uip_close();
@@ -193,15 +235,142 @@ static void HTTPServerApp_OpenRequestedFile(void)
 		          (sizeof(AppState->HTTPServer.FileName) - FileNameLen));
 	}
 
+	/* Serve the file from the web asset bundle if it is stored there, rather than from the Dataflash disk */
+	AppState->HTTPServer.AssetFound         = WebAssets_Find(AppState->HTTPServer.FileName, strlen(AppState->HTTPServer.FileName),
+	                                                         &AppState->HTTPServer.Asset);
+	AppState->HTTPServer.AssetNotAcceptable = false;
+
+	if (AppState->HTTPServer.AssetFound)
+	{
+		uint8_t ETagLength;
+		uint8_t AcceptEncodingLength;
+		char*   ETag           = HTTPServerApp_GetRequestHeader(AppData, uip_datalen(), "If-None-Match:", &ETagLength);
+		char*   AcceptEncoding = HTTPServerApp_GetRequestHeader(AppData, uip_datalen(), "Accept-Encoding:", &AcceptEncodingLength);
+
+		/* Check if the client already holds the current version of the file from a previous request */
+		AppState->HTTPServer.AssetNotModified = ((ETag != NULL) &&
+		                                         WebAssets_MatchETag(&AppState->HTTPServer.Asset, ETag, ETagLength));
+
+		if (AppState->HTTPServer.AssetNotModified ||
+		    WebAssets_IsEncodingAccepted(&AppState->HTTPServer.Asset, AcceptEncoding, AcceptEncodingLength))
+		{
+			AppState->HTTPServer.CurrentState = WEBSERVER_STATE_SendResponseHeader;
+			AppState->HTTPServer.NextState    = WEBSERVER_STATE_SendResponseHeader;
+			return;
+		}
+
+		/* Client cannot decode the compressed bundled file, fall back to an uncompressed copy on the Dataflash disk */
+		AppState->HTTPServer.AssetFound         = false;
+		AppState->HTTPServer.AssetNotAcceptable = true;
+	}
+
 	/* Try to open the file from the Dataflash disk */
 	AppState->HTTPServer.FileOpen     = (f_open(&AppState->HTTPServer.FileHandle, AppState->HTTPServer.FileName,
 	                                            (FA_OPEN_EXISTING | FA_READ)) == FR_OK);
 
+	#if (HTTP_SERVER_READAHEAD_BUFFERS > 0)
+	if (AppState->HTTPServer.FileOpen)
+	{
+		/* Try to allocate a read-ahead buffer - if none are free, the file will be sent one chunk at a time instead */
+		for (uint8_t i = 0; i < HTTP_SERVER_READAHEAD_BUFFERS; i++)
+		{
+			HTTPServer_ReadAhead_t* const ReadAhead = &ReadAheadBuffers[i];
+
+			if (ReadAhead->Owner != NULL)
+			  continue;
+
+			ReadAhead->Owner  = uip_conn;
+			ReadAhead->Start  = 0;
+			ReadAhead->Length = 0;
+			AppState->HTTPServer.ReadAhead = ReadAhead;
+
+			/* Build the file's cluster link map, so that reads need not follow the FAT chain on the Dataflash */
+			ReadAhead->LinkMap[0]                 = HTTP_SERVER_LINKMAP_SIZE;
+			AppState->HTTPServer.FileHandle.cltbl = ReadAhead->LinkMap;
+
+			/* Fall back to normal seeking if the file is too fragmented for its link map to fit */
+			if (f_lseek(&AppState->HTTPServer.FileHandle, CREATE_LINKMAP) != FR_OK)
+			  AppState->HTTPServer.FileHandle.cltbl = NULL;
+
+			break;
+		}
+	}
+	#endif
+
 	/* Lock to the SendResponseHeader state until connection terminated */
 	AppState->HTTPServer.CurrentState = WEBSERVER_STATE_SendResponseHeader;
 	AppState->HTTPServer.NextState    = WEBSERVER_STATE_SendResponseHeader;
 }
 
+/** Locates the value of a header line in the HTTP request received from the client. This is kept identical to the
+ *  \c GetRequestHeader() function of the RNDISEthernet demos.
+ *
+ *  \param[in]  Request        Pointer to the received request
+ *  \param[in]  RequestLength  Length of the received request in bytes
+ *  \param[in]  HeaderName     Name of the header to locate, including the trailing ':' separator
+ *  \param[out] ValueLength    Length of the header value in characters
+ *
+ *  \return Pointer to the header value within the request, or \c NULL if the request does not contain the header
+ */
+static char* HTTPServerApp_GetRequestHeader(char* const Request,
+                                            const uint16_t RequestLength,
+                                            const char* HeaderName,
+                                            uint8_t* const ValueLength)
+{
+	char*   Line             = Request;
+	char*   RequestEnd       = &Request[RequestLength];
+	uint8_t HeaderNameLength = strlen(HeaderName);
+
+	/* Skip over the request line, then search each header line in turn */
+	while ((Line = memchr(Line, '\n', (RequestEnd - Line))) != NULL)
+	{
+		Line++;
+
+		if (((RequestEnd - Line) < HeaderNameLength) || (strncasecmp(Line, HeaderName, HeaderNameLength) != 0))
+		  continue;
+
+		char* Value = &Line[HeaderNameLength];
+
+		while ((Value != RequestEnd) && ((*Value == ' ') || (*Value == '\t')))
+		  Value++;
+
+		*ValueLength = 0;
+
+		/* Value runs to the end of the header line, omitting any trailing whitespace */
+		while (((Value + *ValueLength) != RequestEnd) && (Value[*ValueLength] != '\r') && (Value[*ValueLength] != '\n'))
+		{
+			if (++(*ValueLength) == 0)
+			  return NULL;
+		}
+
+		while (*ValueLength && ((Value[*ValueLength - 1] == ' ') || (Value[*ValueLength - 1] == '\t')))
+		  (*ValueLength)--;
+
+		return Value;
+	}
+
+	return NULL;
+}
+
+/** Closes the file requested by the current HTTP connection if it is open, and releases the connection's read-ahead
+ *  buffer back to the pool.
+ */
+static void HTTPServerApp_CloseRequestedFile(void)
+{
+	uip_tcp_appstate_t* const AppState    = &uip_conn->appstate;
+
+	if (AppState->HTTPServer.FileOpen)
+	{
+		f_close(&AppState->HTTPServer.FileHandle);
+		AppState->HTTPServer.FileOpen = false;
+	}
+
+	if ((AppState->HTTPServer.ReadAhead != NULL) && (AppState->HTTPServer.ReadAhead->Owner == uip_conn))
+	  AppState->HTTPServer.ReadAhead->Owner = NULL;
+
+	AppState->HTTPServer.ReadAhead = NULL;
+}
+
 /** HTTP Server State handler for the HTTP Response Header Send state. This state manages the transmission of
  *  the HTTP response header to the receiving HTTP client.
  */
@@ -213,11 +382,38 @@ static void HTTPServerApp_SendResponseHeader(void)
 	char* Extension     = strpbrk(AppState->HTTPServer.FileName, ".");
 	bool  FoundMIMEType = false;
 
+	/* Files in the web asset bundle are sent with their precomputed headers */
+	if (AppState->HTTPServer.AssetFound)
+	{
+		if (AppState->HTTPServer.AssetNotModified)
+		{
+			/* Copy over the HTTP 304 response header and the file's entity tag, and send them to the receiving client */
+			strcpy_P(AppData, HTTP304Header);
+			strcat_P(AppData, PSTR("ETag: "));
+			strcat_P(AppData, AppState->HTTPServer.Asset.ETag);
+			strcat_P(AppData, PSTR("\r\n\r\n"));
+			uip_send(AppData, strlen(AppData));
+
+			AppState->HTTPServer.NextState = WEBSERVER_STATE_Closing;
+			return;
+		}
+
+		/* Copy over the HTTP 200 response header and the file's headers, and send them to the receiving client */
+		strcpy_P(AppData, HTTP200Header);
+		strcat_P(AppData, AppState->HTTPServer.Asset.Headers);
+		strcat_P(AppData, PSTR("\r\n"));
+		uip_send(AppData, strlen(AppData));
+
+		AppState->HTTPServer.NextState = WEBSERVER_STATE_SendData;
+		return;
+	}
+
 	/* If the file isn't already open, it wasn't found - send back a 404 error response and abort */
 	if (!(AppState->HTTPServer.FileOpen))
 	{
-		/* Copy over the HTTP 404 response header and send it to the receiving client */
-		strcpy_P(AppData, HTTP404Header);
+		/* Copy over the HTTP 404 response header, or the 406 header if only a compressed copy was found, and send it to the
+		 * receiving client */
+		strcpy_P(AppData, (AppState->HTTPServer.AssetNotAcceptable ? HTTP406Header : HTTP404Header));
 		strcat(AppData, AppState->HTTPServer.FileName);
 		uip_send(AppData, strlen(AppData));
 
@@ -228,6 +424,12 @@ static void HTTPServerApp_SendResponseHeader(void)
 	/* Copy over the HTTP 200 response header and send it to the receiving client */
 	strcpy_P(AppData, HTTP200Header);
 
+	/* Caches must not serve this uncompressed copy to clients which accept the compressed bundled file */
+	if (AppState->HTTPServer.AssetNotAcceptable)
+	  strcat_P(AppData, PSTR("Vary: Accept-Encoding\r\n"));
+
+	strcat_P(AppData, PSTR("Content-Type: "));
+
 	/* Check to see if a MIME type for the requested file's extension was found */
 	if (Extension != NULL)
 	{
@@ -262,15 +464,99 @@ static void HTTPServerApp_SendResponseHeader(void)
 
 /** HTTP Server State handler for the Data Send state. This state manages the transmission of file chunks
  *  to the receiving HTTP client.
+ *
+ *  When the connection holds a read-ahead buffer, the file is read ahead into its ring in large blocks and each chunk
+ *  is sent from the front of the buffered data, so that a retransmitted chunk is resent from RAM rather than being
+ *  read again from the Dataflash. Otherwise, each chunk is read from the file directly into the outgoing packet.
  */
 static void HTTPServerApp_SendData(void)
 {
-	uip_tcp_appstate_t* const AppState    = &uip_conn->appstate;
-	char*               const AppData     = (char*)uip_appdata;
+	uip_tcp_appstate_t*     const AppState  = &uip_conn->appstate;
+	char*                   const AppData   = (char*)uip_appdata;
+	HTTPServer_ReadAhead_t* const ReadAhead = AppState->HTTPServer.ReadAhead;
 
 	/* Get the maximum segment size for the current packet */
 	uint16_t MaxChunkSize = uip_mss();
 
+	if (AppState->HTTPServer.AssetFound)
+	{
+		uint16_t RemainingBytes = (AppState->HTTPServer.Asset.Length - AppState->HTTPServer.ACKedFilePos);
+
+		/* Nothing left to send once the entire file has been ACKed, close the connection on the next poll */
+		if (!(RemainingBytes))
+		{
+			AppState->HTTPServer.CurrentState = WEBSERVER_STATE_Closing;
+			AppState->HTTPServer.NextState    = WEBSERVER_STATE_Closing;
+			return;
+		}
+
+		/* Copy the next chunk of the file from FLASH, retransmissions being copied again from the last ACKed position */
+		AppState->HTTPServer.SentChunkSize = MIN(MaxChunkSize, RemainingBytes);
+		memcpy_P(AppData, &AppState->HTTPServer.Asset.Data[AppState->HTTPServer.ACKedFilePos], AppState->HTTPServer.SentChunkSize);
+
+		/* Send the next file chunk to the receiving client */
+		uip_send(AppData, AppState->HTTPServer.SentChunkSize);
+
+		/* Check if we are at the last chunk of the file, if so next ACK should close the connection */
+		if (AppState->HTTPServer.SentChunkSize == RemainingBytes)
+		  AppState->HTTPServer.NextState = WEBSERVER_STATE_Closing;
+
+		return;
+	}
+
+	if (ReadAhead != NULL)
+	{
+		/* Only choose a new chunk once the last has been ACKed, otherwise the unACKed chunk is sent again */
+		if (!(AppState->HTTPServer.SentChunkSize))
+		{
+			/* Top up the ring with the file data following that already buffered, in two reads if the free space wraps */
+			while (ReadAhead->Length < HTTP_SERVER_READAHEAD_SIZE)
+			{
+				uint16_t WritePos  = (ReadAhead->Start + ReadAhead->Length);
+				UINT     BytesRead = 0;
+
+				if (WritePos >= HTTP_SERVER_READAHEAD_SIZE)
+				  WritePos -= HTTP_SERVER_READAHEAD_SIZE;
+
+				uint16_t FreeSpan = MIN((HTTP_SERVER_READAHEAD_SIZE - ReadAhead->Length), (HTTP_SERVER_READAHEAD_SIZE - WritePos));
+
+				f_read(&AppState->HTTPServer.FileHandle, &ReadAhead->Data[WritePos], FreeSpan, &BytesRead);
+				ReadAhead->Length += BytesRead;
+
+				if (BytesRead != FreeSpan)
+				  break;
+			}
+
+			AppState->HTTPServer.SentChunkSize = MIN(MaxChunkSize, ReadAhead->Length);
+		}
+
+		/* Nothing left to send once the entire file has been ACKed, close the connection on the next poll */
+		if (!(AppState->HTTPServer.SentChunkSize))
+		{
+			AppState->HTTPServer.CurrentState = WEBSERVER_STATE_Closing;
+			AppState->HTTPServer.NextState    = WEBSERVER_STATE_Closing;
+			return;
+		}
+
+		/* Copy the chunk at the front of the ring into the packet, it remains buffered until ACKed */
+		uint16_t FirstSpan = MIN(AppState->HTTPServer.SentChunkSize, (HTTP_SERVER_READAHEAD_SIZE - ReadAhead->Start));
+
+		memcpy(AppData, &ReadAhead->Data[ReadAhead->Start], FirstSpan);
+		memcpy(&AppData[FirstSpan], ReadAhead->Data, (AppState->HTTPServer.SentChunkSize - FirstSpan));
+
+		/* Send the chunk to the receiving client */
+		uip_send(AppData, AppState->HTTPServer.SentChunkSize);
+
+		/* Check if this chunk ends the file, if so the next ACK should close the connection */
+		if (f_eof(&AppState->HTTPServer.FileHandle) &&
+		    (AppState->HTTPServer.SentChunkSize == ReadAhead->Length))
+		{
+			AppState->HTTPServer.NextState = WEBSERVER_STATE_Closing;
+		}
+
+		return;
+	}
+
 	/* Read the next chunk of data from the open file */
 	f_read(&AppState->HTTPServer.FileHandle, AppData, MaxChunkSize, &AppState->HTTPServer.SentChunkSize);
 
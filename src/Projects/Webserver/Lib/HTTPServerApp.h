@@ -41,6 +41,7 @@
 		#include <string.h>
 
 		#include <LUFA/Version.h>
+		#include <LUFA/Common/Common.h>
 
 		#include "Config/AppConfig.h"
 
@@ -66,16 +67,38 @@
 			char* MIMEType;  /**< Appropriate MIME type to send when the extension is encountered */
 		} MIME_Type_t;
 
+		/** Type define for a read-ahead buffer of the shared pool, which also holds the cluster link map of the file
+		 *  being read into it so that only the connection owning the buffer pays for one.
+		 */
+		typedef struct HTTPServer_ReadAhead
+		{
+			struct uip_conn* Owner; /**< Connection the buffer is allocated to, or \c NULL if the buffer is free */
+			uint16_t Start; /**< Index of the first unACKed byte of file data in the ring */
+			uint16_t Length; /**< Number of bytes of file data held in the ring, starting at \c Start */
+			DWORD    LinkMap[HTTP_SERVER_LINKMAP_SIZE]; /**< FatFs cluster link map of the file being read */
+			uint8_t  Data[HTTP_SERVER_READAHEAD_SIZE]; /**< Ring of file data read ahead of the last ACKed position */
+		} HTTPServer_ReadAhead_t;
+
 	/* Macros: */
 		/** TCP listen port for incoming HTTP traffic. */
 		#define HTTP_SERVER_PORT  80
 
+	/* Preprocessor Checks: */
+		#if (HTTP_SERVER_LINKMAP_SIZE < 4)
+			#error HTTP_SERVER_LINKMAP_SIZE must be at least 4 to hold the link map of a single fragment file.
+		#endif
+
 	/* Function Prototypes: */
 		void HTTPServerApp_Init(void);
 		void HTTPServerApp_Callback(void);
 
 		#if defined(INCLUDE_FROM_HTTPSERVERAPP_C)
 			static void HTTPServerApp_OpenRequestedFile(void);
+			static char* HTTPServerApp_GetRequestHeader(char* const Request,
+			                                            const uint16_t RequestLength,
+			                                            const char* HeaderName,
+			                                            uint8_t* const ValueLength);
+			static void HTTPServerApp_CloseRequestedFile(void);
 			static void HTTPServerApp_SendResponseHeader(void);
 			static void HTTPServerApp_SendData(void);
 		#endif
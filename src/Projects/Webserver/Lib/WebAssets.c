@@ -0,0 +1,305 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2014.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2014  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Web asset bundle, holding the contents of the web root directory as pre-encoded assets in FLASH memory.
+ *
+ *  This file was generated by http_asset_packer.py and should not be edited directly. Modify the files in the
+ *  web root directory instead, and regenerate the bundle from them.
+ */
+
+#include "WebAssets.h"
+
+/** Seed of the path hash function, chosen so that no two asset paths hash to the same slot. */
+#define WEB_ASSETS_HASH_SEED        0x0000
+
+/** Number of slots in the asset hash table, a power of two. */
+#define WEB_ASSETS_HASH_SLOTS       1
+
+/** Value of an asset hash table slot which does not hold an asset. */
+#define WEB_ASSETS_EMPTY_SLOT       0xFF
+
+/** Accept-Encoding header element which does not refer to the gzip content coding. */
+#define WEB_ASSETS_CODING_NONE      0
+
+/** Accept-Encoding header element which names the gzip content coding. */
+#define WEB_ASSETS_CODING_NAMED     1
+
+/** Accept-Encoding header element which refers to the gzip content coding through the "*" wildcard. */
+#define WEB_ASSETS_CODING_WILDCARD  2
+
+/* Asset 0: about.htm (673 bytes, encoded to 393 bytes) */
+static const char    PROGMEM Asset0Path[]    = "about.htm";
+static const char    PROGMEM Asset0Headers[] = "Content-Type: text/html\r\nContent-Encoding: gzip\r\nVary: Accept-Encoding\r\nContent-Length: 393\r\nETag: \"a4ddeff853b1f4b2\"\r\n";
+static const char    PROGMEM Asset0ETag[]    = "\"a4ddeff853b1f4b2\"";
+static const uint8_t PROGMEM Asset0Data[]    =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x52, 0xC1, 0x8A, 0xDC, 0x30,
+		0x0C, 0x3D, 0x4F, 0xBF, 0x42, 0xEC, 0xA5, 0x97, 0xD9, 0x84, 0xBD, 0x2E, 0x6E, 0x60, 0x60, 0x19,
+		0x5A, 0xD8, 0x43, 0xA1, 0x2D, 0x3D, 0xCB, 0xB1, 0x32, 0x76, 0xEB, 0x58, 0xC1, 0x56, 0x36, 0xCC,
+		0xDF, 0x57, 0x76, 0xA6, 0x2C, 0x03, 0xED, 0xC5, 0x8A, 0xA3, 0xA7, 0xF7, 0x9E, 0x1F, 0x32, 0x5E,
+		0xE6, 0x38, 0x7C, 0x38, 0x18, 0x4F, 0xE8, 0xB4, 0x1E, 0x8C, 0x04, 0x89, 0x54, 0xBF, 0x0E, 0x27,
+		0xCB, 0xAB, 0x80, 0x78, 0x82, 0xD7, 0x1F, 0xE7, 0x13, 0xFC, 0x24, 0x5B, 0x28, 0xBF, 0x51, 0xAE,
+		0xA8, 0xFE, 0x2F, 0xCC, 0xF4, 0xB7, 0x49, 0x63, 0xD9, 0x5D, 0x1B, 0x83, 0x7F, 0x1A, 0xEE, 0x07,
+		0x14, 0xF3, 0xD4, 0x3A, 0x4B, 0xE3, 0xFD, 0xEE, 0x43, 0x81, 0x05, 0x2F, 0x04, 0x5A, 0x1B, 0xC2,
+		0xC1, 0x94, 0x79, 0x6E, 0x52, 0x1B, 0x59, 0xC0, 0x52, 0x48, 0xC0, 0xAE, 0xC9, 0x45, 0x82, 0x22,
+		0x9C, 0x15, 0x10, 0x52, 0x6B, 0x3B, 0x7A, 0x0B, 0x23, 0x7D, 0x2C, 0x70, 0x7E, 0x3D, 0x7D, 0xFB,
+		0x0C, 0x33, 0xCD, 0x9C, 0xAF, 0x47, 0xC8, 0xA8, 0xCD, 0xAC, 0x08, 0x4C, 0xEF, 0x54, 0x2F, 0x28,
+		0x38, 0x45, 0x2C, 0xBE, 0x8A, 0xBA, 0x50, 0x7E, 0x77, 0x70, 0x0E, 0x91, 0x54, 0x3B, 0xE2, 0xF8,
+		0x4E, 0x79, 0xD3, 0xC1, 0xAC, 0x5A, 0x94, 0x04, 0x96, 0x4C, 0x8F, 0x23, 0xCF, 0x5A, 0xD4, 0x86,
+		0x3B, 0x02, 0x26, 0x07, 0x36, 0xF3, 0xA6, 0x4E, 0x0B, 0x78, 0x8E, 0x2E, 0xA4, 0x0B, 0x20, 0x8C,
+		0x6B, 0xCE, 0x15, 0x3E, 0xF2, 0x72, 0x05, 0x9E, 0xF4, 0xCF, 0x4E, 0xA4, 0x6F, 0x09, 0x3B, 0x5D,
+		0x95, 0x15, 0xC5, 0x83, 0x30, 0xAC, 0x45, 0x5F, 0x2B, 0x2A, 0x59, 0x44, 0xE3, 0xAA, 0x78, 0xC7,
+		0x5B, 0x8A, 0x8C, 0x8D, 0x4D, 0x3B, 0x78, 0xC1, 0x90, 0xBA, 0x3A, 0x62, 0x6C, 0x86, 0x7E, 0xD8,
+		0xCF, 0x7A, 0xDF, 0x3D, 0xAB, 0x4C, 0x50, 0x6E, 0x4E, 0x4A, 0x76, 0x17, 0x44, 0x7D, 0xD8, 0xCD,
+		0x7C, 0x4B, 0x12, 0x0B, 0x58, 0x9A, 0x34, 0xB3, 0x23, 0xAC, 0x49, 0x27, 0x8B, 0x3A, 0x6B, 0x8E,
+		0x54, 0xB3, 0x0E, 0x16, 0x9C, 0x09, 0x52, 0x3D, 0x34, 0x7D, 0x8C, 0x85, 0xEF, 0x73, 0xF8, 0xA7,
+		0x05, 0x53, 0x66, 0x8C, 0x71, 0xF8, 0x9A, 0xF9, 0x17, 0x8D, 0x02, 0x5F, 0x92, 0xF2, 0xCF, 0x28,
+		0x81, 0xD3, 0x33, 0x18, 0x04, 0x9F, 0x69, 0xFA, 0xF4, 0xE0, 0x45, 0x96, 0xE7, 0xBE, 0xDF, 0xB6,
+		0xAD, 0x8B, 0xEB, 0x84, 0x8F, 0x31, 0xD8, 0x8E, 0xF3, 0xE5, 0x61, 0xF8, 0x4F, 0xC3, 0xF4, 0x38,
+		0x74, 0xA6, 0xDF, 0xA9, 0xDB, 0x4E, 0x2D, 0x6D, 0x9F, 0xF6, 0x3D, 0xD2, 0x9D, 0x69, 0x9B, 0xF9,
+		0x07, 0x47, 0x8E, 0x00, 0x50, 0xA1, 0x02, 0x00, 0x00,
+	};
+
+/** Table of the assets stored in the bundle. */
+static const WebAsset_t PROGMEM AssetTable[WEB_ASSETS_TOTAL_ASSETS] =
+	{
+		{.Path = Asset0Path, .Headers = Asset0Headers, .ETag = Asset0ETag, .Data = Asset0Data, .Length = 393, .IsGzipEncoded = true},
+	};
+
+/** Perfect hash table of asset indexes, indexed by the hash of each asset's path. */
+static const uint8_t PROGMEM AssetHashTable[WEB_ASSETS_HASH_SLOTS] =
+	{
+		0,
+	};
+
+
+/** Hashes the given path to locate its slot in the asset hash table.
+ *
+ *  \param[in] Path        Path to hash
+ *  \param[in] PathLength  Length of the path in characters
+ *
+ *  \return Hash of the given path
+ */
+static uint16_t WebAssets_HashPath(const char* Path,
+                                   uint8_t PathLength)
+{
+	uint16_t Hash = WEB_ASSETS_HASH_SEED;
+
+	while (PathLength--)
+	  Hash = (((Hash << 5) + Hash) ^ (uint8_t)*(Path++));
+
+	return Hash;
+}
+
+/** Compares a string in RAM of the given length against a null terminated string stored in FLASH memory.
+ *
+ *  \param[in] String        String in RAM to compare, which need not be null terminated
+ *  \param[in] StringLength  Length of the string in RAM in characters
+ *  \param[in] FlashString   Null terminated string in FLASH to compare against
+ *
+ *  \return Boolean \c true if the two strings are identical, \c false otherwise
+ */
+static bool WebAssets_CompareString(const char* String,
+                                    uint8_t StringLength,
+                                    const char* FlashString)
+{
+	while (StringLength--)
+	{
+		if ((uint8_t)*(String++) != pgm_read_byte(FlashString++))
+		  return false;
+	}
+
+	return (pgm_read_byte(FlashString) == '\0');
+}
+
+/** Locates the asset stored under the given path in the bundle.
+ *
+ *  \param[in]  Path        Path of the asset relative to the web root without a leading '/', need not be null terminated
+ *  \param[in]  PathLength  Length of the path in characters
+ *  \param[out] Asset       Pointer to a location where the located asset's information is to be stored
+ *
+ *  \return Boolean \c true if the asset was found, \c false otherwise
+ */
+bool WebAssets_Find(const char* Path,
+                    const uint8_t PathLength,
+                    WebAsset_t* const Asset)
+{
+	uint8_t AssetIndex = pgm_read_byte(&AssetHashTable[WebAssets_HashPath(Path, PathLength) & (WEB_ASSETS_HASH_SLOTS - 1)]);
+
+	if (AssetIndex == WEB_ASSETS_EMPTY_SLOT)
+	  return false;
+
+	memcpy_P(Asset, &AssetTable[AssetIndex], sizeof(WebAsset_t));
+
+	/* Each slot holds the only asset that hashes to it, confirm that it is the one requested */
+	return WebAssets_CompareString(Path, PathLength, Asset->Path);
+}
+
+/** Determines if an entity tag supplied by the client, such as in a HTTP If-None-Match request header, matches the
+ *  current contents of an asset.
+ *
+ *  \param[in] Asset       Pointer to the asset to compare against
+ *  \param[in] ETag        Quoted entity tag supplied by the client, need not be null terminated
+ *  \param[in] ETagLength  Length of the entity tag in characters
+ *
+ *  \return Boolean \c true if the client's copy of the asset is current, \c false otherwise
+ */
+bool WebAssets_MatchETag(const WebAsset_t* const Asset,
+                         const char* ETag,
+                         const uint8_t ETagLength)
+{
+	return WebAssets_CompareString(ETag, ETagLength, Asset->ETag);
+}
+
+/** Determines if an element of a HTTP Accept-Encoding request header refers to the gzip content coding, either by name or
+ *  through the "*" wildcard, and if so whether it accepts the coding, i.e. does not give it a quality value of zero.
+ *
+ *  \param[in]  Element        Element of the header's comma separated list, need not be null terminated
+ *  \param[in]  ElementLength  Length of the element in characters
+ *  \param[out] IsAccepted     Set to \c true if the element's quality value is non-zero, when the element refers to gzip
+ *
+ *  \return One of the \c WEB_ASSETS_CODING_* values, giving how the element refers to the gzip coding
+ */
+static uint8_t WebAssets_MatchGzipCoding(const char* Element,
+                                         const uint8_t ElementLength,
+                                         bool* const IsAccepted)
+{
+	uint8_t Match;
+	uint8_t Start = 0;
+	uint8_t End;
+
+	while ((Start < ElementLength) && ((Element[Start] == ' ') || (Element[Start] == '\t')))
+	  Start++;
+
+	End = Start;
+
+	/* Coding name runs to the start of its parameters or the whitespace following it */
+	while ((End < ElementLength) && (Element[End] != ';') && (Element[End] != ' ') && (Element[End] != '\t'))
+	  End++;
+
+	if ((((End - Start) == 4) && (strncasecmp(&Element[Start], "gzip", 4) == 0)) ||
+	    (((End - Start) == 6) && (strncasecmp(&Element[Start], "x-gzip", 6) == 0)))
+	{
+		Match = WEB_ASSETS_CODING_NAMED;
+	}
+	else if (((End - Start) == 1) && (Element[Start] == '*'))
+	{
+		Match = WEB_ASSETS_CODING_WILDCARD;
+	}
+	else
+	{
+		return WEB_ASSETS_CODING_NONE;
+	}
+
+	*IsAccepted = true;
+
+	/* Search the coding's parameters for a quality value, which rejects the coding if it is zero */
+	for (uint8_t i = End; i < ElementLength; i++)
+	{
+		if (Element[i] != ';')
+		  continue;
+
+		while (((i + 1) < ElementLength) && ((Element[i + 1] == ' ') || (Element[i + 1] == '\t')))
+		  i++;
+
+		if (((i + 3) > ElementLength) || ((Element[i + 1] != 'q') && (Element[i + 1] != 'Q')) || (Element[i + 2] != '='))
+		  continue;
+
+		i += 3;
+
+		if ((i == ElementLength) || (Element[i] != '0'))
+		  break;
+
+		/* Any non-zero digit after the leading zero gives a non-zero quality value */
+		while ((++i < ElementLength) && ((Element[i] == '0') || (Element[i] == '.')));
+
+		*IsAccepted = ((i < ElementLength) && (Element[i] >= '1') && (Element[i] <= '9'));
+		break;
+	}
+
+	return Match;
+}
+
+/** Determines if an asset may be sent to a client, given the contents of the HTTP Accept-Encoding header of its request.
+ *  Assets which are stored gzip encoded may only be sent to clients which accept that coding; a client which does not
+ *  send the header is assumed to accept only uncompressed content.
+ *
+ *  \param[in] Asset                 Pointer to the asset to be sent
+ *  \param[in] AcceptEncoding        Value of the client's Accept-Encoding header, or \c NULL if the request has none
+ *  \param[in] AcceptEncodingLength  Length of the header value in characters
+ *
+ *  \return Boolean \c true if the asset may be sent to the client, \c false otherwise
+ */
+bool WebAssets_IsEncodingAccepted(const WebAsset_t* const Asset,
+                                  const char* AcceptEncoding,
+                                  uint8_t AcceptEncodingLength)
+{
+	bool IsNamed            = false;
+	bool IsNamedAccepted    = false;
+	bool IsWildcardAccepted = false;
+
+	if (!(Asset->IsGzipEncoded))
+	  return true;
+
+	if (AcceptEncoding == NULL)
+	  return false;
+
+	/* Every element of the header's comma separated list is checked, as naming gzip overrides the "*" wildcard */
+	while (AcceptEncodingLength)
+	{
+		uint8_t ElementLength = 0;
+		bool    IsAccepted    = false;
+
+		while ((ElementLength < AcceptEncodingLength) && (AcceptEncoding[ElementLength] != ','))
+		  ElementLength++;
+
+		switch (WebAssets_MatchGzipCoding(AcceptEncoding, ElementLength, &IsAccepted))
+		{
+			case WEB_ASSETS_CODING_NAMED:
+				IsNamed          = true;
+				IsNamedAccepted |= IsAccepted;
+				break;
+			case WEB_ASSETS_CODING_WILDCARD:
+				IsWildcardAccepted |= IsAccepted;
+				break;
+		}
+
+		if (ElementLength < AcceptEncodingLength)
+		  ElementLength++;
+
+		AcceptEncoding       += ElementLength;
+		AcceptEncodingLength -= ElementLength;
+	}
+
+	return (IsNamed ? IsNamedAccepted : IsWildcardAccepted);
+}
+
@@ -629,6 +629,7 @@ void uip_log(char *msg);
 #include <stdint.h>
 
 #include "timer.h"
+#include "Lib/WebAssets.h"
 
 typedef uint8_t u8_t;
 typedef uint16_t u16_t;
@@ -698,6 +699,12 @@ typedef union
 		bool     FileOpen;
 		uint32_t ACKedFilePos;
 		uint16_t SentChunkSize;
+		struct HTTPServer_ReadAhead* ReadAhead;
+
+		WebAsset_t Asset;
+		bool       AssetFound;
+		bool       AssetNotModified;
+		bool       AssetNotAcceptable;
 	} HTTPServer;
 
 	struct